@@ -0,0 +1,15 @@
+"""
+PARP-01 binary control protocol client (host side, CPython + pyserial)
+
+Talks to the reader's second CDC ACM port (src/ctrl_proto.h): settings
+get/set with atomic commit, statistics, stock-take session download and
+firmware identification.
+"""
+
+from .protocol import (Frame, FrameError, encode_frame, FrameDecoder,
+                       encode_tlvs, decode_tlvs, CONFIG_KEYS)
+from .client import ParpCtrl, CtrlError
+
+__version__ = "1.0.0"
+__all__ = ['ParpCtrl', 'CtrlError', 'Frame', 'FrameError', 'encode_frame',
+           'FrameDecoder', 'encode_tlvs', 'decode_tlvs', 'CONFIG_KEYS']
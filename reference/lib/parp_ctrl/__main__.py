@@ -0,0 +1,85 @@
+"""
+Command line front end for the PARP-01 control protocol
+
+Usage (from reference/lib):
+    python3 -m parp_ctrl --port /dev/ttyACM1 ident
+    python3 -m parp_ctrl --port /dev/ttyACM1 get
+    python3 -m parp_ctrl --port /dev/ttyACM1 set rf_power=20 frequency=4,0,5 --flush
+    python3 -m parp_ctrl --port /dev/ttyACM1 stats
+    python3 -m parp_ctrl --port /dev/ttyACM1 session begin|stop
+    python3 -m parp_ctrl --port /dev/ttyACM1 session export -o s.bin [--prev]
+
+`set` stages all values and commits them as one change: if any value is
+rejected, nothing is applied.
+"""
+
+import argparse
+import json
+import sys
+
+from .client import ParpCtrl, CtrlError
+
+
+def parse_settings(pairs):
+    out = {}
+    for pair in pairs:
+        name, _, value = pair.partition("=")
+        if not value:
+            raise SystemExit(f"expected name=value, got '{pair}'")
+        parts = [int(v, 0) for v in value.split(",")]
+        out[name] = tuple(parts) if len(parts) > 1 else parts[0]
+    return out
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    ap.add_argument("--port", required=True, help="control interface device")
+    ap.add_argument("--timeout", type=float, default=1.0)
+    sub = ap.add_subparsers(dest="cmd", required=True)
+
+    sub.add_parser("ident", help="firmware identification")
+    g = sub.add_parser("get", help="read all settings")
+    g.add_argument("--staged", action="store_true")
+    s = sub.add_parser("set", help="set and commit settings atomically")
+    s.add_argument("settings", nargs="+", help="name=value (frequency=r,s,e)")
+    s.add_argument("--flush", action="store_true",
+                   help="wait for the EEPROM write")
+    sub.add_parser("stats", help="statistics snapshot")
+    ss = sub.add_parser("session", help="stock-take session")
+    ss.add_argument("op", choices=("begin", "stop", "export"))
+    ss.add_argument("-o", "--output", help="export: binary stream path")
+    ss.add_argument("--prev", action="store_true",
+                    help="export: previous session")
+    args = ap.parse_args()
+
+    try:
+        with ParpCtrl(args.port, timeout=args.timeout) as reader:
+            if args.cmd == "ident":
+                result = reader.ident()
+            elif args.cmd == "get":
+                result = reader.get_config(staged=args.staged)
+            elif args.cmd == "set":
+                result = reader.configure(flush=args.flush,
+                                          **parse_settings(args.settings))
+            elif args.cmd == "stats":
+                result = reader.stats()
+            elif args.op == "begin":
+                result = {"session": reader.session_begin()}
+            elif args.op == "stop":
+                result = {"session": reader.session_stop()}
+            else:
+                if not args.output:
+                    ap.error("session export needs -o")
+                stream = reader.session_export(previous=args.prev)
+                with open(args.output, "wb") as f:
+                    f.write(stream)
+                result = {"output": args.output, "bytes": len(stream),
+                          "decode": "tools/session_export.py --decode"}
+    except CtrlError as e:
+        sys.exit(f"error: {e}")
+
+    print(json.dumps(result, indent=2))
+
+
+if __name__ == "__main__":
+    main()
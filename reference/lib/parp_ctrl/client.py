@@ -0,0 +1,250 @@
+"""
+PARP-01 control protocol client over the reader's second CDC ACM port
+
+Example:
+    from parp_ctrl import ParpCtrl
+
+    with ParpCtrl("/dev/ttyACM1") as reader:
+        print(reader.ident())
+        reader.set_config(rf_power=20, frequency=(4, 0, 5))
+        print(reader.commit(flush=True))
+"""
+
+import struct
+import time
+
+from . import protocol as p
+
+
+class CtrlError(Exception):
+    """Request answered with a non-OK status, or not answered at all"""
+
+    def __init__(self, message, status=None, payload=b""):
+        super().__init__(message)
+        self.status = status
+        self.payload = payload
+
+
+class ParpCtrl:
+    """Request/response client; one request in flight at a time"""
+
+    def __init__(self, port: str, timeout: float = 1.0, retries: int = 3,
+                 commit_timeout: float = 8.0):
+        """
+        Args:
+            port (str): Serial device of the control interface
+            timeout (float): Response timeout per attempt in seconds
+            retries (int): Attempts per request (same seq on every retry,
+                so the reader runs it at most once)
+            commit_timeout (float): Response timeout for CONFIG_COMMIT,
+                which waits for the E310 round boundary
+        """
+        import serial  # pyserial
+
+        self.ser = serial.Serial(port, 115200, timeout=0.05)
+        self.ser.reset_input_buffer()
+        self.timeout = timeout
+        self.retries = retries
+        self.commit_timeout = commit_timeout
+        self.decoder = p.FrameDecoder()
+        self.events = []
+        self.seq = int(time.time()) & 0xFF
+
+    def close(self):
+        self.ser.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    # ------------------------------------------------------------------
+    # Transport
+    # ------------------------------------------------------------------
+
+    def request(self, cmd: int, payload: bytes = b"", timeout: float = None,
+                ok=(p.ST_OK,)):
+        """Send one request; return (status, response payload)"""
+        self.seq = (self.seq + 1) & 0xFF
+        frame = p.encode_frame(self.seq, cmd, payload)
+        timeout = timeout or self.timeout
+
+        for _ in range(self.retries):
+            self.ser.write(frame)
+            deadline = time.monotonic() + timeout
+            while time.monotonic() < deadline:
+                for rsp in self.decoder.feed(self.ser.read(4096)):
+                    if rsp.cmd == p.EVT_TAGS:
+                        self.events.append(rsp.payload)
+                        continue
+                    if rsp.seq != self.seq or rsp.cmd != (cmd | p.RSP_FLAG):
+                        continue  # late answer to an earlier attempt
+                    if not rsp.payload:
+                        raise CtrlError("empty response")
+                    status, data = rsp.payload[0], rsp.payload[1:]
+                    if status not in ok:
+                        name = p.STATUS_NAMES.get(status, str(status))
+                        raise CtrlError(f"cmd 0x{cmd:02X}: {name}", status,
+                                        data)
+                    return status, data
+        raise CtrlError(f"cmd 0x{cmd:02X}: no response")
+
+    # ------------------------------------------------------------------
+    # Identification
+    # ------------------------------------------------------------------
+
+    def ident(self) -> dict:
+        _, data = self.request(p.CMD_IDENT)
+        (proto, major, minor, patch, kernel, caps, max_payload, uid_len, uid,
+         uptime, board, build) = p.IDENT.unpack_from(data)
+        return {
+            "protocol": proto,
+            "firmware": f"{major}.{minor}.{patch}",
+            "build": build.rstrip(b"\0").decode(errors="replace"),
+            "zephyr": f"{kernel >> 24}.{(kernel >> 16) & 0xFF}."
+                      f"{(kernel >> 8) & 0xFF}",
+            "board": board.rstrip(b"\0").decode(errors="replace"),
+            "uid": uid[:uid_len].hex().upper(),
+            "capabilities": caps,
+            "max_payload": max_payload,
+            "uptime_s": uptime,
+        }
+
+    # ------------------------------------------------------------------
+    # Settings
+    # ------------------------------------------------------------------
+
+    def get_config(self, staged: bool = False) -> dict:
+        source = p.CFG_STAGED if staged else p.CFG_LIVE
+        _, data = self.request(p.CMD_CONFIG_GET, bytes([source]))
+        return p.decode_tlvs(data)
+
+    def set_config(self, **settings):
+        """Stage settings (nothing changes until commit())"""
+        self.request(p.CMD_CONFIG_SET, p.encode_tlvs(settings))
+
+    def commit(self, flush: bool = False) -> dict:
+        """Apply everything staged as one change
+
+        Args:
+            flush (bool): Also wait until the EEPROM write is verified
+        Returns:
+            dict: changed settings, config version, apply time and whether
+            the E310 had taken it before the reader answered
+        """
+        flags = p.COMMIT_F_FLUSH if flush else 0
+        status, data = self.request(p.CMD_CONFIG_COMMIT, bytes([flags]),
+                                    timeout=self.commit_timeout,
+                                    ok=(p.ST_OK, p.ST_TIMEOUT))
+        changed, version, total_us = p.COMMIT_RSP.unpack_from(data)
+        return {
+            "changed": [n for bit, n in p.CHANGED_BITS.items()
+                        if changed & bit],
+            "version": version,
+            "total_ms": total_us / 1000.0,
+            "e310_applied": status == p.ST_OK,
+        }
+
+    def abort(self):
+        self.request(p.CMD_CONFIG_ABORT)
+
+    def configure(self, flush: bool = False, **settings) -> dict:
+        """Stage and commit in one go; nothing is applied if a value is bad"""
+        try:
+            self.set_config(**settings)
+        except CtrlError:
+            self.abort()
+            raise
+        return self.commit(flush=flush)
+
+    # ------------------------------------------------------------------
+    # Statistics
+    # ------------------------------------------------------------------
+
+    def stats(self) -> dict:
+        _, data = self.request(p.CMD_STATS)
+        out = {}
+        pos = 0
+        while pos + 3 <= len(data):
+            sid, length = data[pos], struct.unpack_from("<H", data, pos + 1)[0]
+            body = data[pos + 3:pos + 3 + length]
+            pos += 3 + length
+            if sid == p.STATS_STATE:
+                v = p.STATE.unpack_from(body)
+                out["state"] = dict(zip(
+                    ("mode", "running", "inventory_active", "e310_connected",
+                     "reader_addr", "epc_cached", "config_version",
+                     "uptime_ms"), v))
+            elif sid == p.STATS_ROUTER:
+                v = struct.unpack_from(f"<{len(body) // 4}I", body)
+                out["router"] = dict(zip(p.ROUTER_STATS_FIELDS, v))
+            elif sid == p.STATS_TAG_STORE:
+                v = struct.unpack_from(f"<{len(body) // 4}I", body)
+                out["tag_store"] = dict(zip(p.TAG_STORE_FIELDS, v))
+            elif sid == p.STATS_SESSION:
+                fields = ("id", "running", "tags", "reads", "full_drops",
+                          "duration_s", "blocks")
+                out["sessions"] = [
+                    dict(zip(fields, p.SESSION_INFO.unpack_from(body, off)))
+                    for off in range(0, len(body), p.SESSION_INFO.size)
+                ]
+            elif sid == p.STATS_METRICS:
+                # router_metrics_snapshot_t: tools/router_snapshot.py decode()
+                out["metrics_hex"] = body.hex()
+        return out
+
+    # ------------------------------------------------------------------
+    # Stock-take sessions
+    # ------------------------------------------------------------------
+
+    def session_begin(self) -> int:
+        _, data = self.request(p.CMD_SESSION_CTRL, bytes([p.SESSION_BEGIN]))
+        return struct.unpack_from("<I", data)[0]
+
+    def session_stop(self) -> int:
+        _, data = self.request(p.CMD_SESSION_CTRL, bytes([p.SESSION_STOP]))
+        return struct.unpack_from("<I", data)[0]
+
+    def session_export(self, previous: bool = False) -> bytes:
+        """Download a session as the `session export bin` stream
+
+        Decode with tools/session_export.py --decode.
+        """
+        stream = bytearray()
+        flags = p.READ_F_RESTART
+        while True:
+            _, data = self.request(p.CMD_SESSION_READ,
+                                   bytes([1 if previous else 0, flags]))
+            rflags, offset = struct.unpack_from("<BI", data)
+            if offset != len(stream):
+                raise CtrlError(f"session stream gap at {len(stream)} "
+                                f"(chunk at {offset})")
+            stream += data[5:]
+            flags = 0
+            if rflags & p.READ_F_LAST:
+                if rflags & p.READ_F_PARTIAL:
+                    raise CtrlError("session discarded during the export")
+                return bytes(stream)
+
+    # ------------------------------------------------------------------
+    # Tag stream
+    # ------------------------------------------------------------------
+
+    def tag_stream(self, on: bool = True) -> int:
+        """Start/stop EVT_TAGS frames; returns the next event seq"""
+        _, data = self.request(p.CMD_TAG_STREAM, bytes([1 if on else 0]))
+        return struct.unpack_from("<I", data)[0]
+
+    def tags(self, duration: float = None):
+        """Yield (seq, read_ms, epc, rssi, antenna, flags) as they arrive
+
+        For high rates use tools/parpd, which does the same in C.
+        """
+        end = None if duration is None else time.monotonic() + duration
+        while end is None or time.monotonic() < end:
+            while self.events:
+                yield from p.decode_tag_event(self.events.pop(0))
+            for frame in self.decoder.feed(self.ser.read(4096)):
+                if frame.cmd == p.EVT_TAGS:
+                    yield from p.decode_tag_event(frame.payload)
@@ -0,0 +1,227 @@
+"""
+Framing, CRC and payload layouts of the PARP-01 control protocol
+Mirrors src/ctrl_proto.h (protocol version 1)
+
+Frame (little endian):
+    [0xA5][len u16][seq u8][cmd u8][payload][crc u16]
+    crc = CRC-16/CCITT-FALSE over len..payload
+"""
+
+import struct
+
+PROTO_VERSION = 1
+SOF = 0xA5
+MAX_PAYLOAD = 1024
+RSP_FLAG = 0x80
+
+# Commands
+CMD_IDENT = 0x01
+CMD_CONFIG_GET = 0x10
+CMD_CONFIG_SET = 0x11
+CMD_CONFIG_COMMIT = 0x12
+CMD_CONFIG_ABORT = 0x13
+CMD_STATS = 0x20
+CMD_SESSION_CTRL = 0x30
+CMD_SESSION_READ = 0x31
+CMD_TAG_STREAM = 0x40
+
+# Unsolicited frames
+EVT_TAGS = 0xF0
+
+# Status codes
+STATUS_NAMES = {
+    0: "OK",
+    1: "UNKNOWN_CMD",
+    2: "BAD_LENGTH",
+    3: "BAD_KEY",
+    4: "BAD_VALUE",
+    5: "NO_STAGED",
+    6: "NOT_FOUND",
+    7: "TIMEOUT",
+    8: "BUSY",
+    9: "ERROR",
+}
+ST_OK = 0
+ST_TIMEOUT = 7
+
+# Settings: name -> (key, struct format of the value)
+CONFIG_KEYS = {
+    "rf_power": (0x01, "<B"),
+    "antenna": (0x02, "<B"),
+    "frequency": (0x03, "<BBB"),      # (region, start, end)
+    "inventory_time": (0x04, "<B"),
+    "reader_addr": (0x05, "<B"),
+    "typing_speed": (0x06, "<H"),
+    "beep_pulse": (0x07, "<H"),
+    "beep_filter": (0x08, "<H"),
+    "epc_debounce": (0x09, "<B"),
+    "inventory_interval": (0x0A, "<H"),
+    "rgb_brightness": (0x0B, "<B"),
+}
+_KEY_NAMES = {key: (name, fmt) for name, (key, fmt) in CONFIG_KEYS.items()}
+
+CFG_LIVE = 0
+CFG_STAGED = 1
+COMMIT_F_FLUSH = 0x01
+
+# Commit "changed" bits (E310_PROFILE_F_* and CTRL_CHANGED_READER_ADDR)
+CHANGED_BITS = {
+    0x0001: "rf_power",
+    0x0002: "antenna",
+    0x0004: "frequency",
+    0x0008: "inventory_time",
+    0x0010: "typing_speed",
+    0x0020: "beep_pulse",
+    0x0040: "beep_filter",
+    0x0080: "epc_debounce",
+    0x0100: "inventory_interval",
+    0x0200: "rgb_brightness",
+    0x10000: "reader_addr",
+}
+
+# STATS sections
+STATS_ROUTER = 0x01
+STATS_METRICS = 0x02
+STATS_TAG_STORE = 0x03
+STATS_SESSION = 0x04
+STATS_STATE = 0x05
+
+SESSION_BEGIN = 0
+SESSION_STOP = 1
+READ_F_RESTART = 0x01
+READ_F_LAST = 0x01
+READ_F_PARTIAL = 0x02
+
+TAG_F_NEW = 0x01
+TAG_F_DELIVERED = 0x02
+
+IDENT = struct.Struct("<BBBBIIHB12sI16s24s")
+COMMIT_RSP = struct.Struct("<III")
+TAG_REC = struct.Struct("<IIBBBB")      # seq, read_ms, rssi, antenna, flags, len
+SESSION_INFO = struct.Struct("<IBIIIIH")
+STATE = struct.Struct("<BBBBBBII")
+ROUTER_STATS_FIELDS = (
+    "uart1_rx_bytes", "uart1_tx_bytes", "uart4_rx_bytes", "uart4_tx_bytes",
+    "rx_overruns", "tx_errors", "frames_parsed", "parse_errors",
+    "tags_read", "unique_tags", "epc_sent", "epc_stored",
+)
+TAG_STORE_FIELDS = (
+    "buffered", "replayed", "expired", "deduped", "dropped", "failed",
+    "records", "used_bytes", "oldest_age_ms",
+)
+
+
+class FrameError(Exception):
+    """Malformed frame"""
+
+
+class Frame:
+    """One decoded frame"""
+
+    def __init__(self, seq: int, cmd: int, payload: bytes):
+        self.seq = seq
+        self.cmd = cmd
+        self.payload = payload
+
+    def __repr__(self):
+        return (f"Frame(seq={self.seq}, cmd=0x{self.cmd:02X}, "
+                f"len={len(self.payload)})")
+
+
+def crc16(data: bytes) -> int:
+    """CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)"""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            if crc & 0x8000:
+                crc = ((crc << 1) ^ 0x1021) & 0xFFFF
+            else:
+                crc = (crc << 1) & 0xFFFF
+    return crc
+
+
+def encode_frame(seq: int, cmd: int, payload: bytes = b"") -> bytes:
+    if len(payload) > MAX_PAYLOAD:
+        raise FrameError(f"payload too long ({len(payload)})")
+    body = struct.pack("<HBB", len(payload), seq & 0xFF, cmd) + payload
+    return bytes([SOF]) + body + struct.pack("<H", crc16(body))
+
+
+class FrameDecoder:
+    """Incremental decoder: feed() bytes, get complete frames back"""
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.crc_errors = 0
+
+    def feed(self, data: bytes) -> list:
+        self.buf += data
+        frames = []
+        while True:
+            start = self.buf.find(bytes([SOF]))
+            if start < 0:
+                self.buf.clear()
+                return frames
+            del self.buf[:start]
+            if len(self.buf) < 3:
+                return frames
+            length = struct.unpack_from("<H", self.buf, 1)[0]
+            if length > MAX_PAYLOAD:
+                del self.buf[:1]
+                continue
+            total = 1 + 4 + length + 2
+            if len(self.buf) < total:
+                return frames
+            body = bytes(self.buf[1:5 + length])
+            crc = struct.unpack_from("<H", self.buf, 5 + length)[0]
+            if crc16(body) != crc:
+                self.crc_errors += 1
+                del self.buf[:1]
+                continue
+            del self.buf[:total]
+            frames.append(Frame(body[2], body[3], body[4:]))
+
+
+def encode_tlvs(settings: dict) -> bytes:
+    """{name: value} -> TLV bytes (frequency is a (region, start, end) tuple)"""
+    out = bytearray()
+    for name, value in settings.items():
+        if name not in CONFIG_KEYS:
+            raise KeyError(f"unknown setting '{name}'")
+        key, fmt = CONFIG_KEYS[name]
+        values = value if isinstance(value, (tuple, list)) else (value,)
+        data = struct.pack(fmt, *values)
+        out += bytes([key, len(data)]) + data
+    return bytes(out)
+
+
+def decode_tlvs(data: bytes) -> dict:
+    """TLV bytes -> {name: value}; unknown keys are kept as 'key_0xNN'"""
+    out = {}
+    pos = 0
+    while pos + 2 <= len(data):
+        key, length = data[pos], data[pos + 1]
+        value = data[pos + 2:pos + 2 + length]
+        pos += 2 + length
+        if key in _KEY_NAMES and struct.calcsize(_KEY_NAMES[key][1]) == length:
+            name, fmt = _KEY_NAMES[key]
+            fields = struct.unpack(fmt, value)
+            out[name] = fields if len(fields) > 1 else fields[0]
+        else:
+            out[f"key_0x{key:02X}"] = value.hex()
+    return out
+
+
+def decode_tag_event(payload: bytes) -> list:
+    """EVT_TAGS payload -> [(seq, read_ms, epc_hex, rssi, antenna, flags)]"""
+    tags = []
+    pos = 1
+    for _ in range(payload[0] if payload else 0):
+        seq, read_ms, rssi, antenna, flags, epc_len = \
+            TAG_REC.unpack_from(payload, pos)
+        pos += TAG_REC.size
+        epc = payload[pos:pos + epc_len]
+        pos += epc_len
+        tags.append((seq, read_ms, epc.hex().upper(), rssi, antenna, flags))
+    return tags
@@ -2,6 +2,11 @@
  * @file beep_control.c
  * @brief Beeper Control Implementation
  *
+ * The beeper is driven from TIM13_CH1 (beep-pwm alias) at full duty,
+ * the same level drive the GPIO gave it, or from the beep-out GPIO on
+ * boards without the timer. Pulse timing and the filter window belong
+ * to the feedback coalescer (feedback.h).
+ *
  * @copyright Copyright (c) 2026 PARP
  */
 
@@ -9,78 +14,63 @@
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
 #include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/pwm.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/shell/shell.h>
 #include <stdlib.h>
 #include "e310_settings.h"
+#include "feedback.h"
+#include "runtime_config.h"
 
 LOG_MODULE_REGISTER(beep_control, LOG_LEVEL_INF);
 
 /* Device tree references */
+#define BEEP_PWM_NODE DT_ALIAS(beep_pwm)
 #define BEEP_OUT_NODE DT_ALIAS(beep_out)
 #define E310_BEEP_NODE DT_ALIAS(e310_beep)
 
-#if !DT_NODE_EXISTS(BEEP_OUT_NODE)
-#error "beep-out alias not found in device tree"
+#if DT_NODE_EXISTS(BEEP_PWM_NODE)
+#define BEEP_USE_PWM 1
+static const struct pwm_dt_spec beep_pwm = PWM_DT_SPEC_GET(BEEP_PWM_NODE);
+#elif DT_NODE_EXISTS(BEEP_OUT_NODE)
+static const struct gpio_dt_spec beep_out = GPIO_DT_SPEC_GET(BEEP_OUT_NODE, gpios);
+#else
+#error "beep-pwm or beep-out alias not found in device tree"
 #endif
 
 #if !DT_NODE_EXISTS(E310_BEEP_NODE)
 #error "e310-beep alias not found in device tree"
 #endif
 
-static const struct gpio_dt_spec beep_out = GPIO_DT_SPEC_GET(BEEP_OUT_NODE, gpios);
 static const struct gpio_dt_spec e310_beep = GPIO_DT_SPEC_GET(E310_BEEP_NODE, gpios);
 
 /* State variables */
-static uint16_t beep_pulse_ms = BEEP_DEFAULT_PULSE_MS;
-static uint16_t beep_filter_ms = BEEP_DEFAULT_FILTER_MS;
 static bool e310_input_enabled = true;
-static uint32_t beep_count;
-static int64_t last_beep_time;
+static atomic_t beep_count;
 /* Initialization flag - volatile for ISR/main thread synchronization */
 static volatile bool initialized;
 
 /* GPIO callback for E310 input */
 static struct gpio_callback e310_beep_cb_data;
 
-/* Work queue for beep pulse */
-static struct k_work_delayable beep_off_work;
-static struct k_work beep_trigger_work;
-
-/**
- * @brief Turn off beeper (work handler)
- */
-static void beep_off_handler(struct k_work *work)
-{
-	ARG_UNUSED(work);
-	gpio_pin_set_dt(&beep_out, 0);
-}
+/* Edge capture: written by the PG0 ISR only */
+static volatile bool edge_capture;
+static uint32_t edge_cyc[BEEP_EDGE_HISTORY];
+static atomic_t edge_count;
 
-/**
- * @brief Execute beep pulse (work handler for ISR context)
- */
-static void beep_trigger_handler(struct k_work *work)
+void beep_control_set_output(bool on)
 {
-	ARG_UNUSED(work);
-
-	int64_t now = k_uptime_get();
-
-	/* Apply duplicate filter */
-	if ((now - last_beep_time) < beep_filter_ms) {
-		LOG_DBG("Beep filtered (within %u ms window)", beep_filter_ms);
+	if (!initialized) {
 		return;
 	}
-
-	last_beep_time = now;
-	beep_count++;
-
-	/* Turn on beeper */
-	gpio_pin_set_dt(&beep_out, 1);
-
-	/* Schedule turn off */
-	k_work_schedule(&beep_off_work, K_MSEC(beep_pulse_ms));
-
-	LOG_DBG("Beep triggered (count=%u, pulse=%u ms)", beep_count, beep_pulse_ms);
+	if (on) {
+		atomic_inc(&beep_count);
+	}
+#ifdef BEEP_USE_PWM
+	(void)pwm_set_pulse_dt(&beep_pwm, on ? beep_pwm.period : 0);
+#else
+	(void)gpio_pin_set_dt(&beep_out, on ? 1 : 0);
+#endif
 }
 
 /**
@@ -93,18 +83,38 @@ static void e310_beep_isr(const struct device *dev,
 	ARG_UNUSED(cb);
 	ARG_UNUSED(pins);
 
+	if (edge_capture) {
+		uint32_t n = (uint32_t)atomic_get(&edge_count);
+
+		edge_cyc[n & (BEEP_EDGE_HISTORY - 1)] = k_cycle_get_32();
+		atomic_set(&edge_count, (atomic_val_t)(n + 1));
+	}
+
 	if (!e310_input_enabled) {
 		return;
 	}
 
-	/* Schedule beep trigger from work queue (not ISR context) */
-	k_work_submit(&beep_trigger_work);
+	feedback_request(FEEDBACK_BEEP);
 }
 
 int beep_control_init(void)
 {
 	int ret;
 
+#ifdef BEEP_USE_PWM
+	/* Check beep output timer */
+	if (!pwm_is_ready_dt(&beep_pwm)) {
+		LOG_ERR("Beep output PWM device not ready");
+		return -ENODEV;
+	}
+
+	/* Beep output LOW initially */
+	ret = pwm_set_pulse_dt(&beep_pwm, 0);
+	if (ret < 0) {
+		LOG_ERR("Failed to configure beep output PWM: %d", ret);
+		return ret;
+	}
+#else
 	/* Check beep output GPIO */
 	if (!gpio_is_ready_dt(&beep_out)) {
 		LOG_ERR("Beep output GPIO device not ready");
@@ -117,6 +127,7 @@ int beep_control_init(void)
 		LOG_ERR("Failed to configure beep output GPIO: %d", ret);
 		return ret;
 	}
+#endif
 
 	/* Check E310 beep input GPIO */
 	if (!gpio_is_ready_dt(&e310_beep)) {
@@ -153,16 +164,14 @@ int beep_control_init(void)
 		return ret;
 	}
 
-	/* Initialize work items */
-	k_work_init_delayable(&beep_off_work, beep_off_handler);
-	k_work_init(&beep_trigger_work, beep_trigger_handler);
-
 	initialized = true;
 
 	LOG_INF("Beep control initialized");
-	LOG_INF("  Output: PF8 (BEEP_FROM_MCU)");
+	LOG_INF("  Output: PF8 (BEEP_FROM_MCU, %s)",
+		IS_ENABLED(BEEP_USE_PWM) ? "TIM13_CH1" : "GPIO");
 	LOG_INF("  Input: PG0 (TY928_BEEP from E310)");
-	LOG_INF("  Pulse: %u ms, Filter: %u ms", beep_pulse_ms, beep_filter_ms);
+	LOG_INF("  Pulse: %u ms, Filter: %u ms",
+		beep_control_get_pulse_ms(), beep_control_get_filter_ms());
 
 	return 0;
 }
@@ -173,8 +182,7 @@ void beep_control_trigger(void)
 		return;
 	}
 
-	/* Use work queue for thread safety */
-	k_work_submit(&beep_trigger_work);
+	feedback_request(FEEDBACK_BEEP);
 }
 
 void beep_control_trigger_force(void)
@@ -183,20 +191,7 @@ void beep_control_trigger_force(void)
 		return;
 	}
 
-	/*
-	 * Direct trigger bypassing filter.
-	 * Use irq_lock to prevent race condition with ISR context
-	 * accessing beep_count and last_beep_time.
-	 */
-	unsigned int key = irq_lock();
-	beep_count++;
-	last_beep_time = k_uptime_get();
-	irq_unlock(key);
-
-	gpio_pin_set_dt(&beep_out, 1);
-	k_work_schedule(&beep_off_work, K_MSEC(beep_pulse_ms));
-
-	LOG_DBG("Beep forced (count=%u)", beep_count);
+	feedback_request_now(FEEDBACK_BEEP);
 }
 
 void beep_control_set_pulse_ms(uint16_t ms)
@@ -206,13 +201,17 @@ void beep_control_set_pulse_ms(uint16_t ms)
 	} else if (ms > BEEP_MAX_PULSE_MS) {
 		ms = BEEP_MAX_PULSE_MS;
 	}
-	beep_pulse_ms = ms;
-	LOG_INF("Beep pulse set to %u ms", beep_pulse_ms);
+	runtime_config_edit()->beep_pulse_ms = ms;
+	runtime_config_publish();
+	LOG_INF("Beep pulse set to %u ms", ms);
 }
 
 uint16_t beep_control_get_pulse_ms(void)
 {
-	return beep_pulse_ms;
+	runtime_config_t cfg;
+
+	runtime_config_get(&cfg);
+	return cfg.beep_pulse_ms;
 }
 
 void beep_control_set_filter_ms(uint16_t ms)
@@ -222,13 +221,17 @@ void beep_control_set_filter_ms(uint16_t ms)
 	} else if (ms > BEEP_MAX_FILTER_MS) {
 		ms = BEEP_MAX_FILTER_MS;
 	}
-	beep_filter_ms = ms;
-	LOG_INF("Beep filter set to %u ms", beep_filter_ms);
+	runtime_config_edit()->beep_filter_ms = ms;
+	runtime_config_publish();
+	LOG_INF("Beep filter set to %u ms", ms);
 }
 
 uint16_t beep_control_get_filter_ms(void)
 {
-	return beep_filter_ms;
+	runtime_config_t cfg;
+
+	runtime_config_get(&cfg);
+	return cfg.beep_filter_ms;
 }
 
 void beep_control_enable_e310_input(bool enable)
@@ -242,14 +245,49 @@ bool beep_control_is_e310_input_enabled(void)
 	return e310_input_enabled;
 }
 
+void beep_control_set_edge_capture(bool enable)
+{
+	edge_capture = enable;
+	LOG_INF("E310 beep edge capture %s", enable ? "on" : "off");
+}
+
+bool beep_control_is_edge_capture_enabled(void)
+{
+	return edge_capture;
+}
+
+uint32_t beep_control_get_edge_count(void)
+{
+	return (uint32_t)atomic_get(&edge_count);
+}
+
+int beep_control_get_edge_time(uint32_t index, uint32_t *cycles)
+{
+	uint32_t count = (uint32_t)atomic_get(&edge_count);
+	uint32_t cyc;
+
+	if ((int32_t)(count - index) <= 0 ||
+	    count - index > BEEP_EDGE_HISTORY) {
+		return -ENOENT;
+	}
+	cyc = edge_cyc[index & (BEEP_EDGE_HISTORY - 1)];
+
+	/* The ISR may have lapped the slot while we read it */
+	if ((uint32_t)atomic_get(&edge_count) - index > BEEP_EDGE_HISTORY) {
+		return -ENOENT;
+	}
+	*cycles = cyc;
+	return 0;
+}
+
 uint32_t beep_control_get_count(void)
 {
-	return beep_count;
+	return (uint32_t)atomic_get(&beep_count);
 }
 
 void beep_control_reset_count(void)
 {
-	beep_count = 0;
+	atomic_clear(&beep_count);
 }
 
 /* ========================================================================
@@ -267,7 +305,7 @@ static int cmd_beep_test(const struct shell *sh, size_t argc, char **argv)
 	}
 
 	beep_control_trigger_force();
-	shell_print(sh, "Beep test triggered (pulse=%u ms)", beep_pulse_ms);
+	shell_print(sh, "Beep test triggered (pulse=%u ms)", beep_control_get_pulse_ms());
 
 	return 0;
 }
@@ -275,7 +313,7 @@ static int cmd_beep_test(const struct shell *sh, size_t argc, char **argv)
 static int cmd_beep_pulse(const struct shell *sh, size_t argc, char **argv)
 {
 	if (argc < 2) {
-		shell_print(sh, "Current pulse width: %u ms", beep_pulse_ms);
+		shell_print(sh, "Current pulse width: %u ms", beep_control_get_pulse_ms());
 		shell_print(sh, "Usage: beep pulse <10-1000>");
 		return 0;
 	}
@@ -291,7 +329,7 @@ static int cmd_beep_pulse(const struct shell *sh, size_t argc, char **argv)
 	/* Persist to EEPROM */
 	int ret = e310_settings_set_beep_pulse((uint16_t)ms);
 	shell_print(sh, "Pulse width set to %u ms%s",
-		    beep_pulse_ms, (ret < 0) ? "" : " (saved)");
+		    beep_control_get_pulse_ms(), (ret < 0) ? "" : " (saved)");
 	if (ret < 0) {
 		shell_warn(sh, "EEPROM save failed: %d (change is temporary)", ret);
 	}
@@ -302,7 +340,7 @@ static int cmd_beep_pulse(const struct shell *sh, size_t argc, char **argv)
 static int cmd_beep_filter(const struct shell *sh, size_t argc, char **argv)
 {
 	if (argc < 2) {
-		shell_print(sh, "Current filter time: %u ms", beep_filter_ms);
+		shell_print(sh, "Current filter time: %u ms", beep_control_get_filter_ms());
 		shell_print(sh, "Usage: beep filter <100-10000>");
 		return 0;
 	}
@@ -318,7 +356,7 @@ static int cmd_beep_filter(const struct shell *sh, size_t argc, char **argv)
 	/* Persist to EEPROM */
 	int ret = e310_settings_set_beep_filter((uint16_t)ms);
 	shell_print(sh, "Filter time set to %u ms%s",
-		    beep_filter_ms, (ret < 0) ? "" : " (saved)");
+		    beep_control_get_filter_ms(), (ret < 0) ? "" : " (saved)");
 	if (ret < 0) {
 		shell_warn(sh, "EEPROM save failed: %d (change is temporary)", ret);
 	}
@@ -355,10 +393,12 @@ static int cmd_beep_status(const struct shell *sh, size_t argc, char **argv)
 
 	shell_print(sh, "=== Beep Control Status ===");
 	shell_print(sh, "Initialized: %s", initialized ? "yes" : "no");
-	shell_print(sh, "Pulse width: %u ms", beep_pulse_ms);
-	shell_print(sh, "Filter time: %u ms", beep_filter_ms);
+	shell_print(sh, "Pulse width: %u ms", beep_control_get_pulse_ms());
+	shell_print(sh, "Filter time: %u ms", beep_control_get_filter_ms());
 	shell_print(sh, "E310 input: %s", e310_input_enabled ? "enabled" : "disabled");
-	shell_print(sh, "Beep count: %u", beep_count);
+	shell_print(sh, "Edge capture: %s (%u edges)", edge_capture ? "on" : "off",
+		    beep_control_get_edge_count());
+	shell_print(sh, "Beep count: %u", beep_control_get_count());
 
 	return 0;
 }
@@ -2,8 +2,14 @@
  * @file beep_control.h
  * @brief Beeper Control with E310 Input Detection
  *
- * Provides beeper output control (PF8) with duplicate filtering,
- * and E310 beep signal input detection (PG0).
+ * Provides beeper output control (PF8, TIM13_CH1 or GPIO) and E310 beep
+ * signal input detection (PG0). Pulses are timed and filtered by the
+ * feedback coalescer (feedback.h).
+ *
+ * Edge capture (measurement mode) counts and timestamps every PG0 edge,
+ * i.e. every tag the E310 itself beeped for, so the router can compare
+ * what the reader saw with what came in over UART4 (`router audit`).
+ * The E310 buzzer output must be enabled (`e310 buzzer on`).
  *
  * @copyright Copyright (c) 2026 PARP
  */
@@ -45,6 +51,9 @@ extern "C" {
 /** Maximum filter time */
 #define BEEP_MAX_FILTER_MS        10000
 
+/** E310 beep edge timestamps kept by edge capture (power of 2) */
+#define BEEP_EDGE_HISTORY         64
+
 /* ========================================================================
  * API Functions
  * ======================================================================== */
@@ -61,18 +70,28 @@ int beep_control_init(void);
 /**
  * @brief Trigger beeper output once
  *
- * Outputs a single beep pulse on PF8. Applies duplicate filtering
- * if called within the filter time window.
+ * Asks the feedback coalescer for a beep pulse on PF8: requests within
+ * the filter window of the last beep are folded into one more beep when
+ * the window closes. ISR-safe.
  */
 void beep_control_trigger(void);
 
 /**
  * @brief Force trigger beeper (bypass filter)
  *
- * Outputs a beep pulse without duplicate filtering.
+ * Outputs a beep pulse now and restarts the filter window.
  */
 void beep_control_trigger_force(void);
 
+/**
+ * @brief Drive the beeper output directly (feedback coalescer only)
+ *
+ * Counts a beep on every switch-on. ISR-safe.
+ *
+ * @param on true for beeper on
+ */
+void beep_control_set_output(bool on);
+
 /**
  * @brief Set beep pulse width
  *
@@ -90,7 +109,9 @@ uint16_t beep_control_get_pulse_ms(void);
 /**
  * @brief Set duplicate filter time
  *
- * Beep requests within this time window from the last beep are ignored.
+ * Beep requests within this time window from the last beep are
+ * coalesced into one beep at the end of the window. The same window
+ * paces the RGB LED tag blink.
  *
  * @param ms Filter time in milliseconds (100-10000)
  */
@@ -119,6 +140,40 @@ void beep_control_enable_e310_input(bool enable);
  */
 bool beep_control_is_e310_input_enabled(void);
 
+/**
+ * @brief Enable/disable E310 beep edge capture (measurement mode)
+ *
+ * Independent of the E310 input relay to the beeper.
+ *
+ * @param enable true to count and timestamp PG0 edges
+ */
+void beep_control_set_edge_capture(bool enable);
+
+/**
+ * @brief Check if edge capture is enabled
+ *
+ * @return true if enabled
+ */
+bool beep_control_is_edge_capture_enabled(void);
+
+/**
+ * @brief Number of E310 beep edges captured (wraps)
+ *
+ * Edge n (0-based) has a timestamp while n >= count - BEEP_EDGE_HISTORY.
+ *
+ * @return Edges captured since init
+ */
+uint32_t beep_control_get_edge_count(void);
+
+/**
+ * @brief Timestamp of a captured edge
+ *
+ * @param index Edge number (see beep_control_get_edge_count())
+ * @param cycles Output: k_cycle_get_32() in the edge ISR
+ * @return 0 on success, -ENOENT if not captured yet or overwritten
+ */
+int beep_control_get_edge_time(uint32_t index, uint32_t *cycles);
+
 /**
  * @brief Get beep trigger count
  *
@@ -0,0 +1,1050 @@
+/**
+ * @file ctrl_proto.c
+ * @brief Binary Configuration and Control Protocol Implementation
+ *
+ * The CDC ACM ISR moves bytes between the endpoint FIFOs and two byte
+ * rings; one thread parses frames, runs the command and queues the
+ * response. Commands run one at a time, in arrival order.
+ *
+ * Tag events: the router thread appends reads to a byte ring (spinlock,
+ * never blocks, newest dropped when full); the control thread packs
+ * whatever is there into CTRL_EVT_TAGS frames between requests.
+ *
+ * Staged settings are a full e310_profile_t plus the reader address,
+ * seeded from the live settings by the first CONFIG_SET after a commit
+ * or abort. CONFIG_SET checks the whole frame before staging any of it.
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#include "ctrl_proto.h"
+#include "e310_profile.h"
+#include "e310_settings.h"
+#include "router_metrics.h"
+#include "runtime_config.h"
+#include "tag_session.h"
+#include "tag_store.h"
+#include <app_version.h>
+#include <zephyr/kernel.h>
+#include <zephyr/version.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/hwinfo.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <string.h>
+#include <errno.h>
+
+LOG_MODULE_REGISTER(ctrl_proto, LOG_LEVEL_INF);
+
+#define CTRL_NODE           DT_NODELABEL(cdc_acm_uart1)
+
+#define CTRL_STACK_SIZE     2048
+#define CTRL_PRIORITY       K_PRIO_PREEMPT(8)
+
+#define RX_RING_SIZE        512
+#define TX_RING_SIZE        2048
+
+/* Tag event ring: ~340 reads of 12-byte EPCs (must be a power of two) */
+#define EVT_RING_SIZE       8192
+#define EVT_RING_MASK       (EVT_RING_SIZE - 1)
+
+/** Longest a response may wait for the host to drain the endpoint */
+#define TX_STALL_MS         2000
+
+/* Bytes from len to the end of the CRC */
+#define FRAME_BODY_MAX      (CTRL_FRAME_OVERHEAD - 1 + CTRL_MAX_PAYLOAD)
+
+/* SESSION_READ response: status, flags, offset */
+#define READ_HDR_SIZE       6
+#define READ_CHUNK_MAX      (CTRL_MAX_PAYLOAD - READ_HDR_SIZE)
+
+BUILD_ASSERT(TX_RING_SIZE >= CTRL_FRAME_OVERHEAD + CTRL_MAX_PAYLOAD,
+	     "A whole response must fit the TX ring");
+BUILD_ASSERT(1 + sizeof(ctrl_ident_t) <= CTRL_MAX_PAYLOAD);
+BUILD_ASSERT((EVT_RING_SIZE & EVT_RING_MASK) == 0,
+	     "EVT_RING_SIZE must be a power of two");
+BUILD_ASSERT(1 + sizeof(ctrl_tag_rec_t) + E310_MAX_EPC_LENGTH <= CTRL_MAX_PAYLOAD);
+BUILD_ASSERT(READ_CHUNK_MAX >= sizeof(tag_session_file_hdr_t) +
+	     TAG_SESSION_RECORD_MAX + 5,
+	     "A chunk must hold the header, one record and the trailer");
+
+#if DT_NODE_HAS_STATUS(CTRL_NODE, okay)
+
+static const struct device *const ctrl_dev = DEVICE_DT_GET(CTRL_NODE);
+static uart_router_t *ctrl_router;
+
+RING_BUF_DECLARE(rx_ring, RX_RING_SIZE);
+RING_BUF_DECLARE(tx_ring, TX_RING_SIZE);
+
+/* Given by the ISR on RX and by the router on a tag event */
+static K_SEM_DEFINE(wake_sem, 0, 1);
+static K_SEM_DEFINE(tx_sem, 0, 1);
+
+K_THREAD_STACK_DEFINE(ctrl_stack, CTRL_STACK_SIZE);
+static struct k_thread ctrl_thread;
+
+/* Frame being received: len..crc (the SOF is not stored) */
+static uint8_t rx_frame[FRAME_BODY_MAX];
+static size_t rx_pos;
+static size_t rx_need;
+static bool rx_in_frame;
+static int64_t rx_last_ms;
+
+/* Last response, resent as is for a retried request */
+static uint8_t tx_frame[CTRL_FRAME_OVERHEAD + CTRL_MAX_PAYLOAD];
+static size_t tx_len;
+static bool last_valid;
+static uint8_t last_seq;
+static uint8_t last_cmd;
+static uint16_t last_crc;
+
+static struct {
+	uint32_t rx_frames;
+	uint32_t tx_frames;
+	uint32_t crc_errors;
+	uint32_t length_errors;
+	uint32_t timeouts;
+	uint32_t retries;
+	uint32_t rx_overruns;
+	uint32_t tx_stalls;
+	uint32_t commits;
+	uint32_t evt_frames;
+	uint32_t evt_tags;
+	uint32_t evt_dropped;
+} counters;
+
+/* Tag event stream (CTRL_CMD_TAG_STREAM) */
+static atomic_t stream_on;
+static uint8_t evt_buf[EVT_RING_SIZE];
+static uint32_t evt_head;
+static uint32_t evt_tail;
+static uint32_t evt_seq;
+static struct k_spinlock evt_lock;
+static uint8_t evt_frame[CTRL_FRAME_OVERHEAD + CTRL_MAX_PAYLOAD];
+
+/* Staged settings (CONFIG_SET .. CONFIG_COMMIT) */
+struct ctrl_config {
+	e310_profile_t p;
+	uint8_t reader_addr;
+};
+
+static struct ctrl_config staged;
+static bool staged_valid;
+
+/* SESSION_READ cursor */
+static tag_session_iter_t rd_iter;
+static struct {
+	bool open;
+	int end;                        /* iterator result once it stopped */
+	uint32_t offset;
+	uint32_t crc;
+	bool has_prev;
+	bool has_pending;
+	tag_session_entry_t prev;
+	tag_session_entry_t pending;
+} rd;
+
+/* ========================================================================
+ * Transport (ISR <-> rings)
+ * ======================================================================== */
+
+static void ctrl_uart_isr(const struct device *dev, void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	while (uart_irq_update(dev) && uart_irq_is_pending(dev)) {
+		if (uart_irq_rx_ready(dev)) {
+			uint8_t *data;
+			uint32_t space = ring_buf_put_claim(&rx_ring, &data,
+							    RX_RING_SIZE);
+			int n;
+
+			if (space == 0) {
+				uint8_t scratch[64];
+
+				/* Host is ahead of the parser: drop, it retries */
+				n = uart_fifo_read(dev, scratch, sizeof(scratch));
+				counters.rx_overruns += (n > 0) ? n : 0;
+			} else {
+				n = uart_fifo_read(dev, data, space);
+				ring_buf_put_finish(&rx_ring, (n > 0) ? n : 0);
+			}
+			k_sem_give(&wake_sem);
+		}
+
+		if (uart_irq_tx_ready(dev)) {
+			uint8_t *data;
+			uint32_t len = ring_buf_get_claim(&tx_ring, &data,
+							  TX_RING_SIZE);
+			int n;
+
+			if (len == 0) {
+				uart_irq_tx_disable(dev);
+				continue;
+			}
+			n = uart_fifo_fill(dev, data, len);
+			ring_buf_get_finish(&tx_ring, (n > 0) ? n : 0);
+			k_sem_give(&tx_sem);
+		}
+	}
+}
+
+static int send_bytes(const uint8_t *data, size_t len)
+{
+	int64_t stall_end = k_uptime_get() + TX_STALL_MS;
+
+	while (len > 0) {
+		uint32_t n = ring_buf_put(&tx_ring, data, len);
+
+		if (n > 0) {
+			uart_irq_tx_enable(ctrl_dev);
+			data += n;
+			len -= n;
+			stall_end = k_uptime_get() + TX_STALL_MS;
+			continue;
+		}
+		if (k_uptime_get() > stall_end) {
+			/* Nobody reading the port: forget the backlog */
+			counters.tx_stalls++;
+			uart_irq_tx_disable(ctrl_dev);
+			ring_buf_reset(&tx_ring);
+			return -ETIMEDOUT;
+		}
+		k_sem_take(&tx_sem, K_MSEC(10));
+	}
+	return 0;
+}
+
+/* ========================================================================
+ * Tag Event Stream
+ * ======================================================================== */
+
+static void evt_ring_write(uint32_t pos, const void *src, size_t len)
+{
+	uint32_t off = pos & EVT_RING_MASK;
+	size_t first = MIN(len, EVT_RING_SIZE - off);
+
+	memcpy(&evt_buf[off], src, first);
+	if (len > first) {
+		memcpy(evt_buf, (const uint8_t *)src + first, len - first);
+	}
+}
+
+static void evt_ring_read(uint32_t pos, void *dst, size_t len)
+{
+	uint32_t off = pos & EVT_RING_MASK;
+	size_t first = MIN(len, EVT_RING_SIZE - off);
+
+	memcpy(dst, &evt_buf[off], first);
+	if (len > first) {
+		memcpy((uint8_t *)dst + first, evt_buf, len - first);
+	}
+}
+
+static void stream_set(bool on)
+{
+	k_spinlock_key_t key = k_spin_lock(&evt_lock);
+
+	evt_head = 0;
+	evt_tail = 0;
+	atomic_set(&stream_on, on);
+	k_spin_unlock(&evt_lock, key);
+}
+
+static void frame_finish(uint8_t *frame, uint8_t seq, uint8_t cmd,
+			 size_t payload_len);
+
+/**
+ * @brief Send what the event ring holds, packed into as few frames as fit
+ */
+static void stream_flush(void)
+{
+	uint32_t dtr = 1;
+
+	if (!atomic_get(&stream_on)) {
+		return;
+	}
+
+	/* Host closed the port: nobody to stream to */
+	if (uart_line_ctrl_get(ctrl_dev, UART_LINE_CTRL_DTR, &dtr) == 0 &&
+	    dtr == 0) {
+		stream_set(false);
+		LOG_INF("Tag stream stopped (port closed)");
+		return;
+	}
+
+	while (true) {
+		uint8_t *payload = &evt_frame[CTRL_HDR_SIZE];
+		size_t len = 1;
+		uint8_t count = 0;
+
+		k_spinlock_key_t key = k_spin_lock(&evt_lock);
+
+		while (evt_tail != evt_head && count < UINT8_MAX) {
+			ctrl_tag_rec_t rec;
+			size_t need;
+
+			evt_ring_read(evt_tail, &rec, sizeof(rec));
+			need = sizeof(rec) + rec.epc_len;
+			if (len + need > CTRL_MAX_PAYLOAD) {
+				break;
+			}
+			evt_ring_read(evt_tail, &payload[len], need);
+			evt_tail += need;
+			len += need;
+			count++;
+		}
+		k_spin_unlock(&evt_lock, key);
+
+		if (count == 0) {
+			return;
+		}
+
+		payload[0] = count;
+		frame_finish(evt_frame, 0, CTRL_EVT_TAGS, len);
+		if (send_bytes(evt_frame, CTRL_FRAME_OVERHEAD + len) < 0) {
+			stream_set(false);
+			return;
+		}
+		counters.evt_frames++;
+		counters.evt_tags += count;
+	}
+}
+
+void ctrl_proto_tag_read(const uint8_t *epc, uint8_t epc_len, uint8_t rssi,
+			 uint8_t antenna, uint8_t flags)
+{
+	ctrl_tag_rec_t rec;
+
+	if (!atomic_get(&stream_on) || epc_len > E310_MAX_EPC_LENGTH) {
+		return;
+	}
+
+	rec.read_ms = sys_cpu_to_le32(k_uptime_get_32());
+	rec.rssi = rssi;
+	rec.antenna = antenna;
+	rec.flags = flags;
+	rec.epc_len = epc_len;
+
+	k_spinlock_key_t key = k_spin_lock(&evt_lock);
+
+	/* A dropped read still takes a number: the host sees the gap */
+	rec.seq = sys_cpu_to_le32(evt_seq++);
+	if (EVT_RING_SIZE - (evt_head - evt_tail) < sizeof(rec) + epc_len) {
+		counters.evt_dropped++;
+		k_spin_unlock(&evt_lock, key);
+		return;
+	}
+	evt_ring_write(evt_head, &rec, sizeof(rec));
+	evt_ring_write(evt_head + sizeof(rec), epc, epc_len);
+	evt_head += sizeof(rec) + epc_len;
+	k_spin_unlock(&evt_lock, key);
+
+	k_sem_give(&wake_sem);
+}
+
+/* ========================================================================
+ * Settings TLVs
+ * ======================================================================== */
+
+static void capture_live(struct ctrl_config *c)
+{
+	memset(c, 0, sizeof(*c));
+	e310_profile_capture(&c->p);
+	c->reader_addr = e310_settings_get_reader_addr();
+}
+
+static uint8_t *put_tlv(uint8_t *out, uint8_t key, const uint8_t *val,
+			uint8_t len)
+{
+	out[0] = key;
+	out[1] = len;
+	memcpy(&out[2], val, len);
+	return out + 2 + len;
+}
+
+static uint8_t *put_tlv_u8(uint8_t *out, uint8_t key, uint8_t val)
+{
+	return put_tlv(out, key, &val, 1);
+}
+
+static uint8_t *put_tlv_u16(uint8_t *out, uint8_t key, uint16_t val)
+{
+	uint8_t le[2];
+
+	sys_put_le16(val, le);
+	return put_tlv(out, key, le, 2);
+}
+
+static size_t encode_config(const struct ctrl_config *c, uint8_t *out)
+{
+	const e310_profile_t *p = &c->p;
+	const uint8_t freq[] = { p->freq_region, p->freq_start, p->freq_end };
+	uint8_t *pos = out;
+
+	pos = put_tlv_u8(pos, CTRL_CFG_RF_POWER, p->rf_power);
+	pos = put_tlv_u8(pos, CTRL_CFG_ANTENNA, p->antenna_config);
+	pos = put_tlv(pos, CTRL_CFG_FREQUENCY, freq, sizeof(freq));
+	pos = put_tlv_u8(pos, CTRL_CFG_INV_TIME, p->inventory_time);
+	pos = put_tlv_u8(pos, CTRL_CFG_READER_ADDR, c->reader_addr);
+	pos = put_tlv_u16(pos, CTRL_CFG_TYPING_SPEED, p->typing_speed);
+	pos = put_tlv_u16(pos, CTRL_CFG_BEEP_PULSE, p->beep_pulse_ms);
+	pos = put_tlv_u16(pos, CTRL_CFG_BEEP_FILTER, p->beep_filter_ms);
+	pos = put_tlv_u8(pos, CTRL_CFG_EPC_DEBOUNCE, p->epc_debounce_sec);
+	pos = put_tlv_u16(pos, CTRL_CFG_INV_INTERVAL, p->inventory_interval_ms);
+	pos = put_tlv_u8(pos, CTRL_CFG_RGB_BRIGHTNESS, p->rgb_brightness);
+
+	return pos - out;
+}
+
+/** Value length of a key, 0 if unknown */
+static uint8_t key_len(uint8_t key)
+{
+	switch (key) {
+	case CTRL_CFG_FREQUENCY:
+		return 3;
+	case CTRL_CFG_TYPING_SPEED:
+	case CTRL_CFG_BEEP_PULSE:
+	case CTRL_CFG_BEEP_FILTER:
+	case CTRL_CFG_INV_INTERVAL:
+		return 2;
+	case CTRL_CFG_RF_POWER:
+	case CTRL_CFG_ANTENNA:
+	case CTRL_CFG_INV_TIME:
+	case CTRL_CFG_READER_ADDR:
+	case CTRL_CFG_EPC_DEBOUNCE:
+	case CTRL_CFG_RGB_BRIGHTNESS:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+static void apply_tlv(struct ctrl_config *c, uint8_t key, const uint8_t *v)
+{
+	e310_profile_t *p = &c->p;
+
+	switch (key) {
+	case CTRL_CFG_RF_POWER:
+		p->rf_power = v[0];
+		break;
+	case CTRL_CFG_ANTENNA:
+		p->antenna_config = v[0];
+		break;
+	case CTRL_CFG_FREQUENCY:
+		p->freq_region = v[0];
+		p->freq_start = v[1];
+		p->freq_end = v[2];
+		break;
+	case CTRL_CFG_INV_TIME:
+		p->inventory_time = v[0];
+		break;
+	case CTRL_CFG_READER_ADDR:
+		c->reader_addr = v[0];
+		break;
+	case CTRL_CFG_TYPING_SPEED:
+		p->typing_speed = sys_get_le16(v);
+		break;
+	case CTRL_CFG_BEEP_PULSE:
+		p->beep_pulse_ms = sys_get_le16(v);
+		break;
+	case CTRL_CFG_BEEP_FILTER:
+		p->beep_filter_ms = sys_get_le16(v);
+		break;
+	case CTRL_CFG_EPC_DEBOUNCE:
+		p->epc_debounce_sec = v[0];
+		break;
+	case CTRL_CFG_INV_INTERVAL:
+		p->inventory_interval_ms = sys_get_le16(v);
+		break;
+	case CTRL_CFG_RGB_BRIGHTNESS:
+		p->rgb_brightness = v[0];
+		break;
+	default:
+		break;
+	}
+}
+
+/* ========================================================================
+ * Command Handlers
+ *
+ * Each gets the request payload and fills the response payload after
+ * the status byte; the return value is the status.
+ * ======================================================================== */
+
+static int cmd_ident(const uint8_t *req, size_t req_len, uint8_t *rsp,
+		     size_t *rsp_len)
+{
+	ctrl_ident_t id;
+	ssize_t uid_len;
+
+	ARG_UNUSED(req);
+	ARG_UNUSED(req_len);
+
+	memset(&id, 0, sizeof(id));
+	id.proto_version = CTRL_PROTO_VERSION;
+	id.fw_major = APP_VERSION_MAJOR;
+	id.fw_minor = APP_VERSION_MINOR;
+	id.fw_patch = APP_PATCHLEVEL;
+	id.kernel_version = sys_cpu_to_le32(sys_kernel_version_get());
+	id.capabilities = sys_cpu_to_le32(CTRL_CAP_CONFIG | CTRL_CAP_STATS |
+					  CTRL_CAP_SESSION | CTRL_CAP_TAG_STREAM);
+	id.max_payload = sys_cpu_to_le16(CTRL_MAX_PAYLOAD);
+	uid_len = hwinfo_get_device_id(id.uid, sizeof(id.uid));
+	id.uid_len = (uid_len > 0) ? (uint8_t)uid_len : 0;
+	id.uptime_s = sys_cpu_to_le32((uint32_t)(k_uptime_get() / 1000));
+	strncpy(id.board, CONFIG_BOARD, sizeof(id.board));
+	strncpy(id.build, STRINGIFY(APP_BUILD_VERSION), sizeof(id.build));
+
+	memcpy(rsp, &id, sizeof(id));
+	*rsp_len = sizeof(id);
+	return CTRL_ST_OK;
+}
+
+static int cmd_config_get(const uint8_t *req, size_t req_len, uint8_t *rsp,
+			  size_t *rsp_len)
+{
+	struct ctrl_config live;
+	uint8_t source = (req_len > 0) ? req[0] : CTRL_CFG_LIVE;
+
+	if (source == CTRL_CFG_STAGED) {
+		if (!staged_valid) {
+			return CTRL_ST_NO_STAGED;
+		}
+		*rsp_len = encode_config(&staged, rsp);
+		return CTRL_ST_OK;
+	}
+
+	capture_live(&live);
+	*rsp_len = encode_config(&live, rsp);
+	return CTRL_ST_OK;
+}
+
+static int cmd_config_set(const uint8_t *req, size_t req_len, uint8_t *rsp,
+			  size_t *rsp_len)
+{
+	struct ctrl_config next;
+	size_t pos = 0;
+
+	if (staged_valid) {
+		next = staged;
+	} else {
+		capture_live(&next);
+	}
+
+	while (pos < req_len) {
+		uint8_t key = req[pos];
+
+		if (pos + 2 > req_len || req[pos + 1] != key_len(key) ||
+		    key_len(key) == 0 || pos + 2 + key_len(key) > req_len) {
+			rsp[0] = key;
+			*rsp_len = 1;
+			return CTRL_ST_BAD_KEY;
+		}
+
+		apply_tlv(&next, key, &req[pos + 2]);
+		pos += 2 + key_len(key);
+	}
+
+	if (e310_profile_validate(&next.p) < 0) {
+		return CTRL_ST_BAD_VALUE;
+	}
+
+	staged = next;
+	staged_valid = true;
+	return CTRL_ST_OK;
+}
+
+static int cmd_config_commit(const uint8_t *req, size_t req_len, uint8_t *rsp,
+			     size_t *rsp_len)
+{
+	uint8_t flags = (req_len > 0) ? req[0] : 0;
+	e310_profile_switch_t res = {0};
+	ctrl_commit_rsp_t out;
+	uint32_t changed = 0;
+	int ret;
+
+	if (!staged_valid) {
+		return CTRL_ST_NO_STAGED;
+	}
+	if (e310_profile_validate(&staged.p) < 0) {
+		return CTRL_ST_BAD_VALUE;
+	}
+
+	/* Address first, so the new settings go to the reader at it */
+	if (staged.reader_addr != e310_settings_get_reader_addr()) {
+		ret = uart_router_call(ctrl_router, ROUTER_OP_SET_ADDR,
+				       staged.reader_addr);
+		if (ret < 0) {
+			return CTRL_ST_BUSY;
+		}
+		e310_settings_set_reader_addr(staged.reader_addr);
+		changed |= CTRL_CHANGED_READER_ADDR;
+	}
+
+	ret = e310_profile_apply(&staged.p, &res);
+	if (ret < 0 && ret != -ETIMEDOUT) {
+		return (ret == -EINVAL) ? CTRL_ST_BAD_VALUE : CTRL_ST_ERROR;
+	}
+
+	/* Published: a timeout only means the E310 still has it queued */
+	staged_valid = false;
+	counters.commits++;
+	changed |= res.changed;
+
+	if ((flags & CTRL_COMMIT_F_FLUSH) && e310_settings_flush() < 0) {
+		ret = -EIO;
+	}
+
+	out.changed = sys_cpu_to_le32(changed);
+	out.version = sys_cpu_to_le32(res.version);
+	out.total_us = sys_cpu_to_le32(res.total_us);
+	memcpy(rsp, &out, sizeof(out));
+	*rsp_len = sizeof(out);
+
+	LOG_INF("Settings committed (0x%05x), version %u", changed, res.version);
+
+	if (ret == -ETIMEDOUT) {
+		return CTRL_ST_TIMEOUT;
+	}
+	return (ret < 0) ? CTRL_ST_ERROR : CTRL_ST_OK;
+}
+
+static int cmd_config_abort(const uint8_t *req, size_t req_len, uint8_t *rsp,
+			    size_t *rsp_len)
+{
+	ARG_UNUSED(req);
+	ARG_UNUSED(req_len);
+	ARG_UNUSED(rsp);
+	ARG_UNUSED(rsp_len);
+
+	staged_valid = false;
+	return CTRL_ST_OK;
+}
+
+static uint8_t *put_section(uint8_t *out, uint8_t id, const void *data,
+			    uint16_t len)
+{
+	out[0] = id;
+	sys_put_le16(len, &out[1]);
+	memcpy(&out[3], data, len);
+	return out + 3 + len;
+}
+
+static void session_info_wire(tag_session_which_t which,
+			      ctrl_session_info_t *out)
+{
+	tag_session_info_t info;
+
+	tag_session_get_info(which, &info);
+	out->id = sys_cpu_to_le32(info.id);
+	out->running = info.running;
+	out->tags = sys_cpu_to_le32(info.tags);
+	out->reads = sys_cpu_to_le32(info.reads);
+	out->full_drops = sys_cpu_to_le32(info.full_drops);
+	out->duration_s = sys_cpu_to_le32(info.duration_s);
+	out->blocks = sys_cpu_to_le16(info.blocks);
+}
+
+static int cmd_stats(const uint8_t *req, size_t req_len, uint8_t *rsp,
+		     size_t *rsp_len)
+{
+	uart_router_status_t status;
+	router_metrics_snapshot_t metrics;
+	tag_store_stats_t store;
+	ctrl_session_info_t sessions[2];
+	ctrl_state_t state;
+	uint8_t *pos = rsp;
+
+	ARG_UNUSED(req);
+	ARG_UNUSED(req_len);
+
+	/* Counters are native little-endian uint32_t on this core */
+	uart_router_get_status(ctrl_router, &status);
+	router_metrics_get_snapshot(&metrics);
+	tag_store_get_stats(&store);
+	session_info_wire(TAG_SESSION_CURRENT, &sessions[0]);
+	session_info_wire(TAG_SESSION_PREVIOUS, &sessions[1]);
+
+	state.mode = status.mode;
+	state.running = status.running;
+	state.inventory_active = status.inventory_active;
+	state.e310_connected = status.e310_connected;
+	state.reader_addr = status.reader_addr;
+	state.epc_cached = status.epc_cached;
+	state.config_version = sys_cpu_to_le32(runtime_config_version());
+	state.uptime_ms = sys_cpu_to_le32(k_uptime_get_32());
+
+	pos = put_section(pos, CTRL_STATS_STATE, &state, sizeof(state));
+	pos = put_section(pos, CTRL_STATS_ROUTER, &status.stats,
+			  sizeof(status.stats));
+	pos = put_section(pos, CTRL_STATS_METRICS, &metrics, sizeof(metrics));
+	pos = put_section(pos, CTRL_STATS_TAG_STORE, &store, sizeof(store));
+	pos = put_section(pos, CTRL_STATS_SESSION, sessions, sizeof(sessions));
+
+	*rsp_len = pos - rsp;
+	return CTRL_ST_OK;
+}
+
+static int cmd_session_ctrl(const uint8_t *req, size_t req_len, uint8_t *rsp,
+			    size_t *rsp_len)
+{
+	tag_session_info_t info;
+
+	if (req_len < 1) {
+		return CTRL_ST_BAD_LENGTH;
+	}
+
+	switch (req[0]) {
+	case CTRL_SESSION_BEGIN:
+		tag_session_begin();
+		break;
+	case CTRL_SESSION_STOP:
+		if (tag_session_stop() < 0) {
+			return CTRL_ST_NOT_FOUND;
+		}
+		break;
+	default:
+		return CTRL_ST_BAD_VALUE;
+	}
+
+	tag_session_get_info(TAG_SESSION_CURRENT, &info);
+	sys_put_le32(info.id, rsp);
+	*rsp_len = 4;
+	return CTRL_ST_OK;
+}
+
+static size_t read_put(uint8_t *out, size_t pos, const void *data, size_t len)
+{
+	memcpy(&out[pos], data, len);
+	rd.crc = crc32_ieee_update(rd.crc, data, len);
+	return pos + len;
+}
+
+static int cmd_session_read(const uint8_t *req, size_t req_len, uint8_t *rsp,
+			    size_t *rsp_len)
+{
+	uint8_t *chunk = &rsp[5];
+	uint8_t flags = 0;
+	size_t pos = 0;
+
+	if (req_len < 2) {
+		return CTRL_ST_BAD_LENGTH;
+	}
+
+	if (req[1] & CTRL_READ_F_RESTART) {
+		tag_session_which_t which = (req[0] == 0) ?
+			TAG_SESSION_CURRENT : TAG_SESSION_PREVIOUS;
+		tag_session_file_hdr_t hdr;
+		tag_session_info_t info;
+
+		memset(&rd, 0, sizeof(rd));
+		tag_session_get_info(which, &info);
+		if (tag_session_iter_init(&rd_iter, which) < 0) {
+			return CTRL_ST_NOT_FOUND;
+		}
+		rd.open = true;
+		tag_session_file_hdr(&hdr, &info);
+		pos = read_put(chunk, pos, &hdr, sizeof(hdr));
+	} else if (!rd.open) {
+		return CTRL_ST_NOT_FOUND;
+	}
+
+	while (rd.end == 0) {
+		uint8_t rec[TAG_SESSION_RECORD_MAX];
+		size_t len;
+
+		if (!rd.has_pending) {
+			int ret = tag_session_iter_next(&rd_iter, &rd.pending);
+
+			if (ret < 0) {
+				rd.end = ret;
+				break;
+			}
+			rd.has_pending = true;
+		}
+
+		len = tag_session_encode(&rd.pending,
+					 rd.has_prev ? &rd.prev : NULL, rec);
+		if (pos + len > READ_CHUNK_MAX) {
+			break;
+		}
+		pos = read_put(chunk, pos, rec, len);
+		rd.prev = rd.pending;
+		rd.has_prev = true;
+		rd.has_pending = false;
+	}
+
+	if (rd.end != 0 && pos + 5 <= READ_CHUNK_MAX) {
+		uint8_t end = TAG_SESSION_FILE_END;
+
+		pos = read_put(chunk, pos, &end, 1);
+		sys_put_le32(rd.crc, &chunk[pos]);
+		pos += 4;
+		flags |= CTRL_READ_F_LAST;
+		if (rd.end == -ESTALE) {
+			flags |= CTRL_READ_F_PARTIAL;
+		}
+		rd.open = false;
+	}
+
+	rsp[0] = flags;
+	sys_put_le32(rd.offset, &rsp[1]);
+	rd.offset += pos;
+	*rsp_len = 5 + pos;
+	return CTRL_ST_OK;
+}
+
+static int cmd_tag_stream(const uint8_t *req, size_t req_len, uint8_t *rsp,
+			  size_t *rsp_len)
+{
+	if (req_len < 1) {
+		return CTRL_ST_BAD_LENGTH;
+	}
+
+	stream_set(req[0] != 0);
+	sys_put_le32(evt_seq, rsp);
+	*rsp_len = 4;
+
+	LOG_INF("Tag stream %s", req[0] ? "started" : "stopped");
+	return CTRL_ST_OK;
+}
+
+typedef int (*ctrl_handler_t)(const uint8_t *req, size_t req_len,
+			      uint8_t *rsp, size_t *rsp_len);
+
+static const struct {
+	uint8_t cmd;
+	ctrl_handler_t handler;
+} handlers[] = {
+	{ CTRL_CMD_IDENT, cmd_ident },
+	{ CTRL_CMD_CONFIG_GET, cmd_config_get },
+	{ CTRL_CMD_CONFIG_SET, cmd_config_set },
+	{ CTRL_CMD_CONFIG_COMMIT, cmd_config_commit },
+	{ CTRL_CMD_CONFIG_ABORT, cmd_config_abort },
+	{ CTRL_CMD_STATS, cmd_stats },
+	{ CTRL_CMD_SESSION_CTRL, cmd_session_ctrl },
+	{ CTRL_CMD_SESSION_READ, cmd_session_read },
+	{ CTRL_CMD_TAG_STREAM, cmd_tag_stream },
+};
+
+/* ========================================================================
+ * Framing
+ * ======================================================================== */
+
+static uint16_t frame_crc(const uint8_t *data, size_t len)
+{
+	return crc16_itu_t(0xFFFF, data, len);
+}
+
+/** Fill in the header and CRC around a payload already in place */
+static void frame_finish(uint8_t *frame, uint8_t seq, uint8_t cmd,
+			 size_t payload_len)
+{
+	frame[0] = CTRL_SOF;
+	sys_put_le16(payload_len, &frame[1]);
+	frame[3] = seq;
+	frame[4] = cmd;
+	sys_put_le16(frame_crc(&frame[1], 4 + payload_len),
+		     &frame[CTRL_HDR_SIZE + payload_len]);
+}
+
+static void handle_frame(void)
+{
+	uint16_t len = sys_get_le16(&rx_frame[0]);
+	uint8_t seq = rx_frame[2];
+	uint8_t cmd = rx_frame[3];
+	uint16_t crc = sys_get_le16(&rx_frame[4 + len]);
+	uint8_t *rsp = &tx_frame[CTRL_HDR_SIZE];
+	size_t rsp_len = 0;
+	int status = CTRL_ST_UNKNOWN_CMD;
+
+	if (frame_crc(rx_frame, 4 + len) != crc) {
+		counters.crc_errors++;
+		return;
+	}
+	counters.rx_frames++;
+
+	if (last_valid && seq == last_seq && cmd == last_cmd && crc == last_crc) {
+		counters.retries++;
+		send_bytes(tx_frame, tx_len);
+		return;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(handlers); i++) {
+		if (handlers[i].cmd == cmd) {
+			status = handlers[i].handler(&rx_frame[4], len,
+						     &rsp[1], &rsp_len);
+			break;
+		}
+	}
+
+	rsp[0] = (uint8_t)status;
+	rsp_len += 1;
+
+	frame_finish(tx_frame, seq, cmd | CTRL_RSP_FLAG, rsp_len);
+	tx_len = CTRL_FRAME_OVERHEAD + rsp_len;
+
+	last_valid = true;
+	last_seq = seq;
+	last_cmd = cmd;
+	last_crc = crc;
+
+	counters.tx_frames++;
+	send_bytes(tx_frame, tx_len);
+}
+
+static void parse_byte(uint8_t b)
+{
+	if (!rx_in_frame) {
+		if (b == CTRL_SOF) {
+			rx_in_frame = true;
+			rx_pos = 0;
+			rx_need = 2;
+		}
+		return;
+	}
+
+	rx_frame[rx_pos++] = b;
+
+	if (rx_pos == 2) {
+		uint16_t len = sys_get_le16(rx_frame);
+
+		if (len > CTRL_MAX_PAYLOAD) {
+			counters.length_errors++;
+			rx_in_frame = false;
+			return;
+		}
+		rx_need = 4 + len + 2;
+	}
+
+	if (rx_pos == rx_need) {
+		rx_in_frame = false;
+		handle_frame();
+	}
+}
+
+static void ctrl_thread_fn(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		k_timeout_t wait = rx_in_frame ? K_MSEC(CTRL_FRAME_TIMEOUT_MS) :
+						 K_FOREVER;
+		uint8_t buf[64];
+		uint32_t n;
+
+		(void)k_sem_take(&wake_sem, wait);
+
+		while ((n = ring_buf_get(&rx_ring, buf, sizeof(buf))) > 0) {
+			rx_last_ms = k_uptime_get();
+			for (uint32_t i = 0; i < n; i++) {
+				parse_byte(buf[i]);
+			}
+		}
+
+		if (rx_in_frame &&
+		    k_uptime_get() - rx_last_ms >= CTRL_FRAME_TIMEOUT_MS) {
+			/* Host gave up mid-frame */
+			counters.timeouts++;
+			rx_in_frame = false;
+		}
+
+		stream_flush();
+	}
+}
+
+/* ========================================================================
+ * Public API
+ * ======================================================================== */
+
+int ctrl_proto_init(uart_router_t *router)
+{
+	static k_tid_t tid;
+
+	if (!device_is_ready(ctrl_dev)) {
+		LOG_ERR("Control interface not ready");
+		return -ENODEV;
+	}
+
+	ctrl_router = router;
+
+	uart_irq_callback_set(ctrl_dev, ctrl_uart_isr);
+	uart_irq_rx_enable(ctrl_dev);
+
+	if (tid == NULL) {
+		tid = k_thread_create(&ctrl_thread, ctrl_stack,
+				      K_THREAD_STACK_SIZEOF(ctrl_stack),
+				      ctrl_thread_fn, NULL, NULL, NULL,
+				      CTRL_PRIORITY, 0, K_NO_WAIT);
+		k_thread_name_set(tid, "ctrl_proto");
+	}
+
+	LOG_INF("Control protocol v%u on %s", CTRL_PROTO_VERSION,
+		ctrl_dev->name);
+	return 0;
+}
+
+/* ========================================================================
+ * Shell Commands
+ * ======================================================================== */
+
+static int cmd_ctrl_status(const struct shell *sh, size_t argc, char **argv)
+{
+	uint32_t dtr = 0;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	uart_line_ctrl_get(ctrl_dev, UART_LINE_CTRL_DTR, &dtr);
+
+	shell_print(sh, "=== Control Protocol v%u (%s) ===", CTRL_PROTO_VERSION,
+		    ctrl_dev->name);
+	shell_print(sh, "Host port open: %s", dtr ? "yes" : "no");
+	shell_print(sh, "Frames: %u in, %u out, %u retried",
+		    counters.rx_frames, counters.tx_frames, counters.retries);
+	shell_print(sh, "Errors: %u CRC, %u length, %u timeout, %u overrun bytes, %u TX stalls",
+		    counters.crc_errors, counters.length_errors,
+		    counters.timeouts, counters.rx_overruns, counters.tx_stalls);
+	shell_print(sh, "Commits: %u  Staged: %s  Session read: %s",
+		    counters.commits, staged_valid ? "yes" : "no",
+		    rd.open ? "open" : "idle");
+	shell_print(sh, "Tag stream: %s, %u tags in %u frames, %u dropped",
+		    atomic_get(&stream_on) ? "on" : "off", counters.evt_tags,
+		    counters.evt_frames, counters.evt_dropped);
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_ctrl,
+	SHELL_CMD(status, NULL, "Show control protocol counters", cmd_ctrl_status),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(ctrl, &sub_ctrl, "Binary control protocol (second CDC port)", NULL);
+
+#else /* !DT_NODE_HAS_STATUS(CTRL_NODE, okay) */
+
+int ctrl_proto_init(uart_router_t *router)
+{
+	ARG_UNUSED(router);
+	return -ENODEV;
+}
+
+void ctrl_proto_tag_read(const uint8_t *epc, uint8_t epc_len, uint8_t rssi,
+			 uint8_t antenna, uint8_t flags)
+{
+	ARG_UNUSED(epc);
+	ARG_UNUSED(epc_len);
+	ARG_UNUSED(rssi);
+	ARG_UNUSED(antenna);
+	ARG_UNUSED(flags);
+}
+
+#endif
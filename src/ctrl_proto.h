@@ -0,0 +1,282 @@
+/**
+ * @file ctrl_proto.h
+ * @brief Binary Configuration and Control Protocol (second CDC ACM port)
+ *
+ * Request/response protocol for host tools (provisioning, monitoring,
+ * stock-take download), on its own CDC ACM interface (cdc_acm_uart1) so
+ * the text shell on cdc_acm_uart0 is untouched and both can be open at
+ * the same time. Host client: reference/lib/parp_ctrl.
+ *
+ * Frame (both directions, little endian):
+ *   [0xA5][len u16][seq u8][cmd u8][payload: len bytes][crc u16]
+ *   crc = CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) over len..payload
+ *
+ * A response carries the request seq, cmd | CTRL_RSP_FLAG and a status
+ * byte (CTRL_ST_*) as the first payload byte. Frames with a bad CRC or
+ * length are dropped; the host retries with the same seq. A repeated
+ * request (same seq, cmd and CRC as the last one) is answered from the
+ * last response without running it again, so retries never commit or
+ * advance a session read twice.
+ *
+ * After TAG_STREAM on, the reader also sends CTRL_EVT_TAGS frames on its
+ * own (seq 0, no status byte) carrying every tag read, until TAG_STREAM
+ * off or the host closes the port (DTR low). Host daemon: tools/parpd.
+ *
+ * Settings travel as TLVs [key u8][len u8][value] (CTRL_CFG_*). Sets
+ * are staged; COMMIT applies all staged settings as one runtime config
+ * version and one coalesced EEPROM write (e310_profile_apply()).
+ *
+ * Shell:
+ *   ctrl status                   link state and frame counters
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#ifndef CTRL_PROTO_H_
+#define CTRL_PROTO_H_
+
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+#include "uart_router.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup ctrl_proto Control Protocol
+ * @{
+ */
+
+/* ========================================================================
+ * Constants
+ * ======================================================================== */
+
+/** Protocol version (CTRL_CMD_IDENT) */
+#define CTRL_PROTO_VERSION          1
+
+/** Start of frame */
+#define CTRL_SOF                    0xA5
+
+/** Largest payload in either direction */
+#define CTRL_MAX_PAYLOAD            1024
+
+/** SOF, len, seq, cmd */
+#define CTRL_HDR_SIZE               5
+
+/** Header and CRC */
+#define CTRL_FRAME_OVERHEAD         (CTRL_HDR_SIZE + 2)
+
+/** A partial frame is dropped after this long without a byte */
+#define CTRL_FRAME_TIMEOUT_MS       200
+
+/** Response bit in the cmd byte */
+#define CTRL_RSP_FLAG               0x80
+
+/* ========================================================================
+ * Commands
+ * ======================================================================== */
+
+/**
+ * @brief Request codes
+ *
+ * Payloads (request -> response, after the status byte):
+ *   IDENT          -> ctrl_ident_t
+ *   CONFIG_GET     [source u8: CTRL_CFG_LIVE/STAGED] -> TLVs
+ *   CONFIG_SET     TLVs -> (nothing; on CTRL_ST_BAD_KEY/VALUE the key)
+ *   CONFIG_COMMIT  [flags u8: CTRL_COMMIT_F_*] -> ctrl_commit_rsp_t
+ *   CONFIG_ABORT   -> (nothing)
+ *   STATS          -> sections [id u8][len u16][data] (CTRL_STATS_*)
+ *   SESSION_CTRL   [op u8: CTRL_SESSION_BEGIN/STOP] -> [session id u32]
+ *   SESSION_READ   [which u8][flags u8: CTRL_READ_F_*]
+ *                  -> [flags u8][offset u32][stream bytes]
+ *   TAG_STREAM     [on u8] -> [next event seq u32]
+ *
+ * Event (reader -> host, never a response):
+ *   EVT_TAGS       [count u8] then count x (ctrl_tag_rec_t + EPC bytes)
+ *
+ * SESSION_READ returns the `session export bin` stream (tag_session.h)
+ * in chunks; the chunk with CTRL_READ_F_LAST ends with the end byte and
+ * CRC-32.
+ */
+enum ctrl_cmd {
+	CTRL_CMD_IDENT          = 0x01,
+	CTRL_CMD_CONFIG_GET     = 0x10,
+	CTRL_CMD_CONFIG_SET     = 0x11,
+	CTRL_CMD_CONFIG_COMMIT  = 0x12,
+	CTRL_CMD_CONFIG_ABORT   = 0x13,
+	CTRL_CMD_STATS          = 0x20,
+	CTRL_CMD_SESSION_CTRL   = 0x30,
+	CTRL_CMD_SESSION_READ   = 0x31,
+	CTRL_CMD_TAG_STREAM     = 0x40,
+};
+
+/** Unsolicited frames (0xF0-0xFF: no request has these codes) */
+#define CTRL_EVT_TAGS               0xF0
+
+/** Response status */
+enum ctrl_status {
+	CTRL_ST_OK = 0,
+	CTRL_ST_UNKNOWN_CMD,    /**< No such command */
+	CTRL_ST_BAD_LENGTH,     /**< Payload too short or malformed */
+	CTRL_ST_BAD_KEY,        /**< Unknown setting or wrong value length */
+	CTRL_ST_BAD_VALUE,      /**< Setting out of range */
+	CTRL_ST_NO_STAGED,      /**< Nothing staged to read or commit */
+	CTRL_ST_NOT_FOUND,      /**< No such session / no read open */
+	CTRL_ST_TIMEOUT,        /**< Committed, but the E310 has not taken it yet */
+	CTRL_ST_BUSY,           /**< Router not ready */
+	CTRL_ST_ERROR,          /**< Other failure */
+};
+
+/** Setting keys (value little endian) */
+enum ctrl_cfg_key {
+	CTRL_CFG_RF_POWER       = 0x01,    /**< u8 dBm */
+	CTRL_CFG_ANTENNA        = 0x02,    /**< u8 antenna config */
+	CTRL_CFG_FREQUENCY      = 0x03,    /**< u8 region, u8 start, u8 end */
+	CTRL_CFG_INV_TIME       = 0x04,    /**< u8 x100 ms */
+	CTRL_CFG_READER_ADDR    = 0x05,    /**< u8 E310 address */
+	CTRL_CFG_TYPING_SPEED   = 0x06,    /**< u16 CPM */
+	CTRL_CFG_BEEP_PULSE     = 0x07,    /**< u16 ms */
+	CTRL_CFG_BEEP_FILTER    = 0x08,    /**< u16 ms */
+	CTRL_CFG_EPC_DEBOUNCE   = 0x09,    /**< u8 s */
+	CTRL_CFG_INV_INTERVAL   = 0x0A,    /**< u16 ms */
+	CTRL_CFG_RGB_BRIGHTNESS = 0x0B,    /**< u8 % */
+};
+
+/** CONFIG_GET source */
+#define CTRL_CFG_LIVE               0
+#define CTRL_CFG_STAGED             1
+
+/** CONFIG_COMMIT: return only once the EEPROM write is verified */
+#define CTRL_COMMIT_F_FLUSH         BIT(0)
+
+/** Commit changed bit for the reader address (above E310_PROFILE_F_*) */
+#define CTRL_CHANGED_READER_ADDR    BIT(16)
+
+/** STATS section ids */
+#define CTRL_STATS_ROUTER           0x01   /**< uart_router_stats_t */
+#define CTRL_STATS_METRICS          0x02   /**< router_metrics_snapshot_t */
+#define CTRL_STATS_TAG_STORE        0x03   /**< tag_store_stats_t */
+#define CTRL_STATS_SESSION          0x04   /**< ctrl_session_info_t x2 */
+#define CTRL_STATS_STATE            0x05   /**< ctrl_state_t */
+
+/** SESSION_CTRL ops */
+#define CTRL_SESSION_BEGIN          0
+#define CTRL_SESSION_STOP           1
+
+/** SESSION_READ request: start over at the header */
+#define CTRL_READ_F_RESTART         BIT(0)
+/** SESSION_READ response: last chunk of the stream */
+#define CTRL_READ_F_LAST            BIT(0)
+/** SESSION_READ response: session discarded under the read */
+#define CTRL_READ_F_PARTIAL         BIT(1)
+
+/** IDENT capability bits */
+#define CTRL_CAP_CONFIG             BIT(0)
+#define CTRL_CAP_STATS              BIT(1)
+#define CTRL_CAP_SESSION            BIT(2)
+#define CTRL_CAP_TAG_STREAM         BIT(3)
+
+/** Tag event flags */
+#define CTRL_TAG_F_NEW              BIT(0)  /**< Not in the duplicate cache */
+#define CTRL_TAG_F_DELIVERED        BIT(1)  /**< Passed the filter (typed or stored) */
+
+/* ========================================================================
+ * Payload Structures (packed, little endian)
+ * ======================================================================== */
+
+/** CTRL_CMD_IDENT response */
+typedef struct __attribute__((packed)) {
+	uint8_t  proto_version;     /**< CTRL_PROTO_VERSION */
+	uint8_t  fw_major;
+	uint8_t  fw_minor;
+	uint8_t  fw_patch;
+	uint32_t kernel_version;    /**< Zephyr sys_kernel_version_get() */
+	uint32_t capabilities;      /**< CTRL_CAP_* */
+	uint16_t max_payload;       /**< CTRL_MAX_PAYLOAD */
+	uint8_t  uid_len;           /**< Bytes of uid used */
+	uint8_t  uid[12];           /**< MCU unique ID (hwinfo) */
+	uint32_t uptime_s;
+	char     board[16];         /**< NUL padded */
+	char     build[24];         /**< Build version (git describe), NUL padded */
+} ctrl_ident_t;
+
+/** CTRL_CMD_CONFIG_COMMIT response */
+typedef struct __attribute__((packed)) {
+	uint32_t changed;           /**< E310_PROFILE_F_* | CTRL_CHANGED_READER_ADDR */
+	uint32_t version;           /**< Runtime config version published */
+	uint32_t total_us;          /**< Until the E310 had the new settings */
+} ctrl_commit_rsp_t;
+
+/** Session summary in CTRL_STATS_SESSION (current, then previous) */
+typedef struct __attribute__((packed)) {
+	uint32_t id;                /**< 0 = none */
+	uint8_t  running;
+	uint32_t tags;
+	uint32_t reads;
+	uint32_t full_drops;
+	uint32_t duration_s;
+	uint16_t blocks;
+} ctrl_session_info_t;
+
+/** Router state in CTRL_STATS_STATE */
+typedef struct __attribute__((packed)) {
+	uint8_t  mode;              /**< router_mode_t */
+	uint8_t  running;
+	uint8_t  inventory_active;
+	uint8_t  e310_connected;
+	uint8_t  reader_addr;
+	uint8_t  epc_cached;
+	uint32_t config_version;    /**< runtime_config_version() */
+	uint32_t uptime_ms;
+} ctrl_state_t;
+
+/**
+ * @brief One tag read in CTRL_EVT_TAGS (followed by epc_len EPC bytes)
+ *
+ * seq counts every read since TAG_STREAM on; a read dropped because the
+ * event ring was full still takes a number, so the host sees the gap.
+ */
+typedef struct __attribute__((packed)) {
+	uint32_t seq;               /**< Event sequence number */
+	uint32_t read_ms;           /**< Reader uptime of the read (ms) */
+	uint8_t  rssi;
+	uint8_t  antenna;           /**< Antenna bitmask */
+	uint8_t  flags;             /**< CTRL_TAG_F_* */
+	uint8_t  epc_len;
+} ctrl_tag_rec_t;
+
+/* ========================================================================
+ * API Functions
+ * ======================================================================== */
+
+/**
+ * @brief Start the control protocol on cdc_acm_uart1
+ *
+ * @param router Router context (must outlive the module)
+ * @return 0 on success, -ENODEV if the interface is missing
+ */
+int ctrl_proto_init(uart_router_t *router);
+
+/**
+ * @brief Queue a tag read for the tag stream (router thread)
+ *
+ * No-op unless a host has the stream on. Never blocks: when the event
+ * ring is full the read is dropped and counted.
+ *
+ * @param epc EPC bytes
+ * @param epc_len EPC length
+ * @param rssi RSSI as reported by the reader
+ * @param antenna Antenna bitmask
+ * @param flags CTRL_TAG_F_*
+ */
+void ctrl_proto_tag_read(const uint8_t *epc, uint8_t epc_len, uint8_t rssi,
+			 uint8_t antenna, uint8_t flags);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CTRL_PROTO_H_ */
@@ -0,0 +1,168 @@
+/**
+ * @file dma_bench.c
+ * @brief DMA Buffer Placement Benchmark
+ *
+ * `dmabuf bench` prices both ways of keeping a DMA buffer coherent on
+ * the CPU side: byte-by-byte fill (as a frame builder or ring copy
+ * does), the handoff maintenance, and reading the buffer back, once for
+ * a cache-line aligned buffer in cached SRAM with explicit
+ * sys_cache_data_flush_range()/invd_range() and once for the nocache
+ * region. The DMA engine itself runs at the same speed either way; what
+ * differs is what the CPU pays to feed it.
+ *
+ * The firmware has no DMA buffer that could be cached: UART4 TX (the
+ * only app-owned DMA path) must stay __nocache because the STM32 UART
+ * async driver rejects cached buffers, and the USB buffers belong to
+ * the UDC driver. The numbers are for judging a driver-side change.
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#include <zephyr/cache.h>
+#include <zephyr/kernel.h>
+#include <zephyr/linker/section_tags.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/barrier.h>
+#include <zephyr/sys/util.h>
+#include <stdlib.h>
+#include <errno.h>
+
+/** Benchmark buffer size and defaults for omitted shell arguments */
+#define DMA_BENCH_MAX_BYTES         4096
+#define DMA_BENCH_DEFAULT_BYTES     512
+#define DMA_BENCH_DEFAULT_ROUNDS    64
+#define DMA_BENCH_MAX_ROUNDS        1000
+
+/* Whole cache lines, so maintenance never touches a neighbour */
+#ifdef CONFIG_DCACHE_LINE_SIZE
+#define DMA_BENCH_ALIGN             CONFIG_DCACHE_LINE_SIZE
+#else
+#define DMA_BENCH_ALIGN             32
+#endif
+
+BUILD_ASSERT(DMA_BENCH_MAX_BYTES % DMA_BENCH_ALIGN == 0,
+	     "bench buffers must be whole cache lines");
+
+static uint8_t bench_cached[DMA_BENCH_MAX_BYTES] __aligned(DMA_BENCH_ALIGN);
+#ifdef CONFIG_NOCACHE_MEMORY
+static uint8_t bench_nocache[DMA_BENCH_MAX_BYTES] __nocache __aligned(DMA_BENCH_ALIGN);
+#endif
+
+/** Cycles spent per phase, summed over all rounds */
+struct bench_cost {
+	uint32_t fill;
+	uint32_t flush;
+	uint32_t invd;
+	uint32_t read;
+};
+
+static void bench_region(uint8_t *buf, size_t len, uint32_t rounds,
+			 bool cached, struct bench_cost *c)
+{
+	volatile uint8_t *p = buf;
+	uint32_t sum = 0;
+
+	*c = (struct bench_cost){ 0 };
+
+	for (uint32_t r = 0; r < rounds; r++) {
+		unsigned int key = irq_lock();
+		uint32_t t0 = k_cycle_get_32();
+
+		for (size_t i = 0; i < len; i++) {
+			p[i] = (uint8_t)(i + r);
+		}
+		uint32_t t1 = k_cycle_get_32();
+
+		/* CPU -> device: nocache only needs the writes to drain */
+		if (cached) {
+			(void)sys_cache_data_flush_range(buf, len);
+		} else {
+			barrier_dmem_fence_full();
+		}
+		uint32_t t2 = k_cycle_get_32();
+
+		/* device -> CPU */
+		if (cached) {
+			(void)sys_cache_data_invd_range(buf, len);
+		}
+		uint32_t t3 = k_cycle_get_32();
+
+		for (size_t i = 0; i < len; i++) {
+			sum += p[i];
+		}
+		uint32_t t4 = k_cycle_get_32();
+
+		irq_unlock(key);
+
+		c->fill += t1 - t0;
+		c->flush += t2 - t1;
+		c->invd += t3 - t2;
+		c->read += t4 - t3;
+	}
+
+	ARG_UNUSED(sum);
+}
+
+static uint32_t per_kb(uint32_t cycles, uint64_t bytes)
+{
+	return (uint32_t)((uint64_t)cycles * 1024 / bytes);
+}
+
+static void print_cost(const struct shell *sh, const char *name,
+		       const struct bench_cost *c, size_t len, uint32_t rounds)
+{
+	uint64_t bytes = (uint64_t)len * rounds;
+	uint32_t tx_cyc = c->fill + c->flush;
+	/* Fill + handoff rate, MB/s x10 */
+	uint32_t mbps_x10 = tx_cyc ? (uint32_t)(bytes * 10 *
+			    sys_clock_hw_cycles_per_sec() / tx_cyc / 1000000) : 0;
+
+	shell_print(sh, "  %-8s %7u %7u %7u %7u   %5u.%u",
+		    name, per_kb(c->fill, bytes), per_kb(c->flush, bytes),
+		    per_kb(c->invd, bytes), per_kb(c->read, bytes),
+		    mbps_x10 / 10, mbps_x10 % 10);
+}
+
+static int cmd_dmabuf_bench(const struct shell *sh, size_t argc, char **argv)
+{
+	size_t len = DMA_BENCH_DEFAULT_BYTES;
+	uint32_t rounds = DMA_BENCH_DEFAULT_ROUNDS;
+	struct bench_cost c;
+
+	if (argc > 1) {
+		len = strtoul(argv[1], NULL, 0);
+	}
+	if (argc > 2) {
+		rounds = strtoul(argv[2], NULL, 0);
+	}
+	if (len == 0 || len > DMA_BENCH_MAX_BYTES ||
+	    rounds == 0 || rounds > DMA_BENCH_MAX_ROUNDS) {
+		shell_error(sh, "bytes 1-%u, rounds 1-%u", DMA_BENCH_MAX_BYTES,
+			    DMA_BENCH_MAX_ROUNDS);
+		return -EINVAL;
+	}
+
+	shell_print(sh, "=== DMA buffer: %u B x %u rounds (cycles/KB) ===",
+		    (uint32_t)len, rounds);
+	shell_print(sh, "  %-8s %7s %7s %7s %7s   %s", "", "fill", "flush",
+		    "invd", "read", "fill+flush MB/s");
+
+	bench_region(bench_cached, len, rounds, true, &c);
+	print_cost(sh, "cached", &c, len, rounds);
+
+#ifdef CONFIG_NOCACHE_MEMORY
+	bench_region(bench_nocache, len, rounds, false, &c);
+	print_cost(sh, "nocache", &c, len, rounds);
+#else
+	shell_print(sh, "  nocache: needs CONFIG_NOCACHE_MEMORY");
+#endif
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_dmabuf,
+	SHELL_CMD(bench, NULL, "Cached vs nocache DMA buffer cost: [bytes] [rounds]",
+		  cmd_dmabuf_bench),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(dmabuf, &sub_dmabuf, "DMA buffer cache management", NULL);
@@ -0,0 +1,493 @@
+/**
+ * @file e310_profile.c
+ * @brief Named E310 Configuration Profiles Implementation
+ *
+ * Switch sequence (profile use):
+ *   1. Read the profile record and diff it against the live settings
+ *   2. Publish every profile field as one runtime config version; the
+ *      router pushes the changed reader-side fields at the next round
+ *      boundary
+ *   3. Update the live settings for the changed fields; the write-behind
+ *      coalesces them into one EEPROM write
+ *   4. Wait for the router to report the version applied
+ *
+ * Steps 2-4 are e310_profile_apply(), which the binary control protocol
+ * (ctrl_proto.h) also commits its staged settings through.
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#include "e310_profile.h"
+#include "e310_settings.h"
+#include "kv_store.h"
+#include "runtime_config.h"
+#include "rgb_led.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+LOG_MODULE_REGISTER(e310_profile, LOG_LEVEL_INF);
+
+BUILD_ASSERT(sizeof(e310_profile_t) <= KV_STORE_PAGE_PAYLOAD,
+	     "A profile must fit a single-page record");
+BUILD_ASSERT(KV_KEY_PROFILE_0 + E310_PROFILE_COUNT <= KV_KEY_MAX,
+	     "Profile keys exceed the KV key space");
+
+static uart_router_t *profile_router;
+
+int e310_profile_init(uart_router_t *router)
+{
+	profile_router = router;
+	return 0;
+}
+
+/* ========================================================================
+ * Storage
+ * ======================================================================== */
+
+void e310_profile_capture(e310_profile_t *p)
+{
+	const e310_settings_t *s = e310_settings_get();
+
+	p->rf_power = s->rf_power;
+	p->antenna_config = s->antenna_config;
+	p->freq_region = s->freq_region;
+	p->freq_start = s->freq_start;
+	p->freq_end = s->freq_end;
+	p->inventory_time = s->inventory_time;
+	p->typing_speed = s->typing_speed;
+	p->beep_pulse_ms = s->beep_pulse_ms;
+	p->beep_filter_ms = s->beep_filter_ms;
+	p->epc_debounce_sec = s->epc_debounce_sec;
+	p->inventory_interval_ms = s->inventory_interval_ms;
+	p->rgb_brightness = s->rgb_brightness;
+}
+
+int e310_profile_save(uint8_t slot, const char *name)
+{
+	e310_profile_t p;
+
+	if (slot >= E310_PROFILE_COUNT || !name || name[0] == '\0') {
+		return -EINVAL;
+	}
+	if (!kv_store_is_ready()) {
+		return -ENODEV;
+	}
+
+	memset(&p, 0, sizeof(p));
+	strncpy(p.name, name, sizeof(p.name));
+	e310_profile_capture(&p);
+
+	return kv_store_write_verified(KV_KEY_PROFILE_0 + slot, &p, sizeof(p));
+}
+
+int e310_profile_load(uint8_t slot, e310_profile_t *profile)
+{
+	int ret;
+
+	if (slot >= E310_PROFILE_COUNT || !profile) {
+		return -EINVAL;
+	}
+	if (!kv_store_has(KV_KEY_PROFILE_0 + slot)) {
+		return -ENOENT;
+	}
+
+	ret = kv_store_read(KV_KEY_PROFILE_0 + slot, profile, sizeof(*profile));
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* Written by a firmware with a different profile layout */
+	return (ret == sizeof(*profile)) ? 0 : -EIO;
+}
+
+static bool name_matches(const e310_profile_t *p, const char *name)
+{
+	size_t len = strlen(name);
+
+	if (len == 0 || len > E310_PROFILE_NAME_LEN) {
+		return false;
+	}
+
+	return strncmp(p->name, name, E310_PROFILE_NAME_LEN) == 0;
+}
+
+int e310_profile_find(const char *name)
+{
+	e310_profile_t p;
+
+	for (uint8_t slot = 0; slot < E310_PROFILE_COUNT; slot++) {
+		if (e310_profile_load(slot, &p) == 0 && name_matches(&p, name)) {
+			return slot;
+		}
+	}
+
+	return -ENOENT;
+}
+
+int e310_profile_validate(const e310_profile_t *p)
+{
+	/* Same limits as the e310_settings setters */
+	if (p->rf_power > E310_RF_POWER_MAX ||
+	    p->freq_region < E310_FREQ_REGION_MIN ||
+	    p->freq_region > E310_FREQ_REGION_MAX ||
+	    p->freq_start > E310_FREQ_INDEX_MAX ||
+	    p->freq_end > E310_FREQ_INDEX_MAX ||
+	    p->inventory_time < E310_INVENTORY_TIME_MIN ||
+	    p->typing_speed < E310_TYPING_SPEED_MIN ||
+	    p->typing_speed > E310_TYPING_SPEED_MAX ||
+	    p->beep_pulse_ms < E310_BEEP_PULSE_MIN ||
+	    p->beep_pulse_ms > E310_BEEP_PULSE_MAX ||
+	    p->beep_filter_ms < E310_BEEP_FILTER_MIN ||
+	    p->beep_filter_ms > E310_BEEP_FILTER_MAX ||
+	    p->epc_debounce_sec > E310_EPC_DEBOUNCE_MAX ||
+	    p->inventory_interval_ms > E310_INV_INTERVAL_MAX ||
+	    p->rgb_brightness > E310_RGB_BRIGHTNESS_MAX) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+uint32_t e310_profile_diff(const e310_profile_t *p)
+{
+	const e310_settings_t *s = e310_settings_get();
+	uint32_t diff = 0;
+
+	if (p->rf_power != s->rf_power) {
+		diff |= E310_PROFILE_F_RF_POWER;
+	}
+	if (p->antenna_config != s->antenna_config) {
+		diff |= E310_PROFILE_F_ANTENNA;
+	}
+	if (p->freq_region != s->freq_region || p->freq_start != s->freq_start ||
+	    p->freq_end != s->freq_end) {
+		diff |= E310_PROFILE_F_FREQUENCY;
+	}
+	if (p->inventory_time != s->inventory_time) {
+		diff |= E310_PROFILE_F_INV_TIME;
+	}
+	if (p->typing_speed != s->typing_speed) {
+		diff |= E310_PROFILE_F_TYPING_SPEED;
+	}
+	if (p->beep_pulse_ms != s->beep_pulse_ms) {
+		diff |= E310_PROFILE_F_BEEP_PULSE;
+	}
+	if (p->beep_filter_ms != s->beep_filter_ms) {
+		diff |= E310_PROFILE_F_BEEP_FILTER;
+	}
+	if (p->epc_debounce_sec != s->epc_debounce_sec) {
+		diff |= E310_PROFILE_F_EPC_DEBOUNCE;
+	}
+	if (p->inventory_interval_ms != s->inventory_interval_ms) {
+		diff |= E310_PROFILE_F_INV_INTERVAL;
+	}
+	if (p->rgb_brightness != s->rgb_brightness) {
+		diff |= E310_PROFILE_F_RGB;
+	}
+
+	return diff;
+}
+
+/* ========================================================================
+ * Switching
+ * ======================================================================== */
+
+static uint32_t publish(const e310_profile_t *p)
+{
+	runtime_config_t *cfg = runtime_config_edit();
+
+	cfg->epc_debounce_ms = (uint32_t)p->epc_debounce_sec * 1000;
+	cfg->inventory_interval_ms = p->inventory_interval_ms;
+	cfg->typing_speed_cpm = p->typing_speed;
+	cfg->beep_pulse_ms = p->beep_pulse_ms;
+	cfg->beep_filter_ms = p->beep_filter_ms;
+	cfg->rf_power = p->rf_power;
+	cfg->antenna_config = p->antenna_config;
+	cfg->freq_region = p->freq_region;
+	cfg->freq_start = p->freq_start;
+	cfg->freq_end = p->freq_end;
+	cfg->inventory_time = p->inventory_time;
+
+	return runtime_config_publish();
+}
+
+/** Update the live settings (write-behind, one coalesced EEPROM write) */
+static void persist(const e310_profile_t *p, uint32_t applied)
+{
+	if (applied & E310_PROFILE_F_RF_POWER) {
+		e310_settings_set_rf_power(p->rf_power);
+	}
+	if (applied & E310_PROFILE_F_ANTENNA) {
+		e310_settings_set_antenna(p->antenna_config);
+	}
+	if (applied & E310_PROFILE_F_FREQUENCY) {
+		e310_settings_set_frequency(p->freq_region, p->freq_start, p->freq_end);
+	}
+	if (applied & E310_PROFILE_F_INV_TIME) {
+		e310_settings_set_inventory_time(p->inventory_time);
+	}
+	if (applied & E310_PROFILE_F_TYPING_SPEED) {
+		e310_settings_set_typing_speed(p->typing_speed);
+	}
+	if (applied & E310_PROFILE_F_BEEP_PULSE) {
+		e310_settings_set_beep_pulse(p->beep_pulse_ms);
+	}
+	if (applied & E310_PROFILE_F_BEEP_FILTER) {
+		e310_settings_set_beep_filter(p->beep_filter_ms);
+	}
+	if (applied & E310_PROFILE_F_EPC_DEBOUNCE) {
+		e310_settings_set_epc_debounce(p->epc_debounce_sec);
+	}
+	if (applied & E310_PROFILE_F_INV_INTERVAL) {
+		e310_settings_set_inventory_interval(p->inventory_interval_ms);
+	}
+	if (applied & E310_PROFILE_F_RGB) {
+		e310_settings_set_rgb_brightness(p->rgb_brightness);
+	}
+}
+
+int e310_profile_apply(const e310_profile_t *p, e310_profile_switch_t *result)
+{
+	e310_profile_switch_t res = {0};
+	uint32_t t_start = k_cycle_get_32();
+	int ret;
+
+	if (!profile_router) {
+		return -ENODEV;
+	}
+
+	ret = e310_profile_validate(p);
+	if (ret < 0) {
+		return ret;
+	}
+
+	res.changed = e310_profile_diff(p);
+	res.version = publish(p);
+	if (res.changed & E310_PROFILE_F_RGB) {
+		rgb_led_set_brightness(p->rgb_brightness);
+	}
+	res.publish_us = k_cyc_to_us_floor32(k_cycle_get_32() - t_start);
+
+	persist(p, res.changed);
+
+	ret = uart_router_wait_config(profile_router, res.version,
+				      E310_PROFILE_APPLY_TIMEOUT_MS);
+	res.total_us = k_cyc_to_us_floor32(k_cycle_get_32() - t_start);
+
+	if (result) {
+		*result = res;
+	}
+	return ret;
+}
+
+int e310_profile_use(uint8_t slot, e310_profile_switch_t *result)
+{
+	e310_profile_switch_t res = {0};
+	e310_profile_t p;
+	int ret;
+
+	ret = e310_profile_load(slot, &p);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = e310_profile_apply(&p, &res);
+	if (result) {
+		*result = res;
+	}
+
+	if (ret == 0) {
+		LOG_INF("Profile %u '%.*s' applied (0x%03x) in %u us", slot,
+			E310_PROFILE_NAME_LEN, p.name, res.changed, res.total_us);
+	}
+	return ret;
+}
+
+/* ========================================================================
+ * Shell Commands
+ * ======================================================================== */
+
+static int parse_slot(const struct shell *sh, const char *arg)
+{
+	char *end;
+	long slot = strtol(arg, &end, 10);
+
+	if (*end != '\0' || slot < 0 || slot >= E310_PROFILE_COUNT) {
+		shell_error(sh, "Invalid slot: %s (0-%d)", arg, E310_PROFILE_COUNT - 1);
+		return -EINVAL;
+	}
+
+	return (int)slot;
+}
+
+static void print_changes(const struct shell *sh, uint32_t changed)
+{
+	static const char *const names[] = {
+		"power", "antenna", "freq", "invtime", "speed",
+		"pulse", "filter", "debounce", "interval", "rgb",
+	};
+	char buf[96];
+	int pos = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(names); i++) {
+		if ((changed & BIT(i)) && pos < (int)sizeof(buf)) {
+			pos += snprintk(&buf[pos], sizeof(buf) - pos, " %s", names[i]);
+		}
+	}
+
+	shell_print(sh, "Changes:%s", (pos > 0) ? buf : " none");
+}
+
+static int cmd_profile_list(const struct shell *sh, size_t argc, char **argv)
+{
+	e310_profile_t p;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	shell_print(sh, "Slot Name     Power Ant  Freq      Speed  Interval");
+	for (uint8_t slot = 0; slot < E310_PROFILE_COUNT; slot++) {
+		int ret = e310_profile_load(slot, &p);
+
+		if (ret == -ENOENT) {
+			shell_print(sh, "  %u  (empty)", slot);
+			continue;
+		}
+		if (ret < 0) {
+			shell_print(sh, "  %u  (unreadable: %d)", slot, ret);
+			continue;
+		}
+
+		shell_print(sh, "%c %u  %-8.*s %3u   0x%02x %u:%2u-%-2u   %5u  %5u ms",
+			    (e310_profile_diff(&p) == 0) ? '*' : ' ', slot,
+			    E310_PROFILE_NAME_LEN, p.name, p.rf_power,
+			    p.antenna_config, p.freq_region, p.freq_start,
+			    p.freq_end, p.typing_speed, p.inventory_interval_ms);
+	}
+	shell_print(sh, "* = matches the live settings");
+
+	return 0;
+}
+
+static int cmd_profile_save(const struct shell *sh, size_t argc, char **argv)
+{
+	int slot;
+	int ret;
+
+	if (argc < 3) {
+		shell_print(sh, "Usage: profile save <0-%d> <name>", E310_PROFILE_COUNT - 1);
+		return -EINVAL;
+	}
+
+	slot = parse_slot(sh, argv[1]);
+	if (slot < 0) {
+		return slot;
+	}
+	if (strlen(argv[2]) > E310_PROFILE_NAME_LEN) {
+		shell_error(sh, "Name too long (max %d)", E310_PROFILE_NAME_LEN);
+		return -EINVAL;
+	}
+
+	ret = e310_profile_save((uint8_t)slot, argv[2]);
+	if (ret < 0) {
+		shell_error(sh, "Failed to save profile: %d", ret);
+		return ret;
+	}
+
+	shell_print(sh, "Current settings saved as profile %d '%s'", slot, argv[2]);
+	return 0;
+}
+
+static int cmd_profile_show(const struct shell *sh, size_t argc, char **argv)
+{
+	e310_profile_t p;
+	int slot;
+	int ret;
+
+	if (argc < 2) {
+		shell_print(sh, "Usage: profile show <0-%d>", E310_PROFILE_COUNT - 1);
+		return -EINVAL;
+	}
+
+	slot = parse_slot(sh, argv[1]);
+	if (slot < 0) {
+		return slot;
+	}
+
+	ret = e310_profile_load((uint8_t)slot, &p);
+	if (ret < 0) {
+		shell_error(sh, "Failed to read profile %d: %d", slot, ret);
+		return ret;
+	}
+
+	shell_print(sh, "Profile %d '%.*s'", slot, E310_PROFILE_NAME_LEN, p.name);
+	shell_print(sh, "  RF Power:     %u dBm", p.rf_power);
+	shell_print(sh, "  Antenna:      0x%02X", p.antenna_config);
+	shell_print(sh, "  Frequency:    region %u, %u-%u", p.freq_region,
+		    p.freq_start, p.freq_end);
+	shell_print(sh, "  Inv Time:     %u (x100ms)", p.inventory_time);
+	shell_print(sh, "  Typing Speed: %u CPM", p.typing_speed);
+	shell_print(sh, "  Beep:         %u ms pulse, %u ms filter",
+		    p.beep_pulse_ms, p.beep_filter_ms);
+	shell_print(sh, "  EPC Debounce: %u sec", p.epc_debounce_sec);
+	shell_print(sh, "  Inv Interval: %u ms", p.inventory_interval_ms);
+	shell_print(sh, "  RGB:          %u%%", p.rgb_brightness);
+	print_changes(sh, e310_profile_diff(&p));
+
+	return 0;
+}
+
+static int cmd_profile_use(const struct shell *sh, size_t argc, char **argv)
+{
+	e310_profile_switch_t res;
+	int slot;
+	int ret;
+
+	if (argc < 2) {
+		shell_print(sh, "Usage: profile use <0-%d|name>", E310_PROFILE_COUNT - 1);
+		return -EINVAL;
+	}
+
+	slot = (argv[1][0] >= '0' && argv[1][0] <= '9') ?
+	       parse_slot(sh, argv[1]) : e310_profile_find(argv[1]);
+	if (slot == -ENOENT) {
+		shell_error(sh, "No profile named '%s'", argv[1]);
+	}
+	if (slot < 0) {
+		return slot;
+	}
+
+	ret = e310_profile_use((uint8_t)slot, &res);
+	if (ret == -ENOENT) {
+		shell_error(sh, "Profile %d is empty", slot);
+		return ret;
+	}
+	if (ret == -EINVAL || ret == -EIO) {
+		shell_error(sh, "Profile %d is not valid for this firmware", slot);
+		return ret;
+	}
+
+	print_changes(sh, res.changed);
+	if (ret < 0) {
+		shell_warn(sh, "Profile %d published; E310 not updated yet: %d", slot, ret);
+		return ret;
+	}
+
+	shell_print(sh, "Profile %d applied in %u.%03u ms (host side live after %u us)",
+		    slot, res.total_us / 1000, res.total_us % 1000, res.publish_us);
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_profile,
+	SHELL_CMD(list, NULL, "List profiles", cmd_profile_list),
+	SHELL_CMD(save, NULL, "Save current settings: <n> <name>", cmd_profile_save),
+	SHELL_CMD(show, NULL, "Show a profile: <n>", cmd_profile_show),
+	SHELL_CMD(use, NULL, "Switch to a profile: <n|name>", cmd_profile_use),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(profile, &sub_profile, "Named configuration profiles", NULL);
@@ -0,0 +1,190 @@
+/**
+ * @file e310_profile.h
+ * @brief Named E310 Configuration Profiles
+ *
+ * A profile is a named snapshot of the switchable reader settings (RF
+ * power, antenna, frequency, inventory time and interval, typing speed,
+ * beeper, EPC debounce, LED brightness) kept in the EEPROM key/value
+ * store, one single-page record per slot.
+ *
+ * Switching publishes the profile as one runtime configuration version
+ * (runtime_config.h): host-side fields are live at once and the router
+ * sends only the reader-side fields that differ to the E310 at the next
+ * round boundary, so inventory keeps running. The changed fields are
+ * persisted through the settings write-behind as one coalesced EEPROM
+ * write.
+ *
+ * Shell:
+ *   profile list                  slots, names and the active profile
+ *   profile save <n> <name>       store the current settings in slot n
+ *   profile show <n>              profile fields and what would change
+ *   profile use <n|name>          switch and report the switch time
+ *
+ * The reader address is not part of a profile.
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#ifndef E310_PROFILE_H_
+#define E310_PROFILE_H_
+
+#include "uart_router.h"
+#include <zephyr/sys/util.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup e310_profile E310 Profiles
+ * @{
+ */
+
+/** Profile slots (KV keys KV_KEY_PROFILE_0 onwards) */
+#define E310_PROFILE_COUNT          8
+
+/** Name length (NUL-padded, not terminated when all bytes are used) */
+#define E310_PROFILE_NAME_LEN       8
+
+/** Longest wait for the E310 to take the profile (single-shot round is 5 s) */
+#define E310_PROFILE_APPLY_TIMEOUT_MS 6000
+
+/** Changed-field bits */
+#define E310_PROFILE_F_RF_POWER     BIT(0)
+#define E310_PROFILE_F_ANTENNA      BIT(1)
+#define E310_PROFILE_F_FREQUENCY    BIT(2)
+#define E310_PROFILE_F_INV_TIME     BIT(3)
+#define E310_PROFILE_F_TYPING_SPEED BIT(4)
+#define E310_PROFILE_F_BEEP_PULSE   BIT(5)
+#define E310_PROFILE_F_BEEP_FILTER  BIT(6)
+#define E310_PROFILE_F_EPC_DEBOUNCE BIT(7)
+#define E310_PROFILE_F_INV_INTERVAL BIT(8)
+#define E310_PROFILE_F_RGB          BIT(9)
+
+/** Fields the router sends to the E310 */
+#define E310_PROFILE_F_E310 (E310_PROFILE_F_RF_POWER | E310_PROFILE_F_ANTENNA | \
+			     E310_PROFILE_F_FREQUENCY | E310_PROFILE_F_INV_TIME)
+
+/**
+ * @brief Stored profile (one KV record)
+ */
+typedef struct __packed {
+	char name[E310_PROFILE_NAME_LEN];
+	uint8_t rf_power;
+	uint8_t antenna_config;
+	uint8_t freq_region;
+	uint8_t freq_start;
+	uint8_t freq_end;
+	uint8_t inventory_time;
+	uint16_t typing_speed;
+	uint16_t beep_pulse_ms;
+	uint16_t beep_filter_ms;
+	uint8_t epc_debounce_sec;
+	uint16_t inventory_interval_ms;
+	uint8_t rgb_brightness;
+} e310_profile_t;
+
+/**
+ * @brief Outcome of a profile switch
+ */
+typedef struct {
+	uint32_t changed;      /**< E310_PROFILE_F_* bits that differed */
+	uint32_t version;      /**< Runtime config version published */
+	uint32_t publish_us;   /**< Until host-side fields were live */
+	uint32_t total_us;     /**< Until the E310 had the reader-side fields */
+} e310_profile_switch_t;
+
+/**
+ * @brief Set the router the profiles are applied through
+ *
+ * @param router Router context (must outlive the module)
+ * @return 0
+ */
+int e310_profile_init(uart_router_t *router);
+
+/**
+ * @brief Store the current settings as a profile
+ *
+ * @param slot Slot (0 to E310_PROFILE_COUNT - 1)
+ * @param name Profile name (truncated to E310_PROFILE_NAME_LEN)
+ * @return 0 on success, -EINVAL on bad slot/name, -ENODEV without EEPROM,
+ *         negative errno on write failure
+ */
+int e310_profile_save(uint8_t slot, const char *name);
+
+/**
+ * @brief Read a profile
+ *
+ * @param slot Slot
+ * @param profile Output
+ * @return 0 on success, -ENOENT for an empty slot, negative errno otherwise
+ */
+int e310_profile_load(uint8_t slot, e310_profile_t *profile);
+
+/**
+ * @brief Find a profile by name
+ *
+ * @param name Profile name
+ * @return Slot, or -ENOENT
+ */
+int e310_profile_find(const char *name);
+
+/**
+ * @brief Fill the profile fields from the live settings (name untouched)
+ *
+ * @param profile Output
+ */
+void e310_profile_capture(e310_profile_t *profile);
+
+/**
+ * @brief Check every field against the e310_settings limits
+ *
+ * @param profile Profile
+ * @return 0 if all fields are in range, -EINVAL otherwise
+ */
+int e310_profile_validate(const e310_profile_t *profile);
+
+/**
+ * @brief Get the fields in which a profile differs from the live settings
+ *
+ * @param profile Profile
+ * @return E310_PROFILE_F_* bits
+ */
+uint32_t e310_profile_diff(const e310_profile_t *profile);
+
+/**
+ * @brief Apply a set of settings as one runtime config version
+ *
+ * Validates all fields first: on -EINVAL nothing has been changed.
+ * Shell/thread context only; waits like e310_profile_use().
+ *
+ * @param profile Settings to apply (name ignored)
+ * @param result Output (may be NULL)
+ * @return 0 on success, -EINVAL if a field is out of range, -ETIMEDOUT
+ *         if the E310 has not taken it yet, negative errno otherwise
+ */
+int e310_profile_apply(const e310_profile_t *profile,
+		       e310_profile_switch_t *result);
+
+/**
+ * @brief Switch to a profile
+ *
+ * Shell/thread context only. Returns once the router has applied the
+ * profile, E310 included, or after E310_PROFILE_APPLY_TIMEOUT_MS.
+ *
+ * @param slot Slot
+ * @param result Output (may be NULL)
+ * @return 0 on success, -ENOENT for an empty slot, -ETIMEDOUT if the
+ *         E310 has not taken it yet (it stays queued), negative errno
+ *         otherwise
+ */
+int e310_profile_use(uint8_t slot, e310_profile_switch_t *result);
+
+/** @} */ /* End of e310_profile group */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* E310_PROFILE_H_ */
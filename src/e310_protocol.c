@@ -166,7 +166,7 @@ int e310_build_tag_inventory_default(e310_context_t *ctx)
 	ctx->tx_buffer[idx++] = 0x00;  /* Session: S0 (tags respond every scan) */
 	ctx->tx_buffer[idx++] = 0x00;  /* MaskMem: no mask */
 	ctx->tx_buffer[idx++] = 0x80;  /* MaskAdr high byte */
-	ctx->tx_buffer[idx++] = 0x32;  /* ScanTime: 50 = 5 seconds */
+	ctx->tx_buffer[idx++] = E310_INVENTORY_DEFAULT_SCAN_TIME;  /* 5 seconds */
 
 	return e310_finalize_frame(ctx, idx);
 }
@@ -794,7 +794,7 @@ int e310_build_measure_temperature(e310_context_t *ctx)
 		return E310_ERR_INVALID_PARAM;
 	}
 
-	size_t idx = e310_build_frame_header(ctx, 0x92, 0);
+	size_t idx = e310_build_frame_header(ctx, E310_CMD_MEASURE_TEMPERATURE, 0);
 	return e310_finalize_frame(ctx, idx);
 }
 
@@ -826,6 +826,41 @@ int e310_build_modify_frequency(e310_context_t *ctx, uint8_t max_fre, uint8_t mi
 	return e310_finalize_frame(ctx, idx);
 }
 
+int e310_encode_frequency(uint8_t region, uint8_t start, uint8_t end,
+                          uint8_t *max_fre, uint8_t *min_fre)
+{
+	uint8_t band_hi, band_lo;
+
+	if (!max_fre || !min_fre) {
+		return E310_ERR_INVALID_PARAM;
+	}
+
+	switch (region) {
+	case 1: /* China */
+		band_hi = 0x00;
+		band_lo = 0x01;
+		break;
+	case 2: /* US */
+		band_hi = 0x00;
+		band_lo = 0x02;
+		break;
+	case 3: /* Europe */
+		band_hi = 0x01;
+		band_lo = 0x00;
+		break;
+	case 4: /* Korea */
+		band_hi = 0x00;
+		band_lo = 0x03;
+		break;
+	default:
+		return E310_ERR_INVALID_PARAM;
+	}
+
+	*max_fre = (uint8_t)((band_hi << 6) | (end & 0x3F));
+	*min_fre = (uint8_t)((band_lo << 6) | (start & 0x3F));
+	return E310_OK;
+}
+
 int e310_build_modify_reader_addr(e310_context_t *ctx, uint8_t new_addr)
 {
 	if (!ctx) {
@@ -850,6 +885,19 @@ int e310_build_modify_inventory_time(e310_context_t *ctx, uint8_t time_100ms)
 	return e310_finalize_frame(ctx, idx);
 }
 
+int e310_build_modify_heartbeat_time(e310_context_t *ctx, uint8_t units)
+{
+	if (!ctx || units > E310_HEARTBEAT_MAX) {
+		return E310_ERR_INVALID_PARAM;
+	}
+
+	/* Bit 7 set: modify (clear would only load the current value) */
+	size_t idx = e310_build_frame_header(ctx, E310_CMD_MODIFY_HEARTBEAT_TIME, 1);
+	ctx->tx_buffer[idx++] = 0x80 | units;
+
+	return e310_finalize_frame(ctx, idx);
+}
+
 int e310_build_modify_baud_rate(e310_context_t *ctx, uint8_t baud_index)
 {
 	if (!ctx) {
@@ -194,6 +194,12 @@ extern "C" {
 /** Get Tag Count from Buffer */
 #define E310_CMD_GET_TAG_COUNT_FROM_BUFFER  0x74
 
+/** Load/Modify Heartbeat Packet Time (real-time inventory mode) */
+#define E310_CMD_MODIFY_HEARTBEAT_TIME      0x78
+
+/** Measure Temperature */
+#define E310_CMD_MEASURE_TEMPERATURE        0x92
+
 /** Stop Immediately */
 #define E310_CMD_STOP_IMMEDIATELY           0x93
 
@@ -604,6 +610,9 @@ int e310_build_start_fast_inventory(e310_context_t *ctx, uint8_t target);
  */
 int e310_build_stop_fast_inventory(e310_context_t *ctx);
 
+/** ScanTime sent by e310_build_tag_inventory_default() (x100 ms) */
+#define E310_INVENTORY_DEFAULT_SCAN_TIME    50
+
 /**
  * @brief Build "Tag Inventory" command (0x01) with default parameters
  *
@@ -769,6 +778,19 @@ int e310_build_measure_temperature(e310_context_t *ctx);
  */
 int e310_build_modify_frequency(e310_context_t *ctx, uint8_t max_fre, uint8_t min_fre);
 
+/**
+ * @brief Encode a region and frequency point range for "Modify Frequency"
+ *
+ * @param region Region code (1=China, 2=US, 3=Europe, 4=Korea)
+ * @param start First frequency point (0-63)
+ * @param end Last frequency point (0-63)
+ * @param max_fre Output: MaxFre byte
+ * @param min_fre Output: MinFre byte
+ * @return E310_OK, or E310_ERR_INVALID_PARAM for an unknown region
+ */
+int e310_encode_frequency(uint8_t region, uint8_t start, uint8_t end,
+                          uint8_t *max_fre, uint8_t *min_fre);
+
 /**
  * @brief Build "Modify Reader Address" command (0x24)
  *
@@ -787,6 +809,24 @@ int e310_build_modify_reader_addr(e310_context_t *ctx, uint8_t new_addr);
  */
 int e310_build_modify_inventory_time(e310_context_t *ctx, uint8_t time_100ms);
 
+/** Heartbeat time unit of command 0x78 */
+#define E310_HEARTBEAT_UNIT_MS              30000
+
+/** Largest heartbeat time (units of E310_HEARTBEAT_UNIT_MS) */
+#define E310_HEARTBEAT_MAX                  127
+
+/**
+ * @brief Build "Modify Heartbeat Packet Time" command (0x78)
+ *
+ * In real-time inventory mode the E310 sends a heartbeat packet after
+ * this long without a tag.
+ *
+ * @param ctx Context
+ * @param units Interval in 30 s units (0 = no heartbeat, max 127)
+ * @return Frame length ready to transmit, or negative error code
+ */
+int e310_build_modify_heartbeat_time(e310_context_t *ctx, uint8_t units);
+
 /**
  * @brief Build "Modify Baud Rate" command (0x28)
  *
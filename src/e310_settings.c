@@ -4,11 +4,12 @@
  */
 
 #include "e310_settings.h"
+#include "kv_store.h"
+#include "eeprom_async.h"
 #include <zephyr/kernel.h>
-#include <zephyr/device.h>
-#include <zephyr/drivers/eeprom.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
 #include <string.h>
 
 LOG_MODULE_REGISTER(e310_settings, LOG_LEVEL_INF);
@@ -21,7 +22,48 @@ BUILD_ASSERT(offsetof(e310_settings_t, crc16) == 44,
 	     "CRC field offset changed — EEPROM binary compat broken!");
 static e310_settings_t settings;
 static bool eeprom_available;
-static const struct device *eeprom_dev;
+
+/*
+ * Write-behind state
+ *
+ * The struct is stored as one key/value record (KV_KEY_SETTINGS), so an
+ * update is atomic: a record torn by a power loss fails its CRC and the
+ * previous one is used at boot. Setters update the RAM copy and mark it
+ * dirty. flush_work coalesces everything changed within
+ * E310_SETTINGS_WB_DELAY_MS into one append, skipped if the struct
+ * matches the store. The append is followed by a queued read-back; both
+ * run on the EEPROM I/O thread and a failed read-back marks the struct
+ * dirty again, so the work item itself never waits on the bus.
+ *
+ * settings_lock guards settings against the writer's snapshot. io_lock
+ * serialises write_settings() between the work item and
+ * e310_settings_flush() and guards the stored image.
+ */
+#define WB_MAX_RETRIES    3
+
+BUILD_ASSERT(sizeof(e310_settings_t) <= KV_STORE_VALUE_MAX,
+	     "settings must fit one KV record");
+BUILD_ASSERT(offsetof(e310_settings_t, freq_end) ==
+	     offsetof(e310_settings_t, freq_region) + 2,
+	     "e310_settings_set_frequency() writes the three fields as one span");
+
+static struct k_spinlock settings_lock;
+static K_MUTEX_DEFINE(io_lock);
+
+static atomic_t dirty;            /* Settings changed since the last append */
+static atomic_t force;            /* Stored contents unknown, write regardless */
+static atomic_t inflight;         /* Read-backs not completed yet */
+static atomic_t wb_retries;
+static e310_settings_t stored;    /* Expected store contents */
+static uint32_t wb_writes;
+static uint32_t wb_verify_errors;
+
+static struct k_work_delayable flush_work;
+
+/* e310_settings_flush() waiting for the last read-back */
+static K_SEM_DEFINE(flush_sem, 0, 1);
+static atomic_t flush_waiting;
+static atomic_t flush_result;
 
 static uint16_t crc16_ccitt(const uint8_t *data, size_t len)
 {
@@ -62,64 +104,160 @@ static void load_defaults(void)
 	settings.rgb_brightness = E310_DEFAULT_RGB_BRIGHTNESS;
 }
 
-static int eeprom_read_settings(void)
+static int eeprom_read_legacy(void)
 {
-	if (!eeprom_dev) {
-		return -ENODEV;
-	}
-
-	return eeprom_read(eeprom_dev, E310_SETTINGS_EEPROM_OFFSET,
-			   &settings, sizeof(settings));
+	return eeprom_async_read_sync(E310_SETTINGS_EEPROM_OFFSET,
+				      &settings, sizeof(settings));
 }
 
-static int eeprom_write_settings(void)
+static void update_crc(void)
 {
-	if (!eeprom_dev) {
-		return -ENODEV;
-	}
+	settings.crc16 = crc16_ccitt((const uint8_t *)&settings, CRC_DATA_SIZE);
+}
 
-	return eeprom_write(eeprom_dev, E310_SETTINGS_EEPROM_OFFSET,
-			    &settings, sizeof(settings));
+static bool verify_crc(void)
+{
+	uint16_t calc_crc = crc16_ccitt((const uint8_t *)&settings, CRC_DATA_SIZE);
+	return settings.crc16 == calc_crc;
 }
 
-static int eeprom_write_verified(void)
+/** Read the struct from the KV store into settings */
+static int kv_read_settings(void)
 {
-	e310_settings_t verify;
 	int ret;
 
-	ret = eeprom_write_settings();
+	ret = kv_store_read(KV_KEY_SETTINGS, &settings, sizeof(settings));
 	if (ret < 0) {
 		return ret;
 	}
 
-	k_msleep(5);
+	return ((size_t)ret == sizeof(settings)) ? 0 : -EIO;
+}
+
+/** Write the struct and verify it (boot-time defaults and migration) */
+static int kv_write_settings_verified(void)
+{
+	int ret;
 
-	ret = eeprom_read(eeprom_dev, E310_SETTINGS_EEPROM_OFFSET,
-			  &verify, sizeof(verify));
+	ret = kv_store_write_verified(KV_KEY_SETTINGS, &settings, sizeof(settings));
 	if (ret < 0) {
-		LOG_ERR("Settings verify read failed: %d", ret);
+		LOG_ERR("Settings write verification failed");
 		return ret;
 	}
 
-	if (memcmp(&settings, &verify, sizeof(settings)) != 0) {
-		LOG_ERR("Settings write verification failed");
-		return -EIO;
+	stored = settings;
+	return 0;
+}
+
+/** Read-back of the settings record finished (EEPROM I/O thread) */
+static void settings_checked(int result, void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	if (result < 0) {
+		wb_verify_errors++;
+		atomic_set(&force, 1);
+		atomic_set(&dirty, 1);
+		atomic_set(&flush_result, result);
+		LOG_ERR("Settings verify failed: %d", result);
+		if (atomic_inc(&wb_retries) < WB_MAX_RETRIES) {
+			k_work_schedule(&flush_work, K_MSEC(E310_SETTINGS_WB_DELAY_MS));
+		}
+	}
+
+	if (atomic_dec(&inflight) == 1 && atomic_get(&flush_waiting)) {
+		k_sem_give(&flush_sem);
+	}
+}
+
+/** Queue a settings snapshot if it changed (caller holds io_lock) */
+static int write_settings(void)
+{
+	e310_settings_t snap;
+	k_spinlock_key_t key;
+	int ret;
+
+	if (!atomic_clear(&dirty)) {
+		return 0;
 	}
 
+	key = k_spin_lock(&settings_lock);
+	snap = settings;
+	k_spin_unlock(&settings_lock, key);
+
+	/* A field set back to its stored value needs no write */
+	if (!atomic_get(&force) && memcmp(&snap, &stored, sizeof(snap)) == 0) {
+		return 0;
+	}
+
+	atomic_inc(&inflight);
+	ret = kv_store_write(KV_KEY_SETTINGS, &snap, sizeof(snap), NULL, NULL);
+	if (ret == 0) {
+		ret = kv_store_check(KV_KEY_SETTINGS, &snap, sizeof(snap),
+				     settings_checked, NULL);
+	}
+	if (ret < 0) {
+		atomic_dec(&inflight);
+		atomic_set(&force, 1);
+		atomic_set(&dirty, 1);
+		LOG_ERR("Settings write failed: %d", ret);
+		return ret;
+	}
+
+	stored = snap;
+	atomic_set(&force, 0);
+	wb_writes++;
 	return 0;
 }
 
-static void update_crc(void)
+static void flush_work_handler(struct k_work *work)
 {
-	settings.crc16 = crc16_ccitt((const uint8_t *)&settings, CRC_DATA_SIZE);
+	ARG_UNUSED(work);
+	int ret;
+
+	k_mutex_lock(&io_lock, K_FOREVER);
+	ret = write_settings();
+	k_mutex_unlock(&io_lock);
+
+	if (ret < 0 && atomic_inc(&wb_retries) < WB_MAX_RETRIES) {
+		k_work_reschedule(&flush_work, K_MSEC(E310_SETTINGS_WB_DELAY_MS));
+	}
 }
 
-static bool verify_crc(void)
+/**
+ * @brief Update struct bytes [off, off + len) and queue the struct
+ *
+ * @p val NULL means the caller already changed settings (whole-struct
+ * updates).
+ */
+static void set_bytes(size_t off, const void *val, size_t len)
 {
-	uint16_t calc_crc = crc16_ccitt((const uint8_t *)&settings, CRC_DATA_SIZE);
-	return settings.crc16 == calc_crc;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&settings_lock);
+	if (val) {
+		memcpy((uint8_t *)&settings + off, val, len);
+	}
+	settings.flags |= E310_FLAG_SETTINGS_CHANGED;
+	update_crc();
+	k_spin_unlock(&settings_lock, key);
+
+	if (!eeprom_available) {
+		return;
+	}
+
+	atomic_set(&dirty, 1);
+	atomic_set(&wb_retries, 0);
+	/* schedule, not reschedule: a stream of changes must not starve the write */
+	k_work_schedule(&flush_work, K_MSEC(E310_SETTINGS_WB_DELAY_MS));
 }
 
+#define SET_FIELD(field, value)                                            \
+	do {                                                               \
+		__typeof__(settings.field) v_ = (value);                   \
+		set_bytes(offsetof(e310_settings_t, field), &v_, sizeof(v_)); \
+	} while (0)
+
 static int init_eeprom_defaults(void)
 {
 	int ret;
@@ -127,7 +265,7 @@ static int init_eeprom_defaults(void)
 	load_defaults();
 	update_crc();
 
-	ret = eeprom_write_verified();
+	ret = kv_write_settings_verified();
 	if (ret < 0) {
 		LOG_ERR("Failed to write settings defaults: %d", ret);
 		return ret;
@@ -139,23 +277,38 @@ static int init_eeprom_defaults(void)
 
 int e310_settings_init(void)
 {
+	bool from_legacy = false;
 	int ret;
 
-	eeprom_dev = DEVICE_DT_GET(DT_ALIAS(eeprom_0));
-	if (!device_is_ready(eeprom_dev)) {
-		LOG_WRN("EEPROM not ready, using default settings");
-		eeprom_dev = NULL;
+	k_work_init_delayable(&flush_work, flush_work_handler);
+
+	if (!kv_store_is_ready()) {
+		LOG_WRN("EEPROM store not ready, using default settings");
 		eeprom_available = false;
 		load_defaults();
 		return 0;
 	}
 
-	ret = eeprom_read_settings();
+	ret = -ENOENT;
+	if (kv_store_has(KV_KEY_SETTINGS)) {
+		ret = kv_read_settings();
+		if (ret < 0) {
+			LOG_ERR("Failed to read settings: %d", ret);
+		}
+	}
+
 	if (ret < 0) {
-		LOG_ERR("Failed to read settings: %d", ret);
-		eeprom_available = false;
-		load_defaults();
-		return 0;
+		/*
+		 * First boot on the KV layout, or the record is unreadable:
+		 * the legacy block is never erased, so migrate it (again)
+		 * rather than fall back to defaults.
+		 */
+		ret = eeprom_read_legacy();
+		if (ret < 0) {
+			LOG_ERR("Failed to read legacy settings: %d", ret);
+			settings.magic = 0;
+		}
+		from_legacy = true;
 	}
 
 	if (settings.magic != E310_SETTINGS_MAGIC) {
@@ -188,7 +341,7 @@ int e310_settings_init(void)
 		settings.rgb_brightness = E310_DEFAULT_RGB_BRIGHTNESS;
 		settings.version = E310_SETTINGS_VERSION;
 		update_crc();
-		ret = eeprom_write_verified();
+		ret = kv_write_settings_verified();
 		if (ret < 0) {
 			LOG_ERR("Migration write failed: %d", ret);
 			eeprom_available = false;
@@ -206,8 +359,17 @@ int e310_settings_init(void)
 			load_defaults();
 			return 0;
 		}
+	} else if (from_legacy) {
+		ret = kv_write_settings_verified();
+		if (ret < 0) {
+			LOG_ERR("Migration write failed: %d", ret);
+			eeprom_available = false;
+			return 0;
+		}
+		LOG_INF("Settings migrated from legacy EEPROM block");
 	}
 
+	stored = settings;
 	eeprom_available = true;
 	LOG_INF("E310 settings loaded: RF=%d dBm, Ant=0x%02x, Freq=%d/%d-%d, InvTime=%d, Speed=%d",
 		settings.rf_power, settings.antenna_config,
@@ -223,45 +385,72 @@ const e310_settings_t *e310_settings_get(void)
 }
 
 int e310_settings_save(void)
+{
+	if (!eeprom_available) {
+		LOG_WRN("EEPROM not available, settings in RAM only");
+		return 0;
+	}
+
+	set_bytes(0, NULL, sizeof(e310_settings_t));
+	LOG_DBG("Settings queued for EEPROM");
+	return 0;
+}
+
+int e310_settings_flush(void)
 {
 	int ret;
 
 	if (!eeprom_available) {
-		LOG_WRN("EEPROM not available, settings in RAM only");
 		return 0;
 	}
 
-	settings.flags |= E310_FLAG_SETTINGS_CHANGED;
-	update_crc();
+	k_work_cancel_delayable(&flush_work);
+
+	atomic_set(&flush_result, 0);
+	k_sem_reset(&flush_sem);
+	atomic_set(&flush_waiting, 1);
+
+	k_mutex_lock(&io_lock, K_FOREVER);
+	ret = write_settings();
+	k_mutex_unlock(&io_lock);
+
+	if (ret == 0 && atomic_get(&inflight) > 0 &&
+	    k_sem_take(&flush_sem, K_MSEC(E310_SETTINGS_FLUSH_TIMEOUT_MS)) != 0) {
+		ret = -ETIMEDOUT;
+	}
+	atomic_set(&flush_waiting, 0);
+
+	if (ret == 0) {
+		ret = (int)atomic_get(&flush_result);
+	}
 
-	ret = eeprom_write_verified();
 	if (ret < 0) {
-		LOG_ERR("Failed to save settings: %d", ret);
-		return ret;
+		LOG_ERR("Failed to flush settings: %d", ret);
+		k_work_reschedule(&flush_work, K_MSEC(E310_SETTINGS_WB_DELAY_MS));
 	}
 
-	LOG_DBG("Settings saved to EEPROM");
-	return 0;
+	return ret;
+}
+
+uint32_t e310_settings_pending(void)
+{
+	return (uint32_t)atomic_get(&dirty) + (uint32_t)atomic_get(&inflight);
 }
 
 int e310_settings_reset(void)
 {
-	int ret;
+	k_spinlock_key_t key;
 
+	key = k_spin_lock(&settings_lock);
 	load_defaults();
+	k_spin_unlock(&settings_lock, key);
 
 	if (!eeprom_available) {
 		LOG_WRN("EEPROM not available, settings reset in RAM only");
 		return 0;
 	}
 
-	update_crc();
-	ret = eeprom_write_verified();
-	if (ret < 0) {
-		LOG_ERR("Failed to reset settings: %d", ret);
-		return ret;
-	}
-
+	set_bytes(0, NULL, sizeof(e310_settings_t));
 	LOG_INF("E310 settings reset to defaults");
 	return 0;
 }
@@ -277,8 +466,8 @@ int e310_settings_set_rf_power(uint8_t power)
 		return -EINVAL;
 	}
 
-	settings.rf_power = power;
-	return e310_settings_save();
+	SET_FIELD(rf_power, power);
+	return 0;
 }
 
 uint8_t e310_settings_get_rf_power(void)
@@ -288,8 +477,8 @@ uint8_t e310_settings_get_rf_power(void)
 
 int e310_settings_set_antenna(uint8_t config)
 {
-	settings.antenna_config = config;
-	return e310_settings_save();
+	SET_FIELD(antenna_config, config);
+	return 0;
 }
 
 uint8_t e310_settings_get_antenna(void)
@@ -306,10 +495,11 @@ int e310_settings_set_frequency(uint8_t region, uint8_t start, uint8_t end)
 		return -EINVAL;
 	}
 
-	settings.freq_region = region;
-	settings.freq_start = start;
-	settings.freq_end = end;
-	return e310_settings_save();
+	/* freq_region, freq_start and freq_end are adjacent: one update */
+	uint8_t freq[] = { region, start, end };
+
+	set_bytes(offsetof(e310_settings_t, freq_region), freq, sizeof(freq));
+	return 0;
 }
 
 void e310_settings_get_frequency(uint8_t *region, uint8_t *start, uint8_t *end)
@@ -331,8 +521,8 @@ int e310_settings_set_inventory_time(uint8_t time)
 		return -EINVAL;
 	}
 
-	settings.inventory_time = time;
-	return e310_settings_save();
+	SET_FIELD(inventory_time, time);
+	return 0;
 }
 
 uint8_t e310_settings_get_inventory_time(void)
@@ -342,8 +532,8 @@ uint8_t e310_settings_get_inventory_time(void)
 
 int e310_settings_set_reader_addr(uint8_t addr)
 {
-	settings.reader_addr = addr;
-	return e310_settings_save();
+	SET_FIELD(reader_addr, addr);
+	return 0;
 }
 
 uint8_t e310_settings_get_reader_addr(void)
@@ -357,8 +547,8 @@ int e310_settings_set_typing_speed(uint16_t cpm)
 		return -EINVAL;
 	}
 
-	settings.typing_speed = cpm;
-	return e310_settings_save();
+	SET_FIELD(typing_speed, cpm);
+	return 0;
 }
 
 uint16_t e310_settings_get_typing_speed(void)
@@ -372,8 +562,8 @@ int e310_settings_set_beep_pulse(uint16_t ms)
 		return -EINVAL;
 	}
 
-	settings.beep_pulse_ms = ms;
-	return e310_settings_save();
+	SET_FIELD(beep_pulse_ms, ms);
+	return 0;
 }
 
 uint16_t e310_settings_get_beep_pulse(void)
@@ -387,8 +577,8 @@ int e310_settings_set_beep_filter(uint16_t ms)
 		return -EINVAL;
 	}
 
-	settings.beep_filter_ms = ms;
-	return e310_settings_save();
+	SET_FIELD(beep_filter_ms, ms);
+	return 0;
 }
 
 uint16_t e310_settings_get_beep_filter(void)
@@ -402,8 +592,8 @@ int e310_settings_set_epc_debounce(uint8_t sec)
 		return -EINVAL;
 	}
 
-	settings.epc_debounce_sec = sec;
-	return e310_settings_save();
+	SET_FIELD(epc_debounce_sec, sec);
+	return 0;
 }
 
 uint8_t e310_settings_get_epc_debounce(void)
@@ -417,8 +607,8 @@ int e310_settings_set_inventory_interval(uint16_t ms)
 		return -EINVAL;
 	}
 
-	settings.inventory_interval_ms = ms;
-	return e310_settings_save();
+	SET_FIELD(inventory_interval_ms, ms);
+	return 0;
 }
 
 uint16_t e310_settings_get_inventory_interval(void)
@@ -432,8 +622,8 @@ int e310_settings_set_rgb_brightness(uint8_t percent)
 		return -EINVAL;
 	}
 
-	settings.rgb_brightness = percent;
-	return e310_settings_save();
+	SET_FIELD(rgb_brightness, percent);
+	return 0;
 }
 
 uint8_t e310_settings_get_rgb_brightness(void)
@@ -481,6 +671,9 @@ void e310_settings_print(const struct shell *sh)
 		shell_print(sh, "  RGB Bright:   %d %%", settings.rgb_brightness);
 		shell_print(sh, "  Changed:      %s",
 			    (settings.flags & E310_FLAG_SETTINGS_CHANGED) ? "Yes" : "No");
+		shell_print(sh, "  Write-behind: %s (%u writes, %u verify errors)",
+			    e310_settings_pending() ? "pending" : "idle",
+			    wb_writes, wb_verify_errors);
 	} else {
 		LOG_INF("E310 Settings: RF=%d dBm, Ant=0x%02x, Freq=%s/%d-%d, Inv=%d, Speed=%d",
 			settings.rf_power, settings.antenna_config,
@@ -4,7 +4,9 @@
  * E310 RFID Reader Settings - Persistent Storage
  *
  * Stores E310 configuration in EEPROM for persistence across power cycles.
- * Uses M24C64 EEPROM at offset 0x0030 (after password_storage area).
+ * The struct lives in the EEPROM key/value store (kv_store.h) as a
+ * single record; the fixed block at 0x0030 is only read to migrate
+ * settings written by older firmware, or if that record is unreadable.
  */
 
 #ifndef E310_SETTINGS_H
@@ -22,14 +24,21 @@ extern "C" {
 #endif
 
 /*
- * EEPROM Layout:
- * 0x0000-0x002F: Password Storage (48 bytes) - DO NOT TOUCH
+ * Legacy EEPROM Layout (before the key/value store):
+ * 0x0000-0x002F: Password Storage (48 bytes)
  * 0x0030-0x005F: E310 Settings (48 bytes)
- * 0x0060-0x1FFF: Reserved for future use
  */
 #define E310_SETTINGS_EEPROM_OFFSET  0x0030
 #define E310_SETTINGS_EEPROM_SIZE    48      /* EEPROM allocation (page-aligned) */
 
+/*
+ * Write-behind: setters mark the settings dirty and return at once.
+ * Changes within WB_DELAY_MS are coalesced into one append, read back
+ * by the EEPROM I/O thread once its write cycle is over.
+ */
+#define E310_SETTINGS_WB_DELAY_MS    500
+#define E310_SETTINGS_FLUSH_TIMEOUT_MS 1000
+
 /* Magic number: "E310" in little-endian */
 #define E310_SETTINGS_MAGIC          0x30313345
 #define E310_SETTINGS_VERSION        0x04
@@ -131,16 +140,39 @@ int e310_settings_init(void);
 const e310_settings_t *e310_settings_get(void);
 
 /**
- * @brief Save current settings to EEPROM
+ * @brief Queue current settings for write-behind to EEPROM
  *
- * @return 0 on success, negative error code on failure
+ * Marks the settings dirty; the write happens from the system
+ * workqueue. Use e310_settings_flush() when it must be on the chip now.
+ *
+ * @return 0 (the write itself is not waited for)
  */
 int e310_settings_save(void);
 
+/**
+ * @brief Write pending settings to EEPROM and verify them now
+ *
+ * Call before a reset or power-down. Sleeps until the EEPROM I/O thread
+ * has written and read back the pending update (at most
+ * E310_SETTINGS_FLUSH_TIMEOUT_MS).
+ *
+ * @return 0 on success (or nothing pending), negative error code on
+ *         failure (the write-behind retry is rescheduled)
+ */
+int e310_settings_flush(void);
+
+/**
+ * @brief Get settings updates not yet written or not yet verified
+ *
+ * @return Number of pending writes and read-backs, 0 when EEPROM is up
+ *         to date
+ */
+uint32_t e310_settings_pending(void);
+
 /**
  * @brief Reset settings to factory defaults
  *
- * Resets all settings to default values and saves to EEPROM.
+ * Resets all settings to default values and queues them for EEPROM.
  *
  * @return 0 on success, negative error code on failure
  */
@@ -154,7 +186,9 @@ int e310_settings_reset(void);
 bool e310_settings_is_available(void);
 
 /*
- * Individual setting accessors with automatic save
+ * Individual setting accessors with automatic write-behind save.
+ * "Save" below means the change is queued; see
+ * e310_settings_flush().
  */
 
 /**
@@ -0,0 +1,242 @@
+/**
+ * @file eeprom_async.c
+ * @brief Asynchronous M24C64 EEPROM Access Implementation
+ *
+ * Talks to the M24C64 directly on its I2C bus (16-bit word address,
+ * 32-byte pages) rather than through the blocking EEPROM driver API, so
+ * that write-cycle completion can be ACK-polled.
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#include "eeprom_async.h"
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+#include <errno.h>
+
+LOG_MODULE_REGISTER(eeprom_async, LOG_LEVEL_INF);
+
+#define EEPROM_NODE       DT_ALIAS(eeprom_0)
+#define EEPROM_SIZE       DT_PROP(EEPROM_NODE, size)
+#define EEPROM_PAGE_SIZE  DT_PROP(EEPROM_NODE, pagesize)
+#define EEPROM_ADDR       DT_REG_ADDR(EEPROM_NODE)
+
+#define IO_STACK_SIZE     1024
+#define IO_PRIORITY       K_PRIO_PREEMPT(10)
+
+BUILD_ASSERT(DT_PROP(EEPROM_NODE, address_width) == 16,
+	     "eeprom_async sends 16-bit word addresses");
+
+enum eeprom_op {
+	EEPROM_OP_READ,
+	EEPROM_OP_WRITE,
+};
+
+struct eeprom_req {
+	uint8_t op;
+	uint16_t offset;
+	uint16_t len;
+	void *buf;
+	eeprom_async_cb_t cb;
+	void *user_data;
+};
+
+K_MSGQ_DEFINE(eeprom_q, sizeof(struct eeprom_req), EEPROM_ASYNC_QUEUE_DEPTH, 4);
+
+static const struct device *const i2c_dev = DEVICE_DT_GET(DT_BUS(EEPROM_NODE));
+
+/* ========================================================================
+ * Bus Operations (EEPROM I/O thread only)
+ * ======================================================================== */
+
+/**
+ * @brief Run @p xfer until the chip ACKs or the ready timeout expires
+ *
+ * While programming, the M24C64 NACKs its address and the transfer
+ * fails with -EIO; that is the ACK-polling signal to retry.
+ */
+static int with_ack_poll(int (*xfer)(const struct eeprom_req *, uint16_t, size_t),
+			 const struct eeprom_req *req, uint16_t off, size_t len)
+{
+	int64_t deadline = k_uptime_get() + EEPROM_ASYNC_READY_TIMEOUT_MS;
+	int ret;
+
+	while (true) {
+		ret = xfer(req, off, len);
+		if (ret != -EIO || k_uptime_get() >= deadline) {
+			return ret;
+		}
+		k_usleep(EEPROM_ASYNC_POLL_US);
+	}
+}
+
+static int xfer_read(const struct eeprom_req *req, uint16_t off, size_t len)
+{
+	uint8_t addr[2];
+
+	sys_put_be16(off, addr);
+	return i2c_write_read(i2c_dev, EEPROM_ADDR, addr, sizeof(addr),
+			      (uint8_t *)req->buf + (off - req->offset), len);
+}
+
+static int xfer_write(const struct eeprom_req *req, uint16_t off, size_t len)
+{
+	uint8_t tx[2 + EEPROM_PAGE_SIZE];
+
+	sys_put_be16(off, tx);
+	memcpy(&tx[2], (const uint8_t *)req->buf + (off - req->offset), len);
+	return i2c_write(i2c_dev, tx, 2 + len, EEPROM_ADDR);
+}
+
+/** Address-only write: ACKed once the internal write cycle is over */
+static int xfer_probe(const struct eeprom_req *req, uint16_t off, size_t len)
+{
+	uint8_t addr[2];
+
+	ARG_UNUSED(req);
+	ARG_UNUSED(len);
+	sys_put_be16(off, addr);
+	return i2c_write(i2c_dev, addr, sizeof(addr), EEPROM_ADDR);
+}
+
+static int do_write(const struct eeprom_req *req)
+{
+	uint16_t off = req->offset;
+	size_t left = req->len;
+
+	while (left > 0) {
+		size_t chunk = MIN(left, EEPROM_PAGE_SIZE - (off % EEPROM_PAGE_SIZE));
+		int ret;
+
+		/* A previous write cycle may still be running: poll it out */
+		ret = with_ack_poll(xfer_write, req, off, chunk);
+		if (ret < 0) {
+			return ret;
+		}
+
+		ret = with_ack_poll(xfer_probe, req, off, 0);
+		if (ret < 0) {
+			LOG_ERR("Write cycle at 0x%04x did not finish: %d", off, ret);
+			return -ETIMEDOUT;
+		}
+
+		off += chunk;
+		left -= chunk;
+	}
+
+	return 0;
+}
+
+static void eeprom_io_thread(void *p1, void *p2, void *p3)
+{
+	struct eeprom_req req;
+	int ret;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		k_msgq_get(&eeprom_q, &req, K_FOREVER);
+
+		if (req.op == EEPROM_OP_READ) {
+			ret = with_ack_poll(xfer_read, &req, req.offset, req.len);
+		} else {
+			ret = do_write(&req);
+		}
+
+		if (ret < 0) {
+			LOG_ERR("EEPROM %s 0x%04x+%u failed: %d",
+				req.op == EEPROM_OP_READ ? "read" : "write",
+				req.offset, req.len, ret);
+		}
+
+		if (req.cb) {
+			req.cb(ret, req.user_data);
+		}
+	}
+}
+
+K_THREAD_DEFINE(eeprom_io, IO_STACK_SIZE, eeprom_io_thread, NULL, NULL, NULL,
+		IO_PRIORITY, 0, 0);
+
+/* ========================================================================
+ * Public API
+ * ======================================================================== */
+
+static int submit(uint8_t op, uint16_t offset, void *buf, size_t len,
+		  eeprom_async_cb_t cb, void *user_data)
+{
+	struct eeprom_req req = {
+		.op = op,
+		.offset = offset,
+		.len = len,
+		.buf = buf,
+		.cb = cb,
+		.user_data = user_data,
+	};
+
+	if (len == 0 || (size_t)offset + len > EEPROM_SIZE) {
+		return -EINVAL;
+	}
+
+	if (k_msgq_put(&eeprom_q, &req, K_NO_WAIT) != 0) {
+		LOG_WRN("EEPROM request queue full");
+		return -EAGAIN;
+	}
+
+	return 0;
+}
+
+int eeprom_async_read(uint16_t offset, void *buf, size_t len,
+		      eeprom_async_cb_t cb, void *user_data)
+{
+	return submit(EEPROM_OP_READ, offset, buf, len, cb, user_data);
+}
+
+int eeprom_async_write(uint16_t offset, const void *data, size_t len,
+		       eeprom_async_cb_t cb, void *user_data)
+{
+	return submit(EEPROM_OP_WRITE, offset, (void *)data, len, cb, user_data);
+}
+
+struct sync_wait {
+	struct k_sem done;
+	int result;
+};
+
+static void sync_done(int result, void *user_data)
+{
+	struct sync_wait *w = user_data;
+
+	w->result = result;
+	k_sem_give(&w->done);
+}
+
+int eeprom_async_read_sync(uint16_t offset, void *buf, size_t len)
+{
+	struct sync_wait w;
+	int ret;
+
+	k_sem_init(&w.done, 0, 1);
+
+	/* Retry while the queue is momentarily full */
+	while ((ret = eeprom_async_read(offset, buf, len, sync_done, &w)) == -EAGAIN) {
+		k_msleep(1);
+	}
+	if (ret < 0) {
+		return ret;
+	}
+
+	k_sem_take(&w.done, K_FOREVER);
+	return w.result;
+}
+
+bool eeprom_async_is_ready(void)
+{
+	return device_is_ready(i2c_dev);
+}
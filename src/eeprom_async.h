@@ -0,0 +1,105 @@
+/**
+ * @file eeprom_async.h
+ * @brief Asynchronous M24C64 EEPROM Access on I2C4
+ *
+ * Requests are queued to a dedicated EEPROM I/O thread that owns the
+ * I2C4 transfers, so the shell, main loop and system workqueue never
+ * wait on the 400 kHz bus or on the EEPROM write cycle. Requests run
+ * in submission order; a read queued after a write sees the new data.
+ *
+ * Write-cycle completion is detected by ACK polling (the M24C64 NACKs
+ * its address while programming) instead of a fixed 5 ms sleep, and a
+ * write's callback only runs once the chip is ready again, so a
+ * read-back queued behind it is valid.
+ *
+ * Callbacks run on the EEPROM I/O thread: keep them short and never
+ * call a *_sync() function from one.
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#ifndef EEPROM_ASYNC_H_
+#define EEPROM_ASYNC_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup eeprom_async Async EEPROM
+ * @{
+ */
+
+/** Queued requests (submissions beyond this fail with -EAGAIN) */
+#define EEPROM_ASYNC_QUEUE_DEPTH     16
+
+/** Give up ACK polling after this long (M24C64 tW max is 5 ms) */
+#define EEPROM_ASYNC_READY_TIMEOUT_MS 10
+
+/** Delay between ACK polls */
+#define EEPROM_ASYNC_POLL_US          200
+
+/**
+ * @brief Completion callback
+ *
+ * @param result 0 on success, negative errno on failure
+ * @param user_data Pointer passed at submission
+ */
+typedef void (*eeprom_async_cb_t)(int result, void *user_data);
+
+/**
+ * @brief Queue a read
+ *
+ * @param offset EEPROM byte offset
+ * @param buf Destination, must stay valid until the callback
+ * @param len Bytes to read
+ * @param cb Completion callback (may be NULL)
+ * @param user_data Passed to @p cb
+ * @return 0 if queued, -EINVAL on bad range, -EAGAIN if the queue is full
+ */
+int eeprom_async_read(uint16_t offset, void *buf, size_t len,
+		      eeprom_async_cb_t cb, void *user_data);
+
+/**
+ * @brief Queue a write
+ *
+ * Split at page boundaries; each page is ACK-polled to completion.
+ *
+ * @param offset EEPROM byte offset
+ * @param data Source, must stay valid until the callback
+ * @param len Bytes to write
+ * @param cb Completion callback (may be NULL)
+ * @param user_data Passed to @p cb
+ * @return 0 if queued, -EINVAL on bad range, -EAGAIN if the queue is full
+ */
+int eeprom_async_write(uint16_t offset, const void *data, size_t len,
+		       eeprom_async_cb_t cb, void *user_data);
+
+/**
+ * @brief Read and wait for the result (boot and shell paths only)
+ *
+ * The caller sleeps on a semaphore; the bus work is still done by the
+ * EEPROM I/O thread.
+ *
+ * @return 0 on success, negative errno on failure
+ */
+int eeprom_async_read_sync(uint16_t offset, void *buf, size_t len);
+
+/**
+ * @brief Check if the EEPROM bus is ready
+ *
+ * @return true if I2C4 is ready
+ */
+bool eeprom_async_is_ready(void);
+
+/** @} */ /* End of eeprom_async group */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EEPROM_ASYNC_H_ */
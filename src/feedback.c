@@ -0,0 +1,205 @@
+/**
+ * @file feedback.c
+ * @brief Coalesced Operator Feedback Implementation
+ *
+ * One k_timer, three states:
+ *
+ *   IDLE   no window open; the next request fires immediately
+ *   PULSE  beeper on; expiry turns it off and waits out the window
+ *   HOLD   window open, beeper off; expiry fires what was requested
+ *          meanwhile (and opens a new window) or goes IDLE
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#include "feedback.h"
+#include "beep_control.h"
+#include "rgb_led.h"
+#include "runtime_config.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/spinlock.h>
+
+LOG_MODULE_REGISTER(feedback, LOG_LEVEL_INF);
+
+enum feedback_state {
+	FB_IDLE,
+	FB_PULSE,
+	FB_HOLD,
+};
+
+static struct k_timer fb_timer;
+static struct k_spinlock fb_lock;
+static enum feedback_state fb_state;
+static uint32_t fb_pending;         /* FEEDBACK_* asked for during the window */
+static uint32_t fb_hold_ms;         /* Window left once the pulse ends */
+static feedback_stats_t fb_stats;
+static bool fb_ready;
+
+/**
+ * @brief Start an event and its window (fb_lock held)
+ *
+ * @return FEEDBACK_LED if the caller must blink the LED after unlocking
+ */
+static uint32_t fire_locked(uint32_t what)
+{
+	runtime_config_t cfg;
+	uint32_t pulse_ms;
+
+	runtime_config_get(&cfg);
+	pulse_ms = MIN(cfg.beep_pulse_ms, cfg.beep_filter_ms);
+	fb_stats.events++;
+
+	if (what & FEEDBACK_BEEP) {
+		beep_control_set_output(true);
+		fb_state = FB_PULSE;
+		fb_hold_ms = cfg.beep_filter_ms - pulse_ms;
+		k_timer_start(&fb_timer, K_MSEC(pulse_ms), K_NO_WAIT);
+	} else {
+		fb_state = FB_HOLD;
+		k_timer_start(&fb_timer, K_MSEC(cfg.beep_filter_ms), K_NO_WAIT);
+	}
+
+	return what & FEEDBACK_LED;
+}
+
+/* The LED module only marks itself dirty here; main does the refresh */
+static void blink(uint32_t led)
+{
+	if (led) {
+		rgb_led_notify_tag_read();
+	}
+}
+
+static void fb_timer_expiry(struct k_timer *timer)
+{
+	k_spinlock_key_t key = k_spin_lock(&fb_lock);
+	uint32_t led = 0;
+
+	ARG_UNUSED(timer);
+
+	if (fb_state == FB_PULSE) {
+		beep_control_set_output(false);
+		fb_state = FB_HOLD;
+		if (fb_hold_ms > 0) {
+			k_timer_start(&fb_timer, K_MSEC(fb_hold_ms), K_NO_WAIT);
+			k_spin_unlock(&fb_lock, key);
+			return;
+		}
+	}
+
+	if (fb_pending != 0) {
+		led = fire_locked(fb_pending);
+		fb_pending = 0;
+	} else {
+		fb_state = FB_IDLE;
+	}
+
+	k_spin_unlock(&fb_lock, key);
+	blink(led);
+}
+
+int feedback_init(void)
+{
+	k_timer_init(&fb_timer, fb_timer_expiry, NULL);
+	fb_state = FB_IDLE;
+	fb_ready = true;
+
+	LOG_INF("Feedback coalescer ready (window = beep filter)");
+	return 0;
+}
+
+void feedback_request(uint32_t what)
+{
+	k_spinlock_key_t key;
+	uint32_t led = 0;
+
+	if (!fb_ready) {
+		return;
+	}
+
+	key = k_spin_lock(&fb_lock);
+	fb_stats.requests++;
+	if (fb_state == FB_IDLE) {
+		led = fire_locked(what);
+	} else {
+		fb_pending |= what;
+		fb_stats.coalesced++;
+	}
+	k_spin_unlock(&fb_lock, key);
+
+	blink(led);
+}
+
+void feedback_request_now(uint32_t what)
+{
+	k_spinlock_key_t key;
+	uint32_t led;
+
+	if (!fb_ready) {
+		return;
+	}
+
+	key = k_spin_lock(&fb_lock);
+	fb_stats.requests++;
+	fb_pending = 0;
+	led = fire_locked(what);
+	k_spin_unlock(&fb_lock, key);
+
+	blink(led);
+}
+
+void feedback_get_stats(feedback_stats_t *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&fb_lock);
+
+	*stats = fb_stats;
+	k_spin_unlock(&fb_lock, key);
+}
+
+/* ========================================================================
+ * Shell Commands
+ * ======================================================================== */
+
+static int cmd_feedback_status(const struct shell *sh, size_t argc, char **argv)
+{
+	feedback_stats_t st;
+	runtime_config_t cfg;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	feedback_get_stats(&st);
+	runtime_config_get(&cfg);
+
+	shell_print(sh, "=== Feedback ===");
+	shell_print(sh, "Window: %u ms, beep pulse: %u ms", cfg.beep_filter_ms,
+		    cfg.beep_pulse_ms);
+	shell_print(sh, "Requests:  %u", st.requests);
+	shell_print(sh, "Events:    %u", st.events);
+	shell_print(sh, "Coalesced: %u", st.coalesced);
+	return 0;
+}
+
+static int cmd_feedback_reset(const struct shell *sh, size_t argc, char **argv)
+{
+	k_spinlock_key_t key = k_spin_lock(&fb_lock);
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	fb_stats = (feedback_stats_t){ 0 };
+	k_spin_unlock(&fb_lock, key);
+
+	shell_print(sh, "Feedback counters cleared");
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_feedback,
+	SHELL_CMD(status, NULL, "Requests, events and coalesced counts", cmd_feedback_status),
+	SHELL_CMD(reset, NULL, "Clear the counters", cmd_feedback_reset),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(feedback, &sub_feedback, "Coalesced beeper/LED feedback", NULL);
@@ -0,0 +1,96 @@
+/**
+ * @file feedback.h
+ * @brief Coalesced Operator Feedback (beeper and RGB LED)
+ *
+ * Tag reads, E310 beep edges and beeper tests all come through here and
+ * leave as at most one feedback event per window: the first request
+ * fires at once and opens the window; anything that arrives while it is
+ * open is counted as coalesced and fires once more when it closes. The
+ * window is the beeper filter time (`beep filter`, beep_filter_ms).
+ *
+ * Everything runs off a single k_timer: it ends the beeper pulse and then
+ * the window, in ISR context. Nothing is queued on the system workqueue,
+ * whatever the tag rate.
+ *
+ * All request functions are ISR-safe.
+ *
+ * Shell:
+ *   feedback status    requests, events fired and coalesced
+ *   feedback reset     clear the counters
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#ifndef FEEDBACK_H_
+#define FEEDBACK_H_
+
+#include <zephyr/sys/util.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup feedback Operator Feedback
+ * @{
+ */
+
+/** What a feedback request asks for */
+#define FEEDBACK_BEEP   BIT(0)  /**< Beeper pulse */
+#define FEEDBACK_LED    BIT(1)  /**< RGB LED tag blink */
+
+/**
+ * @brief Feedback counters
+ */
+typedef struct {
+	uint32_t requests;      /**< feedback_request() calls */
+	uint32_t events;        /**< Feedback events fired */
+	uint32_t coalesced;     /**< Requests folded into a later event */
+} feedback_stats_t;
+
+/**
+ * @brief Set up the feedback timer
+ *
+ * Call after beep_control_init() and rgb_led_init().
+ *
+ * @return 0 on success
+ */
+int feedback_init(void);
+
+/**
+ * @brief Ask for feedback (coalesced per window)
+ *
+ * @param what FEEDBACK_BEEP and/or FEEDBACK_LED
+ */
+void feedback_request(uint32_t what);
+
+/**
+ * @brief Fire feedback now, restarting the window (beeper test)
+ *
+ * @param what FEEDBACK_BEEP and/or FEEDBACK_LED
+ */
+void feedback_request_now(uint32_t what);
+
+/**
+ * @brief Feedback for one delivered tag read (beeper and LED)
+ */
+static inline void feedback_tag_read(void)
+{
+	feedback_request(FEEDBACK_BEEP | FEEDBACK_LED);
+}
+
+/**
+ * @brief Read the counters
+ *
+ * @param stats Output
+ */
+void feedback_get_stats(feedback_stats_t *stats);
+
+/** @} */ /* End of feedback group */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FEEDBACK_H_ */
@@ -0,0 +1,197 @@
+/**
+ * @file frame_trace.c
+ * @brief Binary Raw-Frame Trace Ring Implementation
+ *
+ * Records are laid out back to back in a byte ring:
+ *   [frame_trace_hdr_t][data ...][frame_trace_hdr_t][data ...]
+ * head/tail are free-running byte indices; (head - tail) is the fill level.
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#include "frame_trace.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+#include <errno.h>
+
+BUILD_ASSERT((FRAME_TRACE_BUF_SIZE & (FRAME_TRACE_BUF_SIZE - 1)) == 0,
+	     "FRAME_TRACE_BUF_SIZE must be a power of two");
+BUILD_ASSERT(FRAME_TRACE_BUF_SIZE >=
+	     4 * (sizeof(frame_trace_hdr_t) + FRAME_TRACE_MAX_DATA),
+	     "FRAME_TRACE_BUF_SIZE too small for max-size records");
+
+#define RING_MASK (FRAME_TRACE_BUF_SIZE - 1)
+
+static uint8_t trace_buf[FRAME_TRACE_BUF_SIZE];
+static uint32_t trace_head;
+static uint32_t trace_tail;
+static uint32_t trace_count;
+static struct k_spinlock trace_lock;
+
+static bool trace_enabled = true;
+static bool trace_paused;
+
+static uint32_t stat_recorded;
+static uint32_t stat_dropped;
+static uint32_t stat_skipped;
+
+/* ========================================================================
+ * Ring Helpers (caller holds trace_lock)
+ * ======================================================================== */
+
+static void ring_write(uint32_t pos, const void *src, size_t len)
+{
+	uint32_t off = pos & RING_MASK;
+	size_t first = MIN(len, FRAME_TRACE_BUF_SIZE - off);
+
+	memcpy(&trace_buf[off], src, first);
+	if (len > first) {
+		memcpy(trace_buf, (const uint8_t *)src + first, len - first);
+	}
+}
+
+static void ring_read(uint32_t pos, void *dst, size_t len)
+{
+	uint32_t off = pos & RING_MASK;
+	size_t first = MIN(len, FRAME_TRACE_BUF_SIZE - off);
+
+	memcpy(dst, &trace_buf[off], first);
+	if (len > first) {
+		memcpy((uint8_t *)dst + first, trace_buf, len - first);
+	}
+}
+
+static void ring_drop_oldest(void)
+{
+	frame_trace_hdr_t hdr;
+
+	ring_read(trace_tail, &hdr, sizeof(hdr));
+	trace_tail += sizeof(hdr) + hdr.len;
+	trace_count--;
+	stat_dropped++;
+}
+
+/* ========================================================================
+ * API Functions
+ * ======================================================================== */
+
+void frame_trace_record(frame_trace_dir_t dir, uint8_t flags,
+			const uint8_t *data, size_t len)
+{
+	frame_trace_hdr_t hdr;
+
+	if (len > FRAME_TRACE_MAX_DATA) {
+		len = FRAME_TRACE_MAX_DATA;
+		flags |= FRAME_TRACE_FLAG_TRUNCATED;
+	}
+
+	hdr.timestamp_us = (uint32_t)k_ticks_to_us_floor64(k_uptime_ticks());
+	hdr.dir = (uint8_t)dir;
+	hdr.flags = flags;
+	hdr.len = (uint16_t)len;
+
+	size_t need = sizeof(hdr) + len;
+	k_spinlock_key_t key = k_spin_lock(&trace_lock);
+
+	if (!trace_enabled || trace_paused) {
+		stat_skipped++;
+		k_spin_unlock(&trace_lock, key);
+		return;
+	}
+
+	while (FRAME_TRACE_BUF_SIZE - (trace_head - trace_tail) < need) {
+		ring_drop_oldest();
+	}
+
+	ring_write(trace_head, &hdr, sizeof(hdr));
+	ring_write(trace_head + sizeof(hdr), data, len);
+	trace_head += need;
+	trace_count++;
+	stat_recorded++;
+
+	k_spin_unlock(&trace_lock, key);
+}
+
+void frame_trace_set_enabled(bool enable)
+{
+	k_spinlock_key_t key = k_spin_lock(&trace_lock);
+
+	trace_enabled = enable;
+	k_spin_unlock(&trace_lock, key);
+}
+
+bool frame_trace_is_enabled(void)
+{
+	return trace_enabled;
+}
+
+void frame_trace_clear(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&trace_lock);
+
+	trace_head = 0;
+	trace_tail = 0;
+	trace_count = 0;
+	stat_recorded = 0;
+	stat_dropped = 0;
+	stat_skipped = 0;
+	k_spin_unlock(&trace_lock, key);
+}
+
+void frame_trace_get_stats(frame_trace_stats_t *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&trace_lock);
+
+	stats->recorded = stat_recorded;
+	stats->dropped = stat_dropped;
+	stats->skipped = stat_skipped;
+	stats->used_bytes = trace_head - trace_tail;
+	stats->records = trace_count;
+	stats->enabled = trace_enabled;
+	k_spin_unlock(&trace_lock, key);
+}
+
+int frame_trace_foreach(uint32_t skip,
+			void (*fn)(const frame_trace_hdr_t *hdr,
+				   const uint8_t *data, void *user_data),
+			void *user_data)
+{
+	static uint8_t data[FRAME_TRACE_MAX_DATA];
+	frame_trace_hdr_t hdr;
+	uint32_t pos, end;
+	int visited = 0;
+
+	k_spinlock_key_t key = k_spin_lock(&trace_lock);
+
+	if (trace_paused) {
+		/* Another dump is in progress */
+		k_spin_unlock(&trace_lock, key);
+		return -EBUSY;
+	}
+	trace_paused = true;
+	pos = trace_tail;
+	end = trace_head;
+	k_spin_unlock(&trace_lock, key);
+
+	/* Ring is frozen while paused: only this walker touches it */
+	while (pos != end) {
+		ring_read(pos, &hdr, sizeof(hdr));
+		pos += sizeof(hdr);
+
+		if (skip > 0) {
+			skip--;
+		} else {
+			ring_read(pos, data, hdr.len);
+			fn(&hdr, data, user_data);
+			visited++;
+		}
+		pos += hdr.len;
+	}
+
+	key = k_spin_lock(&trace_lock);
+	trace_paused = false;
+	k_spin_unlock(&trace_lock, key);
+
+	return visited;
+}
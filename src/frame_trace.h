@@ -0,0 +1,143 @@
+/**
+ * @file frame_trace.h
+ * @brief Binary Raw-Frame Trace Ring for UART4 (E310) Traffic
+ *
+ * Stores raw RX/TX frames with a timestamp and direction as compact
+ * binary records in RAM. Recording is a memcpy under a spinlock, so it
+ * can stay enabled on the data path without disturbing timing. Records
+ * are decoded later from the shell (`e310 trace dump`).
+ *
+ * When the ring is full the oldest records are dropped.
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#ifndef FRAME_TRACE_H_
+#define FRAME_TRACE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup frame_trace Frame Trace
+ * @{
+ */
+
+/* ========================================================================
+ * Constants
+ * ======================================================================== */
+
+/** Trace ring storage size in bytes (must be a power of two) */
+#define FRAME_TRACE_BUF_SIZE        4096
+
+/** Largest frame payload stored per record (longer frames are truncated) */
+#define FRAME_TRACE_MAX_DATA        256
+
+/* ========================================================================
+ * Data Structures
+ * ======================================================================== */
+
+/** Record direction */
+typedef enum {
+	FRAME_TRACE_RX = 0,         /**< Frame received from E310 (CRC OK) */
+	FRAME_TRACE_RX_CRC_ERR,     /**< Frame received from E310 (CRC error) */
+	FRAME_TRACE_TX,             /**< Frame queued for E310 */
+} frame_trace_dir_t;
+
+/** Record flags */
+#define FRAME_TRACE_FLAG_TRUNCATED  0x01  /**< Payload was truncated */
+#define FRAME_TRACE_FLAG_INVENTORY  0x02  /**< Recorded while inventory active */
+
+/**
+ * @brief Trace record header (followed by @ref len data bytes)
+ */
+typedef struct __attribute__((packed)) {
+	uint32_t timestamp_us;      /**< Uptime in microseconds (wraps ~71 min) */
+	uint8_t  dir;               /**< frame_trace_dir_t */
+	uint8_t  flags;             /**< FRAME_TRACE_FLAG_* */
+	uint16_t len;               /**< Stored data length */
+} frame_trace_hdr_t;
+
+/**
+ * @brief Trace ring statistics
+ */
+typedef struct {
+	uint32_t recorded;          /**< Records written since last clear */
+	uint32_t dropped;           /**< Oldest records overwritten */
+	uint32_t skipped;           /**< Records not stored (disabled/paused) */
+	uint32_t used_bytes;        /**< Bytes currently held in the ring */
+	uint32_t records;           /**< Records currently held in the ring */
+	bool enabled;               /**< Capture enabled */
+} frame_trace_stats_t;
+
+/* ========================================================================
+ * API Functions
+ * ======================================================================== */
+
+/**
+ * @brief Record a raw frame
+ *
+ * Safe to call from thread or ISR context.
+ *
+ * @param dir Frame direction
+ * @param flags FRAME_TRACE_FLAG_* bits
+ * @param data Frame bytes
+ * @param len Frame length
+ */
+void frame_trace_record(frame_trace_dir_t dir, uint8_t flags,
+			const uint8_t *data, size_t len);
+
+/**
+ * @brief Enable or disable capture
+ *
+ * @param enable true to record frames, false to ignore them
+ */
+void frame_trace_set_enabled(bool enable);
+
+/**
+ * @brief Check if capture is enabled
+ *
+ * @return true if enabled
+ */
+bool frame_trace_is_enabled(void);
+
+/**
+ * @brief Discard all records and reset counters
+ */
+void frame_trace_clear(void);
+
+/**
+ * @brief Get trace statistics
+ *
+ * @param stats Output: statistics structure
+ */
+void frame_trace_get_stats(frame_trace_stats_t *stats);
+
+/**
+ * @brief Visit stored records, oldest first
+ *
+ * Capture is paused while walking so the ring cannot be overwritten
+ * underneath the visitor; frames arriving meanwhile are counted as skipped.
+ *
+ * @param skip Number of oldest records to skip
+ * @param fn Visitor, called once per record with a private copy of the data
+ * @param user_data Passed to @p fn
+ * @return Number of records visited, or -EBUSY if a walk is already running
+ */
+int frame_trace_foreach(uint32_t skip,
+			void (*fn)(const frame_trace_hdr_t *hdr,
+				   const uint8_t *data, void *user_data),
+			void *user_data);
+
+/** @} */ /* End of frame_trace group */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAME_TRACE_H_ */
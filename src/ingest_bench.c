@@ -0,0 +1,521 @@
+/**
+ * @file ingest_bench.c
+ * @brief On-Target Ingest Pipeline Self-Benchmark
+ *
+ * Frames are injected from the shell thread; the router thread consumes
+ * them exactly as it would reader traffic. Each injected tag carries its id in
+ * EPC bytes 0-3, which the HID dry-run sink uses to look up the injection
+ * time for latency.
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#include "ingest_bench.h"
+#include "usb_hid.h"
+#include "sys_monitor.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+LOG_MODULE_REGISTER(ingest_bench, LOG_LEVEL_INF);
+
+/** Injection timestamps kept per tag id (power of 2) */
+#define BENCH_LAT_SLOTS         1024
+
+/** Give up waiting for the backlog after this long */
+#define BENCH_DRAIN_MAX_MS      2000
+
+/** Injection pacing granularity */
+#define BENCH_TICK_MS           1
+
+/** Sweep: start rate, cap, step length and bisection steps */
+#define BENCH_SWEEP_START_FPS   25
+#define BENCH_SWEEP_MAX_FPS     12800
+#define BENCH_SWEEP_STEP_S      2
+#define BENCH_SWEEP_REFINE      3
+
+/** Defaults for omitted shell arguments */
+#define BENCH_DEFAULT_TAGS      8
+#define BENCH_DEFAULT_EPC_LEN   12
+#define BENCH_DEFAULT_SEC       5
+
+static uart_router_t *bench_router;
+static atomic_t bench_busy = ATOMIC_INIT(0);
+
+/*
+ * inject_*: written by the shell thread as frames go in, read by the
+ * dry-run sink on the router thread (a slot already reused fails the id
+ * check). The rest: written by the sink, read once the run has drained.
+ */
+static uint32_t inject_id[BENCH_LAT_SLOTS];
+static uint32_t inject_cyc[BENCH_LAT_SLOTS];
+static uint32_t lat_hist[INGEST_BENCH_LAT_BUCKETS + 1];
+static uint32_t lat_max_us;
+static uint32_t sink_count;
+static uint32_t sink_report_sum;
+
+/* ========================================================================
+ * Frame Generation
+ * ======================================================================== */
+
+static void put_epc(uint8_t *out, uint8_t epc_len, uint32_t id)
+{
+	sys_put_be32(id, out);
+	for (uint8_t i = 4; i < epc_len; i++) {
+		out[i] = (uint8_t)(0xA0 + i);
+	}
+}
+
+static void stamp_tag(uint32_t id, uint32_t cyc)
+{
+	uint32_t slot = id & (BENCH_LAT_SLOTS - 1);
+
+	inject_id[slot] = id;
+	inject_cyc[slot] = cyc;
+}
+
+static size_t finish_frame(uint8_t *frame, size_t total, uint8_t recmd,
+			   uint8_t status)
+{
+	uint16_t crc;
+
+	frame[0] = (uint8_t)(total - 1);
+	frame[1] = E310_ADDR_DEFAULT;
+	frame[2] = recmd;
+	frame[3] = status;
+
+	crc = e310_crc16(frame, total - 2);
+	frame[total - 2] = (uint8_t)(crc & 0xFF);
+	frame[total - 1] = (uint8_t)(crc >> 8);
+	return total;
+}
+
+/**
+ * @brief Build the next benchmark frame
+ *
+ * @return Frame length in bytes
+ */
+static size_t build_frame(uint8_t *frame, const ingest_bench_params_t *p,
+			  uint32_t *seq)
+{
+	uint32_t now = k_cycle_get_32();
+	size_t pos;
+
+	if (p->tags == 0) {
+		/* Auto-upload: Ant | Len | EPC | RSSI */
+		uint32_t id = p->population ? *seq % p->population : *seq;
+
+		(*seq)++;
+		frame[4] = E310_ANT_1;
+		frame[5] = p->epc_len;
+		put_epc(&frame[6], p->epc_len, id);
+		frame[6 + p->epc_len] = 0xC8;
+		stamp_tag(id, now);
+
+		return finish_frame(frame, 4 + 2 + p->epc_len + 1 + 2,
+				    E310_RECMD_AUTO_UPLOAD, E310_STATUS_SUCCESS);
+	}
+
+	/* Tag Inventory: Ant | Num | { LenByte | EPC | RSSI } ... */
+	frame[4] = E310_ANT_1;
+	frame[5] = p->tags;
+	pos = 6;
+	for (uint8_t i = 0; i < p->tags; i++) {
+		uint32_t id = p->population ? *seq % p->population : *seq;
+
+		(*seq)++;
+		frame[pos++] = p->epc_len;
+		put_epc(&frame[pos], p->epc_len, id);
+		pos += p->epc_len;
+		frame[pos++] = 0xC8;
+		stamp_tag(id, now);
+	}
+
+	/* More-data status: the router must not treat it as end of round */
+	return finish_frame(frame, pos + 2, E310_CMD_TAG_INVENTORY,
+			    E310_STATUS_MORE_DATA);
+}
+
+/* ========================================================================
+ * HID Dry-Run Sink
+ * ======================================================================== */
+
+static void bench_hid_sink(const uint8_t *epc, size_t len, uint32_t report_sum)
+{
+	uint8_t id_be[4];
+	uint32_t id, slot, lat;
+
+	sink_count++;
+	sink_report_sum += report_sum;
+
+	if (len < 8 || hex2bin((const char *)epc, 8, id_be, sizeof(id_be)) == 0) {
+		return;
+	}
+
+	id = sys_get_be32(id_be);
+	slot = id & (BENCH_LAT_SLOTS - 1);
+	if (inject_id[slot] != id) {
+		return; /* Slot reused: tag older than the timestamp window */
+	}
+
+	lat = k_cyc_to_us_floor32(k_cycle_get_32() - inject_cyc[slot]);
+	lat_max_us = MAX(lat_max_us, lat);
+	lat_hist[MIN(lat / INGEST_BENCH_LAT_BUCKET_US,
+		     INGEST_BENCH_LAT_BUCKETS)]++;
+}
+
+static uint32_t latency_pct_us(uint32_t pct)
+{
+	uint32_t total = 0, acc = 0;
+
+	for (size_t i = 0; i <= INGEST_BENCH_LAT_BUCKETS; i++) {
+		total += lat_hist[i];
+	}
+	if (total == 0) {
+		return 0;
+	}
+
+	uint32_t target = DIV_ROUND_UP(total * pct, 100);
+
+	for (size_t i = 0; i <= INGEST_BENCH_LAT_BUCKETS; i++) {
+		acc += lat_hist[i];
+		if (acc >= target) {
+			/* Upper edge of the bucket, clamped to the observed max */
+			return MIN((i + 1) * INGEST_BENCH_LAT_BUCKET_US, lat_max_us);
+		}
+	}
+	return lat_max_us;
+}
+
+/* ========================================================================
+ * CPU Usage
+ * ======================================================================== */
+
+struct cpu_sample {
+	uint64_t busy;
+	uint64_t total;
+};
+
+static void cpu_sample(struct cpu_sample *s)
+{
+#if defined(CONFIG_SCHED_THREAD_USAGE_ALL)
+	k_thread_runtime_stats_t st;
+
+	k_thread_runtime_stats_all_get(&st);
+	s->busy = st.total_cycles;        /* Non-idle cycles */
+	s->total = st.execution_cycles;   /* Idle + non-idle */
+#else
+	s->busy = 0;
+	s->total = 0;
+#endif
+}
+
+static int32_t cpu_pct_between(const struct cpu_sample *a,
+			       const struct cpu_sample *b)
+{
+	uint64_t total = b->total - a->total;
+
+	if (total == 0) {
+		return -1;
+	}
+	return (int32_t)((b->busy - a->busy) * 100 / total);
+}
+
+/* ========================================================================
+ * Runner
+ * ======================================================================== */
+
+int ingest_bench_init(uart_router_t *router)
+{
+	bench_router = router;
+	return 0;
+}
+
+static int validate_params(const ingest_bench_params_t *p)
+{
+	if (p->fps == 0 || p->duration_s == 0) {
+		return -EINVAL;
+	}
+	if (p->epc_len < 4 || p->epc_len > E310_MAX_EPC_LENGTH ||
+	    (p->epc_len & 1)) {
+		return -EINVAL;
+	}
+	/* Whole frame (header, blocks, CRC) must fit one E310 frame */
+	if (p->tags > 0 &&
+	    6 + (size_t)p->tags * (1 + p->epc_len + 1) + 2 > E310_MAX_FRAME_SIZE) {
+		return -EINVAL;
+	}
+	return 0;
+}
+
+int ingest_bench_run(const ingest_bench_params_t *params,
+		     ingest_bench_result_t *res)
+{
+	uint8_t frame[E310_MAX_FRAME_SIZE];
+	uart_router_stats_t before, after;
+	struct cpu_sample cpu_start, cpu_end;
+	uint32_t seq = 0;
+	uint32_t tags_per_frame = params->tags ? params->tags : 1;
+	int ret;
+
+	if (!bench_router) {
+		return -ENODEV;
+	}
+	ret = validate_params(params);
+	if (ret < 0) {
+		return ret;
+	}
+	if (uart_router_is_inventory_active(bench_router) ||
+	    uart_router_get_mode(bench_router) == ROUTER_MODE_INVENTORY) {
+		return -EBUSY;
+	}
+	if (!atomic_cas(&bench_busy, 0, 1)) {
+		return -EBUSY;
+	}
+
+	memset(res, 0, sizeof(*res));
+	memset(inject_id, 0xFF, sizeof(inject_id));
+	memset(lat_hist, 0, sizeof(lat_hist));
+	lat_max_us = 0;
+	sink_count = 0;
+	sink_report_sum = 0;
+
+	usb_hid_set_dry_run(bench_hid_sink);
+	uart_router_get_stats(bench_router, &before);
+	cpu_sample(&cpu_start);
+
+	const int64_t start = k_uptime_get();
+	const int64_t duration_ms = (int64_t)params->duration_s * 1000;
+	int64_t elapsed;
+	size_t pending = 0;
+
+	while ((elapsed = k_uptime_get() - start) < duration_ms) {
+		uint64_t due = (uint64_t)params->fps * elapsed / 1000 + 1;
+
+		while (res->frames_injected < due) {
+			if (pending == 0) {
+				pending = build_frame(frame, params, &seq);
+			}
+			if (uart_router_inject_rx(bench_router, frame,
+						  pending) < 0) {
+				/* Pipeline behind: retry this frame next tick */
+				res->ring_full++;
+				break;
+			}
+			pending = 0;
+			res->frames_injected++;
+			res->tags_injected += tags_per_frame;
+		}
+		k_msleep(BENCH_TICK_MS);
+	}
+	res->elapsed_ms = (uint32_t)elapsed;
+
+	/* Let the router thread finish what is already queued */
+	const int64_t drain_start = k_uptime_get();
+
+	do {
+		uart_router_get_stats(bench_router, &after);
+		if (after.frames_parsed + after.parse_errors -
+		    before.frames_parsed - before.parse_errors >=
+		    res->frames_injected) {
+			break;
+		}
+		k_msleep(BENCH_TICK_MS);
+	} while (k_uptime_get() - drain_start < BENCH_DRAIN_MAX_MS);
+	res->drain_ms = (uint32_t)(k_uptime_get() - drain_start);
+
+	cpu_sample(&cpu_end);
+	usb_hid_set_dry_run(NULL);
+
+	res->frames_parsed = after.frames_parsed - before.frames_parsed;
+	res->tags_read = after.tags_read - before.tags_read;
+	res->parse_errors = after.parse_errors - before.parse_errors;
+	res->epc_emitted = sink_count;
+	res->report_sum = sink_report_sum;
+	res->cpu_pct = cpu_pct_between(&cpu_start, &cpu_end);
+	res->lat_p50_us = latency_pct_us(50);
+	res->lat_p90_us = latency_pct_us(90);
+	res->lat_p99_us = latency_pct_us(99);
+	res->lat_max_us = lat_max_us;
+
+	res->sustained = res->ring_full == 0 &&
+			 res->parse_errors == 0 &&
+			 res->frames_parsed == res->frames_injected &&
+			 res->drain_ms <= INGEST_BENCH_DRAIN_OK_MS;
+
+	atomic_set(&bench_busy, 0);
+	return 0;
+}
+
+/* ========================================================================
+ * Shell Commands
+ * ======================================================================== */
+
+static uint32_t rate_per_sec(uint32_t count, uint32_t ms)
+{
+	return ms ? (uint32_t)((uint64_t)count * 1000 / ms) : 0;
+}
+
+static const char *bench_err_str(int err)
+{
+	switch (err) {
+	case -EBUSY:  return "inventory running (e310 stop) or bench in progress";
+	case -EINVAL: return "bad parameters (epc_len even 4-62, frame <= 256 bytes)";
+	case -ENODEV: return "router not available";
+	default:      return "failed";
+	}
+}
+
+static void print_result(const struct shell *sh, const ingest_bench_params_t *p,
+			 const ingest_bench_result_t *r)
+{
+	uint32_t busy_ms = r->elapsed_ms + r->drain_ms;
+
+	shell_print(sh, "=== Bench: %u fps, %s, %u-byte EPC, %u s ===",
+		    p->fps, p->tags ? "inventory" : "auto-upload",
+		    p->epc_len, p->duration_s);
+	if (p->tags) {
+		shell_print(sh, "Tags/frame: %u", p->tags);
+	}
+	if (p->population) {
+		shell_print(sh, "Population: %u EPCs", p->population);
+	}
+	shell_print(sh, "Injected:  %u frames, %u tags (ring full x%u)",
+		    r->frames_injected, r->tags_injected, r->ring_full);
+	shell_print(sh, "Processed: %u frames, %u tags, %u errors",
+		    r->frames_parsed, r->tags_read, r->parse_errors);
+	shell_print(sh, "Throughput: %u frames/s, %u tags/s",
+		    rate_per_sec(r->frames_parsed, busy_ms),
+		    rate_per_sec(r->tags_read, busy_ms));
+	shell_print(sh, "HID (dry-run): %u EPCs, report checksum %08x",
+		    r->epc_emitted, r->report_sum);
+	shell_print(sh, "Drain: %u ms", r->drain_ms);
+	if (r->cpu_pct >= 0) {
+		shell_print(sh, "CPU: %d%%", r->cpu_pct);
+	} else {
+		shell_print(sh, "CPU: n/a (CONFIG_SCHED_THREAD_USAGE_ALL)");
+	}
+	shell_print(sh, "Latency: p50 %u us, p90 %u us, p99 %u us, max %u us",
+		    r->lat_p50_us, r->lat_p90_us, r->lat_p99_us, r->lat_max_us);
+	shell_print(sh, "Sustained: %s", r->sustained ? "YES" : "NO");
+}
+
+static void parse_shape(size_t argc, char **argv, size_t first,
+			ingest_bench_params_t *p)
+{
+	p->tags = (argc > first) ? (uint8_t)strtoul(argv[first], NULL, 10)
+				 : BENCH_DEFAULT_TAGS;
+	p->epc_len = (argc > first + 1) ?
+		     (uint8_t)strtoul(argv[first + 1], NULL, 10) :
+		     BENCH_DEFAULT_EPC_LEN;
+}
+
+static int cmd_bench_run(const struct shell *sh, size_t argc, char **argv)
+{
+	ingest_bench_params_t p = { 0 };
+	ingest_bench_result_t r;
+
+	if (argc < 2) {
+		shell_print(sh, "Usage: bench run <fps> [tags] [epc_len] [sec] [pop]");
+		shell_print(sh, "  tags=0: auto-upload frames (default %u), "
+			    "epc_len default %u, sec default %u, pop 0=unique",
+			    BENCH_DEFAULT_TAGS, BENCH_DEFAULT_EPC_LEN,
+			    BENCH_DEFAULT_SEC);
+		return -EINVAL;
+	}
+
+	p.fps = strtoul(argv[1], NULL, 10);
+	parse_shape(argc, argv, 2, &p);
+	p.duration_s = (argc > 4) ? (uint16_t)strtoul(argv[4], NULL, 10)
+				  : BENCH_DEFAULT_SEC;
+	p.population = (argc > 5) ? strtoul(argv[5], NULL, 10) : 0;
+
+	shell_print(sh, "Running %u s...", p.duration_s);
+	int ret = ingest_bench_run(&p, &r);
+
+	if (ret < 0) {
+		shell_error(sh, "Bench: %s", bench_err_str(ret));
+		return ret;
+	}
+
+	print_result(sh, &p, &r);
+	sys_monitor_print_stacks(sh);
+	return 0;
+}
+
+static int cmd_bench_sweep(const struct shell *sh, size_t argc, char **argv)
+{
+	ingest_bench_params_t p = { .duration_s = BENCH_SWEEP_STEP_S };
+	ingest_bench_result_t r, best = { 0 };
+	uint32_t lo = 0, hi = 0;
+	int ret;
+
+	parse_shape(argc, argv, 1, &p);
+
+	shell_print(sh, "Sweeping (%u s per step)...", BENCH_SWEEP_STEP_S);
+
+	/* Double the rate until the pipeline falls behind... */
+	for (p.fps = BENCH_SWEEP_START_FPS; p.fps <= BENCH_SWEEP_MAX_FPS;
+	     p.fps *= 2) {
+		ret = ingest_bench_run(&p, &r);
+		if (ret < 0) {
+			shell_error(sh, "Bench: %s", bench_err_str(ret));
+			return ret;
+		}
+		shell_print(sh, "  %5u fps: %s (drain %u ms, ring full x%u, CPU %d%%)",
+			    p.fps, r.sustained ? "ok  " : "FAIL",
+			    r.drain_ms, r.ring_full, r.cpu_pct);
+		if (!r.sustained) {
+			hi = p.fps;
+			break;
+		}
+		lo = p.fps;
+		best = r;
+	}
+
+	/* ...then bisect between the last good and first bad rate */
+	for (int i = 0; i < BENCH_SWEEP_REFINE && lo > 0 && hi > lo + 1; i++) {
+		p.fps = lo + (hi - lo) / 2;
+		ret = ingest_bench_run(&p, &r);
+		if (ret < 0) {
+			return ret;
+		}
+		shell_print(sh, "  %5u fps: %s (drain %u ms, ring full x%u, CPU %d%%)",
+			    p.fps, r.sustained ? "ok  " : "FAIL",
+			    r.drain_ms, r.ring_full, r.cpu_pct);
+		if (r.sustained) {
+			lo = p.fps;
+			best = r;
+		} else {
+			hi = p.fps;
+		}
+	}
+
+	if (lo == 0) {
+		shell_warn(sh, "Not sustained even at %u fps",
+			   BENCH_SWEEP_START_FPS);
+		return 0;
+	}
+
+	p.fps = lo;
+	shell_print(sh, "Max sustained: %u frames/s, %u tags/s%s",
+		    lo, lo * (p.tags ? p.tags : 1),
+		    hi ? "" : " (sweep cap reached)");
+	print_result(sh, &p, &best);
+	sys_monitor_print_stacks(sh);
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_bench,
+	SHELL_CMD(run, NULL, "Fixed rate: <fps> [tags] [epc_len] [sec] [pop]", cmd_bench_run),
+	SHELL_CMD(sweep, NULL, "Find max sustained rate: [tags] [epc_len]", cmd_bench_sweep),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(bench, &sub_bench, "Ingest pipeline self-benchmark", NULL);
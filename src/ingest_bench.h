@@ -0,0 +1,102 @@
+/**
+ * @file ingest_bench.h
+ * @brief On-Target Ingest Pipeline Self-Benchmark
+ *
+ * Qualifies a board and firmware build without an RFID population:
+ * synthetic E310 frames are injected into the UART4 RX ring at a chosen
+ * rate and mix, and pass through the real assembler → parser → EPC
+ * filter → HID path (HID in dry-run, nothing is typed).
+ *
+ * Shell:
+ *   bench run <fps> [tags] [epc_len] [sec] [pop]   fixed-rate run
+ *   bench sweep [tags] [epc_len]                    find max sustained rate
+ *
+ * tags = 0 sends auto-upload (0xEE) frames, one tag each; otherwise
+ * Tag Inventory (0x01) frames with that many tags. pop limits the EPC
+ * population so repeats exercise the duplicate filter (0 = all unique).
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#ifndef INGEST_BENCH_H_
+#define INGEST_BENCH_H_
+
+#include "uart_router.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup ingest_bench Ingest Benchmark
+ * @{
+ */
+
+/** Latency histogram bucket width (us) and bucket count */
+#define INGEST_BENCH_LAT_BUCKET_US  250
+#define INGEST_BENCH_LAT_BUCKETS    200
+
+/** Backlog allowed to remain after a run for it to count as sustained */
+#define INGEST_BENCH_DRAIN_OK_MS    50
+
+/**
+ * @brief Run parameters
+ */
+typedef struct {
+	uint32_t fps;               /**< Injected frames per second */
+	uint8_t tags;               /**< Tags per frame (0 = auto-upload) */
+	uint8_t epc_len;            /**< EPC length in bytes (even, 4-62) */
+	uint16_t duration_s;        /**< Run length in seconds */
+	uint32_t population;        /**< Distinct EPCs (0 = every tag unique) */
+} ingest_bench_params_t;
+
+/**
+ * @brief Run results
+ */
+typedef struct {
+	uint32_t frames_injected;   /**< Frames queued into the RX ring */
+	uint32_t tags_injected;     /**< Tags in those frames */
+	uint32_t ring_full;         /**< Frames delayed by a full RX ring */
+	uint32_t frames_parsed;     /**< Router frames_parsed delta */
+	uint32_t tags_read;         /**< Router tags_read delta */
+	uint32_t parse_errors;      /**< Router parse_errors delta */
+	uint32_t epc_emitted;       /**< EPCs that reached the HID sink */
+	uint32_t report_sum;        /**< Sum of the sink's key report checksums */
+	uint32_t elapsed_ms;        /**< Injection window */
+	uint32_t drain_ms;          /**< Time to empty the backlog afterwards */
+	int32_t cpu_pct;            /**< Non-idle CPU % during the run, -1 if unknown */
+	uint32_t lat_p50_us;        /**< Inject → HID sink latency percentiles */
+	uint32_t lat_p90_us;
+	uint32_t lat_p99_us;
+	uint32_t lat_max_us;
+	bool sustained;             /**< Kept up with the requested rate */
+} ingest_bench_result_t;
+
+/**
+ * @brief Bind the benchmark to the router instance
+ *
+ * @param router Router whose RX ring receives injected frames
+ * @return 0 on success
+ */
+int ingest_bench_init(uart_router_t *router);
+
+/**
+ * @brief Run one fixed-rate benchmark (blocks for the run duration)
+ *
+ * The router must be idle (no inventory running).
+ *
+ * @param params Run parameters
+ * @param res Output: results
+ * @return 0 on success, -EINVAL on bad parameters, -EBUSY if inventory
+ *         is running or another run is in progress, -ENODEV if not bound
+ */
+int ingest_bench_run(const ingest_bench_params_t *params,
+		     ingest_bench_result_t *res);
+
+/** @} */ /* End of ingest_bench group */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INGEST_BENCH_H_ */
@@ -0,0 +1,627 @@
+/**
+ * @file kv_store.c
+ * @brief Log-Structured Key/Value Store Implementation
+ *
+ * Record format (little-endian), starting on a page boundary:
+ *   Offset  Size  Description
+ *   0       4     Sequence number (increases with every append)
+ *   4       1     Key (0x01 to KV_KEY_MAX - 1)
+ *   5       1     Value length (1 to KV_STORE_VALUE_MAX)
+ *   6       2     CRC-16-CCITT over bytes 0-5 and the value
+ *   8       len   Value
+ *
+ * A record occupies ceil((8 + len) / 32) pages; the padding is not
+ * written.
+ *
+ * Appends and checks are queued to the EEPROM I/O thread (eeprom_async)
+ * and complete through callbacks. The index is updated when an append
+ * is queued, so later requests (which run after it, in order) already
+ * see it; a failed append rolls its key back to the newest record that
+ * was written (a later append queued behind a failed one inherits its
+ * rollback target). The pages of a record superseded by an in-flight
+ * append stay protected until the append completes, so the rollback
+ * target is never overwritten.
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#include "kv_store.h"
+#include "eeprom_async.h"
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+#include <errno.h>
+
+LOG_MODULE_REGISTER(kv_store, LOG_LEVEL_INF);
+
+#define EEPROM_NODE       DT_ALIAS(eeprom_0)
+#define AREA_END          DT_PROP(EEPROM_NODE, size)
+#define AREA_PAGES        ((AREA_END - KV_STORE_AREA_START) / KV_STORE_PAGE_SIZE)
+#define RECORD_PAGES_MAX  DIV_ROUND_UP(KV_STORE_HDR_SIZE + KV_STORE_VALUE_MAX, \
+				       KV_STORE_PAGE_SIZE)
+
+/** Boot scan reads this many pages per EEPROM transfer */
+#define SCAN_PAGES        8
+
+BUILD_ASSERT(DT_PROP(EEPROM_NODE, pagesize) == KV_STORE_PAGE_SIZE,
+	     "KV_STORE_PAGE_SIZE must match the EEPROM page size");
+BUILD_ASSERT(KV_STORE_AREA_START % KV_STORE_PAGE_SIZE == 0,
+	     "Log area must start on a page boundary");
+BUILD_ASSERT(KV_STORE_VALUE_MAX <= UINT8_MAX, "length is one byte");
+/* Every key holding a maximum-size record must leave room to append */
+BUILD_ASSERT((KV_KEY_MAX + 1) * RECORD_PAGES_MAX <= AREA_PAGES,
+	     "Log area too small for the key space");
+
+struct kv_index {
+	uint32_t seq;
+	uint16_t page;
+	uint8_t pages;      /* 0 = no record */
+};
+
+enum kv_op_type {
+	KV_OP_FREE = 0,
+	KV_OP_APPEND,
+	KV_OP_CHECK,
+};
+
+/** One queued append or check; rec is the I/O buffer */
+struct kv_op {
+	uint8_t type;
+	uint8_t key;
+	uint8_t len;
+	struct kv_index rec_at;   /* Where the record is (append: written) */
+	struct kv_index prev;     /* Append: index entry to restore on failure */
+	uint8_t rec[RECORD_PAGES_MAX * KV_STORE_PAGE_SIZE];
+	uint8_t expect[KV_STORE_VALUE_MAX];
+	kv_store_cb_t cb;
+	void *user_data;
+};
+
+static bool ready;
+static K_MUTEX_DEFINE(kv_lock);
+
+static struct kv_index key_index[KV_KEY_MAX];
+static uint16_t head;
+static uint32_t next_seq;
+static uint32_t appends;
+static uint32_t skipped;
+static uint32_t failures;
+static struct kv_op ops[KV_STORE_MAX_PENDING];
+
+static uint16_t crc16_ccitt(uint16_t crc, const uint8_t *data, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		crc ^= (uint16_t)data[i] << 8;
+		for (int j = 0; j < 8; j++) {
+			if (crc & 0x8000) {
+				crc = (crc << 1) ^ 0x1021;
+			} else {
+				crc <<= 1;
+			}
+		}
+	}
+
+	return crc;
+}
+
+static uint8_t record_pages(size_t len)
+{
+	return DIV_ROUND_UP(KV_STORE_HDR_SIZE + len, KV_STORE_PAGE_SIZE);
+}
+
+static uint16_t record_crc(const uint8_t *rec, size_t len)
+{
+	uint16_t crc = crc16_ccitt(0xFFFF, rec, 6);
+
+	return crc16_ccitt(crc, &rec[KV_STORE_HDR_SIZE], len);
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+	       ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Validate a record image
+ *
+ * @param rec Record bytes (at least @p avail)
+ * @param avail Bytes available from @p rec
+ * @return Value length if valid, 0 otherwise
+ */
+static size_t record_valid(const uint8_t *rec, size_t avail)
+{
+	uint8_t key = rec[4];
+	uint8_t len = rec[5];
+	uint16_t crc;
+
+	if (key == 0 || key >= KV_KEY_MAX || len == 0 || len > KV_STORE_VALUE_MAX) {
+		return 0;
+	}
+	if ((size_t)KV_STORE_HDR_SIZE + len > avail) {
+		return 0;
+	}
+
+	crc = (uint16_t)rec[6] | ((uint16_t)rec[7] << 8);
+	return (crc == record_crc(rec, len)) ? len : 0;
+}
+
+static uint16_t page_offset(uint16_t page)
+{
+	return KV_STORE_AREA_START + page * KV_STORE_PAGE_SIZE;
+}
+
+static int read_pages(uint16_t page, void *buf, size_t len)
+{
+	return eeprom_async_read_sync(page_offset(page), buf, len);
+}
+
+struct sync_wait {
+	struct k_sem done;
+	int result;
+};
+
+static void sync_done(int result, void *user_data)
+{
+	struct sync_wait *w = user_data;
+
+	/* Keep the first failure: the append's, if both fail */
+	if (w->result == 0) {
+		w->result = result;
+	}
+	k_sem_give(&w->done);
+}
+
+/* ========================================================================
+ * Boot Scan
+ * ======================================================================== */
+
+static int scan(void)
+{
+	static uint8_t buf[SCAN_PAGES * KV_STORE_PAGE_SIZE];
+	uint16_t buf_first = 0, buf_pages = 0;
+	uint32_t max_seq = 0;
+	bool any = false;
+	uint16_t page = 0;
+
+	memset(key_index, 0, sizeof(key_index));
+	head = 0;
+	skipped = 0;
+
+	while (page < AREA_PAGES) {
+		/* Keep a whole maximum-size record in the window */
+		if (page + RECORD_PAGES_MAX > buf_first + buf_pages &&
+		    buf_first + buf_pages < AREA_PAGES) {
+			int ret;
+
+			buf_first = page;
+			buf_pages = MIN(SCAN_PAGES, AREA_PAGES - page);
+			ret = read_pages(buf_first, buf, buf_pages * KV_STORE_PAGE_SIZE);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+
+		const uint8_t *rec = &buf[(page - buf_first) * KV_STORE_PAGE_SIZE];
+		size_t avail = (buf_first + buf_pages - page) * KV_STORE_PAGE_SIZE;
+		size_t len = record_valid(rec, avail);
+
+		if (len == 0) {
+			skipped++;
+			page++;
+			continue;
+		}
+
+		uint32_t seq = get_le32(rec);
+		struct kv_index *e = &key_index[rec[4]];
+		uint8_t n = record_pages(len);
+
+		if (e->pages == 0 || seq > e->seq) {
+			e->seq = seq;
+			e->page = page;
+			e->pages = n;
+		}
+		if (!any || seq > max_seq) {
+			max_seq = seq;
+			head = (page + n) % AREA_PAGES;
+			any = true;
+		}
+		page += n;
+	}
+
+	next_seq = any ? max_seq + 1 : 1;
+	return 0;
+}
+
+int kv_store_init(void)
+{
+	kv_store_stats_t st;
+	int ret;
+
+	if (!eeprom_async_is_ready()) {
+		LOG_WRN("EEPROM not ready, key/value store unavailable");
+		ready = false;
+		return -ENODEV;
+	}
+
+	k_mutex_lock(&kv_lock, K_FOREVER);
+	ret = scan();
+	k_mutex_unlock(&kv_lock);
+
+	if (ret < 0) {
+		LOG_ERR("Log scan failed: %d", ret);
+		ready = false;
+		return ret;
+	}
+
+	ready = true;
+	kv_store_get_stats(&st);
+	LOG_INF("KV store: %u keys, %u/%u pages live, head %u, seq %u",
+		st.keys, st.live_pages, st.pages, st.head, st.seq);
+	return 0;
+}
+
+bool kv_store_is_ready(void)
+{
+	return ready;
+}
+
+bool kv_store_has(uint8_t key)
+{
+	return ready && key < KV_KEY_MAX && key_index[key].pages != 0;
+}
+
+/* ========================================================================
+ * Read
+ * ======================================================================== */
+
+int kv_store_read(uint8_t key, void *buf, size_t len)
+{
+	uint8_t rec[RECORD_PAGES_MAX * KV_STORE_PAGE_SIZE];
+	struct sync_wait w = { .result = 0 };
+	struct kv_index e;
+	size_t vlen;
+	int ret;
+
+	if (!ready) {
+		return -ENODEV;
+	}
+	if (key == 0 || key >= KV_KEY_MAX) {
+		return -EINVAL;
+	}
+
+	k_sem_init(&w.done, 0, 1);
+
+	/*
+	 * Queue the read under the lock, so no later append can take these
+	 * pages first, but wait outside it: completions need the lock.
+	 */
+	k_mutex_lock(&kv_lock, K_FOREVER);
+	e = key_index[key];
+	if (e.pages == 0) {
+		k_mutex_unlock(&kv_lock);
+		return -ENOENT;
+	}
+	ret = eeprom_async_read(page_offset(e.page), rec, e.pages * KV_STORE_PAGE_SIZE,
+				sync_done, &w);
+	k_mutex_unlock(&kv_lock);
+
+	if (ret < 0) {
+		return ret;
+	}
+
+	k_sem_take(&w.done, K_FOREVER);
+	if (w.result < 0) {
+		return w.result;
+	}
+
+	vlen = record_valid(rec, e.pages * KV_STORE_PAGE_SIZE);
+	if (vlen == 0 || rec[4] != key || get_le32(rec) != e.seq) {
+		return -EIO;
+	}
+
+	memcpy(buf, &rec[KV_STORE_HDR_SIZE], MIN(len, vlen));
+	return (int)vlen;
+}
+
+/* ========================================================================
+ * Append
+ * ======================================================================== */
+
+static bool overlaps(const struct kv_index *e, uint16_t page, uint8_t n)
+{
+	return e->pages != 0 && e->page < page + n && page < e->page + e->pages;
+}
+
+/**
+ * @brief Find the end of the last protected record overlapping [page, page + n)
+ *
+ * Protected: the current record of every key, and the record an
+ * in-flight append would roll back to.
+ *
+ * @return Page after that record, or 0 if the range is free
+ */
+static uint16_t live_overlap_end(uint16_t page, uint8_t n)
+{
+	uint16_t end = 0;
+
+	for (int k = 1; k < KV_KEY_MAX; k++) {
+		const struct kv_index *e = &key_index[k];
+
+		if (overlaps(e, page, n)) {
+			end = MAX(end, e->page + e->pages);
+		}
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(ops); i++) {
+		const struct kv_index *e = &ops[i].prev;
+
+		if (ops[i].type == KV_OP_APPEND && overlaps(e, page, n)) {
+			end = MAX(end, e->page + e->pages);
+		}
+	}
+
+	return end;
+}
+
+/** Find where an @p n page record can go without touching a live record */
+static int find_slot(uint8_t n, uint16_t *slot)
+{
+	uint16_t page = head;
+
+	/* One lap over the area is enough to see every gap */
+	for (int tries = 0; tries <= AREA_PAGES; tries++) {
+		uint16_t end;
+
+		if (page + n > AREA_PAGES) {
+			page = 0;
+		}
+
+		end = live_overlap_end(page, n);
+		if (end == 0) {
+			*slot = page;
+			return 0;
+		}
+		page = end % AREA_PAGES;
+	}
+
+	return -ENOSPC;
+}
+
+/** Take a free op slot (caller holds kv_lock) */
+static struct kv_op *op_alloc(uint8_t type)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(ops); i++) {
+		if (ops[i].type == KV_OP_FREE) {
+			memset(&ops[i], 0, offsetof(struct kv_op, rec));
+			ops[i].type = type;
+			return &ops[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void op_finish(struct kv_op *op, int result)
+{
+	kv_store_cb_t cb = op->cb;
+	void *user_data = op->user_data;
+
+	k_mutex_lock(&kv_lock, K_FOREVER);
+	if (result < 0) {
+		failures++;
+	}
+	op->type = KV_OP_FREE;
+	k_mutex_unlock(&kv_lock);
+
+	if (cb) {
+		cb(result, user_data);
+	}
+}
+
+static void append_done(int result, void *user_data)
+{
+	struct kv_op *op = user_data;
+
+	k_mutex_lock(&kv_lock, K_FOREVER);
+	if (result == 0) {
+		appends++;
+	} else if (key_index[op->key].seq == op->rec_at.seq) {
+		/* Nothing newer was queued for this key: fall back */
+		key_index[op->key] = op->prev;
+	} else {
+		/* A newer append would fall back to this torn record: skip it */
+		for (size_t i = 0; i < ARRAY_SIZE(ops); i++) {
+			if (ops[i].type == KV_OP_APPEND && ops[i].key == op->key &&
+			    ops[i].prev.pages != 0 && ops[i].prev.seq == op->rec_at.seq) {
+				ops[i].prev = op->prev;
+			}
+		}
+	}
+	k_mutex_unlock(&kv_lock);
+
+	if (result < 0) {
+		LOG_ERR("Append of key 0x%02x failed: %d", op->key, result);
+	}
+	op_finish(op, result);
+}
+
+int kv_store_write(uint8_t key, const void *data, size_t len,
+		   kv_store_cb_t cb, void *user_data)
+{
+	struct kv_op *op;
+	uint16_t slot, crc;
+	uint32_t seq;
+	uint8_t n;
+	int ret;
+
+	if (!ready) {
+		return -ENODEV;
+	}
+	if (key == 0 || key >= KV_KEY_MAX || len == 0 || len > KV_STORE_VALUE_MAX) {
+		return -EINVAL;
+	}
+
+	n = record_pages(len);
+
+	k_mutex_lock(&kv_lock, K_FOREVER);
+
+	ret = find_slot(n, &slot);
+	if (ret < 0) {
+		k_mutex_unlock(&kv_lock);
+		LOG_ERR("No room for key 0x%02x (%u pages)", key, n);
+		return ret;
+	}
+
+	op = op_alloc(KV_OP_APPEND);
+	if (!op) {
+		k_mutex_unlock(&kv_lock);
+		return -EAGAIN;
+	}
+
+	seq = next_seq;
+	op->key = key;
+	op->len = len;
+	op->cb = cb;
+	op->user_data = user_data;
+	op->prev = key_index[key];
+	op->rec_at.seq = seq;
+	op->rec_at.page = slot;
+	op->rec_at.pages = n;
+
+	op->rec[0] = (seq >> 0) & 0xFF;
+	op->rec[1] = (seq >> 8) & 0xFF;
+	op->rec[2] = (seq >> 16) & 0xFF;
+	op->rec[3] = (seq >> 24) & 0xFF;
+	op->rec[4] = key;
+	op->rec[5] = (uint8_t)len;
+	memcpy(&op->rec[KV_STORE_HDR_SIZE], data, len);
+	crc = record_crc(op->rec, len);
+	op->rec[6] = (crc >> 0) & 0xFF;
+	op->rec[7] = (crc >> 8) & 0xFF;
+
+	ret = eeprom_async_write(page_offset(slot), op->rec, KV_STORE_HDR_SIZE + len,
+				 append_done, op);
+	if (ret < 0) {
+		op->type = KV_OP_FREE;
+		k_mutex_unlock(&kv_lock);
+		return ret;
+	}
+
+	/* Consume the slot and sequence: if the write fails the pages may be torn */
+	key_index[key] = op->rec_at;
+	head = (slot + n) % AREA_PAGES;
+	next_seq++;
+
+	k_mutex_unlock(&kv_lock);
+	return 0;
+}
+
+static void check_done(int result, void *user_data)
+{
+	struct kv_op *op = user_data;
+
+	if (result == 0) {
+		size_t vlen = record_valid(op->rec, op->rec_at.pages * KV_STORE_PAGE_SIZE);
+
+		if (vlen != op->len || op->rec[4] != op->key ||
+		    get_le32(op->rec) != op->rec_at.seq ||
+		    memcmp(&op->rec[KV_STORE_HDR_SIZE], op->expect, vlen) != 0) {
+			result = -EIO;
+		}
+	}
+
+	if (result < 0) {
+		LOG_ERR("Verify of key 0x%02x failed: %d", op->key, result);
+	}
+	op_finish(op, result);
+}
+
+int kv_store_check(uint8_t key, const void *data, size_t len,
+		   kv_store_cb_t cb, void *user_data)
+{
+	struct kv_op *op;
+	int ret;
+
+	if (!ready) {
+		return -ENODEV;
+	}
+	if (key == 0 || key >= KV_KEY_MAX || len == 0 || len > KV_STORE_VALUE_MAX) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&kv_lock, K_FOREVER);
+
+	if (key_index[key].pages == 0) {
+		k_mutex_unlock(&kv_lock);
+		return -ENOENT;
+	}
+
+	op = op_alloc(KV_OP_CHECK);
+	if (!op) {
+		k_mutex_unlock(&kv_lock);
+		return -EAGAIN;
+	}
+
+	op->key = key;
+	op->len = len;
+	op->cb = cb;
+	op->user_data = user_data;
+	op->rec_at = key_index[key];
+	memcpy(op->expect, data, len);
+
+	ret = eeprom_async_read(page_offset(op->rec_at.page), op->rec,
+				op->rec_at.pages * KV_STORE_PAGE_SIZE, check_done, op);
+	if (ret < 0) {
+		op->type = KV_OP_FREE;
+	}
+
+	k_mutex_unlock(&kv_lock);
+	return ret;
+}
+
+int kv_store_write_verified(uint8_t key, const void *data, size_t len)
+{
+	struct sync_wait w = { .result = 0 };
+	int ret;
+
+	k_sem_init(&w.done, 0, 2);
+
+	ret = kv_store_write(key, data, len, sync_done, &w);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* Runs after the append's write cycle: no delay needed */
+	ret = kv_store_check(key, data, len, sync_done, &w);
+	if (ret < 0) {
+		k_sem_take(&w.done, K_FOREVER);
+		return ret;
+	}
+
+	k_sem_take(&w.done, K_FOREVER);
+	k_sem_take(&w.done, K_FOREVER);
+	return w.result;
+}
+
+void kv_store_get_stats(kv_store_stats_t *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+
+	k_mutex_lock(&kv_lock, K_FOREVER);
+	for (int k = 1; k < KV_KEY_MAX; k++) {
+		if (key_index[k].pages != 0) {
+			stats->keys++;
+			stats->live_pages += key_index[k].pages;
+		}
+	}
+	stats->pages = AREA_PAGES;
+	stats->head = head;
+	stats->seq = next_seq;
+	stats->appends = appends;
+	stats->failures = failures;
+	stats->skipped = skipped;
+	k_mutex_unlock(&kv_lock);
+}
@@ -0,0 +1,200 @@
+/**
+ * @file kv_store.h
+ * @brief Log-Structured Key/Value Store on the M24C64 EEPROM
+ *
+ * Every update appends a record (header + value + CRC) at the log head
+ * instead of rewriting a fixed location, so writes spread over the whole
+ * log area. A one-page record (value up to KV_STORE_PAGE_PAYLOAD bytes)
+ * costs a single 32-byte page write.
+ *
+ * At boot the log area is read once, front to back, and a RAM index of
+ * the newest valid record per key is built (highest sequence number
+ * wins; torn or corrupted records fail their CRC and are skipped, so
+ * the previous value survives a power loss mid-write).
+ *
+ * All EEPROM I/O goes through the EEPROM I/O thread (eeprom_async.h):
+ * appends and checks complete through callbacks on that thread, so
+ * callers never wait on the bus.
+ *
+ * Space is reclaimed in place: when the head wraps, superseded records
+ * are overwritten and pages still holding the current record of some
+ * key are stepped over, never erased.
+ *
+ * EEPROM Layout:
+ *   0x0000-0x007F  Legacy fixed blocks (password, E310 settings), read
+ *                  once for migration and otherwise left untouched
+ *   0x0080-0x1FFF  Log area (252 pages)
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#ifndef KV_STORE_H_
+#define KV_STORE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup kv_store EEPROM Key/Value Store
+ * @{
+ */
+
+/** Start of the log area (first page after the legacy blocks) */
+#define KV_STORE_AREA_START     0x0080
+
+/** EEPROM write page (M24C64) */
+#define KV_STORE_PAGE_SIZE      32
+
+/** Record header: seq (4), key (1), len (1), CRC-16 (2) */
+#define KV_STORE_HDR_SIZE       8
+
+/** Largest value that still fits a single-page record */
+#define KV_STORE_PAGE_PAYLOAD   (KV_STORE_PAGE_SIZE - KV_STORE_HDR_SIZE)
+
+/** Largest value (two-page record) */
+#define KV_STORE_VALUE_MAX      (2 * KV_STORE_PAGE_SIZE - KV_STORE_HDR_SIZE)
+
+/** Appends and checks in flight at once (more fail with -EAGAIN) */
+#define KV_STORE_MAX_PENDING    8
+
+/**
+ * @brief Record keys
+ *
+ * 0x00 and 0xFF are never used so that zeroed or blank EEPROM cannot
+ * look like a record header.
+ */
+enum kv_key {
+	KV_KEY_PW_PASSWORD = 0x01,  /**< Login password, NUL-terminated */
+	KV_KEY_PW_FLAGS    = 0x02,  /**< Password flags byte */
+	KV_KEY_PW_FAILED   = 0x03,  /**< Failed login attempts byte */
+	KV_KEY_SETTINGS    = 0x10,  /**< e310_settings_t (one record) */
+	KV_KEY_PROFILE_0   = 0x20,  /**< Named profile 0 (profiles 0x20-0x2F) */
+	KV_KEY_MAX         = 0x30,  /**< Number of key slots in the index */
+};
+
+/**
+ * @brief Store statistics
+ */
+typedef struct {
+	uint16_t pages;        /**< Pages in the log area */
+	uint16_t live_pages;   /**< Pages holding a current record */
+	uint16_t head;         /**< Next page to append at */
+	uint8_t keys;          /**< Keys with a current record */
+	uint32_t seq;          /**< Next sequence number */
+	uint32_t appends;      /**< Records appended since boot */
+	uint32_t failures;     /**< Appends or checks that failed */
+	uint32_t skipped;      /**< Invalid pages skipped by the boot scan */
+} kv_store_stats_t;
+
+/**
+ * @brief Completion callback (runs on the EEPROM I/O thread)
+ *
+ * @param result 0 on success, negative errno on failure
+ * @param user_data Pointer passed at submission
+ */
+typedef void (*kv_store_cb_t)(int result, void *user_data);
+
+/**
+ * @brief Scan the log area and build the RAM index
+ *
+ * @return 0 on success, -ENODEV if the EEPROM is not ready, negative
+ *         errno on read failure (the store is then unavailable)
+ */
+int kv_store_init(void);
+
+/**
+ * @brief Check if the store is usable
+ *
+ * @return true after a successful kv_store_init()
+ */
+bool kv_store_is_ready(void);
+
+/**
+ * @brief Check if a key has a current record
+ *
+ * @param key Record key
+ * @return true if kv_store_read() would find a record
+ */
+bool kv_store_has(uint8_t key);
+
+/**
+ * @brief Read the current value of a key
+ *
+ * The record is read from EEPROM and its CRC checked. The caller
+ * sleeps until the read completes: use at boot or from the shell, never
+ * from a completion callback.
+ *
+ * @param key Record key
+ * @param buf Destination
+ * @param len Size of @p buf (longer values are truncated)
+ * @return Stored value length, -ENOENT if the key has no record,
+ *         -EIO on CRC mismatch, other negative errno on read failure
+ */
+int kv_store_read(uint8_t key, void *buf, size_t len);
+
+/**
+ * @brief Queue a new value for a key
+ *
+ * The value is copied; the index points at the new record at once. The
+ * callback runs after the EEPROM write cycle has finished. On failure
+ * the key falls back to its previous record.
+ *
+ * @param key Record key (1 to KV_KEY_MAX - 1)
+ * @param data Value
+ * @param len Value length (1 to KV_STORE_VALUE_MAX)
+ * @param cb Completion callback (may be NULL)
+ * @param user_data Passed to @p cb
+ * @return 0 if queued, -EINVAL on bad key/length, -ENOSPC if no room
+ *         can be found, -EAGAIN if too many requests are in flight
+ */
+int kv_store_write(uint8_t key, const void *data, size_t len,
+		   kv_store_cb_t cb, void *user_data);
+
+/**
+ * @brief Queue a read-back of a key's current record and compare it
+ *
+ * Queued after kv_store_write() of the same key, it checks that write.
+ * The callback gets 0 if the record matches, -EIO if not.
+ *
+ * @param key Record key
+ * @param data Expected value (copied)
+ * @param len Expected length
+ * @param cb Completion callback (may be NULL)
+ * @param user_data Passed to @p cb
+ * @return 0 if queued, -ENOENT if the key has no record, -EAGAIN if too
+ *         many requests are in flight
+ */
+int kv_store_check(uint8_t key, const void *data, size_t len,
+		   kv_store_cb_t cb, void *user_data);
+
+/**
+ * @brief Write a value, read it back and wait for both
+ *
+ * For boot-time initialisation and user-facing shell commands that
+ * must report the result. The caller sleeps on a semaphore; no fixed
+ * delay is involved.
+ *
+ * @return 0 on success, -EIO on verification failure, negative errno
+ *         otherwise
+ */
+int kv_store_write_verified(uint8_t key, const void *data, size_t len);
+
+/**
+ * @brief Get store statistics
+ *
+ * @param stats Output
+ */
+void kv_store_get_stats(kv_store_stats_t *stats);
+
+/** @} */ /* End of kv_store group */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KV_STORE_H_ */
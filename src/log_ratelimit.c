@@ -0,0 +1,26 @@
+/**
+ * @file log_ratelimit.c
+ * @brief Rate-Limited Logging Counters
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#include "log_ratelimit.h"
+#include <zephyr/sys/atomic.h>
+
+static atomic_t rl_dropped = ATOMIC_INIT(0);
+
+void log_ratelimit_count_dropped(void)
+{
+	atomic_inc(&rl_dropped);
+}
+
+uint32_t log_ratelimit_get_dropped(void)
+{
+	return (uint32_t)atomic_get(&rl_dropped);
+}
+
+void log_ratelimit_reset_dropped(void)
+{
+	atomic_set(&rl_dropped, 0);
+}
@@ -0,0 +1,69 @@
+/**
+ * @file log_ratelimit.h
+ * @brief Rate-Limited Logging for Per-Tag Events
+ *
+ * Per-tag log statements can fire hundreds of times per second during
+ * inventory. These wrappers let each call site emit at most one message
+ * per interval; suppressed messages are counted in a global counter that
+ * is reported by `router stats`.
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#ifndef LOG_RATELIMIT_H_
+#define LOG_RATELIMIT_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Default per-call-site interval for per-tag log messages (ms) */
+#define LOG_RATELIMIT_DEFAULT_MS    1000
+
+/**
+ * @brief Count one suppressed log message
+ */
+void log_ratelimit_count_dropped(void);
+
+/**
+ * @brief Get number of suppressed log messages since boot/reset
+ *
+ * @return Suppressed message count
+ */
+uint32_t log_ratelimit_get_dropped(void);
+
+/**
+ * @brief Reset suppressed message counter
+ */
+void log_ratelimit_reset_dropped(void);
+
+/**
+ * @brief Emit a log message at most once per @p _interval_ms per call site
+ *
+ * State is a static deadline private to each expansion. Concurrent callers
+ * at the same site may occasionally both pass, which is harmless.
+ */
+#define LOG_RATELIMIT(_log_macro, _interval_ms, ...)                        \
+	do {                                                                \
+		static int64_t _rl_next;                                    \
+		int64_t _rl_now = k_uptime_get();                           \
+		if (_rl_now >= _rl_next) {                                  \
+			_rl_next = _rl_now + (_interval_ms);                \
+			_log_macro(__VA_ARGS__);                            \
+		} else {                                                    \
+			log_ratelimit_count_dropped();                      \
+		}                                                           \
+	} while (0)
+
+#define LOG_RL_ERR(...) LOG_RATELIMIT(LOG_ERR, LOG_RATELIMIT_DEFAULT_MS, __VA_ARGS__)
+#define LOG_RL_WRN(...) LOG_RATELIMIT(LOG_WRN, LOG_RATELIMIT_DEFAULT_MS, __VA_ARGS__)
+#define LOG_RL_INF(...) LOG_RATELIMIT(LOG_INF, LOG_RATELIMIT_DEFAULT_MS, __VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOG_RATELIMIT_H_ */
@@ -25,9 +25,16 @@
 #include "switch_control.h"
 #include "shell_login.h"
 #include "password_storage.h"
+#include "kv_store.h"
 #include "beep_control.h"
+#include "feedback.h"
 #include "rgb_led.h"
 #include "e310_settings.h"
+#include "ingest_bench.h"
+#include "e310_profile.h"
+#include "ctrl_proto.h"
+#include "runtime_config.h"
+#include "sys_monitor.h"
 
 LOG_MODULE_REGISTER(parp01, LOG_LEVEL_INF);
 
@@ -100,26 +107,54 @@ static void usb_msg_cb(struct usbd_context *const ctx,
 	}
 }
 
+/**
+ * @brief Router reply to a start request (SW0 or auto-start)
+ *
+ * Runs on the router thread; the router calls below run inline.
+ */
+static void on_inventory_started(int result, void *user_data)
+{
+	const char *who = user_data;
+
+	if (result < 0) {
+		LOG_ERR("Inventory start (%s) failed: %d", who, result);
+		uart_router_set_mode(&uart_router, ROUTER_MODE_IDLE);
+		switch_control_set_inventory_state(false);
+		rgb_led_set_inventory_status(false);
+	}
+}
+
 /**
  * @brief Inventory toggle callback from switch
  *
  * Called when SW0 is pressed to toggle inventory on/off.
  * - Inventory ON:  HID keyboard enabled (RFID pad mode)
  * - Inventory OFF: HID keyboard disabled (Debug mode)
+ *
+ * Only posts to the router: the switch work handler never waits for the
+ * E310 (connecting can take a second).
  */
 static void on_inventory_toggle(bool start)
 {
+	int ret;
+
 	if (start) {
 		shell_login_force_logout();
-		int ret = uart_router_start_inventory(&uart_router);
-		if (ret < 0) {
-			switch_control_set_inventory_state(false);
-			rgb_led_set_inventory_status(false);
-			LOG_ERR("Inventory start failed: %d", ret);
-		}
+		ret = uart_router_post(&uart_router, ROUTER_OP_START_INVENTORY, 0,
+				       on_inventory_started, (void *)"SW0");
 	} else {
-		uart_router_stop_inventory(&uart_router);
-		uart_router_set_mode(&uart_router, ROUTER_MODE_IDLE);
+		ret = uart_router_post(&uart_router, ROUTER_OP_STOP_INVENTORY, 0,
+				       NULL, NULL);
+		if (ret == 0) {
+			ret = uart_router_post(&uart_router, ROUTER_OP_SET_MODE,
+					       ROUTER_MODE_IDLE, NULL, NULL);
+		}
+	}
+
+	if (ret < 0) {
+		LOG_ERR("Inventory %s not queued: %d", start ? "start" : "stop", ret);
+		switch_control_set_inventory_state(!start);
+		rgb_led_set_inventory_status(!start);
 	}
 }
 
@@ -132,12 +167,96 @@ static void on_inventory_toggle(bool start)
 
 static const struct gpio_dt_spec test_led = GPIO_DT_SPEC_GET(TEST_LED_NODE, gpios);
 
+/* ========================================================================
+ * Main Loop Events
+ * ======================================================================== */
+
+/** Test LED toggle, watchdog feed (2000 ms timeout) and login check */
+#define HEARTBEAT_MS              500
+
+#define AUTO_START_USB_SETTLE_MS  2000
+#define AUTO_START_MAX_WAIT_MS   15000
+
+/* One signal per wake source; SYS_WAKE_DEADLINE is the k_poll timeout */
+#define MAIN_SIGNAL_COUNT  SYS_WAKE_DEADLINE
+
+static struct k_poll_signal main_signals[MAIN_SIGNAL_COUNT];
+static struct k_poll_event main_events[MAIN_SIGNAL_COUNT];
+
+static void main_wake(enum sys_wake_source src)
+{
+	k_poll_signal_raise(&main_signals[src], 0);
+}
+
+static void heartbeat_expiry(struct k_timer *timer)
+{
+	ARG_UNUSED(timer);
+	main_wake(SYS_WAKE_HEARTBEAT);
+}
+
+static K_TIMER_DEFINE(heartbeat_timer, heartbeat_expiry, NULL);
+
+static void on_led_wake(void)
+{
+	main_wake(SYS_WAKE_LED);
+}
+
+static void on_usb_hid_ready(bool ready)
+{
+	ARG_UNUSED(ready);
+	main_wake(SYS_WAKE_USB);
+}
+
+static void on_inventory_state(bool running)
+{
+	ARG_UNUSED(running);
+	main_wake(SYS_WAKE_INVENTORY);
+}
+
+static void main_events_init(void)
+{
+	for (int i = 0; i < MAIN_SIGNAL_COUNT; i++) {
+		k_poll_signal_init(&main_signals[i]);
+		k_poll_event_init(&main_events[i], K_POLL_TYPE_SIGNAL,
+				  K_POLL_MODE_NOTIFY_ONLY, &main_signals[i]);
+	}
+}
+
+/**
+ * @brief Sleep until an event or @p deadline (uptime ms, INT64_MAX = none)
+ *
+ * @return BIT(SYS_WAKE_*) of what woke us
+ */
+static uint32_t main_wait(int64_t deadline)
+{
+	k_timeout_t timeout = K_FOREVER;
+	uint32_t fired = 0;
+
+	if (deadline != INT64_MAX) {
+		timeout = K_TIMEOUT_ABS_MS(deadline);
+	}
+
+	if (k_poll(main_events, MAIN_SIGNAL_COUNT, timeout) == -EAGAIN) {
+		fired |= BIT(SYS_WAKE_DEADLINE);
+	}
+
+	for (int i = 0; i < MAIN_SIGNAL_COUNT; i++) {
+		if (main_events[i].state == K_POLL_STATE_SIGNALED) {
+			fired |= BIT(i);
+			k_poll_signal_reset(&main_signals[i]);
+			main_events[i].state = K_POLL_STATE_NOT_READY;
+		}
+	}
+
+	sys_monitor_note_wakeup(fired);
+	return fired;
+}
+
 int main(void)
 {
 	int ret;
 	bool led_state = false;
 	bool last_inv_state = false;
-	int64_t last_led_toggle = 0;
 
 	/* === EARLY DEBUG: Print immediately to verify boot === */
 	printk("\n\n*** PARP-01 BOOT START ***\n");
@@ -198,6 +317,12 @@ int main(void)
 	gpio_pin_set_dt(&test_led, 0);
 	printk("LED blinked once\n");
 
+	/* Wake sources must be wired before the modules can raise them */
+	main_events_init();
+	usb_hid_set_ready_callback(on_usb_hid_ready);
+	switch_control_set_state_callback(on_inventory_state);
+	rgb_led_set_wake_callback(on_led_wake);
+
 	/* Reset USB OTG HS peripheral BEFORE stack init to clear stale state */
 	usb_otg_hs_pre_init();
 
@@ -243,6 +368,8 @@ int main(void)
 			LOG_ERR("Failed to start UART router: %d", ret);
 		} else {
 			printk("UART router started\n");
+			ingest_bench_init(&uart_router);
+			e310_profile_init(&uart_router);
 		}
 	}
 
@@ -254,6 +381,12 @@ int main(void)
 		switch_control_set_inventory_callback(on_inventory_toggle);
 	}
 
+	/* Scan the EEPROM record log (before password storage and settings) */
+	ret = kv_store_init();
+	if (ret < 0) {
+		LOG_WRN("EEPROM store init failed: %d (settings in RAM only)", ret);
+	}
+
 	/* Initialize password storage (must be before shell_login_init) */
 	ret = password_storage_init();
 	if (ret < 0) {
@@ -295,17 +428,31 @@ int main(void)
 		rgb_led_set_inventory_status(false);
 	}
 
+	/* Beeper/LED feedback coalescer (needs both of the above) */
+	feedback_init();
 
 	/* Apply remaining persisted settings (modules must be initialized first) */
 	beep_control_set_pulse_ms(e310_settings_get_beep_pulse());
 	beep_control_set_filter_ms(e310_settings_get_beep_filter());
-	uart_router.epc_filter.debounce_ms =
-		(uint32_t)e310_settings_get_epc_debounce() * 1000;
-	uart_router.inventory_interval_ms =
-		e310_settings_get_inventory_interval();
+
+	runtime_config_t *cfg = runtime_config_edit();
+	cfg->epc_debounce_ms = (uint32_t)e310_settings_get_epc_debounce() * 1000;
+	cfg->inventory_interval_ms = e310_settings_get_inventory_interval();
+	cfg->rf_power = e310_settings_get_rf_power();
+	cfg->antenna_config = e310_settings_get_antenna();
+	e310_settings_get_frequency(&cfg->freq_region, &cfg->freq_start, &cfg->freq_end);
+	cfg->inventory_time = e310_settings_get_inventory_time();
+	runtime_config_publish();
+
 	rgb_led_set_brightness(e310_settings_get_rgb_brightness());
 	LOG_INF("Persisted settings applied from EEPROM");
 
+	/* Host tools may read and commit settings from here on */
+	ret = ctrl_proto_init(&uart_router);
+	if (ret < 0) {
+		LOG_WRN("Control protocol not started: %d", ret);
+	}
+
 	print_banner();
 
 	/* E310 tests disabled - was causing stack overflow
@@ -313,28 +460,58 @@ int main(void)
 	printk("\n");
 	*/
 
-	/* Deferred auto-start: wait for USB HID ready, then connect E310.
-	 * Must run inside main loop so uart_router_process() is active
-	 * and can parse E310 responses (wait_for_e310_response depends on it). */
+	/* Deferred auto-start: wait for USB HID ready, then ask the router
+	 * thread to connect the E310 and start inventory. */
 	bool auto_started = false;
 	int64_t usb_ready_since = 0;
 	const int64_t boot_time = k_uptime_get();
-	#define AUTO_START_USB_SETTLE_MS  2000
-	#define AUTO_START_MAX_WAIT_MS   15000
+	int64_t led_due = INT64_MAX;
 
 	LOG_INF("Starting main loop (auto-start after USB ready, SW0 to toggle)");
 
+	/* Everything below runs on an event or a deadline; in between the
+	 * CPU idles (tickless). `sys wakeups` shows the resulting rates. */
+	k_timer_start(&heartbeat_timer, K_NO_WAIT, K_MSEC(HEARTBEAT_MS));
+
 	while (1) {
-		uart_router_process(&uart_router);
-		rgb_led_poll();
-		k_msleep(10);
+		int64_t deadline = led_due;
+		int64_t now;
+
+		if (!auto_started) {
+			int64_t start_at = (usb_ready_since > 0) ?
+				usb_ready_since + AUTO_START_USB_SETTLE_MS :
+				boot_time + AUTO_START_MAX_WAIT_MS;
+
+			deadline = MIN(deadline, start_at);
+		}
+
+		uint32_t fired = main_wait(deadline);
+
+		now = k_uptime_get();
+
+		if (fired & BIT(SYS_WAKE_HEARTBEAT)) {
+			/* Feed only when every supervised thread made progress
+			 * since the last feed: main by getting here, the router
+			 * thread (all E310 I/O) by checking in */
+			if (wdt_channel_id >= 0 && uart_router_checked_in()) {
+				wdt_feed(wdt, wdt_channel_id);
+			}
+
+			shell_login_check_timeout();
 
-		/* Feed watchdog every loop iteration (~10 ms) */
-		if (wdt_channel_id >= 0) {
-			wdt_feed(wdt, wdt_channel_id);
+			led_state = !led_state;
+			ret = gpio_pin_set_dt(&test_led, led_state);
+			if (ret < 0) {
+				LOG_WRN("Failed to set LED state: %d", ret);
+			}
 		}
 
-		int64_t now = k_uptime_get();
+		/* Cheap when there is nothing to do; a wake of any kind may
+		 * be the blink deadline it asked for */
+		int32_t led_wait = rgb_led_poll();
+
+		led_due = (led_wait == SYS_FOREVER_MS) ? INT64_MAX :
+			  k_uptime_get() + led_wait;
 
 		if (!auto_started) {
 			bool usb_ready = usb_hid_is_ready();
@@ -357,41 +534,26 @@ int main(void)
 						 "starting E310 anyway", elapsed);
 				}
 				LOG_INF("Auto-starting E310 inventory...");
-				ret = uart_router_start_inventory(&uart_router);
+				ret = uart_router_post(&uart_router,
+						       ROUTER_OP_START_INVENTORY, 0,
+						       on_inventory_started,
+						       (void *)"auto-start");
 				if (ret < 0) {
-					LOG_WRN("E310 auto-start failed: %d "
+					LOG_WRN("E310 auto-start not queued: %d "
 						 "(use SW0 or 'e310 start')", ret);
-					uart_router_set_mode(&uart_router,
-							     ROUTER_MODE_IDLE);
-					switch_control_set_inventory_state(false);
-					rgb_led_set_inventory_status(false);
 				}
 			}
 		}
 
-		static int64_t last_login_check = 0;
-		if (now - last_login_check >= 100) {
-			last_login_check = now;
-			shell_login_check_timeout();
-		}
-
-		/* Toggle LED every 500ms */
-		if ((now - last_led_toggle) >= 500) {
-			last_led_toggle = now;
+		/* Print only on inventory state change */
+		if (fired & BIT(SYS_WAKE_INVENTORY)) {
+			bool cur_inv_state = switch_control_is_inventory_running();
 
-			led_state = !led_state;
-			ret = gpio_pin_set_dt(&test_led, led_state);
-			if (ret < 0) {
-				LOG_WRN("Failed to set LED state: %d", ret);
+			if (cur_inv_state != last_inv_state) {
+				last_inv_state = cur_inv_state;
+				printk("Inventory: %s\n", cur_inv_state ? "ON" : "OFF");
 			}
 		}
-
-		/* Print only on inventory state change */
-		bool cur_inv_state = switch_control_is_inventory_running();
-		if (cur_inv_state != last_inv_state) {
-			last_inv_state = cur_inv_state;
-			printk("Inventory: %s\n", cur_inv_state ? "ON" : "OFF");
-		}
 	}
 
 	return 0;
@@ -2,7 +2,13 @@
  * @file password_storage.c
  * @brief EEPROM-based Password Storage Implementation
  *
- * EEPROM Data Structure (48 bytes):
+ * Password state lives in the EEPROM key/value store (kv_store.h):
+ *   KV_KEY_PW_PASSWORD  Password, NUL-terminated (two-page record)
+ *   KV_KEY_PW_FLAGS     Flags byte (bit 0: master_used, bit 1: changed)
+ *   KV_KEY_PW_FAILED    Failed login attempts byte
+ *
+ * Legacy fixed block, migrated on the first boot with the KV store
+ * (48 bytes):
  *   Offset  Size  Description
  *   0x0000  4     Magic number (0x50415250 = "PARP")
  *   0x0004  1     Version (0x01)
@@ -17,15 +23,15 @@
 
 #include "password_storage.h"
 #include "shell_login.h"
+#include "kv_store.h"
+#include "eeprom_async.h"
 #include <zephyr/kernel.h>
-#include <zephyr/device.h>
-#include <zephyr/drivers/eeprom.h>
 #include <zephyr/logging/log.h>
 #include <string.h>
 
 LOG_MODULE_REGISTER(password_storage, LOG_LEVEL_INF);
 
-/* EEPROM layout constants */
+/* Legacy EEPROM layout constants */
 #define EEPROM_MAGIC          0x50415250  /* "PARP" */
 #define EEPROM_VERSION        0x01
 #define EEPROM_BASE_ADDR      0x0000
@@ -51,9 +57,6 @@ static bool eeprom_available;
 static uint8_t current_flags;
 static uint8_t failed_attempts;
 
-/* EEPROM device */
-static const struct device *eeprom_dev;
-
 /**
  * @brief Load default password into RAM
  */
@@ -86,201 +89,177 @@ static uint16_t crc16_ccitt(const uint8_t *data, size_t len)
 }
 
 /**
- * @brief Read storage structure from EEPROM
+ * @brief Read legacy storage structure from EEPROM
  */
 static int eeprom_read_storage(uint8_t *buf, size_t len)
 {
-	if (!eeprom_dev) {
-		return -ENODEV;
-	}
-
-	return eeprom_read(eeprom_dev, EEPROM_BASE_ADDR, buf, len);
+	return eeprom_async_read_sync(EEPROM_BASE_ADDR, buf, len);
 }
 
 /**
- * @brief Write storage structure to EEPROM
+ * @brief Log the outcome of a background write or read-back
  */
-static int eeprom_write_storage(const uint8_t *buf, size_t len)
+static void write_done(int result, void *user_data)
 {
-	if (!eeprom_dev) {
-		return -ENODEV;
+	if (result < 0) {
+		LOG_ERR("Failed to save %s: %d", (const char *)user_data, result);
 	}
-
-	return eeprom_write(eeprom_dev, EEPROM_BASE_ADDR, buf, len);
 }
 
 /**
- * @brief Write to EEPROM with read-back verification
- *
- * Writes data to EEPROM and reads back to verify integrity.
- * This is critical for production to ensure data persistence.
- *
- * @param buf Data buffer to write
- * @param len Length of data
- * @return 0 on success, -EIO on verification failure, other negative on error
+ * @brief Queue a write and its read-back without waiting for either
  */
-static int eeprom_write_verified(const uint8_t *buf, size_t len)
+static void kv_write_background(uint8_t key, const void *data, size_t len,
+				const char *what)
 {
-	uint8_t verify[STORAGE_SIZE];
 	int ret;
 
-	/* Write to EEPROM */
-	ret = eeprom_write_storage(buf, len);
+	ret = kv_store_write(key, data, len, NULL, NULL);
+	if (ret == 0) {
+		ret = kv_store_check(key, data, len, write_done, (void *)what);
+	}
 	if (ret < 0) {
-		return ret;
+		LOG_ERR("Failed to queue %s: %d", what, ret);
 	}
+}
 
-	/* Small delay for EEPROM internal write cycle (M24C64: 5ms max) */
-	k_msleep(5);
+/**
+ * @brief Write password, flags and failed attempts from RAM to the KV store
+ */
+static int store_all(void)
+{
+	int ret;
 
-	/* Read back for verification */
-	ret = eeprom_read_storage(verify, len);
-	if (ret < 0) {
-		LOG_ERR("EEPROM verify read failed: %d", ret);
-		return ret;
+	ret = kv_store_write_verified(KV_KEY_PW_PASSWORD, current_password,
+				strlen(current_password) + 1);
+	if (ret == 0) {
+		ret = kv_store_write_verified(KV_KEY_PW_FLAGS, &current_flags, 1);
 	}
-
-	/* Compare written data with read-back data */
-	if (memcmp(buf, verify, len) != 0) {
-		LOG_ERR("EEPROM write verification failed");
-		return -EIO;
+	if (ret == 0) {
+		ret = kv_store_write_verified(KV_KEY_PW_FAILED, &failed_attempts, 1);
 	}
 
-	return 0;
+	return ret;
 }
 
 /**
- * @brief Initialize EEPROM with default values
+ * @brief Load password state from the KV store
  */
-static int init_eeprom_defaults(void)
+static int load_from_kv(void)
 {
-	uint8_t buf[STORAGE_SIZE] = {0};
-	uint32_t magic = EEPROM_MAGIC;
-	uint16_t crc;
+	char pw[sizeof(current_password)] = {0};
 	int ret;
 
-	/* Set magic number (little-endian) */
-	buf[OFF_MAGIC + 0] = (magic >> 0) & 0xFF;
-	buf[OFF_MAGIC + 1] = (magic >> 8) & 0xFF;
-	buf[OFF_MAGIC + 2] = (magic >> 16) & 0xFF;
-	buf[OFF_MAGIC + 3] = (magic >> 24) & 0xFF;
-
-	/* Set version */
-	buf[OFF_VERSION] = EEPROM_VERSION;
-
-	/* Set flags (none set initially) */
-	buf[OFF_FLAGS] = 0;
-
-	/* Copy default password */
-	strncpy((char *)&buf[OFF_PASSWORD], SHELL_LOGIN_DEFAULT_PASSWORD,
-		PASSWORD_MAX_LEN);
-	buf[OFF_PASSWORD + PASSWORD_MAX_LEN] = '\0';
-
-	/* Calculate CRC over magic through password (40 bytes) */
-	crc = crc16_ccitt(buf, OFF_CRC);
-	buf[OFF_CRC + 0] = (crc >> 0) & 0xFF;
-	buf[OFF_CRC + 1] = (crc >> 8) & 0xFF;
-
-	/* Write to EEPROM with verification */
-	ret = eeprom_write_verified(buf, STORAGE_SIZE);
+	ret = kv_store_read(KV_KEY_PW_PASSWORD, pw, sizeof(pw) - 1);
 	if (ret < 0) {
-		LOG_ERR("Failed to write EEPROM defaults: %d", ret);
 		return ret;
 	}
 
-	LOG_INF("EEPROM initialized with default password");
+	if (pw[0] == '\0') {
+		LOG_WRN("Empty password in EEPROM, using default");
+		load_default_password();
+	} else {
+		memcpy(current_password, pw, sizeof(current_password));
+	}
+
+	/* Missing byte records mean "never set" */
+	current_flags = 0;
+	failed_attempts = 0;
+	(void)kv_store_read(KV_KEY_PW_FLAGS, &current_flags, 1);
+	(void)kv_store_read(KV_KEY_PW_FAILED, &failed_attempts, 1);
+
 	return 0;
 }
 
-int password_storage_init(void)
+/**
+ * @brief Load the legacy fixed block at 0x0000 (pre-KV firmware)
+ *
+ * @return 0 if a valid block was loaded, negative errno otherwise
+ */
+static int load_legacy(void)
 {
 	uint8_t buf[STORAGE_SIZE];
 	uint32_t magic;
 	uint16_t stored_crc, calc_crc;
 	int ret;
 
-	/* Get EEPROM device */
-	eeprom_dev = DEVICE_DT_GET(DT_ALIAS(eeprom_0));
-	if (!device_is_ready(eeprom_dev)) {
-		LOG_WRN("EEPROM device not ready, using default password");
-		eeprom_dev = NULL;
-		eeprom_available = false;
-		load_default_password();
-		return 0;
-	}
-
-	/* Read current storage */
 	ret = eeprom_read_storage(buf, STORAGE_SIZE);
 	if (ret < 0) {
-		LOG_ERR("Failed to read EEPROM: %d", ret);
-		eeprom_available = false;
-		load_default_password();
-		return 0;
+		return ret;
 	}
 
-	/* Check magic number */
 	magic = (uint32_t)buf[OFF_MAGIC + 0] |
 		((uint32_t)buf[OFF_MAGIC + 1] << 8) |
 		((uint32_t)buf[OFF_MAGIC + 2] << 16) |
 		((uint32_t)buf[OFF_MAGIC + 3] << 24);
 
 	if (magic != EEPROM_MAGIC) {
-		LOG_INF("EEPROM not initialized (magic=0x%08x), initializing...",
-			magic);
-		ret = init_eeprom_defaults();
-		if (ret < 0) {
-			eeprom_available = false;
-			load_default_password();
-			return 0;
-		}
-
-		/* Re-read after initialization */
-		ret = eeprom_read_storage(buf, STORAGE_SIZE);
-		if (ret < 0) {
-			LOG_ERR("Failed to re-read EEPROM: %d", ret);
-			eeprom_available = false;
-			load_default_password();
-			return 0;
-		}
+		LOG_INF("No legacy password block (magic=0x%08x)", magic);
+		return -ENOENT;
 	}
 
-	/* Verify CRC */
 	stored_crc = (uint16_t)buf[OFF_CRC + 0] |
 		     ((uint16_t)buf[OFF_CRC + 1] << 8);
 	calc_crc = crc16_ccitt(buf, OFF_CRC);
 
 	if (stored_crc != calc_crc) {
-		LOG_ERR("EEPROM CRC mismatch (stored=0x%04x, calc=0x%04x)",
+		LOG_ERR("Legacy password CRC mismatch (stored=0x%04x, calc=0x%04x)",
 			stored_crc, calc_crc);
-		LOG_WRN("Using default password due to CRC error");
-		eeprom_available = false;
-		load_default_password();
-		return 0;
-	}
-
-	/* Check version */
-	if (buf[OFF_VERSION] != EEPROM_VERSION) {
-		LOG_WRN("EEPROM version mismatch (got %d, expected %d)",
-			buf[OFF_VERSION], EEPROM_VERSION);
-		/* Could add migration logic here in future */
+		return -EIO;
 	}
 
-	/* Load password */
 	strncpy(current_password, (char *)&buf[OFF_PASSWORD],
 		sizeof(current_password) - 1);
 	current_password[sizeof(current_password) - 1] = '\0';
-
-	/* Ensure null-termination (defense in depth) */
 	if (strlen(current_password) == 0) {
-		LOG_WRN("Empty password in EEPROM, using default");
 		load_default_password();
 	}
 
-	/* Load flags */
 	current_flags = buf[OFF_FLAGS];
-
-	/* Load failed attempts count */
 	failed_attempts = buf[OFF_FAILED_ATTEMPTS];
+	return 0;
+}
+
+int password_storage_init(void)
+{
+	int ret;
+
+	load_default_password();
+	current_flags = 0;
+	failed_attempts = 0;
+
+	if (!kv_store_is_ready()) {
+		LOG_WRN("EEPROM store not ready, using default password");
+		eeprom_available = false;
+		return 0;
+	}
+
+	if (kv_store_has(KV_KEY_PW_PASSWORD)) {
+		ret = load_from_kv();
+		if (ret < 0) {
+			LOG_ERR("Failed to read password record: %d", ret);
+			LOG_WRN("Using default password");
+			eeprom_available = false;
+			load_default_password();
+			return 0;
+		}
+	} else {
+		/* First boot on the KV layout: migrate the legacy block if any */
+		if (load_legacy() == 0) {
+			LOG_INF("Migrating password from legacy EEPROM block");
+		} else {
+			load_default_password();
+			current_flags = 0;
+			failed_attempts = 0;
+		}
+
+		ret = store_all();
+		if (ret < 0) {
+			LOG_ERR("Failed to initialize password store: %d", ret);
+			eeprom_available = false;
+			return 0;
+		}
+	}
 
 	eeprom_available = true;
 	LOG_INF("Password loaded from EEPROM");
@@ -299,9 +278,8 @@ const char *password_storage_get(void)
 
 int password_storage_save(const char *new_password)
 {
-	uint8_t buf[STORAGE_SIZE];
 	char backup[32];
-	uint16_t crc;
+	uint8_t flags;
 	int ret;
 	size_t len;
 
@@ -328,30 +306,7 @@ int password_storage_save(const char *new_password)
 		return 0;
 	}
 
-	/* Read current storage to preserve other fields */
-	ret = eeprom_read_storage(buf, STORAGE_SIZE);
-	if (ret < 0) {
-		LOG_ERR("Failed to read EEPROM: %d", ret);
-		/* Rollback RAM to previous value */
-		strncpy(current_password, backup, sizeof(current_password) - 1);
-		current_password[sizeof(current_password) - 1] = '\0';
-		return ret;
-	}
-
-	/* Update password in buffer */
-	memset(&buf[OFF_PASSWORD], 0, 32);
-	strncpy((char *)&buf[OFF_PASSWORD], new_password, PASSWORD_MAX_LEN);
-
-	/* Set password changed flag */
-	buf[OFF_FLAGS] |= FLAG_PASSWORD_CHANGED;
-
-	/* Recalculate CRC */
-	crc = crc16_ccitt(buf, OFF_CRC);
-	buf[OFF_CRC + 0] = (crc >> 0) & 0xFF;
-	buf[OFF_CRC + 1] = (crc >> 8) & 0xFF;
-
-	/* Write back to EEPROM with verification */
-	ret = eeprom_write_verified(buf, STORAGE_SIZE);
+	ret = kv_store_write_verified(KV_KEY_PW_PASSWORD, current_password, len + 1);
 	if (ret < 0) {
 		LOG_ERR("Failed to write EEPROM: %d", ret);
 		/* Rollback RAM to previous value */
@@ -361,8 +316,18 @@ int password_storage_save(const char *new_password)
 		return ret;
 	}
 
+	/* Set password changed flag (one more record only the first time) */
+	flags = current_flags | FLAG_PASSWORD_CHANGED;
+	if (flags != current_flags) {
+		ret = kv_store_write_verified(KV_KEY_PW_FLAGS, &flags, 1);
+		if (ret < 0) {
+			LOG_ERR("Failed to write password flags: %d", ret);
+			return ret;
+		}
+	}
+
 	/* Update RAM flags */
-	current_flags |= FLAG_PASSWORD_CHANGED;
+	current_flags = flags;
 
 	LOG_INF("Password saved to EEPROM");
 	return 0;
@@ -375,14 +340,14 @@ int password_storage_reset(void)
 	/* Reset to defaults */
 	load_default_password();
 	current_flags = 0;
+	failed_attempts = 0;
 
 	if (!eeprom_available) {
 		LOG_WRN("EEPROM not available, password reset in RAM only");
 		return 0;
 	}
 
-	/* Reinitialize EEPROM with defaults */
-	ret = init_eeprom_defaults();
+	ret = store_all();
 	if (ret < 0) {
 		LOG_ERR("Failed to reset EEPROM: %d", ret);
 		return ret;
@@ -399,10 +364,6 @@ bool password_storage_is_available(void)
 
 void password_storage_set_master_used(void)
 {
-	uint8_t buf[STORAGE_SIZE];
-	uint16_t crc;
-	int ret;
-
 	/* Already set - skip EEPROM write to reduce wear */
 	if (current_flags & FLAG_MASTER_USED) {
 		return;
@@ -415,28 +376,7 @@ void password_storage_set_master_used(void)
 		return;
 	}
 
-	/* Read current storage */
-	ret = eeprom_read_storage(buf, STORAGE_SIZE);
-	if (ret < 0) {
-		LOG_ERR("Failed to read EEPROM for master flag: %d", ret);
-		return;
-	}
-
-	/* Update flags */
-	buf[OFF_FLAGS] |= FLAG_MASTER_USED;
-
-	/* Recalculate CRC */
-	crc = crc16_ccitt(buf, OFF_CRC);
-	buf[OFF_CRC + 0] = (crc >> 0) & 0xFF;
-	buf[OFF_CRC + 1] = (crc >> 8) & 0xFF;
-
-	/* Write back with verification */
-	ret = eeprom_write_verified(buf, STORAGE_SIZE);
-	if (ret < 0) {
-		LOG_ERR("Failed to write master flag: %d", ret);
-		return;
-	}
-
+	kv_write_background(KV_KEY_PW_FLAGS, &current_flags, 1, "master flag");
 	LOG_WRN("Master password usage recorded");
 }
 
@@ -452,8 +392,6 @@ uint8_t password_storage_get_failed_attempts(void)
 
 void password_storage_inc_failed_attempts(void)
 {
-	uint8_t buf[STORAGE_SIZE];
-	uint16_t crc;
 	int ret;
 
 	/* Increment in RAM (cap at 255) */
@@ -465,23 +403,9 @@ void password_storage_inc_failed_attempts(void)
 		return;
 	}
 
-	/* Read current storage */
-	ret = eeprom_read_storage(buf, STORAGE_SIZE);
-	if (ret < 0) {
-		LOG_ERR("Failed to read EEPROM for failed attempts: %d", ret);
-		return;
-	}
-
-	/* Update failed attempts */
-	buf[OFF_FAILED_ATTEMPTS] = failed_attempts;
-
-	/* Recalculate CRC */
-	crc = crc16_ccitt(buf, OFF_CRC);
-	buf[OFF_CRC + 0] = (crc >> 0) & 0xFF;
-	buf[OFF_CRC + 1] = (crc >> 8) & 0xFF;
-
-	/* Write back (without verification for speed - this is frequently updated) */
-	ret = eeprom_write_storage(buf, STORAGE_SIZE);
+	/* Single-page append, not verified (this is frequently updated) */
+	ret = kv_store_write(KV_KEY_PW_FAILED, &failed_attempts, 1,
+			     write_done, (void *)"failed attempts");
 	if (ret < 0) {
 		LOG_ERR("Failed to save failed attempts: %d", ret);
 	}
@@ -489,10 +413,6 @@ void password_storage_inc_failed_attempts(void)
 
 void password_storage_clear_failed_attempts(void)
 {
-	uint8_t buf[STORAGE_SIZE];
-	uint16_t crc;
-	int ret;
-
 	/* Already zero - skip EEPROM write */
 	if (failed_attempts == 0) {
 		return;
@@ -505,26 +425,8 @@ void password_storage_clear_failed_attempts(void)
 		return;
 	}
 
-	/* Read current storage */
-	ret = eeprom_read_storage(buf, STORAGE_SIZE);
-	if (ret < 0) {
-		LOG_ERR("Failed to read EEPROM for clear attempts: %d", ret);
-		return;
-	}
-
-	/* Clear failed attempts */
-	buf[OFF_FAILED_ATTEMPTS] = 0;
-
-	/* Recalculate CRC */
-	crc = crc16_ccitt(buf, OFF_CRC);
-	buf[OFF_CRC + 0] = (crc >> 0) & 0xFF;
-	buf[OFF_CRC + 1] = (crc >> 8) & 0xFF;
-
-	/* Write back with verification (this is important for security) */
-	ret = eeprom_write_verified(buf, STORAGE_SIZE);
-	if (ret < 0) {
-		LOG_ERR("Failed to clear failed attempts: %d", ret);
-	}
+	/* Write with verification (this is important for security) */
+	kv_write_background(KV_KEY_PW_FAILED, &failed_attempts, 1, "failed attempts");
 }
 
 bool password_storage_is_password_changed(void)
@@ -40,6 +40,7 @@ static int64_t tag_blink_start;
 static bool error_active;
 static bool error_on;
 static int64_t error_last;
+static rgb_led_wake_cb_t wake_cb;
 
 #define TAG_BLINK_DURATION_MS  150
 #define ERROR_BLINK_INTERVAL_MS 200
@@ -242,10 +243,28 @@ void rgb_led_test(void)
 	LOG_INF("RGB LED test complete");
 }
 
-void rgb_led_poll(void)
+/** Flag a change for rgb_led_poll() and wake whoever calls it */
+static void mark_dirty(void)
 {
+	rgb_led_wake_cb_t cb = wake_cb;
+
+	led_dirty = true;
+	if (cb != NULL) {
+		cb();
+	}
+}
+
+void rgb_led_set_wake_callback(rgb_led_wake_cb_t cb)
+{
+	wake_cb = cb;
+}
+
+int32_t rgb_led_poll(void)
+{
+	int32_t next = SYS_FOREVER_MS;
+
 	if (!initialized) {
-		return;
+		return SYS_FOREVER_MS;
 	}
 
 	int64_t now = k_uptime_get();
@@ -262,14 +281,21 @@ void rgb_led_poll(void)
 			}
 			led_dirty = true;
 		}
+		next = (int32_t)(error_last + ERROR_BLINK_INTERVAL_MS - now);
 	}
 
 	/* Tag blink timeout → return to base color */
-	if (tag_blink_active && (now - tag_blink_start) >= TAG_BLINK_DURATION_MS) {
-		tag_blink_active = false;
-		if (!error_active) {
-			apply_base_color();
-			led_dirty = true;
+	if (tag_blink_active) {
+		int32_t left = (int32_t)(tag_blink_start + TAG_BLINK_DURATION_MS - now);
+
+		if (left <= 0) {
+			tag_blink_active = false;
+			if (!error_active) {
+				apply_base_color();
+				led_dirty = true;
+			}
+		} else if (next == SYS_FOREVER_MS || left < next) {
+			next = left;
 		}
 	}
 
@@ -277,6 +303,8 @@ void rgb_led_poll(void)
 		rgb_led_update();
 		led_dirty = false;
 	}
+
+	return next;
 }
 
 void rgb_led_set_inventory_status(bool running)
@@ -284,7 +312,7 @@ void rgb_led_set_inventory_status(bool running)
 	inventory_running = running;
 	if (!error_active && !tag_blink_active) {
 		apply_base_color();
-		led_dirty = true;
+		mark_dirty();
 	}
 }
 
@@ -296,7 +324,7 @@ void rgb_led_notify_tag_read(void)
 	rgb_led_clear();
 	tag_blink_active = true;
 	tag_blink_start = k_uptime_get();
-	led_dirty = true;
+	mark_dirty();
 }
 
 void rgb_led_set_error(bool active)
@@ -304,12 +332,12 @@ void rgb_led_set_error(bool active)
 	error_active = active;
 	if (!active) {
 		apply_base_color();
-		led_dirty = true;
+		mark_dirty();
 	} else {
 		error_last = k_uptime_get();
 		error_on = true;
 		rgb_led_set_all(LED_BRIGHTNESS, 0, 0);
-		led_dirty = true;
+		mark_dirty();
 	}
 }
 
@@ -99,12 +99,23 @@ uint8_t rgb_led_get_brightness(void);
  */
 void rgb_led_test(void);
 
+/** Called (any context) when rgb_led_poll() has new work */
+typedef void (*rgb_led_wake_cb_t)(void);
+
+/**
+ * @brief Register the wake callback of the thread calling rgb_led_poll()
+ */
+void rgb_led_set_wake_callback(rgb_led_wake_cb_t cb);
+
 /**
  * @brief Poll LED state — call from main loop
  *
- * Handles tag blink timeout, error blink, and batched updates.
+ * Handles tag blink timeout, error blink, and batched updates. Call it
+ * when woken and again once the returned time has passed.
+ *
+ * @return ms until the next call is due, SYS_FOREVER_MS if none
  */
-void rgb_led_poll(void);
+int32_t rgb_led_poll(void);
 
 /**
  * @brief Set inventory status (all 7 LEDs)
@@ -115,6 +126,9 @@ void rgb_led_set_inventory_status(bool running);
 
 /**
  * @brief Notify tag read — all LEDs blink BLUE for 100ms
+ *
+ * Called by the feedback coalescer, from its timer ISR; only marks the
+ * LED dirty, the refresh happens in rgb_led_poll().
  */
 void rgb_led_notify_tag_read(void);
 
@@ -0,0 +1,233 @@
+/**
+ * @file router_metrics.c
+ * @brief Windowed Router Throughput Metrics Implementation
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#include "router_metrics.h"
+#include "usb_hid.h"
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/uart.h>
+#include <string.h>
+
+/** Fallback when the driver cannot report its configuration */
+#define ROUTER_METRICS_DEFAULT_BAUD     115200
+
+/** UART bits per byte on the wire: start + 8 data + stop */
+#define UART_BITS_PER_BYTE              10
+
+/** A source counter dropping by more than this was reset, not wrapped */
+#define COUNTER_RESET_THRESHOLD         0x80000000UL
+
+static const uint8_t window_sec[ROUTER_WINDOW_COUNT] = { 1, 10, 60 };
+
+static struct {
+	/* Per-second deltas, hist[m][head] is the most recent second */
+	uint32_t hist[ROUTER_METRIC_COUNT][ROUTER_METRICS_HISTORY_SEC];
+	uint8_t head;
+	uint8_t filled;             /**< Seconds recorded, up to HISTORY_SEC */
+	uint64_t total[ROUTER_METRIC_COUNT];
+	uint32_t last[ROUTER_METRIC_COUNT];
+	bool baseline;              /**< last[] holds valid counter values */
+	int64_t next_roll_ms;
+
+	uint32_t rounds;
+	uint32_t round_last_ms;
+	uint32_t round_min_ms;
+	uint32_t round_max_ms;
+	uint64_t round_sum_ms;
+
+	uint32_t baud;
+} metrics;
+
+static struct k_spinlock metrics_lock;
+
+static const char *const metric_names[ROUTER_METRIC_COUNT] = {
+	[ROUTER_METRIC_READS]     = "Reads",
+	[ROUTER_METRIC_UNIQUE]    = "Unique tags",
+	[ROUTER_METRIC_FRAMES]    = "Frames",
+	[ROUTER_METRIC_UART4_RX]  = "UART4 RX bytes",
+	[ROUTER_METRIC_UART4_TX]  = "UART4 TX bytes",
+	[ROUTER_METRIC_HID_CHARS] = "HID chars",
+};
+
+/**
+ * @brief Read the current source counters
+ */
+static void read_counters(uart_router_t *router, uint32_t cur[ROUTER_METRIC_COUNT])
+{
+	struct usb_hid_stats hid;
+
+	usb_hid_get_stats(&hid);
+
+	cur[ROUTER_METRIC_READS] = router->stats.tags_read;
+	cur[ROUTER_METRIC_UNIQUE] = router->stats.unique_tags;
+	cur[ROUTER_METRIC_FRAMES] = router->stats.frames_parsed;
+	cur[ROUTER_METRIC_UART4_RX] = router->stats.uart4_rx_bytes;
+	cur[ROUTER_METRIC_UART4_TX] = router->stats.uart4_tx_bytes;
+	cur[ROUTER_METRIC_HID_CHARS] = hid.chars_sent;
+}
+
+void router_metrics_init(uart_router_t *router)
+{
+	struct uart_config cfg;
+
+	router_metrics_reset();
+
+	metrics.baud = ROUTER_METRICS_DEFAULT_BAUD;
+	if (uart_config_get(router->uart4, &cfg) == 0 && cfg.baudrate > 0) {
+		metrics.baud = cfg.baudrate;
+	}
+}
+
+void router_metrics_poll(uart_router_t *router)
+{
+	uint32_t cur[ROUTER_METRIC_COUNT];
+	int64_t now = k_uptime_get();
+
+	if (now < metrics.next_roll_ms) {
+		return;
+	}
+
+	read_counters(router, cur);
+
+	k_spinlock_key_t key = k_spin_lock(&metrics_lock);
+
+	if (!metrics.baseline) {
+		memcpy(metrics.last, cur, sizeof(metrics.last));
+		metrics.baseline = true;
+		metrics.next_roll_ms = now + MSEC_PER_SEC;
+		k_spin_unlock(&metrics_lock, key);
+		return;
+	}
+
+	/*
+	 * Seconds elapsed since the last roll. If the caller stalled, the
+	 * whole delta lands in the newest slot and skipped seconds read 0.
+	 */
+	uint32_t steps = 1 + (uint32_t)((now - metrics.next_roll_ms) / MSEC_PER_SEC);
+
+	steps = MIN(steps, ROUTER_METRICS_HISTORY_SEC);
+
+	for (uint32_t s = 0; s < steps; s++) {
+		metrics.head = (metrics.head + 1) % ROUTER_METRICS_HISTORY_SEC;
+		for (int m = 0; m < ROUTER_METRIC_COUNT; m++) {
+			metrics.hist[m][metrics.head] = 0;
+		}
+		if (metrics.filled < ROUTER_METRICS_HISTORY_SEC) {
+			metrics.filled++;
+		}
+	}
+
+	for (int m = 0; m < ROUTER_METRIC_COUNT; m++) {
+		uint32_t delta = cur[m] - metrics.last[m];
+
+		if (delta >= COUNTER_RESET_THRESHOLD) {
+			delta = 0; /* Source statistics were reset */
+		}
+		metrics.hist[m][metrics.head] = delta;
+		metrics.total[m] += delta;
+		metrics.last[m] = cur[m];
+	}
+
+	metrics.next_roll_ms = now + MSEC_PER_SEC;
+	k_spin_unlock(&metrics_lock, key);
+}
+
+void router_metrics_round_done(uint32_t duration_ms)
+{
+	k_spinlock_key_t key = k_spin_lock(&metrics_lock);
+
+	if (metrics.rounds == 0 || duration_ms < metrics.round_min_ms) {
+		metrics.round_min_ms = duration_ms;
+	}
+	metrics.round_max_ms = MAX(metrics.round_max_ms, duration_ms);
+	metrics.round_last_ms = duration_ms;
+	metrics.round_sum_ms += duration_ms;
+	metrics.rounds++;
+
+	k_spin_unlock(&metrics_lock, key);
+}
+
+void router_metrics_reset(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&metrics_lock);
+	uint32_t baud = metrics.baud;
+
+	memset(&metrics, 0, sizeof(metrics));
+	metrics.baud = baud;
+	k_spin_unlock(&metrics_lock, key);
+}
+
+/**
+ * @brief Sum of the newest @p sec slots of one metric
+ */
+static uint64_t window_sum(int m, uint8_t sec)
+{
+	uint64_t sum = 0;
+	uint8_t idx = metrics.head;
+
+	for (uint8_t i = 0; i < sec; i++) {
+		sum += metrics.hist[m][idx];
+		idx = (idx + ROUTER_METRICS_HISTORY_SEC - 1) % ROUTER_METRICS_HISTORY_SEC;
+	}
+	return sum;
+}
+
+static uint16_t util_x100(uint64_t bytes_x10_per_sec, uint32_t baud)
+{
+	/* (bytes/s x10) x bits/byte / baud = fraction x10; x1000 → percent x100 */
+	uint64_t pct = bytes_x10_per_sec * UART_BITS_PER_BYTE * 1000 / baud;
+
+	return (uint16_t)MIN(pct, UINT16_MAX);
+}
+
+void router_metrics_get_snapshot(router_metrics_snapshot_t *snap)
+{
+	memset(snap, 0, sizeof(*snap));
+	snap->version = ROUTER_METRICS_SNAPSHOT_VERSION;
+	snap->metric_count = ROUTER_METRIC_COUNT;
+	snap->size = sizeof(*snap);
+	snap->uptime_ms = (uint32_t)k_uptime_get();
+
+	k_spinlock_key_t key = k_spin_lock(&metrics_lock);
+
+	snap->uart4_baud = metrics.baud;
+	memcpy(snap->total, metrics.total, sizeof(snap->total));
+
+	for (int w = 0; w < ROUTER_WINDOW_COUNT; w++) {
+		uint8_t sec = MIN(window_sec[w], metrics.filled);
+
+		if (sec == 0) {
+			continue;
+		}
+		for (int m = 0; m < ROUTER_METRIC_COUNT; m++) {
+			snap->rate_x10[m][w] =
+				(uint32_t)(window_sum(m, sec) * 10 / sec);
+		}
+		snap->uart4_rx_util_x100[w] =
+			util_x100(snap->rate_x10[ROUTER_METRIC_UART4_RX][w],
+				  metrics.baud);
+		snap->uart4_tx_util_x100[w] =
+			util_x100(snap->rate_x10[ROUTER_METRIC_UART4_TX][w],
+				  metrics.baud);
+	}
+
+	snap->rounds = metrics.rounds;
+	snap->round_last_ms = metrics.round_last_ms;
+	snap->round_min_ms = metrics.round_min_ms;
+	snap->round_max_ms = metrics.round_max_ms;
+	snap->round_avg_ms = metrics.rounds ?
+			     (uint32_t)(metrics.round_sum_ms / metrics.rounds) : 0;
+
+	k_spin_unlock(&metrics_lock, key);
+}
+
+const char *router_metrics_name(enum router_metric metric)
+{
+	if (metric >= ROUTER_METRIC_COUNT) {
+		return "?";
+	}
+	return metric_names[metric];
+}
@@ -0,0 +1,132 @@
+/**
+ * @file router_metrics.h
+ * @brief Windowed Router Throughput Metrics
+ *
+ * Samples the router and HID counters once per second into a 60-slot
+ * history, giving 1 s / 10 s / 60 s sliding-window rates and 64-bit
+ * lifetime totals that do not wrap. Also tracks inventory round
+ * duration and UART4 line utilisation against the configured baud rate.
+ *
+ * The 32-bit source counters may wrap: only their per-second deltas
+ * are used, which unsigned arithmetic handles.
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#ifndef ROUTER_METRICS_H_
+#define ROUTER_METRICS_H_
+
+#include <stdint.h>
+#include "uart_router.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup router_metrics Router Metrics
+ * @{
+ */
+
+/** Seconds of per-second history (longest window) */
+#define ROUTER_METRICS_HISTORY_SEC      60
+
+/** Binary snapshot layout version */
+#define ROUTER_METRICS_SNAPSHOT_VERSION 1
+
+/**
+ * @brief Counted quantities
+ */
+enum router_metric {
+	ROUTER_METRIC_READS = 0,    /**< Tag records decoded */
+	ROUTER_METRIC_UNIQUE,       /**< EPCs not in the duplicate cache */
+	ROUTER_METRIC_FRAMES,       /**< E310 frames parsed */
+	ROUTER_METRIC_UART4_RX,     /**< UART4 bytes received */
+	ROUTER_METRIC_UART4_TX,     /**< UART4 bytes sent */
+	ROUTER_METRIC_HID_CHARS,    /**< HID characters typed */
+	ROUTER_METRIC_COUNT,
+};
+
+/**
+ * @brief Rate windows
+ */
+enum router_window {
+	ROUTER_WINDOW_1S = 0,
+	ROUTER_WINDOW_10S,
+	ROUTER_WINDOW_60S,
+	ROUTER_WINDOW_COUNT,
+};
+
+/**
+ * @brief Metrics snapshot (also the binary format for host tools)
+ *
+ * Packed, little endian. Rates are per second x10, utilisation is
+ * percent x100. Windows shorter than the uptime are averaged over the
+ * seconds actually recorded.
+ */
+typedef struct __attribute__((packed)) {
+	uint8_t  version;           /**< ROUTER_METRICS_SNAPSHOT_VERSION */
+	uint8_t  metric_count;      /**< ROUTER_METRIC_COUNT */
+	uint16_t size;              /**< sizeof(router_metrics_snapshot_t) */
+	uint32_t uptime_ms;         /**< k_uptime at snapshot */
+	uint32_t uart4_baud;        /**< Baud rate used for utilisation */
+	uint64_t total[ROUTER_METRIC_COUNT];      /**< Lifetime totals */
+	uint32_t rate_x10[ROUTER_METRIC_COUNT][ROUTER_WINDOW_COUNT];
+	uint16_t uart4_rx_util_x100[ROUTER_WINDOW_COUNT];
+	uint16_t uart4_tx_util_x100[ROUTER_WINDOW_COUNT];
+	uint32_t rounds;            /**< Completed inventory rounds */
+	uint32_t round_last_ms;     /**< Duration of the latest round */
+	uint32_t round_min_ms;
+	uint32_t round_max_ms;
+	uint32_t round_avg_ms;
+} router_metrics_snapshot_t;
+
+/**
+ * @brief Initialise metrics for a router
+ *
+ * Reads the UART4 baud rate from the driver (115200 if unavailable).
+ *
+ * @param router Router whose counters are sampled
+ */
+void router_metrics_init(uart_router_t *router);
+
+/**
+ * @brief Roll the per-second history if a second has elapsed
+ *
+ * Cheap when nothing is due; called from every router thread poll.
+ *
+ * @param router Router whose counters are sampled
+ */
+void router_metrics_poll(uart_router_t *router);
+
+/**
+ * @brief Record a completed inventory round
+ *
+ * @param duration_ms Command sent → round-complete status
+ */
+void router_metrics_round_done(uint32_t duration_ms);
+
+/**
+ * @brief Discard history, totals and round statistics
+ */
+void router_metrics_reset(void);
+
+/**
+ * @brief Take a consistent snapshot
+ *
+ * @param snap Output: snapshot
+ */
+void router_metrics_get_snapshot(router_metrics_snapshot_t *snap);
+
+/**
+ * @brief Short display name of a metric
+ */
+const char *router_metrics_name(enum router_metric metric);
+
+/** @} */ /* End of router_metrics group */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ROUTER_METRICS_H_ */
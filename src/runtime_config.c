@@ -0,0 +1,98 @@
+/**
+ * @file runtime_config.c
+ * @brief Versioned Runtime Configuration Implementation
+ *
+ * Two buffers: the published one and the one the next writer fills.
+ * Each buffer has a sequence counter that is odd while it is being
+ * written, which lets a reader detect that the buffer it copied from was
+ * rewritten under it (two publishes during one copy).
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#include "runtime_config.h"
+#include "e310_settings.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+struct config_buf {
+	atomic_t seq;
+	runtime_config_t cfg;
+};
+
+#define CONFIG_DEFAULTS {                                               \
+	.version = 1,                                                   \
+	.epc_debounce_ms = E310_DEFAULT_EPC_DEBOUNCE_SEC * 1000,        \
+	.inventory_interval_ms = E310_DEFAULT_INV_INTERVAL_MS,          \
+	.typing_speed_cpm = E310_DEFAULT_TYPING_SPEED,                  \
+	.beep_pulse_ms = E310_DEFAULT_BEEP_PULSE_MS,                    \
+	.beep_filter_ms = E310_DEFAULT_BEEP_FILTER_MS,                  \
+	.rf_power = E310_DEFAULT_RF_POWER,                              \
+	.antenna_config = E310_DEFAULT_ANTENNA,                         \
+	.freq_region = E310_DEFAULT_FREQ_REGION,                        \
+	.freq_start = E310_DEFAULT_FREQ_START,                          \
+	.freq_end = E310_DEFAULT_FREQ_END,                              \
+	.inventory_time = E310_DEFAULT_INVENTORY_TIME,                  \
+}
+
+static struct config_buf bufs[2] = {
+	{ .cfg = CONFIG_DEFAULTS },
+	{ .cfg = CONFIG_DEFAULTS },
+};
+
+static atomic_ptr_t current = ATOMIC_PTR_INIT(&bufs[0]);
+
+K_MUTEX_DEFINE(writer_lock);
+
+void runtime_config_get(runtime_config_t *cfg)
+{
+	struct config_buf *b;
+	atomic_val_t seq;
+
+	do {
+		b = atomic_ptr_get(&current);
+		seq = atomic_get(&b->seq);
+		*cfg = b->cfg;
+		/* atomic_get() is a full barrier: the copy is done before the re-check */
+	} while ((seq & 1) != 0 || atomic_get(&b->seq) != seq);
+}
+
+uint32_t runtime_config_version(void)
+{
+	const struct config_buf *b = atomic_ptr_get(&current);
+
+	return b->cfg.version;
+}
+
+runtime_config_t *runtime_config_edit(void)
+{
+	struct config_buf *cur;
+	struct config_buf *next;
+
+	k_mutex_lock(&writer_lock, K_FOREVER);
+
+	cur = atomic_ptr_get(&current);
+	next = (cur == &bufs[0]) ? &bufs[1] : &bufs[0];
+
+	/* Odd: readers still copying from this buffer will retry */
+	atomic_inc(&next->seq);
+	next->cfg = cur->cfg;
+
+	return &next->cfg;
+}
+
+uint32_t runtime_config_publish(void)
+{
+	struct config_buf *cur = atomic_ptr_get(&current);
+	struct config_buf *next = (cur == &bufs[0]) ? &bufs[1] : &bufs[0];
+	uint32_t version;
+
+	next->cfg.version = cur->cfg.version + 1;
+	version = next->cfg.version;
+
+	atomic_inc(&next->seq);
+	atomic_ptr_set(&current, next);
+
+	k_mutex_unlock(&writer_lock);
+	return version;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file runtime_config.h
+ * @brief Versioned Runtime Configuration
+ *
+ * The live values the hot path works with (EPC debounce, inventory
+ * interval, typing speed, beeper timing) and the reader-side values the
+ * E310 should run with, in one object. Writers fill the inactive copy
+ * and publish it with an atomic pointer swap; readers never lock.
+ *
+ * Readers take a snapshot with runtime_config_get(): every field of a
+ * snapshot comes from the same version. A reader that raced a second
+ * publish into the buffer it was copying notices through the buffer's
+ * sequence counter and copies again.
+ *
+ * Host-side fields take effect at a reader's next snapshot. Reader-side
+ * fields are pushed to the E310 by the router at the next round boundary
+ * (see uart_router_wait_config()), so inventory is never stopped for
+ * a change.
+ *
+ * Writers are serialised by a mutex: thread context only.
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#ifndef RUNTIME_CONFIG_H_
+#define RUNTIME_CONFIG_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup runtime_config Runtime Configuration
+ * @{
+ */
+
+/**
+ * @brief Runtime configuration snapshot
+ */
+typedef struct {
+	uint32_t version;               /**< Bumped by every publish */
+
+	/* Host side: used by the next snapshot */
+	uint32_t epc_debounce_ms;       /**< EPC duplicate window */
+	uint32_t inventory_interval_ms; /**< Between rounds (0 = single-shot) */
+	uint16_t typing_speed_cpm;      /**< HID typing speed */
+	uint16_t beep_pulse_ms;         /**< Beeper pulse width */
+	uint16_t beep_filter_ms;        /**< Beeper duplicate filter */
+
+	/* Reader side: sent to the E310 at the next round boundary */
+	uint8_t rf_power;               /**< dBm */
+	uint8_t antenna_config;         /**< Antenna mux byte */
+	uint8_t freq_region;            /**< 1=CN, 2=US, 3=EU, 4=KR */
+	uint8_t freq_start;             /**< First frequency point */
+	uint8_t freq_end;               /**< Last frequency point */
+	uint8_t inventory_time;         /**< E310 inventory time (x100 ms) */
+} runtime_config_t;
+
+/**
+ * @brief Take a consistent snapshot of the current configuration
+ *
+ * Lock-free; callable from any context, ISRs included.
+ *
+ * @param cfg Output
+ */
+void runtime_config_get(runtime_config_t *cfg);
+
+/**
+ * @brief Get the current version without copying
+ *
+ * @return Version of the last published configuration
+ */
+uint32_t runtime_config_version(void);
+
+/**
+ * @brief Start an update
+ *
+ * Locks out other writers and returns the inactive copy, pre-filled with
+ * the current values. Change the fields, then runtime_config_publish().
+ *
+ * @return Writable configuration (valid until publish)
+ */
+runtime_config_t *runtime_config_edit(void);
+
+/**
+ * @brief Publish the copy returned by runtime_config_edit()
+ *
+ * @return The new version
+ */
+uint32_t runtime_config_publish(void);
+
+/** @} */ /* End of runtime_config group */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RUNTIME_CONFIG_H_ */
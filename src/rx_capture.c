@@ -0,0 +1,136 @@
+/**
+ * @file rx_capture.c
+ * @brief UART4 RX Byte-Stream Capture Implementation
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#include "rx_capture.h"
+#include <zephyr/kernel.h>
+#include <string.h>
+#include <errno.h>
+
+static uint8_t capture_buf[RX_CAPTURE_BUF_SIZE];
+static uint32_t capture_used;
+static uint32_t capture_chunks;
+static uint32_t capture_bytes;
+static uint32_t capture_last_us;
+static bool capture_active;
+static bool capture_full;
+static uint64_t capture_start_cyc;
+static struct k_spinlock capture_lock;
+
+/**
+ * @brief Current time in hardware cycles, cycle resolution, 64-bit
+ */
+static uint64_t capture_now_cyc(void)
+{
+#if defined(CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER)
+	return k_cycle_get_64();
+#else
+	/*
+	 * The 32-bit cycle counter wraps every few seconds at full clock;
+	 * the tick count says how many wraps have passed and the cycle
+	 * counter (the low 32 bits of the same count, ahead of the last
+	 * tick by less than one tick) gives the resolution.
+	 */
+	uint64_t coarse = k_ticks_to_cyc_floor64(k_uptime_ticks());
+
+	return coarse + (int32_t)(k_cycle_get_32() - (uint32_t)coarse);
+#endif
+}
+
+void rx_capture_start(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&capture_lock);
+
+	capture_used = 0;
+	capture_chunks = 0;
+	capture_bytes = 0;
+	capture_last_us = 0;
+	capture_full = false;
+	capture_start_cyc = capture_now_cyc();
+	capture_active = true;
+	k_spin_unlock(&capture_lock, key);
+}
+
+void rx_capture_stop(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&capture_lock);
+
+	capture_active = false;
+	k_spin_unlock(&capture_lock, key);
+}
+
+void rx_capture_chunk(const uint8_t *data, size_t len, uint8_t flags)
+{
+	rx_capture_hdr_t hdr;
+
+	if (!capture_active || len == 0) {
+		return;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&capture_lock);
+
+	if (!capture_active) {
+		k_spin_unlock(&capture_lock, key);
+		return;
+	}
+
+	if (capture_used + sizeof(hdr) + len > RX_CAPTURE_BUF_SIZE) {
+		capture_active = false;
+		capture_full = true;
+		k_spin_unlock(&capture_lock, key);
+		return;
+	}
+
+	hdr.timestamp_us = (uint32_t)k_cyc_to_us_floor64(capture_now_cyc() -
+							 capture_start_cyc);
+	hdr.len = (uint8_t)len;
+	hdr.flags = flags;
+
+	memcpy(&capture_buf[capture_used], &hdr, sizeof(hdr));
+	memcpy(&capture_buf[capture_used + sizeof(hdr)], data, len);
+	capture_used += sizeof(hdr) + len;
+	capture_chunks++;
+	capture_bytes += len;
+	capture_last_us = hdr.timestamp_us;
+
+	k_spin_unlock(&capture_lock, key);
+}
+
+void rx_capture_get_status(rx_capture_status_t *status)
+{
+	k_spinlock_key_t key = k_spin_lock(&capture_lock);
+
+	status->active = capture_active;
+	status->full = capture_full;
+	status->chunks = capture_chunks;
+	status->bytes = capture_bytes;
+	status->used = capture_used;
+	status->duration_us = capture_last_us;
+	k_spin_unlock(&capture_lock, key);
+}
+
+int rx_capture_foreach(void (*fn)(const rx_capture_hdr_t *hdr,
+				  const uint8_t *data, void *user_data),
+		       void *user_data)
+{
+	rx_capture_hdr_t hdr;
+	uint32_t pos = 0;
+	int visited = 0;
+
+	if (capture_active) {
+		return -EBUSY;
+	}
+
+	while (pos + sizeof(hdr) <= capture_used) {
+		memcpy(&hdr, &capture_buf[pos], sizeof(hdr));
+		pos += sizeof(hdr);
+		fn(&hdr, &capture_buf[pos], user_data);
+		pos += hdr.len;
+		visited++;
+	}
+
+	return visited;
+}
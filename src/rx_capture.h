@@ -0,0 +1,111 @@
+/**
+ * @file rx_capture.h
+ * @brief UART4 RX Byte-Stream Capture
+ *
+ * Records raw UART4 RX bytes exactly as the ISR drains them from the
+ * FIFO, each chunk stamped with a microsecond timestamp taken from the
+ * hardware cycle counter (not the kernel tick). Unlike the frame
+ * trace, nothing is assembled or dropped: the capture is a faithful copy
+ * of the line, meant for replay on native_sim (tests/router_sim).
+ *
+ * Capture stops when the buffer is full so a capture is always a
+ * contiguous stream starting at `e310 capture start`.
+ *
+ * Download: `e310 capture dump` prints the chunks over the shell, and
+ * tools/capture2bin.py turns that text into a replayable .bin file.
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#ifndef RX_CAPTURE_H_
+#define RX_CAPTURE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup rx_capture RX Capture
+ * @{
+ */
+
+/** Capture buffer size in bytes (chunk headers included) */
+#define RX_CAPTURE_BUF_SIZE         32768
+
+/**
+ * @brief Capture chunk header (followed by @ref len data bytes)
+ */
+typedef struct __attribute__((packed)) {
+	uint32_t timestamp_us;      /**< Microseconds since capture start */
+	uint8_t  len;               /**< Data bytes in this chunk */
+	uint8_t  flags;             /**< RX_CAPTURE_FLAG_* */
+} rx_capture_hdr_t;
+
+/** Router RX ring overflowed while storing this chunk */
+#define RX_CAPTURE_FLAG_OVERRUN     0x01
+
+/**
+ * @brief Capture status
+ */
+typedef struct {
+	bool active;                /**< Capture running */
+	bool full;                  /**< Stopped because the buffer filled */
+	uint32_t chunks;            /**< Chunks stored */
+	uint32_t bytes;             /**< RX data bytes stored */
+	uint32_t used;              /**< Buffer bytes used (with headers) */
+	uint32_t duration_us;       /**< Timestamp of the last chunk */
+} rx_capture_status_t;
+
+/**
+ * @brief Clear the buffer and start capturing
+ */
+void rx_capture_start(void);
+
+/**
+ * @brief Stop capturing (buffer is kept for download)
+ */
+void rx_capture_stop(void);
+
+/**
+ * @brief Store one chunk of received bytes (ISR context)
+ *
+ * No-op unless capture is active. Cheap enough for the UART ISR:
+ * a timestamp and a memcpy under a spinlock.
+ *
+ * @param data Bytes read from the UART FIFO
+ * @param len Number of bytes (<= 255)
+ * @param flags RX_CAPTURE_FLAG_* bits
+ */
+void rx_capture_chunk(const uint8_t *data, size_t len, uint8_t flags);
+
+/**
+ * @brief Get capture status
+ *
+ * @param status Output: status structure
+ */
+void rx_capture_get_status(rx_capture_status_t *status);
+
+/**
+ * @brief Visit stored chunks in order
+ *
+ * Only valid while capture is stopped.
+ *
+ * @param fn Visitor, called once per chunk
+ * @param user_data Passed to @p fn
+ * @return Number of chunks visited, or -EBUSY while capturing
+ */
+int rx_capture_foreach(void (*fn)(const rx_capture_hdr_t *hdr,
+				  const uint8_t *data, void *user_data),
+		       void *user_data);
+
+/** @} */ /* End of rx_capture group */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RX_CAPTURE_H_ */
@@ -45,6 +45,7 @@ static const struct gpio_dt_spec sw_pwr = GPIO_DT_SPEC_GET(SW_PWR_NODE, gpios);
 /* State variables — atomic for ISR/thread safety */
 static atomic_t inventory_running = ATOMIC_INIT(0);
 static volatile inventory_toggle_cb_t toggle_callback;
+static volatile inventory_state_cb_t state_callback;
 static struct gpio_callback sw0_cb_data;
 
 static struct k_work_delayable debounce_work;
@@ -162,7 +163,17 @@ bool switch_control_is_inventory_running(void)
 
 void switch_control_set_inventory_state(bool running)
 {
-	atomic_set(&inventory_running, running ? 1 : 0);
+	inventory_state_cb_t cb = state_callback;
+
+	if (atomic_set(&inventory_running, running ? 1 : 0) != (running ? 1 : 0) &&
+	    cb != NULL) {
+		cb(running);
+	}
+}
+
+void switch_control_set_state_callback(inventory_state_cb_t cb)
+{
+	state_callback = cb;
 }
 
 /* ========================================================================
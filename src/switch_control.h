@@ -19,6 +19,9 @@
 /** Inventory toggle callback type */
 typedef void (*inventory_toggle_cb_t)(bool start);
 
+/** Called (any context) when the inventory running state changes */
+typedef void (*inventory_state_cb_t)(bool running);
+
 /**
  * @brief Initialize switch control
  *
@@ -51,4 +54,12 @@ bool switch_control_is_inventory_running(void);
  */
 void switch_control_set_inventory_state(bool running);
 
+/**
+ * @brief Register inventory state change callback
+ *
+ * @param cb Callback run on every change made through
+ *        switch_control_set_inventory_state()
+ */
+void switch_control_set_state_callback(inventory_state_cb_t cb);
+
 #endif /* SWITCH_CONTROL_H */
@@ -0,0 +1,379 @@
+/**
+ * @file sys_monitor.c
+ * @brief Thread CPU and Stack Telemetry Implementation
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#include "sys_monitor.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#define STACKS_AVAILABLE (IS_ENABLED(CONFIG_THREAD_MONITOR) && \
+			  IS_ENABLED(CONFIG_THREAD_STACK_INFO) && \
+			  IS_ENABLED(CONFIG_INIT_STACKS))
+
+/* ========================================================================
+ * Stack High-Water Marks
+ * ======================================================================== */
+
+struct stack_usage {
+	size_t size;
+	size_t used;
+	bool valid;
+};
+
+static void get_stack_usage(struct k_thread *thread, struct stack_usage *su)
+{
+	su->valid = false;
+#if STACKS_AVAILABLE
+	size_t unused;
+
+	su->size = thread->stack_info.size;
+	if (su->size > 0 && k_thread_stack_space_get(thread, &unused) == 0) {
+		su->used = su->size - unused;
+		su->valid = true;
+	}
+#else
+	ARG_UNUSED(thread);
+#endif
+}
+
+static const char *thread_label(struct k_thread *thread)
+{
+	const char *name = k_thread_name_get(thread);
+
+	return (name && name[0]) ? name : "?";
+}
+
+#if STACKS_AVAILABLE
+static void print_stack_usage(const struct k_thread *cthread, void *user_data)
+{
+	const struct shell *sh = user_data;
+	struct k_thread *thread = (struct k_thread *)cthread;
+	struct stack_usage su;
+
+	get_stack_usage(thread, &su);
+	if (!su.valid) {
+		return;
+	}
+
+	shell_print(sh, "  %-20s %5zu / %5zu bytes (%zu%%)",
+		    thread_label(thread), su.used, su.size,
+		    su.used * 100 / su.size);
+}
+#endif
+
+void sys_monitor_print_stacks(const struct shell *sh)
+{
+#if STACKS_AVAILABLE
+	shell_print(sh, "Stack high-water marks:");
+	k_thread_foreach_unlocked(print_stack_usage, (void *)sh);
+#else
+	shell_print(sh, "Stack usage: n/a (needs CONFIG_THREAD_MONITOR, "
+		    "CONFIG_THREAD_STACK_INFO, CONFIG_INIT_STACKS)");
+#endif
+}
+
+/* ========================================================================
+ * CPU Usage (sys top)
+ * ======================================================================== */
+
+#if defined(CONFIG_SCHED_THREAD_USAGE_ALL) && defined(CONFIG_THREAD_MONITOR)
+
+struct top_entry {
+	struct k_thread *thread;
+	uint64_t start_cycles;
+	uint64_t delta_cycles;
+	bool seen_end;
+};
+
+struct top_sample {
+	struct top_entry entries[SYS_MONITOR_MAX_THREADS];
+	size_t count;
+	size_t dropped;
+	bool end_pass;
+};
+
+/* Only one `sys top` at a time: the sample lives off the shell stack */
+static struct top_sample top;
+static atomic_t top_busy = ATOMIC_INIT(0);
+
+static void top_collect(const struct k_thread *cthread, void *user_data)
+{
+	struct top_sample *ts = user_data;
+	struct k_thread *thread = (struct k_thread *)cthread;
+	k_thread_runtime_stats_t rt;
+
+	/* Idle time is the "(idle)" row, from the CPU-wide stats */
+	if (k_thread_priority_get(thread) == K_IDLE_PRIO) {
+		return;
+	}
+
+	if (k_thread_runtime_stats_get(thread, &rt) != 0) {
+		return;
+	}
+
+	if (!ts->end_pass) {
+		if (ts->count < ARRAY_SIZE(ts->entries)) {
+			ts->entries[ts->count].thread = thread;
+			ts->entries[ts->count].start_cycles = rt.execution_cycles;
+			ts->count++;
+		} else {
+			ts->dropped++;
+		}
+		return;
+	}
+
+	for (size_t i = 0; i < ts->count; i++) {
+		if (ts->entries[i].thread == thread) {
+			ts->entries[i].delta_cycles =
+				rt.execution_cycles - ts->entries[i].start_cycles;
+			ts->entries[i].seen_end = true;
+			return;
+		}
+	}
+	/* Thread created during the window: not in the table, ignored */
+}
+
+static int top_cmp(const void *a, const void *b)
+{
+	const struct top_entry *ea = a, *eb = b;
+
+	if (ea->delta_cycles == eb->delta_cycles) {
+		return 0;
+	}
+	return (ea->delta_cycles < eb->delta_cycles) ? 1 : -1;
+}
+
+/** Percent x10 of @p part in @p whole */
+static uint32_t pct_x10(uint64_t part, uint64_t whole)
+{
+	return whole ? (uint32_t)(part * 1000 / whole) : 0;
+}
+
+static int cmd_sys_top(const struct shell *sh, size_t argc, char **argv)
+{
+	uint32_t window_ms = SYS_TOP_WINDOW_DEFAULT_MS;
+	k_thread_runtime_stats_t all_start, all_end;
+
+	if (argc >= 2) {
+		window_ms = strtoul(argv[1], NULL, 10);
+		if (window_ms == 0 || window_ms > SYS_TOP_WINDOW_MAX_MS) {
+			shell_error(sh, "Window must be 1-%u ms",
+				    SYS_TOP_WINDOW_MAX_MS);
+			return -EINVAL;
+		}
+	}
+
+	if (!atomic_cas(&top_busy, 0, 1)) {
+		shell_error(sh, "sys top already running");
+		return -EBUSY;
+	}
+
+	memset(&top, 0, sizeof(top));
+	k_thread_runtime_stats_all_get(&all_start);
+	k_thread_foreach_unlocked(top_collect, &top);
+
+	k_msleep(window_ms);
+
+	top.end_pass = true;
+	k_thread_foreach_unlocked(top_collect, &top);
+	k_thread_runtime_stats_all_get(&all_end);
+
+	/* execution_cycles covers idle + non-idle for the whole CPU */
+	uint64_t total = all_end.execution_cycles - all_start.execution_cycles;
+	uint64_t idle = all_end.idle_cycles - all_start.idle_cycles;
+
+	qsort(top.entries, top.count, sizeof(top.entries[0]), top_cmp);
+
+	shell_print(sh, "=== CPU over %u ms (%u MHz) ===", window_ms,
+		    sys_clock_hw_cycles_per_sec() / 1000000);
+	shell_print(sh, "  %-20s %4s %7s %13s", "THREAD", "PRIO", "CPU", "STACK");
+
+	for (size_t i = 0; i < top.count; i++) {
+		struct top_entry *e = &top.entries[i];
+		struct stack_usage su;
+		char stack[16] = "-";
+		uint32_t p;
+
+		if (!e->seen_end) {
+			continue; /* Exited during the window */
+		}
+
+		get_stack_usage(e->thread, &su);
+		if (su.valid) {
+			snprintk(stack, sizeof(stack), "%zu/%zu", su.used, su.size);
+		}
+
+		p = pct_x10(e->delta_cycles, total);
+		shell_print(sh, "  %-20s %4d %5u.%u%% %13s",
+			    thread_label(e->thread), k_thread_priority_get(e->thread),
+			    p / 10, p % 10, stack);
+	}
+
+	uint32_t idle_p = pct_x10(idle, total);
+	uint32_t busy_p = 1000 - MIN(idle_p, 1000);
+
+	shell_print(sh, "  %-20s %4s %5u.%u%%", "(idle)", "", idle_p / 10, idle_p % 10);
+	shell_print(sh, "Busy: %u.%u%%", busy_p / 10, busy_p % 10);
+	if (top.dropped > 0) {
+		shell_warn(sh, "%zu thread(s) not shown (SYS_MONITOR_MAX_THREADS)",
+			   top.dropped);
+	}
+
+	atomic_set(&top_busy, 0);
+	return 0;
+}
+
+#else
+
+static int cmd_sys_top(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+	shell_error(sh, "Needs CONFIG_SCHED_THREAD_USAGE_ALL and CONFIG_THREAD_MONITOR");
+	return -ENOTSUP;
+}
+
+#endif
+
+/* ========================================================================
+ * Wakeups
+ * ======================================================================== */
+
+static atomic_t wake_loops;
+static atomic_t wake_counts[SYS_WAKE_SOURCE_COUNT];
+
+static const char *const wake_names[SYS_WAKE_SOURCE_COUNT] = {
+	[SYS_WAKE_HEARTBEAT] = "heartbeat",
+	[SYS_WAKE_LED] = "rgb led",
+	[SYS_WAKE_USB] = "usb",
+	[SYS_WAKE_INVENTORY] = "inventory",
+	[SYS_WAKE_DEADLINE] = "deadline",
+};
+
+void sys_monitor_note_wakeup(uint32_t sources)
+{
+	atomic_inc(&wake_loops);
+	for (int i = 0; i < SYS_WAKE_SOURCE_COUNT; i++) {
+		if (sources & BIT(i)) {
+			atomic_inc(&wake_counts[i]);
+		}
+	}
+}
+
+#if defined(CONFIG_SCHED_THREAD_USAGE_ANALYSIS) && defined(CONFIG_THREAD_MONITOR)
+
+static void find_idle(const struct k_thread *cthread, void *user_data)
+{
+	struct k_thread **idle = user_data;
+	const char *name = k_thread_name_get((k_tid_t)cthread);
+
+	if (*idle == NULL && name != NULL && strncmp(name, "idle", 4) == 0) {
+		*idle = (struct k_thread *)cthread;
+	}
+}
+
+/**
+ * @brief Times the idle thread has been switched in
+ *
+ * Every switch-in follows a wakeup that ran a thread, so the delta over
+ * a window is the CPU wakeup count. Wakeups where only an ISR ran (and
+ * the CPU went straight back to WFI) are not included.
+ */
+static uint64_t idle_entries(void)
+{
+	struct k_thread *idle = NULL;
+	k_thread_runtime_stats_t rt;
+
+	k_thread_foreach_unlocked(find_idle, &idle);
+	if (idle == NULL || k_thread_runtime_stats_get(idle, &rt) != 0 ||
+	    rt.average_cycles == 0) {
+		return 0;
+	}
+	/* average_cycles = total_cycles / windows */
+	return rt.total_cycles / rt.average_cycles;
+}
+
+#else
+
+static uint64_t idle_entries(void)
+{
+	return 0;
+}
+
+#endif
+
+/** Rate x10 per second of @p count over @p ms */
+static uint32_t rate_x10(uint64_t count, uint32_t ms)
+{
+	return ms ? (uint32_t)(count * 10000 / ms) : 0;
+}
+
+static int cmd_sys_wakeups(const struct shell *sh, size_t argc, char **argv)
+{
+	uint32_t window_ms = SYS_TOP_WINDOW_DEFAULT_MS;
+	atomic_val_t counts[SYS_WAKE_SOURCE_COUNT];
+	atomic_val_t loops;
+	uint64_t idle0, idle1;
+	uint32_t r;
+
+	if (argc >= 2) {
+		window_ms = strtoul(argv[1], NULL, 10);
+		if (window_ms == 0 || window_ms > SYS_TOP_WINDOW_MAX_MS) {
+			shell_error(sh, "Window must be 1-%u ms",
+				    SYS_TOP_WINDOW_MAX_MS);
+			return -EINVAL;
+		}
+	}
+
+	loops = atomic_get(&wake_loops);
+	for (int i = 0; i < SYS_WAKE_SOURCE_COUNT; i++) {
+		counts[i] = atomic_get(&wake_counts[i]);
+	}
+	idle0 = idle_entries();
+
+	k_msleep(window_ms);
+
+	idle1 = idle_entries();
+	shell_print(sh, "=== Wakeups over %u ms ===", window_ms);
+	if (idle1 > 0) {
+		/* Includes this command waking at the end of the window */
+		r = rate_x10(idle1 - idle0, window_ms);
+		shell_print(sh, "  CPU (idle exits):  %u.%u/s", r / 10, r % 10);
+	} else {
+		shell_print(sh, "  CPU: needs CONFIG_SCHED_THREAD_USAGE_ANALYSIS");
+	}
+
+	r = rate_x10((uint32_t)(atomic_get(&wake_loops) - loops), window_ms);
+	shell_print(sh, "  Main loop:         %u.%u/s", r / 10, r % 10);
+	for (int i = 0; i < SYS_WAKE_SOURCE_COUNT; i++) {
+		r = rate_x10((uint32_t)(atomic_get(&wake_counts[i]) - counts[i]),
+			     window_ms);
+		shell_print(sh, "    %-16s %u.%u/s", wake_names[i], r / 10, r % 10);
+	}
+	return 0;
+}
+
+static int cmd_sys_stacks(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+	sys_monitor_print_stacks(sh);
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_sys,
+	SHELL_CMD(top, NULL, "CPU % per thread: [window_ms]", cmd_sys_top),
+	SHELL_CMD(stacks, NULL, "Stack high-water marks", cmd_sys_stacks),
+	SHELL_CMD(wakeups, NULL, "CPU and main loop wakeups/s: [window_ms]",
+		  cmd_sys_wakeups),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(sys, &sub_sys, "System CPU, stack and wakeup telemetry", NULL);
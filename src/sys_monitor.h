@@ -0,0 +1,69 @@
+/**
+ * @file sys_monitor.h
+ * @brief Thread CPU and Stack Telemetry
+ *
+ * Per-thread CPU share over a sampling window (thread runtime stats)
+ * and stack high-water marks (stack painting), for sizing priorities
+ * and stacks from measurements. Wakeup rates show how often the CPU
+ * leaves idle and what woke the main loop.
+ *
+ * Shell:
+ *   sys top [window_ms]       CPU % per thread and idle over the window
+ *   sys stacks                stack high-water marks
+ *   sys wakeups [window_ms]   CPU and main loop wakeups/s by source
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#ifndef SYS_MONITOR_H_
+#define SYS_MONITOR_H_
+
+#include <zephyr/shell/shell.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup sys_monitor System Monitor
+ * @{
+ */
+
+/** Threads tracked by `sys top` (extra threads are listed as dropped) */
+#define SYS_MONITOR_MAX_THREADS     24
+
+/** Default and maximum `sys top` window (ms) */
+#define SYS_TOP_WINDOW_DEFAULT_MS   1000
+#define SYS_TOP_WINDOW_MAX_MS       10000
+
+/** Main loop wake reasons, as counted by sys_monitor_note_wakeup() */
+enum sys_wake_source {
+	SYS_WAKE_HEARTBEAT,     /**< Heartbeat timer (LED, watchdog, login) */
+	SYS_WAKE_LED,           /**< RGB LED has new state to show */
+	SYS_WAKE_USB,           /**< HID interface came up or went down */
+	SYS_WAKE_INVENTORY,     /**< Inventory started or stopped */
+	SYS_WAKE_DEADLINE,      /**< LED blink or auto-start deadline */
+	SYS_WAKE_SOURCE_COUNT
+};
+
+/**
+ * @brief Count one main loop wakeup
+ *
+ * @param sources BIT(SYS_WAKE_*) of everything that was pending
+ */
+void sys_monitor_note_wakeup(uint32_t sources);
+
+/**
+ * @brief Print stack usage of every thread to a shell
+ *
+ * @param sh Shell to print to
+ */
+void sys_monitor_print_stacks(const struct shell *sh);
+
+/** @} */ /* End of sys_monitor group */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SYS_MONITOR_H_ */
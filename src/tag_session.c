@@ -0,0 +1,950 @@
+/**
+ * @file tag_session.c
+ * @brief Stock-Take Session Store Implementation
+ *
+ * Pool blocks are TAG_SESSION_BLOCK_SIZE bytes:
+ *   [count u8][reserved u8][used u16][entry][entry]...
+ *   entry = [shared u8][suffix_len u8][suffix ...][tag_session_stats_t]
+ * The first entry of a block always has shared = 0, so a block can be
+ * decoded on its own and its first EPC is the key for the binary search
+ * over the session's block index (dir[], sorted by first EPC).
+ *
+ * A hit updates the stats in place. A new tag re-encodes its block with
+ * the entry inserted, splitting it in two when it no longer fits.
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#include "tag_session.h"
+#include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/linker/section_tags.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+LOG_MODULE_REGISTER(tag_session, LOG_LEVEL_INF);
+
+/* DTCM when the board has it: CPU-only data, and it leaves SRAM to DMA */
+#if DT_NODE_HAS_STATUS(DT_CHOSEN(zephyr_dtcm), okay)
+#define POOL_SECTION __dtcm_noinit_section
+#else
+#define POOL_SECTION
+#endif
+
+typedef struct __attribute__((packed)) {
+	uint8_t count;              /* Entries in the block */
+	uint8_t reserved;
+	uint16_t used;              /* Entry bytes after the header */
+} block_hdr_t;
+
+#define BLOCK_DATA_SIZE   (TAG_SESSION_BLOCK_SIZE - sizeof(block_hdr_t))
+#define ENTRY_OVERHEAD    (2 + sizeof(tag_session_stats_t))
+
+/* Smallest entry has a 1-byte suffix */
+#define MAX_PER_BLOCK     (BLOCK_DATA_SIZE / (ENTRY_OVERHEAD + 1) + 1)
+
+BUILD_ASSERT(2 * (ENTRY_OVERHEAD + E310_MAX_EPC_LENGTH) <= BLOCK_DATA_SIZE,
+	     "a split block must hold two max-size entries");
+BUILD_ASSERT(E310_MAX_EPC_LENGTH < TAG_SESSION_FILE_END,
+	     "shared prefix length must not collide with the end marker");
+BUILD_ASSERT(TAG_SESSION_BLOCKS <= UINT16_MAX, "block index is 16-bit");
+
+/** Give up an export when the host stops reading for this long (ms) */
+#define EXPORT_STALL_MS   2000
+
+struct session {
+	uint32_t id;                            /* 0 = slot unused */
+	uint16_t dir[TAG_SESSION_BLOCKS];       /* Blocks in EPC order */
+	uint16_t nblocks;
+	uint32_t tags;
+	uint32_t reads;
+	uint32_t full_drops;
+	int64_t begin_ms;
+	int64_t end_ms;
+};
+
+static uint8_t pool[TAG_SESSION_BLOCKS][TAG_SESSION_BLOCK_SIZE]
+	POOL_SECTION __aligned(4);
+static uint16_t free_list[TAG_SESSION_BLOCKS];
+static uint16_t nfree;
+static uint16_t next_fresh;
+
+static struct session sessions[2];
+static uint8_t cur;                 /* sessions[cur] is the current one */
+static bool running;
+static uint32_t next_id = 1;
+
+static K_MUTEX_DEFINE(session_lock);
+
+/* Insert scratch: a block, the new entry and a neighbour (session_lock held) */
+static tag_session_entry_t scratch[2 * MAX_PER_BLOCK + 1];
+
+/* ========================================================================
+ * Block Helpers (caller holds session_lock)
+ * ======================================================================== */
+
+struct walk {
+	uint8_t *p;
+	uint8_t *end;
+	uint8_t key[E310_MAX_EPC_LENGTH];
+	uint8_t len;
+	uint8_t *stats;             /* Unaligned, in the block */
+};
+
+static void walk_init(struct walk *w, uint16_t blk)
+{
+	const block_hdr_t *hdr = (const block_hdr_t *)pool[blk];
+
+	w->p = &pool[blk][sizeof(block_hdr_t)];
+	w->end = w->p + hdr->used;
+}
+
+static bool walk_next(struct walk *w)
+{
+	if (w->p >= w->end) {
+		return false;
+	}
+
+	uint8_t shared = w->p[0];
+	uint8_t suffix = w->p[1];
+
+	memcpy(&w->key[shared], &w->p[2], suffix);
+	w->len = shared + suffix;
+	w->stats = &w->p[2 + suffix];
+	w->p += ENTRY_OVERHEAD + suffix;
+	return true;
+}
+
+int tag_session_epc_cmp(const uint8_t *a, uint8_t a_len,
+			const uint8_t *b, uint8_t b_len)
+{
+	int ret = memcmp(a, b, MIN(a_len, b_len));
+
+	return (ret != 0) ? ret : (int)a_len - (int)b_len;
+}
+
+static uint8_t common_prefix(const tag_session_entry_t *a,
+			     const tag_session_entry_t *b)
+{
+	uint8_t n = MIN(a->epc_len, b->epc_len);
+	uint8_t i = 0;
+
+	while (i < n && a->epc[i] == b->epc[i]) {
+		i++;
+	}
+	return i;
+}
+
+/**
+ * @brief Front-code entries [from, to) into dst (NULL: measure only)
+ *
+ * @return Encoded bytes, or -ENOSPC if more than @p cap
+ */
+static int encode_entries(const tag_session_entry_t *e, size_t from, size_t to,
+			  uint8_t *dst, size_t cap)
+{
+	size_t pos = 0;
+
+	for (size_t i = from; i < to; i++) {
+		uint8_t shared = (i > from) ? common_prefix(&e[i - 1], &e[i]) : 0;
+		uint8_t suffix = e[i].epc_len - shared;
+		size_t need = ENTRY_OVERHEAD + suffix;
+
+		if (pos + need > cap) {
+			return -ENOSPC;
+		}
+		if (dst) {
+			dst[pos] = shared;
+			dst[pos + 1] = suffix;
+			memcpy(&dst[pos + 2], &e[i].epc[shared], suffix);
+			memcpy(&dst[pos + 2 + suffix], &e[i].stats,
+			       sizeof(tag_session_stats_t));
+		}
+		pos += need;
+	}
+	return (int)pos;
+}
+
+static void write_block(uint16_t blk, const tag_session_entry_t *e,
+			size_t from, size_t to)
+{
+	block_hdr_t *hdr = (block_hdr_t *)pool[blk];
+	int used = encode_entries(e, from, to, &pool[blk][sizeof(block_hdr_t)],
+				  BLOCK_DATA_SIZE);
+
+	__ASSERT_NO_MSG(used >= 0);
+	hdr->count = (uint8_t)(to - from);
+	hdr->used = (uint16_t)used;
+}
+
+static size_t decode_block(uint16_t blk, tag_session_entry_t *out)
+{
+	struct walk w;
+	size_t n = 0;
+
+	walk_init(&w, blk);
+	while (walk_next(&w)) {
+		memcpy(out[n].epc, w.key, w.len);
+		out[n].epc_len = w.len;
+		memcpy(&out[n].stats, w.stats, sizeof(tag_session_stats_t));
+		n++;
+	}
+	return n;
+}
+
+/** Index into dir[] of the block that holds (or would hold) the EPC */
+static size_t find_block(const struct session *s, const uint8_t *epc,
+			 uint8_t epc_len)
+{
+	size_t lo = 0, hi = s->nblocks, found = 0;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		const uint8_t *first = &pool[s->dir[mid]][sizeof(block_hdr_t)];
+
+		if (tag_session_epc_cmp(&first[2], first[1], epc, epc_len) <= 0) {
+			found = mid;
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return found;
+}
+
+static void release(struct session *s)
+{
+	for (uint16_t i = 0; i < s->nblocks; i++) {
+		free_list[nfree++] = s->dir[i];
+	}
+	s->id = 0;
+	s->nblocks = 0;
+}
+
+static int alloc_block(void)
+{
+	struct session *prev = &sessions[cur ^ 1];
+
+	if (nfree > 0) {
+		return free_list[--nfree];
+	}
+	if (next_fresh < TAG_SESSION_BLOCKS) {
+		return next_fresh++;
+	}
+	if (prev->id != 0 && prev->nblocks > 0) {
+		LOG_WRN("Session pool full, dropping previous session %u", prev->id);
+		release(prev);
+		return free_list[--nfree];
+	}
+	return -ENOMEM;
+}
+
+static uint8_t antenna_slot(uint8_t antenna)
+{
+	/* Bitmask; 0 (not reported) is the first antenna */
+	return (antenna == 0) ? 0 : (uint8_t)(find_lsb_set(antenna) - 1);
+}
+
+static void update_stats(tag_session_stats_t *st, uint16_t now_s,
+			 uint8_t rssi, uint8_t slot)
+{
+	st->last_s = now_s;
+	if (st->reads < UINT16_MAX) {
+		st->reads++;
+	}
+	if (slot < TAG_SESSION_ANTENNAS && rssi > st->rssi[slot]) {
+		st->rssi[slot] = rssi;
+	}
+}
+
+/**
+ * @brief Split point for scratch[0..m) over two blocks
+ *
+ * @return k so that [0, k) and [k, m) both fit with the larger half as
+ *         small as possible, or 0 if there is none
+ */
+static size_t balance_point(size_t m)
+{
+	size_t best = 0;
+	int best_size = INT_MAX;
+
+	for (size_t k = 1; k < m; k++) {
+		int left = encode_entries(scratch, 0, k, NULL, BLOCK_DATA_SIZE);
+		int right = encode_entries(scratch, k, m, NULL, BLOCK_DATA_SIZE);
+
+		if (left >= 0 && right >= 0 && MAX(left, right) < best_size) {
+			best = k;
+			best_size = MAX(left, right);
+		}
+	}
+	return best;
+}
+
+/**
+ * @brief Write scratch[0..n) back as dir[bi]
+ *
+ * When the block overflows, entries move to a neighbour with room first
+ * (keeps blocks ~85% full under random arrival instead of ~70%); only
+ * then is the block split. A tag appended past the last block starts a
+ * new block on its own, so ascending serials pack blocks full.
+ */
+static int store_block(struct session *s, size_t bi, size_t n, bool append)
+{
+	size_t k;
+
+	if (encode_entries(scratch, 0, n, NULL, BLOCK_DATA_SIZE) >= 0) {
+		write_block(s->dir[bi], scratch, 0, n);
+		return 0;
+	}
+
+	if (!append && bi + 1 < s->nblocks) {
+		size_t m = n + decode_block(s->dir[bi + 1], &scratch[n]);
+
+		k = balance_point(m);
+		if (k > 0) {
+			write_block(s->dir[bi], scratch, 0, k);
+			write_block(s->dir[bi + 1], scratch, k, m);
+			return 0;
+		}
+	}
+
+	if (!append && bi > 0) {
+		const block_hdr_t *left = (const block_hdr_t *)pool[s->dir[bi - 1]];
+		size_t m = left->count + n;
+
+		memmove(&scratch[left->count], scratch, n * sizeof(scratch[0]));
+		decode_block(s->dir[bi - 1], scratch);
+
+		k = balance_point(m);
+		if (k > 0) {
+			write_block(s->dir[bi - 1], scratch, 0, k);
+			write_block(s->dir[bi], scratch, k, m);
+			return 0;
+		}
+
+		/* Back to this block's entries only */
+		memmove(scratch, &scratch[left->count], n * sizeof(scratch[0]));
+	}
+
+	k = append ? n - 1 : balance_point(n);
+	if (k == 0) {
+		return -ENOSPC;
+	}
+
+	int blk = alloc_block();
+
+	if (blk < 0) {
+		return blk;
+	}
+
+	write_block(s->dir[bi], scratch, 0, k);
+	write_block((uint16_t)blk, scratch, k, n);
+	memmove(&s->dir[bi + 2], &s->dir[bi + 1],
+		(s->nblocks - bi - 1) * sizeof(s->dir[0]));
+	s->dir[bi + 1] = (uint16_t)blk;
+	s->nblocks++;
+	return 0;
+}
+
+/* ========================================================================
+ * API Functions
+ * ======================================================================== */
+
+uint32_t tag_session_begin(void)
+{
+	int64_t now = k_uptime_get();
+	uint32_t id;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	if (running) {
+		sessions[cur].end_ms = now;
+	}
+
+	/* Current becomes previous; the old previous slot is reused */
+	cur ^= 1;
+	release(&sessions[cur]);
+	memset(&sessions[cur], 0, sizeof(sessions[cur]));
+	sessions[cur].id = next_id++;
+	sessions[cur].begin_ms = now;
+	id = sessions[cur].id;
+	running = true;
+
+	k_mutex_unlock(&session_lock);
+
+	LOG_INF("Session %u started", id);
+	return id;
+}
+
+int tag_session_stop(void)
+{
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	if (!running) {
+		k_mutex_unlock(&session_lock);
+		return -EALREADY;
+	}
+	running = false;
+	sessions[cur].end_ms = k_uptime_get();
+
+	k_mutex_unlock(&session_lock);
+	return 0;
+}
+
+bool tag_session_is_running(void)
+{
+	return running;
+}
+
+int tag_session_record(const uint8_t *epc, uint8_t epc_len, uint8_t rssi,
+		       uint8_t antenna)
+{
+	if (!running) {
+		return 0;
+	}
+	if (epc_len == 0 || epc_len > E310_MAX_EPC_LENGTH) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	struct session *s = &sessions[cur];
+	uint8_t slot = antenna_slot(antenna);
+	uint16_t now_s = (uint16_t)MIN((k_uptime_get() - s->begin_ms) / 1000,
+				       UINT16_MAX);
+	size_t bi = 0, pos = 0, n = 0;
+	int ret = 0;
+
+	if (!running) {
+		goto out;
+	}
+	s->reads++;
+
+	if (s->nblocks > 0) {
+		struct walk w;
+
+		bi = find_block(s, epc, epc_len);
+		walk_init(&w, s->dir[bi]);
+		while (walk_next(&w)) {
+			int c = tag_session_epc_cmp(w.key, w.len, epc, epc_len);
+
+			if (c == 0) {
+				tag_session_stats_t st;
+
+				memcpy(&st, w.stats, sizeof(st));
+				update_stats(&st, now_s, rssi, slot);
+				memcpy(w.stats, &st, sizeof(st));
+				goto out;
+			}
+			if (c > 0) {
+				break;
+			}
+			pos++;
+		}
+		n = decode_block(s->dir[bi], scratch);
+	} else {
+		int blk = alloc_block();
+
+		if (blk < 0) {
+			ret = blk;
+			goto full;
+		}
+		s->dir[0] = (uint16_t)blk;
+		s->nblocks = 1;
+	}
+
+	/* New tag */
+	tag_session_entry_t *e = &scratch[pos];
+
+	memmove(&scratch[pos + 1], &scratch[pos], (n - pos) * sizeof(scratch[0]));
+	memcpy(e->epc, epc, epc_len);
+	e->epc_len = epc_len;
+	memset(&e->stats, 0, sizeof(e->stats));
+	e->stats.first_s = now_s;
+	update_stats(&e->stats, now_s, rssi, slot);
+
+	ret = store_block(s, bi, n + 1,
+			  bi == s->nblocks - 1 && pos == n && n > 0);
+	if (ret == 0) {
+		s->tags++;
+		goto out;
+	}
+
+full:
+	if (s->full_drops++ == 0) {
+		LOG_WRN("Session %u full at %u tags", s->id, s->tags);
+	}
+out:
+	k_mutex_unlock(&session_lock);
+	return ret;
+}
+
+void tag_session_get_info(tag_session_which_t which, tag_session_info_t *info)
+{
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	const struct session *s = &sessions[(which == TAG_SESSION_CURRENT) ?
+					    cur : cur ^ 1];
+	bool live = running && which == TAG_SESSION_CURRENT;
+	int64_t end = live ? k_uptime_get() : s->end_ms;
+
+	info->id = s->id;
+	info->running = live;
+	info->tags = s->tags;
+	info->reads = s->reads;
+	info->full_drops = s->full_drops;
+	info->duration_s = (s->id != 0) ? (uint32_t)((end - s->begin_ms) / 1000) : 0;
+	info->blocks = s->nblocks;
+
+	k_mutex_unlock(&session_lock);
+}
+
+uint16_t tag_session_blocks_used(void)
+{
+	return next_fresh - nfree;
+}
+
+int tag_session_iter_init(tag_session_iter_t *it, tag_session_which_t which)
+{
+	k_mutex_lock(&session_lock, K_FOREVER);
+	it->id = sessions[(which == TAG_SESSION_CURRENT) ? cur : cur ^ 1].id;
+	k_mutex_unlock(&session_lock);
+
+	it->cursor_len = 0;
+	it->count = 0;
+	it->pos = 0;
+	it->done = (it->id == 0);
+	return it->done ? -ENOENT : 0;
+}
+
+/** Fetch the next batch of entries after the cursor */
+static int iter_fill(tag_session_iter_t *it)
+{
+	const struct session *s = NULL;
+	struct walk w;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	for (size_t i = 0; i < ARRAY_SIZE(sessions); i++) {
+		if (sessions[i].id == it->id) {
+			s = &sessions[i];
+		}
+	}
+	if (!s) {
+		k_mutex_unlock(&session_lock);
+		it->done = true;
+		return -ESTALE;
+	}
+
+	it->count = 0;
+	it->pos = 0;
+
+	size_t bi = (it->cursor_len > 0) ?
+		    find_block(s, it->cursor, it->cursor_len) : 0;
+
+	for (; bi < s->nblocks && it->count < TAG_SESSION_ITER_BATCH; bi++) {
+		walk_init(&w, s->dir[bi]);
+		while (it->count < TAG_SESSION_ITER_BATCH && walk_next(&w)) {
+			if (it->cursor_len > 0 &&
+			    tag_session_epc_cmp(w.key, w.len, it->cursor,
+						it->cursor_len) <= 0) {
+				continue;
+			}
+
+			tag_session_entry_t *e = &it->batch[it->count++];
+
+			memcpy(e->epc, w.key, w.len);
+			e->epc_len = w.len;
+			memcpy(&e->stats, w.stats, sizeof(e->stats));
+		}
+	}
+
+	k_mutex_unlock(&session_lock);
+
+	if (it->count == 0) {
+		it->done = true;
+		return -ENOENT;
+	}
+
+	const tag_session_entry_t *last = &it->batch[it->count - 1];
+
+	memcpy(it->cursor, last->epc, last->epc_len);
+	it->cursor_len = last->epc_len;
+	return 0;
+}
+
+int tag_session_iter_next(tag_session_iter_t *it, tag_session_entry_t *entry)
+{
+	if (it->done) {
+		return -ENOENT;
+	}
+	if (it->pos >= it->count) {
+		int ret = iter_fill(it);
+
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	*entry = it->batch[it->pos++];
+	return 0;
+}
+
+void tag_session_file_hdr(tag_session_file_hdr_t *hdr,
+			  const tag_session_info_t *info)
+{
+	memset(hdr, 0, sizeof(*hdr));
+	hdr->magic = sys_cpu_to_le32(TAG_SESSION_FILE_MAGIC);
+	hdr->version = TAG_SESSION_FILE_VERSION;
+	hdr->antennas = TAG_SESSION_ANTENNAS;
+	hdr->stats_size = sizeof(tag_session_stats_t);
+	hdr->session_id = sys_cpu_to_le32(info->id);
+	hdr->duration_s = sys_cpu_to_le32(info->duration_s);
+	hdr->tags = sys_cpu_to_le32(info->tags);
+}
+
+size_t tag_session_encode(const tag_session_entry_t *entry,
+			  const tag_session_entry_t *prev, uint8_t *buf)
+{
+	uint8_t shared = (prev != NULL) ? common_prefix(prev, entry) : 0;
+	uint8_t suffix = entry->epc_len - shared;
+
+	buf[0] = shared;
+	buf[1] = suffix;
+	memcpy(&buf[2], &entry->epc[shared], suffix);
+	memcpy(&buf[2 + suffix], &entry->stats, sizeof(entry->stats));
+	return ENTRY_OVERHEAD + suffix;
+}
+
+/* ========================================================================
+ * Shell Commands
+ * ======================================================================== */
+
+/* Export/diff state: shell thread only, too large for its stack */
+static tag_session_iter_t walk_a;
+static tag_session_iter_t walk_b;
+
+struct export_out {
+	const struct shell *sh;
+	uint8_t buf[512];
+	size_t len;
+	uint32_t crc;
+	uint32_t bytes;
+	int err;
+};
+
+static struct export_out out;
+
+/**
+ * @brief Write bytes straight to the shell transport
+ *
+ * Bypasses shell formatting (no newline translation, no VT100), so the
+ * CDC endpoint runs at bulk speed and binary data passes unchanged.
+ */
+static int shell_write_raw(const struct shell *sh, const uint8_t *data,
+			   size_t len)
+{
+	int64_t stall_end = k_uptime_get() + EXPORT_STALL_MS;
+
+	while (len > 0) {
+		size_t cnt = 0;
+		int ret = sh->iface->api->write(sh->iface, data, len, &cnt);
+
+		if (ret < 0) {
+			return ret;
+		}
+		if (cnt == 0) {
+			if (k_uptime_get() > stall_end) {
+				return -ETIMEDOUT;
+			}
+			k_msleep(1);
+			continue;
+		}
+		data += cnt;
+		len -= cnt;
+		stall_end = k_uptime_get() + EXPORT_STALL_MS;
+	}
+	return 0;
+}
+
+static void out_flush(struct export_out *o)
+{
+	if (o->err == 0 && o->len > 0) {
+		o->err = shell_write_raw(o->sh, o->buf, o->len);
+	}
+	o->len = 0;
+}
+
+static void out_put(struct export_out *o, const void *data, size_t len)
+{
+	if (o->len + len > sizeof(o->buf)) {
+		out_flush(o);
+	}
+	memcpy(&o->buf[o->len], data, len);
+	o->len += len;
+	o->bytes += len;
+	o->crc = crc32_ieee_update(o->crc, data, len);
+}
+
+static int epc_to_hex(const uint8_t *epc, uint8_t len, char *str)
+{
+	static const char hex[] = "0123456789ABCDEF";
+
+	for (uint8_t i = 0; i < len; i++) {
+		str[2 * i] = hex[epc[i] >> 4];
+		str[2 * i + 1] = hex[epc[i] & 0x0F];
+	}
+	str[2 * len] = '\0';
+	return 2 * len;
+}
+
+static void export_csv_entry(struct export_out *o, const tag_session_entry_t *e)
+{
+	char line[2 * E310_MAX_EPC_LENGTH + 24 + 4 * TAG_SESSION_ANTENNAS];
+	int pos = epc_to_hex(e->epc, e->epc_len, line);
+
+	pos += snprintf(&line[pos], sizeof(line) - pos, ",%u,%u,%u",
+			e->stats.first_s, e->stats.last_s, e->stats.reads);
+	for (int a = 0; a < TAG_SESSION_ANTENNAS; a++) {
+		pos += snprintf(&line[pos], sizeof(line) - pos, ",%u",
+				e->stats.rssi[a]);
+	}
+	pos += snprintf(&line[pos], sizeof(line) - pos, "\r\n");
+	out_put(o, line, pos);
+}
+
+static void export_bin_entry(struct export_out *o, const tag_session_entry_t *e,
+			     const tag_session_entry_t *prev)
+{
+	uint8_t rec[TAG_SESSION_RECORD_MAX];
+
+	out_put(o, rec, tag_session_encode(e, prev, rec));
+}
+
+static int cmd_session_begin(const struct shell *sh, size_t argc, char **argv)
+{
+	tag_session_info_t prev;
+	uint32_t id;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	id = tag_session_begin();
+	tag_session_get_info(TAG_SESSION_PREVIOUS, &prev);
+
+	shell_print(sh, "Session %u started", id);
+	if (prev.id != 0) {
+		shell_print(sh, "Previous: session %u, %u tags", prev.id, prev.tags);
+	}
+	return 0;
+}
+
+static int cmd_session_stop(const struct shell *sh, size_t argc, char **argv)
+{
+	tag_session_info_t info;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	if (tag_session_stop() < 0) {
+		shell_error(sh, "No session running");
+		return -EALREADY;
+	}
+
+	tag_session_get_info(TAG_SESSION_CURRENT, &info);
+	shell_print(sh, "Session %u stopped: %u tags, %u reads in %u s",
+		    info.id, info.tags, info.reads, info.duration_s);
+	return 0;
+}
+
+static void print_info(const struct shell *sh, const char *label,
+		       const tag_session_info_t *info)
+{
+	if (info->id == 0) {
+		shell_print(sh, "%s: none", label);
+		return;
+	}
+
+	shell_print(sh, "%s: session %u (%s, %u s)", label, info->id,
+		    info->running ? "recording" : "stopped", info->duration_s);
+	shell_print(sh, "  Tags: %u  Reads: %u  Not stored (full): %u",
+		    info->tags, info->reads, info->full_drops);
+	if (info->tags > 0) {
+		shell_print(sh, "  Pool: %u blocks, %u bytes/tag", info->blocks,
+			    info->blocks * TAG_SESSION_BLOCK_SIZE / info->tags);
+	}
+}
+
+static int cmd_session_status(const struct shell *sh, size_t argc, char **argv)
+{
+	tag_session_info_t info;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	shell_print(sh, "=== Tag Session ===");
+	tag_session_get_info(TAG_SESSION_CURRENT, &info);
+	print_info(sh, "Current", &info);
+	tag_session_get_info(TAG_SESSION_PREVIOUS, &info);
+	print_info(sh, "Previous", &info);
+	shell_print(sh, "Pool: %u/%u blocks of %u bytes",
+		    tag_session_blocks_used(), TAG_SESSION_BLOCKS,
+		    TAG_SESSION_BLOCK_SIZE);
+	return 0;
+}
+
+static int cmd_session_export(const struct shell *sh, size_t argc, char **argv)
+{
+	tag_session_which_t which = TAG_SESSION_CURRENT;
+	tag_session_entry_t e, prev;
+	tag_session_info_t info;
+	bool binary = false;
+	uint32_t records = 0;
+	int ret;
+
+	for (size_t i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "bin") == 0) {
+			binary = true;
+		} else if (strcmp(argv[i], "csv") == 0) {
+			binary = false;
+		} else if (strcmp(argv[i], "prev") == 0) {
+			which = TAG_SESSION_PREVIOUS;
+		} else {
+			shell_error(sh, "Usage: session export [bin|csv] [prev]");
+			return -EINVAL;
+		}
+	}
+
+	tag_session_get_info(which, &info);
+	if (tag_session_iter_init(&walk_a, which) < 0) {
+		shell_error(sh, "No such session");
+		return -ENOENT;
+	}
+
+	/* Header line parsed by tools/session_export.py */
+	shell_print(sh, "SESSION BEGIN %s v%u id=%u tags=%u",
+		    binary ? "bin" : "csv", TAG_SESSION_FILE_VERSION,
+		    info.id, info.tags);
+
+	memset(&out, 0, sizeof(out));
+	out.sh = sh;
+
+	if (binary) {
+		tag_session_file_hdr_t hdr;
+
+		tag_session_file_hdr(&hdr, &info);
+		out_put(&out, &hdr, sizeof(hdr));
+	} else {
+		char head[32 + 8 * TAG_SESSION_ANTENNAS];
+		int pos = snprintf(head, sizeof(head), "epc,first_s,last_s,reads");
+
+		for (int a = 0; a < TAG_SESSION_ANTENNAS; a++) {
+			pos += snprintf(&head[pos], sizeof(head) - pos,
+					",rssi_a%d", a + 1);
+		}
+		pos += snprintf(&head[pos], sizeof(head) - pos, "\r\n");
+		out_put(&out, head, pos);
+	}
+
+	while ((ret = tag_session_iter_next(&walk_a, &e)) == 0 && out.err == 0) {
+		if (binary) {
+			export_bin_entry(&out, &e, (records > 0) ? &prev : NULL);
+			prev = e;
+		} else {
+			export_csv_entry(&out, &e);
+		}
+		records++;
+	}
+
+	if (binary) {
+		uint8_t end = TAG_SESSION_FILE_END;
+		uint8_t crc[4];
+
+		out_put(&out, &end, 1);
+		sys_put_le32(out.crc, crc);
+		out_put(&out, crc, sizeof(crc));
+		out_put(&out, "\r\n", 2);
+	}
+	out_flush(&out);
+
+	if (out.err < 0) {
+		shell_error(sh, "Export aborted: %d", out.err);
+		return out.err;
+	}
+	if (ret == -ESTALE) {
+		shell_print(sh, "SESSION END records=%u bytes=%u (session discarded, partial)",
+			    records, out.bytes);
+		return ret;
+	}
+
+	shell_print(sh, "SESSION END records=%u bytes=%u", records, out.bytes);
+	return 0;
+}
+
+static int cmd_session_diff(const struct shell *sh, size_t argc, char **argv)
+{
+	bool summary = (argc >= 2 && strcmp(argv[1], "summary") == 0);
+	uint32_t added = 0, missing = 0, common = 0;
+	tag_session_entry_t a, b;
+	char hex[2 * E310_MAX_EPC_LENGTH + 1];
+
+	if (tag_session_iter_init(&walk_a, TAG_SESSION_CURRENT) < 0 ||
+	    tag_session_iter_init(&walk_b, TAG_SESSION_PREVIOUS) < 0) {
+		shell_error(sh, "Need a current and a previous session");
+		return -ENOENT;
+	}
+
+	/* Both walks are sorted: one merge pass */
+	int ra = tag_session_iter_next(&walk_a, &a);
+	int rb = tag_session_iter_next(&walk_b, &b);
+
+	while (ra == 0 || rb == 0) {
+		int c = (ra != 0) ? 1 : (rb != 0) ? -1 :
+			tag_session_epc_cmp(a.epc, a.epc_len, b.epc, b.epc_len);
+
+		if (c < 0) {
+			added++;
+			if (!summary) {
+				epc_to_hex(a.epc, a.epc_len, hex);
+				shell_print(sh, "+%s", hex);
+			}
+			ra = tag_session_iter_next(&walk_a, &a);
+		} else if (c > 0) {
+			missing++;
+			if (!summary) {
+				epc_to_hex(b.epc, b.epc_len, hex);
+				shell_print(sh, "-%s", hex);
+			}
+			rb = tag_session_iter_next(&walk_b, &b);
+		} else {
+			common++;
+			ra = tag_session_iter_next(&walk_a, &a);
+			rb = tag_session_iter_next(&walk_b, &b);
+		}
+	}
+
+	if (ra == -ESTALE || rb == -ESTALE) {
+		shell_warn(sh, "A session was discarded during the diff");
+	}
+	shell_print(sh, "%u new, %u missing, %u in both", added, missing, common);
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_session,
+	SHELL_CMD(begin, NULL, "Start a new session", cmd_session_begin),
+	SHELL_CMD(stop, NULL, "Stop recording", cmd_session_stop),
+	SHELL_CMD(status, NULL, "Show session status", cmd_session_status),
+	SHELL_CMD(export, NULL, "Stream a session: [bin|csv] [prev]", cmd_session_export),
+	SHELL_CMD(diff, NULL, "Tags new/missing vs previous: [summary]", cmd_session_diff),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(session, &sub_session, "Stock-take session store", NULL);
@@ -0,0 +1,273 @@
+/**
+ * @file tag_session.h
+ * @brief Stock-Take Session Store (every unique tag seen in a session)
+ *
+ * Keeps one record per unique EPC for the running session: first and
+ * last seen, read count and best RSSI per antenna. EPCs are held sorted
+ * and front-coded (each entry stores only the bytes that differ from the
+ * previous EPC) in fixed-size blocks, so the shared GS1 header and
+ * company prefix of a stock population cost nothing per tag. Lookup is a
+ * binary search over the block index plus a short walk inside one block.
+ *
+ * The previous session is kept next to the current one for diffing. When
+ * the pool runs out, the previous session is given up first.
+ *
+ * Shell:
+ *   session begin                 start a new session (current -> previous)
+ *   session stop                  freeze the current session
+ *   session status                tags, reads and pool use of both sessions
+ *   session export [bin|csv] [prev]  stream a session over the CDC shell
+ *   session diff [summary]        tags new / missing against the previous
+ *
+ * The binary stream can also be read in chunks over the control
+ * interface (ctrl_proto.h, SESSION_READ).
+ *
+ * Export format (both framed by "SESSION BEGIN ..." / "SESSION END" text
+ * lines, decoded by tools/session_export.py):
+ *   csv  one line per tag: epc,first_s,last_s,reads,rssi_a1..rssi_aN
+ *   bin  tag_session_file_hdr_t, then front-coded records
+ *        [shared u8][suffix_len u8][suffix][tag_session_stats_t]
+ *        across the whole session, a 0xFF end byte and a CRC-32 (IEEE,
+ *        little endian) of everything before it
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#ifndef TAG_SESSION_H_
+#define TAG_SESSION_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "e310_protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup tag_session Tag Session
+ * @{
+ */
+
+/* ========================================================================
+ * Constants
+ * ======================================================================== */
+
+/** Block size in bytes (4-byte header + front-coded entries) */
+#define TAG_SESSION_BLOCK_SIZE      256
+
+/**
+ * Blocks in the pool (shared by the current and previous session)
+ *
+ * 112 KB, placed in DTCM: the session is CPU-only data, so it does not
+ * need DMA-reachable SRAM. SGTIN-96 tags with random serials cost ~16
+ * bytes each (2-3 suffix bytes, 10 bytes stats, 2 bytes framing, ~87%
+ * block fill): ~7000 tags alone, or two sessions of ~3500 for diffing.
+ */
+#define TAG_SESSION_BLOCKS          448
+
+/** Antennas with a best-RSSI slot (antenna bitmask bits 0..N-1) */
+#define TAG_SESSION_ANTENNAS        4
+
+/** Entries fetched per iterator refill */
+#define TAG_SESSION_ITER_BATCH      8
+
+/** Binary export magic and version */
+#define TAG_SESSION_FILE_MAGIC      0x53455350  /* "PSES" little endian */
+#define TAG_SESSION_FILE_VERSION    1
+
+/** End-of-records marker (a shared-prefix length never reaches it) */
+#define TAG_SESSION_FILE_END        0xFF
+
+/** Longest encoded record (no shared prefix, longest EPC) */
+#define TAG_SESSION_RECORD_MAX      (2 + E310_MAX_EPC_LENGTH + \
+				     sizeof(tag_session_stats_t))
+
+/* ========================================================================
+ * Data Structures
+ * ======================================================================== */
+
+/**
+ * @brief Per-tag statistics (stored as is after the EPC bytes)
+ *
+ * Times are seconds since the session began and saturate at 65535 (18 h),
+ * as does the read count. An RSSI of 0 means "not seen on this antenna".
+ */
+typedef struct __attribute__((packed)) {
+	uint16_t first_s;                       /**< First read */
+	uint16_t last_s;                        /**< Latest read */
+	uint16_t reads;                         /**< Read count */
+	uint8_t  rssi[TAG_SESSION_ANTENNAS];    /**< Best RSSI per antenna */
+} tag_session_stats_t;
+
+/**
+ * @brief One tag as returned by the iterator
+ */
+typedef struct {
+	uint8_t epc[E310_MAX_EPC_LENGTH];   /**< EPC data */
+	uint8_t epc_len;                    /**< EPC length */
+	tag_session_stats_t stats;          /**< Statistics */
+} tag_session_entry_t;
+
+/** Session selector */
+typedef enum {
+	TAG_SESSION_CURRENT = 0,    /**< Running or last stopped session */
+	TAG_SESSION_PREVIOUS,       /**< The one before it */
+} tag_session_which_t;
+
+/**
+ * @brief Session summary
+ */
+typedef struct {
+	uint32_t id;                /**< Session number (0 = none) */
+	bool running;               /**< Still recording */
+	uint32_t tags;              /**< Unique tags */
+	uint32_t reads;             /**< Reads recorded */
+	uint32_t full_drops;        /**< New tags not stored (pool full) */
+	uint32_t duration_s;        /**< Begin to stop (or now) */
+	uint16_t blocks;            /**< Pool blocks held */
+} tag_session_info_t;
+
+/**
+ * @brief Binary export header (little endian)
+ */
+typedef struct __attribute__((packed)) {
+	uint32_t magic;             /**< TAG_SESSION_FILE_MAGIC */
+	uint8_t  version;           /**< TAG_SESSION_FILE_VERSION */
+	uint8_t  antennas;          /**< TAG_SESSION_ANTENNAS */
+	uint8_t  stats_size;        /**< sizeof(tag_session_stats_t) */
+	uint8_t  reserved;
+	uint32_t session_id;        /**< Session number */
+	uint32_t duration_s;        /**< Session length */
+	uint32_t tags;              /**< Unique tags when the export started */
+} tag_session_file_hdr_t;
+
+/**
+ * @brief Session walker (sorted by EPC)
+ *
+ * Fetches a few entries at a time under the session lock, so the router
+ * keeps recording while a long export is written out.
+ */
+typedef struct {
+	uint32_t id;                                    /**< Session being walked */
+	uint8_t cursor[E310_MAX_EPC_LENGTH];            /**< Last EPC fetched */
+	uint8_t cursor_len;                             /**< 0 before the first fetch */
+	tag_session_entry_t batch[TAG_SESSION_ITER_BATCH];
+	uint8_t count;                                  /**< Entries in batch */
+	uint8_t pos;                                    /**< Next entry in batch */
+	bool done;                                      /**< No more entries */
+} tag_session_iter_t;
+
+/* ========================================================================
+ * API Functions
+ * ======================================================================== */
+
+/**
+ * @brief Start a new session
+ *
+ * The current session becomes the previous one; the old previous
+ * session is discarded.
+ *
+ * @return New session number
+ */
+uint32_t tag_session_begin(void);
+
+/**
+ * @brief Stop recording into the current session
+ *
+ * @return 0 on success, -EALREADY if no session is running
+ */
+int tag_session_stop(void);
+
+/**
+ * @brief Check if a session is recording
+ */
+bool tag_session_is_running(void);
+
+/**
+ * @brief Record one tag read (router thread, every decoded tag)
+ *
+ * No-op while no session is running.
+ *
+ * @param epc EPC bytes
+ * @param epc_len EPC length (1..E310_MAX_EPC_LENGTH)
+ * @param rssi RSSI as reported by the reader
+ * @param antenna Antenna bitmask from the inventory frame
+ * @return 0 on success (or not running), -ENOMEM if a new tag did not
+ *         fit, -EINVAL on bad length
+ */
+int tag_session_record(const uint8_t *epc, uint8_t epc_len, uint8_t rssi,
+		       uint8_t antenna);
+
+/**
+ * @brief Get a session summary
+ *
+ * @param which Session
+ * @param info Output: summary (id 0 if there is no such session)
+ */
+void tag_session_get_info(tag_session_which_t which, tag_session_info_t *info);
+
+/**
+ * @brief Pool blocks in use by both sessions
+ */
+uint16_t tag_session_blocks_used(void);
+
+/**
+ * @brief Start walking a session in EPC order
+ *
+ * @param it Iterator (large: keep it off small stacks)
+ * @param which Session
+ * @return 0 on success, -ENOENT if there is no such session
+ */
+int tag_session_iter_init(tag_session_iter_t *it, tag_session_which_t which);
+
+/**
+ * @brief Next entry of the walk
+ *
+ * @param it Iterator
+ * @param entry Output: entry copy
+ * @return 0 on success, -ENOENT at the end, -ESTALE if the session was
+ *         discarded under the walk
+ */
+int tag_session_iter_next(tag_session_iter_t *it, tag_session_entry_t *entry);
+
+/**
+ * @brief Fill the binary export header for a session
+ *
+ * @param hdr Output header (little endian)
+ * @param info Session summary (tag_session_get_info())
+ */
+void tag_session_file_hdr(tag_session_file_hdr_t *hdr,
+			  const tag_session_info_t *info);
+
+/**
+ * @brief Encode one export record, front-coded against the previous one
+ *
+ * Used by the shell export and the binary control protocol, so both
+ * produce the same stream.
+ *
+ * @param entry Entry to encode
+ * @param prev Entry before it in the stream (NULL for the first)
+ * @param buf Output, at least TAG_SESSION_RECORD_MAX bytes
+ * @return Bytes written
+ */
+size_t tag_session_encode(const tag_session_entry_t *entry,
+			  const tag_session_entry_t *prev, uint8_t *buf);
+
+/**
+ * @brief Compare two EPCs in session order
+ *
+ * @return <0, 0 or >0 like memcmp (a shorter EPC sorts before its extensions)
+ */
+int tag_session_epc_cmp(const uint8_t *a, uint8_t a_len,
+			const uint8_t *b, uint8_t b_len);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TAG_SESSION_H_ */
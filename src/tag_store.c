@@ -0,0 +1,217 @@
+/**
+ * @file tag_store.c
+ * @brief Store-and-Forward Tag Buffer Implementation
+ *
+ * Records are laid out back to back in a byte ring:
+ *   [tag_store_hdr_t][epc ...][tag_store_hdr_t][epc ...]
+ * head/tail are free-running byte indices; (head - tail) is the fill level.
+ * Reads are stored in arrival order, so expired records are always at
+ * the tail.
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#include "tag_store.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+#include <errno.h>
+
+BUILD_ASSERT((TAG_STORE_BUF_SIZE & (TAG_STORE_BUF_SIZE - 1)) == 0,
+	     "TAG_STORE_BUF_SIZE must be a power of two");
+BUILD_ASSERT(TAG_STORE_BUF_SIZE >=
+	     4 * (sizeof(tag_store_hdr_t) + E310_MAX_EPC_LENGTH),
+	     "TAG_STORE_BUF_SIZE too small for max-size records");
+
+#define RING_MASK (TAG_STORE_BUF_SIZE - 1)
+
+static uint8_t store_buf[TAG_STORE_BUF_SIZE];
+static uint32_t store_head;
+static uint32_t store_tail;
+static uint32_t store_count;
+static struct k_spinlock store_lock;
+
+static uint32_t expiry_ms = TAG_STORE_EXPIRY_DEFAULT_SEC * 1000U;
+static uint32_t replay_rate = TAG_STORE_RATE_DEFAULT;
+
+static tag_store_stats_t stats;
+
+/* ========================================================================
+ * Ring Helpers (caller holds store_lock)
+ * ======================================================================== */
+
+static void ring_write(uint32_t pos, const void *src, size_t len)
+{
+	uint32_t off = pos & RING_MASK;
+	size_t first = MIN(len, TAG_STORE_BUF_SIZE - off);
+
+	memcpy(&store_buf[off], src, first);
+	if (len > first) {
+		memcpy(store_buf, (const uint8_t *)src + first, len - first);
+	}
+}
+
+static void ring_read(uint32_t pos, void *dst, size_t len)
+{
+	uint32_t off = pos & RING_MASK;
+	size_t first = MIN(len, TAG_STORE_BUF_SIZE - off);
+
+	memcpy(dst, &store_buf[off], first);
+	if (len > first) {
+		memcpy((uint8_t *)dst + first, store_buf, len - first);
+	}
+}
+
+static void ring_remove_oldest(void)
+{
+	tag_store_hdr_t hdr;
+
+	ring_read(store_tail, &hdr, sizeof(hdr));
+	store_tail += sizeof(hdr) + hdr.epc_len;
+	store_count--;
+}
+
+/** Age of the record at the tail; the stored time is 32-bit ms */
+static uint32_t tail_age_ms(uint32_t now_ms)
+{
+	tag_store_hdr_t hdr;
+
+	ring_read(store_tail, &hdr, sizeof(hdr));
+	return now_ms - hdr.read_ms;
+}
+
+/* ========================================================================
+ * API Functions
+ * ======================================================================== */
+
+int tag_store_put(const uint8_t *epc, uint8_t epc_len, int64_t read_time)
+{
+	tag_store_hdr_t hdr;
+
+	if (epc_len == 0 || epc_len > E310_MAX_EPC_LENGTH) {
+		return -EINVAL;
+	}
+
+	hdr.read_ms = (uint32_t)read_time;
+	hdr.epc_len = epc_len;
+
+	size_t need = sizeof(hdr) + epc_len;
+	k_spinlock_key_t key = k_spin_lock(&store_lock);
+
+	while (TAG_STORE_BUF_SIZE - (store_head - store_tail) < need) {
+		ring_remove_oldest();
+		stats.dropped++;
+	}
+
+	ring_write(store_head, &hdr, sizeof(hdr));
+	ring_write(store_head + sizeof(hdr), epc, epc_len);
+	store_head += need;
+	store_count++;
+	stats.buffered++;
+
+	k_spin_unlock(&store_lock, key);
+	return 0;
+}
+
+int tag_store_peek(tag_store_record_t *rec)
+{
+	int64_t now = k_uptime_get();
+	tag_store_hdr_t hdr;
+
+	k_spinlock_key_t key = k_spin_lock(&store_lock);
+
+	while (store_count > 0 && expiry_ms > 0 &&
+	       tail_age_ms((uint32_t)now) >= expiry_ms) {
+		ring_remove_oldest();
+		stats.expired++;
+	}
+
+	if (store_count == 0) {
+		k_spin_unlock(&store_lock, key);
+		return -ENOENT;
+	}
+
+	ring_read(store_tail, &hdr, sizeof(hdr));
+	ring_read(store_tail + sizeof(hdr), rec->epc, hdr.epc_len);
+	rec->epc_len = hdr.epc_len;
+	rec->read_time = now - (uint32_t)((uint32_t)now - hdr.read_ms);
+
+	k_spin_unlock(&store_lock, key);
+	return 0;
+}
+
+void tag_store_pop(tag_store_outcome_t outcome)
+{
+	k_spinlock_key_t key = k_spin_lock(&store_lock);
+
+	if (store_count > 0) {
+		ring_remove_oldest();
+
+		switch (outcome) {
+		case TAG_STORE_REPLAYED:
+			stats.replayed++;
+			break;
+		case TAG_STORE_DEDUPED:
+			stats.deduped++;
+			break;
+		default:
+			stats.failed++;
+			break;
+		}
+	}
+
+	k_spin_unlock(&store_lock, key);
+}
+
+bool tag_store_pending(void)
+{
+	return store_count > 0;
+}
+
+void tag_store_clear(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&store_lock);
+
+	store_head = 0;
+	store_tail = 0;
+	store_count = 0;
+	memset(&stats, 0, sizeof(stats));
+	k_spin_unlock(&store_lock, key);
+}
+
+void tag_store_set_expiry(uint32_t sec)
+{
+	expiry_ms = sec * 1000U;
+}
+
+uint32_t tag_store_get_expiry(void)
+{
+	return expiry_ms / 1000U;
+}
+
+int tag_store_set_rate(uint32_t per_sec)
+{
+	if (per_sec < TAG_STORE_RATE_MIN || per_sec > TAG_STORE_RATE_MAX) {
+		return -EINVAL;
+	}
+
+	replay_rate = per_sec;
+	return 0;
+}
+
+uint32_t tag_store_get_rate(void)
+{
+	return replay_rate;
+}
+
+void tag_store_get_stats(tag_store_stats_t *out)
+{
+	k_spinlock_key_t key = k_spin_lock(&store_lock);
+
+	*out = stats;
+	out->records = store_count;
+	out->used_bytes = store_head - store_tail;
+	out->oldest_age_ms = (store_count > 0) ?
+			     tail_age_ms((uint32_t)k_uptime_get()) : 0;
+	k_spin_unlock(&store_lock, key);
+}
@@ -0,0 +1,187 @@
+/**
+ * @file tag_store.h
+ * @brief Store-and-Forward Buffer for Tags the HID Sink Could Not Take
+ *
+ * While the USB HID interface is not ready (re-enumeration, host sleep,
+ * cable swap) the router parks accepted tag reads here instead of losing
+ * them. Each record keeps the EPC and the uptime it was read at. Once the
+ * interface is back the router replays the records oldest first at a
+ * bounded rate, skipping those that have expired or that the duplicate
+ * cache shows were already delivered.
+ *
+ * When the store is full the oldest records are dropped.
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#ifndef TAG_STORE_H_
+#define TAG_STORE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "e310_protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup tag_store Tag Store
+ * @{
+ */
+
+/* ========================================================================
+ * Constants
+ * ======================================================================== */
+
+/**
+ * Store size in bytes (must be a power of two)
+ *
+ * 64 KB is what the 320 KB of SRAM has spare after the stacks, the UDC
+ * pool, the router rings and the 32 KB RX capture: about 3800 records
+ * of 12-byte EPCs, i.e. minutes of outage at a busy portal.
+ */
+#define TAG_STORE_BUF_SIZE              65536
+
+/** Default record lifetime in seconds (0 = keep until replayed) */
+#define TAG_STORE_EXPIRY_DEFAULT_SEC    600
+
+/** Default replay rate in records per second */
+#define TAG_STORE_RATE_DEFAULT          20
+
+/** Replay rate limits (the router polls every 10 ms) */
+#define TAG_STORE_RATE_MIN              1
+#define TAG_STORE_RATE_MAX              100
+
+/* ========================================================================
+ * Data Structures
+ * ======================================================================== */
+
+/**
+ * @brief Stored record header (followed by @ref epc_len EPC bytes)
+ */
+typedef struct __attribute__((packed)) {
+	uint32_t read_ms;           /**< Uptime of the read in ms (wraps ~49 days) */
+	uint8_t  epc_len;           /**< EPC length */
+} tag_store_hdr_t;
+
+/**
+ * @brief Record as handed back by tag_store_peek()
+ */
+typedef struct {
+	int64_t read_time;                  /**< k_uptime_get() of the read */
+	uint8_t epc_len;                    /**< EPC length */
+	uint8_t epc[E310_MAX_EPC_LENGTH];   /**< EPC data */
+} tag_store_record_t;
+
+/**
+ * @brief Outcome of a record leaving the store (tag_store_pop())
+ */
+typedef enum {
+	TAG_STORE_REPLAYED = 0,     /**< Delivered to the host */
+	TAG_STORE_DEDUPED,          /**< Already delivered, skipped */
+	TAG_STORE_FAILED,           /**< Sink rejected it, dropped */
+} tag_store_outcome_t;
+
+/**
+ * @brief Tag store statistics
+ */
+typedef struct {
+	uint32_t buffered;          /**< Records stored since last clear */
+	uint32_t replayed;          /**< Records delivered on replay */
+	uint32_t expired;           /**< Records discarded for age */
+	uint32_t deduped;           /**< Records skipped as already delivered */
+	uint32_t dropped;           /**< Oldest records overwritten (store full) */
+	uint32_t failed;            /**< Records the sink rejected on replay */
+	uint32_t records;           /**< Records currently held */
+	uint32_t used_bytes;        /**< Bytes currently held */
+	uint32_t oldest_age_ms;     /**< Age of the oldest record (0 if empty) */
+} tag_store_stats_t;
+
+/* ========================================================================
+ * API Functions
+ * ======================================================================== */
+
+/**
+ * @brief Store a tag read for later delivery
+ *
+ * Drops the oldest records if there is no room.
+ *
+ * @param epc EPC bytes
+ * @param epc_len EPC length (1..E310_MAX_EPC_LENGTH)
+ * @param read_time k_uptime_get() of the read
+ * @return 0 on success, -EINVAL on bad length
+ */
+int tag_store_put(const uint8_t *epc, uint8_t epc_len, int64_t read_time);
+
+/**
+ * @brief Get the oldest record that has not expired
+ *
+ * Expired records in front of it are discarded and counted. The record
+ * stays in the store until tag_store_pop().
+ *
+ * @param rec Output: record copy
+ * @return 0 on success, -ENOENT if the store is empty
+ */
+int tag_store_peek(tag_store_record_t *rec);
+
+/**
+ * @brief Remove the oldest record
+ *
+ * @param outcome What happened to it (selects the counter)
+ */
+void tag_store_pop(tag_store_outcome_t outcome);
+
+/**
+ * @brief Check if records are waiting
+ *
+ * @return true if the store holds at least one record
+ */
+bool tag_store_pending(void);
+
+/**
+ * @brief Discard all records and reset counters
+ */
+void tag_store_clear(void);
+
+/**
+ * @brief Set the record lifetime
+ *
+ * @param sec Seconds after the read a record is discarded (0 = never)
+ */
+void tag_store_set_expiry(uint32_t sec);
+
+/**
+ * @brief Get the record lifetime in seconds
+ */
+uint32_t tag_store_get_expiry(void);
+
+/**
+ * @brief Set the replay rate
+ *
+ * @param per_sec Records per second (TAG_STORE_RATE_MIN..MAX)
+ * @return 0 on success, -EINVAL if out of range
+ */
+int tag_store_set_rate(uint32_t per_sec);
+
+/**
+ * @brief Get the replay rate in records per second
+ */
+uint32_t tag_store_get_rate(void);
+
+/**
+ * @brief Get store statistics
+ *
+ * @param stats Output: statistics structure
+ */
+void tag_store_get_stats(tag_store_stats_t *stats);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TAG_STORE_H_ */
@@ -0,0 +1,367 @@
+/**
+ * @file thermal_gov.c
+ * @brief E310 Thermal Governor Implementation
+ *
+ * The router thread samples and reads the throttle; the shell reads the
+ * stats and changes settings. Everything shared sits under one spinlock.
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#include "thermal_gov.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/spinlock.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+LOG_MODULE_REGISTER(thermal_gov, LOG_LEVEL_INF);
+
+/** Degrees over the ceiling worth one extra level per sample */
+#define THERMAL_GOV_STEP_C      2
+
+/* RF power first, then duty cycle (see thermal_gov.h) */
+static const uint8_t power_cut_db[THERMAL_GOV_MAX_LEVEL + 1] = {
+	0, 2, 4, 6, 8, 8, 8, 8, 8,
+};
+static const uint8_t duty_pct[THERMAL_GOV_MAX_LEVEL + 1] = {
+	100, 100, 100, 100, 100, 75, 50, 35, 25,
+};
+
+static struct k_spinlock gov_lock;
+static bool gov_enabled = true;
+static int8_t gov_ceiling_c = THERMAL_GOV_DEFAULT_CEILING_C;
+static uint32_t gov_period_ms = THERMAL_GOV_DEFAULT_PERIOD_MS;
+
+static thermal_gov_stats_t gov_stats;
+static int64_t next_sample_ms;
+static int64_t last_sample_ms;
+static bool over_ceiling;
+
+static thermal_gov_sample_t history[THERMAL_GOV_HISTORY];
+static size_t history_head;
+static size_t history_count;
+
+/* gov_lock held */
+static void set_level_locked(uint8_t level)
+{
+	if (level > 0 && gov_stats.level == 0) {
+		gov_stats.throttle_events++;
+	}
+	gov_stats.level = level;
+	gov_stats.max_level = MAX(gov_stats.max_level, level);
+	gov_stats.power_cut_db = power_cut_db[level];
+	gov_stats.duty_pct = duty_pct[level];
+}
+
+static void reset_locked(void)
+{
+	gov_stats = (thermal_gov_stats_t){ 0 };
+	set_level_locked(0);
+	last_sample_ms = 0;
+	over_ceiling = false;
+	history_head = 0;
+	history_count = 0;
+}
+
+bool thermal_gov_sample_due(void)
+{
+	return gov_enabled && k_uptime_get() >= next_sample_ms;
+}
+
+void thermal_gov_sample_sent(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&gov_lock);
+
+	next_sample_ms = k_uptime_get() + gov_period_ms;
+	gov_stats.requests++;
+	k_spin_unlock(&gov_lock, key);
+}
+
+void thermal_gov_update(int8_t temp_c)
+{
+	int64_t now = k_uptime_get();
+	k_spinlock_key_t key = k_spin_lock(&gov_lock);
+	uint8_t level = gov_stats.level;
+	uint8_t was = level;
+
+	/* The interval since the last sample counts at the state it had */
+	if (last_sample_ms != 0) {
+		uint32_t dt = (uint32_t)(now - last_sample_ms);
+
+		if (level > 0) {
+			gov_stats.throttled_ms += dt;
+		}
+		if (over_ceiling) {
+			gov_stats.over_ms += dt;
+		}
+	}
+	last_sample_ms = now;
+	over_ceiling = temp_c >= gov_ceiling_c;
+
+	if (gov_stats.samples == 0) {
+		gov_stats.min_c = temp_c;
+		gov_stats.max_c = temp_c;
+	}
+	gov_stats.samples++;
+	gov_stats.temp_c = temp_c;
+	gov_stats.min_c = MIN(gov_stats.min_c, temp_c);
+	gov_stats.max_c = MAX(gov_stats.max_c, temp_c);
+
+	if (!gov_enabled) {
+		level = 0;
+	} else if (over_ceiling) {
+		level += 1 + (temp_c - gov_ceiling_c) / THERMAL_GOV_STEP_C;
+		level = MIN(level, THERMAL_GOV_MAX_LEVEL);
+	} else if (temp_c <= gov_ceiling_c - THERMAL_GOV_HYSTERESIS_C && level > 0) {
+		level--;
+	}
+	set_level_locked(level);
+
+	history[history_head] = (thermal_gov_sample_t){
+		.uptime_s = (uint32_t)(now / 1000),
+		.temp_c = temp_c,
+		.level = level,
+	};
+	history_head = (history_head + 1) % THERMAL_GOV_HISTORY;
+	if (history_count < THERMAL_GOV_HISTORY) {
+		history_count++;
+	}
+
+	k_spin_unlock(&gov_lock, key);
+
+	if (level != was) {
+		LOG_INF("E310 %d C: throttle level %u (RF -%u dB, duty %u%%)",
+			temp_c, level, power_cut_db[level], duty_pct[level]);
+	}
+}
+
+uint8_t thermal_gov_rf_power(uint8_t configured)
+{
+	uint8_t cut = power_cut_db[gov_stats.level];
+
+	return configured > cut ? configured - cut : 0;
+}
+
+uint32_t thermal_gov_round_gap_ms(uint32_t gap_ms, uint32_t round_ms)
+{
+	uint8_t duty = duty_pct[gov_stats.level];
+	uint32_t idle_ms = round_ms * (100 - duty) / duty;
+
+	return MAX(gap_ms, idle_ms);
+}
+
+void thermal_gov_get_stats(thermal_gov_stats_t *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&gov_lock);
+
+	*stats = gov_stats;
+	k_spin_unlock(&gov_lock, key);
+}
+
+size_t thermal_gov_get_history(thermal_gov_sample_t *out, size_t max)
+{
+	k_spinlock_key_t key = k_spin_lock(&gov_lock);
+	size_t n = MIN(max, history_count);
+	size_t first = (history_head + THERMAL_GOV_HISTORY - n) % THERMAL_GOV_HISTORY;
+
+	for (size_t i = 0; i < n; i++) {
+		out[i] = history[(first + i) % THERMAL_GOV_HISTORY];
+	}
+	k_spin_unlock(&gov_lock, key);
+
+	return n;
+}
+
+void thermal_gov_reset(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&gov_lock);
+
+	reset_locked();
+	k_spin_unlock(&gov_lock, key);
+}
+
+int thermal_gov_set_ceiling(int ceiling_c)
+{
+	if (ceiling_c < THERMAL_GOV_CEILING_MIN_C ||
+	    ceiling_c > THERMAL_GOV_CEILING_MAX_C) {
+		return -EINVAL;
+	}
+
+	gov_ceiling_c = (int8_t)ceiling_c;
+	return 0;
+}
+
+int8_t thermal_gov_get_ceiling(void)
+{
+	return gov_ceiling_c;
+}
+
+int thermal_gov_set_period(uint32_t period_ms)
+{
+	k_spinlock_key_t key;
+
+	if (period_ms < THERMAL_GOV_PERIOD_MIN_MS ||
+	    period_ms > THERMAL_GOV_PERIOD_MAX_MS) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&gov_lock);
+	gov_period_ms = period_ms;
+	next_sample_ms = MIN(next_sample_ms, k_uptime_get() + period_ms);
+	k_spin_unlock(&gov_lock, key);
+	return 0;
+}
+
+uint32_t thermal_gov_get_period(void)
+{
+	return gov_period_ms;
+}
+
+void thermal_gov_set_enabled(bool enable)
+{
+	k_spinlock_key_t key = k_spin_lock(&gov_lock);
+
+	gov_enabled = enable;
+	if (!enable) {
+		set_level_locked(0);
+	}
+	k_spin_unlock(&gov_lock, key);
+}
+
+bool thermal_gov_is_enabled(void)
+{
+	return gov_enabled;
+}
+
+/* ========================================================================
+ * Shell Commands
+ * ======================================================================== */
+
+static int cmd_thermal_status(const struct shell *sh, size_t argc, char **argv)
+{
+	thermal_gov_stats_t st;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	thermal_gov_get_stats(&st);
+
+	shell_print(sh, "=== Thermal Governor ===");
+	shell_print(sh, "Governor: %s, ceiling %d C, sample every %u ms",
+		    gov_enabled ? "on" : "off", gov_ceiling_c, gov_period_ms);
+	if (st.samples == 0) {
+		shell_print(sh, "No samples yet (%u requested)", st.requests);
+		return 0;
+	}
+	shell_print(sh, "Temperature: %d C (min %d, max %d)", st.temp_c,
+		    st.min_c, st.max_c);
+	shell_print(sh, "Level: %u/%u (max %u): RF -%u dB, duty %u%%", st.level,
+		    THERMAL_GOV_MAX_LEVEL, st.max_level, st.power_cut_db, st.duty_pct);
+	shell_print(sh, "Samples: %u of %u requested", st.samples, st.requests);
+	shell_print(sh, "Throttled: %u s in %u events, over ceiling %u s",
+		    st.throttled_ms / 1000, st.throttle_events, st.over_ms / 1000);
+	return 0;
+}
+
+static int cmd_thermal_history(const struct shell *sh, size_t argc, char **argv)
+{
+	static thermal_gov_sample_t h[THERMAL_GOV_HISTORY];
+	uint32_t now_s = (uint32_t)(k_uptime_get() / 1000);
+	size_t n;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	n = thermal_gov_get_history(h, ARRAY_SIZE(h));
+	if (n == 0) {
+		shell_print(sh, "No samples yet");
+		return 0;
+	}
+
+	shell_print(sh, "%8s %5s %5s", "age (s)", "C", "level");
+	for (size_t i = 0; i < n; i++) {
+		shell_print(sh, "%8u %5d %5u", now_s - h[i].uptime_s, h[i].temp_c,
+			    h[i].level);
+	}
+	return 0;
+}
+
+static int cmd_thermal_ceiling(const struct shell *sh, size_t argc, char **argv)
+{
+	if (argc < 2) {
+		shell_print(sh, "Ceiling: %d C", gov_ceiling_c);
+		return 0;
+	}
+
+	if (thermal_gov_set_ceiling((int)strtol(argv[1], NULL, 10)) < 0) {
+		shell_error(sh, "Ceiling must be %d-%d C", THERMAL_GOV_CEILING_MIN_C,
+			    THERMAL_GOV_CEILING_MAX_C);
+		return -EINVAL;
+	}
+
+	shell_print(sh, "Ceiling set to %d C", gov_ceiling_c);
+	return 0;
+}
+
+static int cmd_thermal_period(const struct shell *sh, size_t argc, char **argv)
+{
+	if (argc < 2) {
+		shell_print(sh, "Sample period: %u ms", gov_period_ms);
+		return 0;
+	}
+
+	if (thermal_gov_set_period(strtoul(argv[1], NULL, 10)) < 0) {
+		shell_error(sh, "Period must be %u-%u ms", THERMAL_GOV_PERIOD_MIN_MS,
+			    THERMAL_GOV_PERIOD_MAX_MS);
+		return -EINVAL;
+	}
+
+	shell_print(sh, "Sample period set to %u ms", gov_period_ms);
+	return 0;
+}
+
+static int cmd_thermal_enable(const struct shell *sh, size_t argc, char **argv)
+{
+	if (argc < 2) {
+		shell_print(sh, "Governor: %s", gov_enabled ? "on" : "off");
+		return 0;
+	}
+
+	if (strcmp(argv[1], "on") == 0) {
+		thermal_gov_set_enabled(true);
+	} else if (strcmp(argv[1], "off") == 0) {
+		thermal_gov_set_enabled(false);
+	} else {
+		shell_error(sh, "Usage: thermal enable <on|off>");
+		return -EINVAL;
+	}
+
+	shell_print(sh, "Governor %s", gov_enabled ? "on" : "off (throttle released)");
+	return 0;
+}
+
+static int cmd_thermal_reset(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	thermal_gov_reset();
+	shell_print(sh, "Thermal stats and history cleared, throttle released");
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_thermal,
+	SHELL_CMD(status, NULL, "Temperature, throttle level and time", cmd_thermal_status),
+	SHELL_CMD(history, NULL, "Recent samples, oldest first", cmd_thermal_history),
+	SHELL_CMD(ceiling, NULL, "Get/set ceiling (C)", cmd_thermal_ceiling),
+	SHELL_CMD(period, NULL, "Get/set sample period (ms)", cmd_thermal_period),
+	SHELL_CMD(enable, NULL, "Governor <on|off>", cmd_thermal_enable),
+	SHELL_CMD(reset, NULL, "Clear stats and history, release throttle",
+		  cmd_thermal_reset),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(thermal, &sub_thermal, "E310 thermal governor", NULL);
@@ -0,0 +1,197 @@
+/**
+ * @file thermal_gov.h
+ * @brief E310 Thermal Governor
+ *
+ * Holds the reader module under a temperature ceiling during continuous
+ * inventory. The router samples the E310 temperature sensor (0x92)
+ * between rounds every sample period and feeds it here. A sample at or
+ * over the ceiling raises the throttle level by one, plus one for every
+ * 2 C over; one at least THERMAL_GOV_HYSTERESIS_C below it lowers the
+ * level by one.
+ *
+ * Levels cut RF power first, in 2 dB steps: that costs read range at the
+ * edge of the field but not throughput close in. Only past the power
+ * steps is the inventory duty cycle lowered, by idling after each round.
+ *
+ *   level   0    1    2    3    4    5    6    7    8
+ *   RF -dB  0    2    4    6    8    8    8    8    8
+ *   duty %  100  100  100  100  100  75   50   35   25
+ *
+ * Throttled time, time over the ceiling and the last
+ * THERMAL_GOV_HISTORY samples are kept for the shell.
+ *
+ * Settings are not persisted; they return to the defaults on reboot.
+ *
+ * Shell:
+ *   thermal status             temperature, level, throttled time
+ *   thermal history            recent samples, oldest first
+ *   thermal ceiling [C]        get/set the ceiling
+ *   thermal period [ms]        get/set the sample period
+ *   thermal enable <on|off>    turn the governor on or off
+ *   thermal reset              clear stats and history, release throttle
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#ifndef THERMAL_GOV_H_
+#define THERMAL_GOV_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup thermal_gov Thermal Governor
+ * @{
+ */
+
+/** Samples of temperature history kept */
+#define THERMAL_GOV_HISTORY             60
+
+/** Default ceiling and its valid range (C) */
+#define THERMAL_GOV_DEFAULT_CEILING_C   60
+#define THERMAL_GOV_CEILING_MIN_C       30
+#define THERMAL_GOV_CEILING_MAX_C       85
+
+/** Cooling below the ceiling needed to step a level down (C) */
+#define THERMAL_GOV_HYSTERESIS_C        3
+
+/** Default sample period and its valid range (ms) */
+#define THERMAL_GOV_DEFAULT_PERIOD_MS   5000
+#define THERMAL_GOV_PERIOD_MIN_MS       1000
+#define THERMAL_GOV_PERIOD_MAX_MS       60000
+
+/** Highest throttle level */
+#define THERMAL_GOV_MAX_LEVEL           8
+
+/**
+ * @brief Governor counters and current state
+ */
+typedef struct {
+	int8_t   temp_c;            /**< Latest sample */
+	int8_t   min_c;             /**< Lowest sample */
+	int8_t   max_c;             /**< Highest sample */
+	uint8_t  level;             /**< Throttle level (0 = none) */
+	uint8_t  max_level;         /**< Highest level reached */
+	uint8_t  power_cut_db;      /**< RF power derating at this level */
+	uint8_t  duty_pct;          /**< Inventory duty cycle at this level */
+	uint32_t requests;          /**< Samples asked of the E310 */
+	uint32_t samples;           /**< Samples received */
+	uint32_t throttle_events;   /**< Level 0 -> throttled transitions */
+	uint32_t throttled_ms;      /**< Time spent at level > 0 */
+	uint32_t over_ms;           /**< Time spent at or over the ceiling */
+} thermal_gov_stats_t;
+
+/**
+ * @brief One history entry
+ */
+typedef struct {
+	uint32_t uptime_s;          /**< When it was taken */
+	int8_t   temp_c;            /**< Temperature */
+	uint8_t  level;             /**< Level after the sample */
+} thermal_gov_sample_t;
+
+/**
+ * @brief Check whether the next temperature sample is due
+ *
+ * Router thread only.
+ */
+bool thermal_gov_sample_due(void);
+
+/**
+ * @brief Note that a sample request went out (restarts the period)
+ */
+void thermal_gov_sample_sent(void);
+
+/**
+ * @brief Feed a temperature sample and update the throttle level
+ *
+ * @param temp_c Reader temperature (C)
+ */
+void thermal_gov_update(int8_t temp_c);
+
+/**
+ * @brief RF power to run with at the current level
+ *
+ * @param configured Configured RF power (dBm)
+ * @return Derated RF power (dBm)
+ */
+uint8_t thermal_gov_rf_power(uint8_t configured);
+
+/**
+ * @brief Idle time before the next round at the current level
+ *
+ * @param gap_ms Configured inventory interval
+ * @param round_ms Duration of the round just finished
+ * @return The larger of @p gap_ms and the duty-cycle idle time
+ */
+uint32_t thermal_gov_round_gap_ms(uint32_t gap_ms, uint32_t round_ms);
+
+/**
+ * @brief Read counters and state
+ *
+ * @param stats Output
+ */
+void thermal_gov_get_stats(thermal_gov_stats_t *stats);
+
+/**
+ * @brief Copy the temperature history, oldest first
+ *
+ * @param out Output array
+ * @param max Entries @p out holds
+ * @return Entries copied
+ */
+size_t thermal_gov_get_history(thermal_gov_sample_t *out, size_t max);
+
+/**
+ * @brief Clear counters and history and drop back to level 0
+ */
+void thermal_gov_reset(void);
+
+/**
+ * @brief Set the ceiling
+ *
+ * @param ceiling_c THERMAL_GOV_CEILING_MIN_C..THERMAL_GOV_CEILING_MAX_C
+ * @return 0 on success, -EINVAL if out of range
+ */
+int thermal_gov_set_ceiling(int ceiling_c);
+
+/**
+ * @brief Get the ceiling (C)
+ */
+int8_t thermal_gov_get_ceiling(void);
+
+/**
+ * @brief Set the sample period
+ *
+ * @param period_ms THERMAL_GOV_PERIOD_MIN_MS..THERMAL_GOV_PERIOD_MAX_MS
+ * @return 0 on success, -EINVAL if out of range
+ */
+int thermal_gov_set_period(uint32_t period_ms);
+
+/**
+ * @brief Get the sample period (ms)
+ */
+uint32_t thermal_gov_get_period(void);
+
+/**
+ * @brief Turn the governor on or off (off releases any throttle)
+ */
+void thermal_gov_set_enabled(bool enable);
+
+/**
+ * @brief Check if the governor is on
+ */
+bool thermal_gov_is_enabled(void);
+
+/** @} */ /* End of thermal_gov group */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* THERMAL_GOV_H_ */
@@ -3,8 +3,13 @@
  * @brief UART Router Implementation
  *
  * Thread Safety:
- * - uart_router_process() must be called from single thread only
- * - Shell commands are thread-safe (protected by mode_lock)
+ * - The router thread owns the router context and all UART4 TX; other
+ *   threads only post requests (uart_router_post()/uart_router_call())
+ * - The UART4 ISR is the RX ring's only producer besides
+ *   uart_router_inject_rx(), which masks it
+ * - UART4 TX is drained by DMA (async API, "tx" DMA channel on uart4)
+ *   or by the TX FIFO interrupt; uart4_tx_busy marks a transmission in
+ *   flight and is only cleared from its completion
  * - Ring buffer reset operations are protected by disabling interrupts
  *
  * @copyright Copyright (c) 2026 PARP
@@ -13,9 +18,20 @@
 #include "uart_router.h"
 #include "usb_hid.h"
 #include "beep_control.h"
+#include "feedback.h"
 #include "rgb_led.h"
 #include "switch_control.h"
 #include "e310_settings.h"
+#include "frame_trace.h"
+#include "rx_capture.h"
+#include "log_ratelimit.h"
+#include "router_metrics.h"
+#include "tag_store.h"
+#include "tag_session.h"
+#include "ctrl_proto.h"
+#include "thermal_gov.h"
+#include <zephyr/linker/linker-defs.h>
+#include <zephyr/linker/section_tags.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/shell/shell.h>
 #include <zephyr/sys/atomic.h>
@@ -33,14 +49,69 @@ static uart_router_t *g_router_instance;
 /** Frame assembler timeout (ms) - reset if no byte for this duration */
 #define FRAME_ASSEMBLER_TIMEOUT_MS  100
 
-/* Re-entrance guard for uart_router_process() */
-static atomic_t process_lock = ATOMIC_INIT(0);
+/** Response timeout for a reader-side config command (ms) */
+#define CFG_RESPONSE_TIMEOUT_MS     200
+
+/** Longest a queued command may take to leave UART4 (4 KB ring @ 115200 ~ 360 ms) */
+#define UART4_TX_STALL_MS           500
+
+/*
+ * UART4 TX over DMA when the async API is on and uart4 has a "tx" DMA
+ * channel: everything queued while a transfer runs goes out as the next
+ * single transfer. Otherwise (e.g. the native_sim UART emulator) the TX
+ * FIFO interrupt drains the ring 64 bytes at a time.
+ */
+#if defined(CONFIG_UART_ASYNC_API) && DT_DMAS_HAS_NAME(DT_NODELABEL(uart4), tx)
+#define UART4_TX_DMA                1
+
+/** Largest single DMA transfer (staging buffer size) */
+#define UART4_DMA_CHUNK             512
+
+/*
+ * The STM32 async driver refuses (-EFAULT) a TX buffer outside the
+ * nocache region when the D-cache is on, so this one stays there rather
+ * than in cached SRAM with explicit maintenance.
+ */
+BUILD_ASSERT(!IS_ENABLED(CONFIG_DCACHE) || IS_ENABLED(CONFIG_NOCACHE_MEMORY),
+	     "UART4 DMA TX needs CONFIG_NOCACHE_MEMORY with the D-cache on");
+static uint8_t uart4_dma_buf[UART4_DMA_CHUNK] __nocache;
+#endif
+
+/** Link supervisor: slack past a round's scan time or the heartbeat */
+#define LINK_ROUND_MARGIN_MS        300
+#define LINK_HEARTBEAT_MARGIN_MS    2000
+
+/** Heartbeat asked of the E310 for real-time mode (x30 s, the minimum) */
+#define LINK_HEARTBEAT_UNITS        1
+
+/** Resync step timeouts: a live reader is back in well under 100 ms */
+#define LINK_STOP_TIMEOUT_MS        20
+#define LINK_INFO_TIMEOUT_MS        40
+#define LINK_CFG_TIMEOUT_MS         30
+
+/** Resync retry period while the reader does not answer */
+#define LINK_RETRY_MS               1000
+
+/** Shell wait for a config change to reach the E310 (> one 1 s round) */
+#define CFG_SHELL_WAIT_MS           1500
+
+/** Router thread */
+#define ROUTER_STACK_SIZE           3072
+#define ROUTER_PRIORITY             K_PRIO_PREEMPT(2)
 
 /* ISR overrun flag — set in ISR, handled in thread context */
 static atomic_t uart4_rx_overrun = ATOMIC_INIT(0);
 
 /* Forward declarations */
 static void frame_assembler_reset(frame_assembler_t *fa);
+static int wait_for_e310_response(uart_router_t *router, int timeout_ms);
+static void router_thread_fn(void *p1, void *p2, void *p3);
+
+/* Router thread (created by the first uart_router_start()) */
+K_THREAD_STACK_DEFINE(router_stack, ROUTER_STACK_SIZE);
+static struct k_thread router_thread;
+static k_tid_t router_tid;
+static atomic_t router_checkin;     /* Set by the thread, cleared by the watchdog */
 
 /* ========================================================================
  * Phase 1.1: Safe Ring Buffer Reset Helper
@@ -64,10 +135,9 @@ static void safe_uart4_rx_reset(uart_router_t *router)
 /**
  * @brief Initialize EPC filter
  */
-static void epc_filter_init(epc_filter_t *filter, uint32_t debounce_sec)
+static void epc_filter_init(epc_filter_t *filter)
 {
 	memset(filter, 0, sizeof(epc_filter_t));
-	filter->debounce_ms = debounce_sec * 1000;
 }
 
 /**
@@ -80,15 +150,6 @@ static void epc_filter_clear(epc_filter_t *filter)
 	memset(filter->entries, 0, sizeof(filter->entries));
 }
 
-/**
- * @brief Set EPC filter debounce time
- */
-static void epc_filter_set_debounce(epc_filter_t *filter, uint32_t debounce_sec)
-{
-	filter->debounce_ms = debounce_sec * 1000;
-	LOG_INF("EPC debounce set to %u seconds", debounce_sec);
-}
-
 static void epc_filter_print_summary(epc_filter_t *filter)
 {
 	if (filter->count == 0) {
@@ -117,9 +178,12 @@ static void epc_filter_print_summary(epc_filter_t *filter)
 	}
 }
 
-static bool epc_filter_check(epc_filter_t *filter, const uint8_t *epc,
-                             uint8_t epc_len, uint8_t rssi)
+static bool epc_filter_check(epc_filter_t *filter, uint32_t debounce_ms,
+                             const uint8_t *epc, uint8_t epc_len, uint8_t rssi,
+                             bool *is_new)
 {
+	*is_new = false;
+
 	int64_t now = k_uptime_get();
 
 	for (uint8_t i = 0; i < filter->count; i++) {
@@ -136,7 +200,7 @@ static bool epc_filter_check(epc_filter_t *filter, const uint8_t *epc,
 				entry->rssi_min = rssi;
 			}
 
-			if ((now - entry->last_sent) < filter->debounce_ms) {
+			if ((now - entry->last_sent) < debounce_ms) {
 				return false;
 			}
 			entry->last_sent = now;
@@ -144,11 +208,14 @@ static bool epc_filter_check(epc_filter_t *filter, const uint8_t *epc,
 		}
 	}
 
+	*is_new = true;
+
 	epc_cache_entry_t *entry = &filter->entries[filter->next_idx];
 	memcpy(entry->epc, epc, epc_len);
 	entry->epc_len = epc_len;
 	entry->last_sent = now;
 	entry->last_seen = now;
+	entry->last_delivered = -1;
 	entry->rssi_max = rssi;
 	entry->rssi_min = rssi;
 	entry->read_count = 1;
@@ -298,9 +365,13 @@ static void uart4_callback(const struct device *dev, void *user_data)
 				router->stats.rx_overruns++;
 				atomic_set(&uart4_rx_overrun, 1);
 			}
+
+			rx_capture_chunk(buf, len, (put < len) ?
+					 RX_CAPTURE_FLAG_OVERRUN : 0);
 		}
 	}
 
+#ifndef UART4_TX_DMA
 	/* Phase 2.1: Handle TX with claim/finish pattern */
 	if (uart_irq_tx_ready(dev)) {
 		uint8_t *data;
@@ -310,13 +381,72 @@ static void uart4_callback(const struct device *dev, void *user_data)
 			int sent = uart_fifo_fill(dev, data, len);
 			ring_buf_get_finish(&router->uart4_tx_ring, sent);
 			router->stats.uart4_tx_bytes += sent;
+			atomic_set(&router->uart4_tx_busy, 1);
 		} else {
-			/* No more data to send, disable TX interrupt */
+			/* No more data to send, disable TX interrupt. The FIFO
+			 * still holds the tail: complete to within a FIFO's worth */
 			uart_irq_tx_disable(dev);
+			atomic_set(&router->uart4_tx_done_ms, k_uptime_get_32());
+			atomic_clear(&router->uart4_tx_busy);
+		}
+	}
+#endif
+}
+
+#ifdef UART4_TX_DMA
+/**
+ * @brief Start a DMA transfer of whatever is queued, unless one is running
+ *
+ * Called by the router thread after queueing and by the TX-done event.
+ * Only the caller that takes uart4_tx_busy touches the staging buffer, and
+ * no TX-done can arrive while nothing is in flight, so no lock is needed.
+ */
+static void uart4_tx_kick(uart_router_t *router)
+{
+	while (!ring_buf_is_empty(&router->uart4_tx_ring) &&
+	       atomic_cas(&router->uart4_tx_busy, 0, 1)) {
+		uint32_t len = ring_buf_get(&router->uart4_tx_ring, uart4_dma_buf,
+					    UART4_DMA_CHUNK);
+
+		if (uart_tx(router->uart4, uart4_dma_buf, len, SYS_FOREVER_US) == 0) {
+			atomic_inc(&router->uart4_tx_batches);
+			return;
 		}
+
+		router->stats.tx_errors++;
+		atomic_clear(&router->uart4_tx_busy);
 	}
 }
 
+/**
+ * @brief UART4 async callback (TX only; RX stays interrupt driven)
+ *
+ * UART_TX_DONE comes from the transmission-complete flag, i.e. after the
+ * last stop bit, which is where response timeouts start.
+ */
+static void uart4_async_callback(const struct device *dev,
+				 struct uart_event *evt, void *user_data)
+{
+	uart_router_t *router = (uart_router_t *)user_data;
+
+	ARG_UNUSED(dev);
+
+	switch (evt->type) {
+	case UART_TX_ABORTED:
+		router->stats.tx_errors++;
+		__fallthrough;
+	case UART_TX_DONE:
+		router->stats.uart4_tx_bytes += evt->data.tx.len;
+		atomic_set(&router->uart4_tx_done_ms, k_uptime_get_32());
+		atomic_clear(&router->uart4_tx_busy);
+		uart4_tx_kick(router);
+		break;
+	default:
+		break;
+	}
+}
+#endif
+
 /* ========================================================================
  * Initialization
  * ======================================================================== */
@@ -326,9 +456,6 @@ int uart_router_init(uart_router_t *router)
 	/* Clear context */
 	memset(router, 0, sizeof(uart_router_t));
 
-	/* Initialize mutex */
-	k_mutex_init(&router->mode_lock);
-
 	/* Get UART4 device (E310 RFID module) */
 	router->uart4 = DEVICE_DT_GET(DT_NODELABEL(uart4));
 	if (!device_is_ready(router->uart4)) {
@@ -348,13 +475,18 @@ int uart_router_init(uart_router_t *router)
 	/* Initialize frame assembler */
 	frame_assembler_reset(&router->e310_frame);
 
-	/* Initialize EPC filter with default debounce time */
-	epc_filter_init(&router->epc_filter, EPC_DEBOUNCE_DEFAULT_SEC);
+	/* Initialize EPC filter (debounce time comes from the runtime config) */
+	epc_filter_init(&router->epc_filter);
 
 	router->mode = ROUTER_MODE_IDLE;
 	router->inventory_active = false;
 	router->uart4_ready = true;
-	router->inventory_interval_ms = INVENTORY_INTERVAL_DEFAULT_MS;
+	runtime_config_get(&router->cfg);
+	router->e310_cfg = router->cfg;
+	router->rf_power_cfg = router->cfg.rf_power;
+	atomic_set(&router->cfg_applied, router->cfg.version);
+
+	router_metrics_init(router);
 
 	g_router_instance = router;
 
@@ -376,10 +508,33 @@ int uart_router_start(uart_router_t *router)
 
 	/* Configure UART4 interrupt */
 	uart_irq_callback_user_data_set(router->uart4, uart4_callback, router);
+#ifdef UART4_TX_DMA
+#ifdef CONFIG_NOCACHE_MEMORY
+	if (uart4_dma_buf < (uint8_t *)_nocache_ram_start ||
+	    uart4_dma_buf + UART4_DMA_CHUNK > (uint8_t *)_nocache_ram_end) {
+		LOG_ERR("UART4 DMA buffer is not in the nocache region");
+		return -EFAULT;
+	}
+#endif
+	int err = uart_callback_set(router->uart4, uart4_async_callback, router);
+
+	if (err < 0) {
+		LOG_ERR("UART4 async callback: %d", err);
+		return err;
+	}
+#endif
 	uart_irq_rx_enable(router->uart4);
 
 	router->running = true;
 
+	if (router_tid == NULL) {
+		router_tid = k_thread_create(&router_thread, router_stack,
+					     K_THREAD_STACK_SIZEOF(router_stack),
+					     router_thread_fn, router, NULL, NULL,
+					     ROUTER_PRIORITY, 0, K_NO_WAIT);
+		k_thread_name_set(router_tid, "uart_router");
+	}
+
 	LOG_INF("UART Router started");
 	return 0;
 }
@@ -391,7 +546,11 @@ int uart_router_stop(uart_router_t *router)
 	}
 
 	uart_irq_rx_disable(router->uart4);
+#ifdef UART4_TX_DMA
+	(void)uart_tx_abort(router->uart4);
+#else
 	uart_irq_tx_disable(router->uart4);
+#endif
 
 	router->running = false;
 
@@ -403,14 +562,11 @@ int uart_router_stop(uart_router_t *router)
  * Mode Control
  * ======================================================================== */
 
-int uart_router_set_mode(uart_router_t *router, router_mode_t mode)
+static void do_set_mode(uart_router_t *router, router_mode_t mode)
 {
-	k_mutex_lock(&router->mode_lock, K_FOREVER);
-
 	router_mode_t old_mode = router->mode;
-	router->mode = mode;
 
-	k_mutex_unlock(&router->mode_lock);
+	router->mode = mode;
 
 	if (old_mode != mode) {
 		LOG_INF("Mode changed: %s -> %s",
@@ -419,22 +575,207 @@ int uart_router_set_mode(uart_router_t *router, router_mode_t mode)
 
 		safe_uart4_rx_reset(router);
 	}
+}
 
-	return 0;
+/* ========================================================================
+ * Tag Delivery
+ * ======================================================================== */
+
+static epc_cache_entry_t *epc_filter_find(epc_filter_t *filter,
+					  const uint8_t *epc, uint8_t epc_len)
+{
+	for (uint8_t i = 0; i < filter->count; i++) {
+		epc_cache_entry_t *entry = &filter->entries[i];
+
+		if (entry->epc_len == epc_len &&
+		    memcmp(entry->epc, epc, epc_len) == 0) {
+			return entry;
+		}
+	}
+
+	return NULL;
 }
 
-router_mode_t uart_router_get_mode(uart_router_t *router)
+/**
+ * @brief Type one EPC on the HID keyboard as a hex string
+ *
+ * @return usb_hid_send_epc() result
+ */
+static int send_epc_hex(uart_router_t *router, const uint8_t *epc,
+			uint8_t epc_len, int64_t read_time)
+{
+	char epc_str[64];
+	int pos = 0;
+
+	for (uint8_t b = 0; b < epc_len && pos + 2 < (int)sizeof(epc_str); b++) {
+		pos += snprintf(&epc_str[pos], sizeof(epc_str) - pos,
+				"%02X", epc[b]);
+	}
+	epc_str[pos] = '\0';
+
+	int ret = usb_hid_send_epc((const uint8_t *)epc_str, strlen(epc_str));
+
+	if (ret >= 0) {
+		epc_cache_entry_t *entry = epc_filter_find(&router->epc_filter,
+							   epc, epc_len);
+
+		if (entry) {
+			entry->last_delivered = read_time;
+		}
+		router->stats.epc_sent++;
+	}
+	return ret;
+}
+
+/* ========================================================================
+ * E310 Beep Edge Audit
+ * ======================================================================== */
+
+/**
+ * @brief Start measuring a round (edge capture on)
+ */
+static void audit_round_begin(uart_router_t *router)
+{
+	router->audit_open = beep_control_is_edge_capture_enabled();
+	if (!router->audit_open) {
+		return;
+	}
+	router->audit_edge0 = beep_control_get_edge_count();
+	router->audit_edge_next = router->audit_edge0;
+	router->audit_tags0 = router->stats.tags_read;
+}
+
+/**
+ * @brief Pair a decoded tag with the next unpaired beep edge of the round
+ */
+static void audit_tag(uart_router_t *router)
+{
+	uint32_t edge_cyc;
+
+	if (!router->audit_open ||
+	    (int32_t)(beep_control_get_edge_count() - router->audit_edge_next) <= 0) {
+		return;
+	}
+	if (beep_control_get_edge_time(router->audit_edge_next++, &edge_cyc) < 0) {
+		return;
+	}
+
+	uart_router_audit_t *a = &router->audit;
+	uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - edge_cyc);
+
+	a->lat_count++;
+	a->lat_sum_us += us;
+	a->lat_avg_us = (uint32_t)(a->lat_sum_us / a->lat_count);
+	a->lat_max_us = MAX(a->lat_max_us, us);
+}
+
+/**
+ * @brief Close the round: reader saw N, we decoded M
+ */
+static void audit_round_end(uart_router_t *router)
+{
+	uart_router_audit_t *a = &router->audit;
+	uint32_t reads, decoded;
+
+	if (!router->audit_open) {
+		return;
+	}
+	router->audit_open = false;
+
+	reads = beep_control_get_edge_count() - router->audit_edge0;
+	decoded = router->stats.tags_read - router->audit_tags0;
+
+	a->rounds++;
+	a->reader_reads += reads;
+	a->decoded += decoded;
+	a->last_reads = reads;
+	a->last_decoded = decoded;
+	if (reads > decoded) {
+		a->missing += reads - decoded;
+	} else {
+		a->unbeeped += decoded - reads;
+	}
+}
+
+/**
+ * @brief Deliver a tag the filter accepted, or park it while HID is down
+ */
+static void deliver_epc(uart_router_t *router, const uint8_t *epc,
+			uint8_t epc_len)
+{
+	int64_t now = k_uptime_get();
+	int ret = send_epc_hex(router, epc, epc_len, now);
+
+	if (ret == -EAGAIN && tag_store_put(epc, epc_len, now) == 0) {
+		/* Captured: the operator gets the same feedback */
+		router->stats.epc_stored++;
+		ret = 0;
+	}
+
+	if (ret >= 0) {
+		feedback_tag_read();
+	} else {
+		LOG_RL_WRN("HID send failed: %d", ret);
+	}
+}
+
+/**
+ * @brief Replay stored tags once the HID sink is back
+ *
+ * At most one record per tag_store_get_rate() period, so the backlog
+ * does not starve live reads or flood the host. A record is skipped if
+ * the duplicate cache shows a read of the same EPC within the debounce
+ * window of it was already delivered.
+ */
+static void replay_stored_tags(uart_router_t *router)
 {
-	k_mutex_lock(&router->mode_lock, K_FOREVER);
-	router_mode_t mode = router->mode;
-	k_mutex_unlock(&router->mode_lock);
-	return mode;
+	tag_store_record_t rec;
+	int64_t now = k_uptime_get();
+
+	if (!tag_store_pending() || !usb_hid_is_ready() ||
+	    !usb_hid_is_enabled() || now < router->next_replay_time) {
+		return;
+	}
+
+	if (tag_store_peek(&rec) < 0) {
+		return;
+	}
+
+	epc_cache_entry_t *entry = epc_filter_find(&router->epc_filter,
+						   rec.epc, rec.epc_len);
+
+	if (entry && entry->last_delivered >= 0 &&
+	    llabs(entry->last_delivered - rec.read_time) <
+	    router->cfg.epc_debounce_ms) {
+		tag_store_pop(TAG_STORE_DEDUPED);
+		return;
+	}
+
+	int ret = send_epc_hex(router, rec.epc, rec.epc_len, rec.read_time);
+
+	if (ret == -EAGAIN) {
+		/* Gone again: keep it for the next reconnect */
+		return;
+	}
+
+	if (ret < 0) {
+		LOG_RL_WRN("Stored tag replay failed: %d", ret);
+	}
+	tag_store_pop(ret < 0 ? TAG_STORE_FAILED : TAG_STORE_REPLAYED);
+	router->next_replay_time = now + 1000 / tag_store_get_rate();
 }
 
 /* ========================================================================
  * Data Processing
  * ======================================================================== */
 
+/** Filter outcome as tag stream flags (ctrl_proto.h) */
+static inline uint8_t tag_flags(bool is_new, bool delivered)
+{
+	return (is_new ? CTRL_TAG_F_NEW : 0) |
+	       (delivered ? CTRL_TAG_F_DELIVERED : 0);
+}
+
 /* Forward declaration */
 bool e310_is_debug_mode(void);
 
@@ -444,13 +785,9 @@ bool e310_is_debug_mode(void);
 static void process_e310_frame(uart_router_t *router,
                                 const uint8_t *frame, size_t len)
 {
-	if (!router->inventory_active || e310_is_debug_mode()) {
-		printk("RX[%zu]: ", len);
-		for (size_t i = 0; i < len; i++) {
-			printk("%02X ", frame[i]);
-		}
-		printk("\n");
-	}
+	frame_trace_record(FRAME_TRACE_RX,
+			   router->inventory_active ? FRAME_TRACE_FLAG_INVENTORY : 0,
+			   frame, len);
 
 	/* Parse E310 protocol frame */
 	e310_response_header_t header;
@@ -461,44 +798,47 @@ static void process_e310_frame(uart_router_t *router,
 		router->stats.parse_errors++;
 		return;
 	}
+	router->last_frame_ms = k_uptime_get();
 
 	if (e310_is_debug_mode() && !router->inventory_active) {
-		printk("  -> Len=%u Addr=0x%02X Cmd=0x%02X Status=0x%02X (%s)\n",
-		       header.len, header.addr, header.recmd, header.status,
-		       e310_get_status_desc(header.status));
+		LOG_INF("RX Len=%u Addr=0x%02X Cmd=0x%02X Status=0x%02X",
+			header.len, header.addr, header.recmd, header.status);
 	}
 
 	if (header.recmd == E310_RECMD_AUTO_UPLOAD) {
+		/* Tags with no round of ours in flight: real-time mode */
+		if (!router->inventory_active) {
+			router->e310_realtime = true;
+		}
+
 		/* Parse auto-upload tag (Tag Inventory mode) */
 		e310_tag_data_t tag;
 		ret = e310_parse_auto_upload_tag(&frame[4], len - 6, &tag);
 
 		if (ret >= 0) {
-			/* Format EPC as hex string without spaces for HID */
-			char epc_str[64];
-			int pos = 0;
-			for (uint8_t b = 0; b < tag.epc_len && pos + 2 < (int)sizeof(epc_str); b++) {
-				pos += snprintf(&epc_str[pos], sizeof(epc_str) - pos,
-				                "%02X", tag.epc[b]);
+			router->stats.tags_read++;
+			audit_tag(router);
+			tag_session_record(tag.epc, tag.epc_len, tag.rssi,
+					   tag.antenna);
+
+			bool is_new;
+			bool send = epc_filter_check(&router->epc_filter,
+			                             router->cfg.epc_debounce_ms,
+			                             tag.epc, tag.epc_len, tag.rssi,
+			                             &is_new);
+
+			if (is_new) {
+				router->stats.unique_tags++;
 			}
-			epc_str[pos] = '\0';
-
-			if (epc_filter_check(&router->epc_filter, tag.epc,
-				                     tag.epc_len, tag.rssi)) {
-				int hid_ret = usb_hid_send_epc((const uint8_t *)epc_str,
-				                               strlen(epc_str));
-				if (hid_ret >= 0) {
-					router->stats.epc_sent++;
-					beep_control_trigger();
-					rgb_led_notify_tag_read();
-				} else if (hid_ret != 0) {
-					LOG_WRN("HID send failed: %d", hid_ret);
-				}
+			if (send) {
+				deliver_epc(router, tag.epc, tag.epc_len);
 			}
+			ctrl_proto_tag_read(tag.epc, tag.epc_len, tag.rssi,
+					    tag.antenna, tag_flags(is_new, send));
 
 			router->stats.frames_parsed++;
 		} else {
-			LOG_WRN("Failed to parse auto-upload tag: %d", ret);
+			LOG_RL_WRN("Failed to parse auto-upload tag: %d", ret);
 			router->stats.parse_errors++;
 		}
 	} else if (header.recmd == E310_CMD_TAG_INVENTORY) {
@@ -518,66 +858,45 @@ static void process_e310_frame(uart_router_t *router,
 				size_t remaining = data_len - 2;
 
 			for (uint8_t i = 0; i < tag_count && remaining > 0; i++) {
-				if (e310_is_debug_mode()) {
-					printk("  RAW[%u/%u] %zu bytes:", i + 1,
-					       tag_count, remaining);
-					for (size_t d = 0;
-					     d < remaining && d < 64; d++) {
-						printk(" %02X", block_ptr[d]);
-					}
-					printk("\n");
-				}
-
 				e310_tag_data_t tag;
 				int consumed = e310_parse_tag_data(
 					block_ptr, remaining, &tag);
 				if (consumed <= 0) {
-					LOG_WRN("Tag Inventory: parse error %d at tag %u",
+					LOG_RL_WRN("Tag Inventory: parse error %d at tag %u",
 					        consumed, i);
 					break;
 				}
 
 				tag.antenna = antenna;
+				router->stats.tags_read++;
+				audit_tag(router);
+				tag_session_record(tag.epc, tag.epc_len,
+						   tag.rssi, antenna);
 
 				uint8_t *epc_data = tag.epc;
 				uint8_t epc_len = tag.epc_len;
 
 				if (e310_is_debug_mode()) {
-					printk("  PARSED[%u]: epc_len=%u"
-					       " has_tid=%d rssi=%u\n",
-					       i + 1, epc_len,
-					       tag.has_tid, tag.rssi);
-					printk("    EPC:");
-					for (uint8_t b = 0; b < epc_len; b++) {
-						printk(" %02X", epc_data[b]);
-					}
-					printk("\n");
+					/* Raw bytes are in the frame trace */
+					LOG_INF("Tag %u/%u: epc_len=%u has_tid=%d rssi=%u",
+						i + 1, tag_count, epc_len,
+						tag.has_tid, tag.rssi);
 				}
 
-				char epc_str[64];
-				int epc_pos = 0;
-				for (uint8_t b = 0; b < epc_len &&
-				     epc_pos + 2 < (int)sizeof(epc_str); b++) {
-					epc_pos += snprintf(&epc_str[epc_pos],
-					                    sizeof(epc_str) - epc_pos,
-					                    "%02X", epc_data[b]);
+				bool is_new;
+				bool send = epc_filter_check(&router->epc_filter,
+				                             router->cfg.epc_debounce_ms,
+				                             epc_data, epc_len,
+				                             tag.rssi, &is_new);
+
+				if (is_new) {
+					router->stats.unique_tags++;
 				}
-				epc_str[epc_pos] = '\0';
-
-				if (epc_filter_check(&router->epc_filter,
-					             epc_data, epc_len, tag.rssi)) {
-					int hid_ret = usb_hid_send_epc(
-						(const uint8_t *)epc_str,
-						strlen(epc_str));
-					if (hid_ret >= 0) {
-						router->stats.epc_sent++;
-						beep_control_trigger();
-						rgb_led_notify_tag_read();
-					} else if (hid_ret != 0) {
-						LOG_WRN("HID send failed: %d",
-						        hid_ret);
-					}
+				if (send) {
+					deliver_epc(router, epc_data, epc_len);
 				}
+				ctrl_proto_tag_read(epc_data, epc_len, tag.rssi,
+						    antenna, tag_flags(is_new, send));
 
 					block_ptr += consumed;
 					remaining -= consumed;
@@ -598,11 +917,17 @@ static void process_e310_frame(uart_router_t *router,
 
 		if (inventory_round_done && router->inventory_active) {
 			router->inventory_active = false;
+			audit_round_end(router);
+			router_metrics_round_done(
+				(uint32_t)(k_uptime_get() - router->round_start));
 
-			if (router->inventory_interval_ms > 0) {
+			if (router->cfg.inventory_interval_ms > 0) {
 				router->next_inventory_time =
 					k_uptime_get() +
-					router->inventory_interval_ms;
+					thermal_gov_round_gap_ms(
+						router->cfg.inventory_interval_ms,
+						(uint32_t)(k_uptime_get() -
+							   router->round_start));
 			} else {
 				epc_filter_print_summary(&router->epc_filter);
 				switch_control_set_inventory_state(false);
@@ -660,12 +985,15 @@ static void process_e310_frame(uart_router_t *router,
 			printk("Reader SN: Status 0x%02X (%s)\n",
 			       header.status, e310_get_status_desc(header.status));
 		}
-	} else if (header.recmd == 0x92) {
+	} else if (header.recmd == E310_CMD_MEASURE_TEMPERATURE) {
 		router->stats.frames_parsed++;
 		if (header.status == E310_STATUS_SUCCESS && len > 6) {
 			int8_t temp;
 			ret = e310_parse_temperature(&frame[4], len - 6, &temp);
-			if (ret == E310_OK) {
+			if (ret == E310_OK &&
+			    router->cfg_cmd == E310_CMD_MEASURE_TEMPERATURE) {
+				thermal_gov_update(temp);
+			} else if (ret == E310_OK) {
 				printk("Reader Temperature: %d C\n", temp);
 			} else {
 				printk("Temperature: parse error %d\n", ret);
@@ -688,6 +1016,16 @@ static void process_e310_frame(uart_router_t *router,
 			printk("Tag Count: Status 0x%02X (%s)\n",
 			       header.status, e310_get_status_desc(header.status));
 		}
+	} else if (router->cfg_cmd != 0 && header.recmd == router->cfg_cmd) {
+		/* Round-boundary config command: quiet unless it failed */
+		router->stats.frames_parsed++;
+		if (header.status == E310_STATUS_SUCCESS) {
+			/* Only an accepted command updates what the E310 has */
+			router->e310_cfg = router->cfg_pending;
+		} else {
+			LOG_WRN("E310 config 0x%02X: 0x%02X (%s)", header.recmd,
+				header.status, e310_get_status_desc(header.status));
+		}
 	} else {
 		router->stats.frames_parsed++;
 		printk("E310 [0x%02X] Status=0x%02X (%s)",
@@ -744,16 +1082,17 @@ static void process_inventory_mode(uart_router_t *router)
 					process_e310_frame(router, frame, frame_len);
 					frame_assembler_reset(&router->e310_frame);
 			} else {
-				LOG_WRN("Frame CRC error (len=%zu)", frame_len);
-				printk("RX[%zu]: ", frame_len);
-				for (size_t i = 0; i < frame_len; i++) {
-					printk("%02X ", frame[i]);
-				}
-				printk("\n");
+				frame_trace_record(FRAME_TRACE_RX_CRC_ERR,
+						   router->inventory_active ?
+						   FRAME_TRACE_FLAG_INVENTORY : 0,
+						   frame, frame_len);
 				if (frame_len >= 3) {
 					uint16_t calc_crc = e310_crc16(frame, frame_len - 2);
 					uint16_t frame_crc = frame[frame_len - 2] | (frame[frame_len - 1] << 8);
-					printk("CRC calc=%04X frame=%04X\n", calc_crc, frame_crc);
+					LOG_RL_WRN("Frame CRC error (len=%zu, calc=%04X frame=%04X)",
+						frame_len, calc_crc, frame_crc);
+				} else {
+					LOG_RL_WRN("Frame CRC error (len=%zu)", frame_len);
 				}
 				router->stats.parse_errors++;
 				safe_uart4_rx_reset(router);
@@ -766,144 +1105,547 @@ static void process_inventory_mode(uart_router_t *router)
 	}
 }
 
-static int send_inventory_command(uart_router_t *router)
-{
-	safe_uart4_rx_reset(router);
-
-	/* 연속 모드: ScanTime=10 (1초), 단발: ScanTime=50 (5초) */
-	uint8_t scan_time = (router->inventory_interval_ms > 0) ? 10 : 50;
-	int len = e310_build_tag_inventory_scan_time(&router->e310_ctx,
-						     scan_time);
-	if (len < 0) {
-		return len;
-	}
-	return uart_router_send_uart4(router, router->e310_ctx.tx_buffer, len);
-}
+/* ========================================================================
+ * Runtime Configuration
+ * ======================================================================== */
 
-void uart_router_process(uart_router_t *router)
+static void refresh_config(uart_router_t *router)
 {
-	if (!router->running) {
-		return;
-	}
-
-	/*
-	 * Re-entrance guard: prevent concurrent calls from main loop
-	 * and shell thread (via wait_for_e310_response).
-	 * atomic_cas returns true if we successfully set 0->1.
-	 */
-	if (!atomic_cas(&process_lock, 0, 1)) {
-		return; /* Another thread is already processing */
-	}
-
-	process_inventory_mode(router);
-
-	if (router->inventory_interval_ms > 0 &&
-	    router->next_inventory_time > 0 &&
-	    router->mode == ROUTER_MODE_INVENTORY &&
-	    k_uptime_get() >= router->next_inventory_time) {
-		router->inventory_active = true;
-		if (send_inventory_command(router) < 0) {
-			router->inventory_active = false;
-		}
-		router->next_inventory_time =
-			k_uptime_get() +
-			router->inventory_interval_ms;
+	if (runtime_config_version() != router->cfg.version) {
+		runtime_config_get(&router->cfg);
+		router->rf_power_cfg = router->cfg.rf_power;
 	}
 
-	atomic_set(&process_lock, 0);
+	/* The E310 gets the thermally derated power like any config change */
+	router->cfg.rf_power = thermal_gov_rf_power(router->rf_power_cfg);
 }
 
-/* ========================================================================
- * Statistics
- * ======================================================================== */
-
-void uart_router_get_stats(uart_router_t *router, uart_router_stats_t *stats)
+static bool reader_config_differs(const runtime_config_t *a, const runtime_config_t *b)
 {
-	memcpy(stats, &router->stats, sizeof(uart_router_stats_t));
+	return a->rf_power != b->rf_power ||
+	       a->antenna_config != b->antenna_config ||
+	       a->freq_region != b->freq_region ||
+	       a->freq_start != b->freq_start ||
+	       a->freq_end != b->freq_end ||
+	       a->inventory_time != b->inventory_time;
 }
 
-void uart_router_reset_stats(uart_router_t *router)
+/**
+ * @brief Build the command for the first reader-side field the E310 lacks
+ *
+ * cfg_pending is set to what the E310 will have once it accepts the
+ * command; e310_cfg only takes it from the response handler, so a
+ * rejected or lost command is built again next time.
+ *
+ * @return Frame length, 0 if the E310 is up to date, negative on error
+ */
+static int build_reader_config(uart_router_t *router)
 {
-	memset(&router->stats, 0, sizeof(uart_router_stats_t));
-}
+	const runtime_config_t *want = &router->cfg;
+	runtime_config_t *have = &router->e310_cfg;
+	runtime_config_t *next = &router->cfg_pending;
+	e310_context_t *ctx = &router->e310_ctx;
 
-/* ========================================================================
- * Utility Functions
- * ======================================================================== */
+	*next = *have;
 
-const char *uart_router_get_mode_name(router_mode_t mode)
-{
-	switch (mode) {
-	case ROUTER_MODE_IDLE:       return "IDLE";
-	case ROUTER_MODE_INVENTORY:  return "INVENTORY";
-	default:                     return "UNKNOWN";
+	if (want->antenna_config != have->antenna_config) {
+		next->antenna_config = want->antenna_config;
+		return e310_build_setup_antenna_mux(ctx, want->antenna_config);
 	}
-}
 
-int uart_router_send_uart4(uart_router_t *router, const uint8_t *data, size_t len)
-{
-	if (!router->uart4_ready) {
-		return -ENODEV;
-	}
+	if (want->freq_region != have->freq_region ||
+	    want->freq_start != have->freq_start ||
+	    want->freq_end != have->freq_end) {
+		uint8_t max_fre, min_fre;
 
-	if (!router->inventory_active) {
-		printk("TX[%zu]: ", len);
-		for (size_t i = 0; i < len; i++) {
-			printk("%02X ", data[i]);
+		next->freq_region = want->freq_region;
+		next->freq_start = want->freq_start;
+		next->freq_end = want->freq_end;
+		if (e310_encode_frequency(want->freq_region, want->freq_start,
+					  want->freq_end, &max_fre, &min_fre) != E310_OK) {
+			/* Not sendable at all: drop it rather than retry forever */
+			*have = *next;
+			return E310_ERR_INVALID_PARAM;
 		}
-		printk("\n");
+		return e310_build_modify_frequency(ctx, max_fre, min_fre);
 	}
 
-	/* Queue data in TX ring buffer */
-	int put = ring_buf_put(&router->uart4_tx_ring, data, len);
-	if (put > 0) {
-		/* Enable TX interrupt to start transmission */
-		uart_irq_tx_enable(router->uart4);
+	if (want->rf_power != have->rf_power) {
+		next->rf_power = want->rf_power;
+		return e310_build_modify_rf_power(ctx, want->rf_power);
 	}
 
-	if (put < (int)len) {
-		router->stats.tx_errors++;
-		LOG_WRN("UART4 TX buffer full: lost %zu bytes", len - put);
+	if (want->inventory_time != have->inventory_time) {
+		next->inventory_time = want->inventory_time;
+		return e310_build_modify_inventory_time(ctx, want->inventory_time);
 	}
 
-	return put;
+	return 0;
 }
 
-/* ========================================================================
- * E310 RFID Control API
- * ======================================================================== */
-
 /**
- * @brief Wait for E310 response with timeout (poll-only, no processing)
+ * @brief Send a command from build_reader_config() and wait for the answer
  *
- * Sleeps and polls frame counters. Actual UART processing is done by
- * main loop's uart_router_process() — this function MUST NOT call it
- * to avoid driving the parser from the shell thread context.
+ * For connect and resync, which run outside the round loop.
+ *
+ * @return 0 if the E310 accepted it, -EIO if it was rejected or not
+ *         sent, -ETIMEDOUT if no answer came
  */
-static int wait_for_e310_response(uart_router_t *router, int timeout_ms)
+static int send_reader_config(uart_router_t *router, int len, int timeout_ms)
 {
-	int64_t start = k_uptime_get();
-	uint32_t initial_frames = router->stats.frames_parsed;
-	uint32_t initial_errors = router->stats.parse_errors;
-
-	while ((k_uptime_get() - start) < timeout_ms) {
-		if (atomic_cas(&process_lock, 0, 1)) {
-			process_inventory_mode(router);
-			atomic_set(&process_lock, 0);
-		}
+	int ret;
 
-		if (router->stats.frames_parsed > initial_frames ||
-		    router->stats.parse_errors > initial_errors) {
-			return 0;
-		}
+	router->cfg_cmd = router->e310_ctx.tx_buffer[2];
+	if (uart_router_send_uart4(router, router->e310_ctx.tx_buffer, len) <= 0) {
+		router->cfg_cmd = 0;
+		return -EIO;
+	}
 
-		k_msleep(10);
+	ret = wait_for_e310_response(router, timeout_ms);
+	router->cfg_cmd = 0;
+	if (ret < 0) {
+		return ret;
 	}
 
-	return -ETIMEDOUT;
+	return reader_config_differs(&router->cfg_pending, &router->e310_cfg) ? -EIO : 0;
 }
 
-int uart_router_connect_e310(uart_router_t *router)
+/**
+ * @brief True once everything queued for UART4 has been sent
+ */
+static bool uart4_tx_idle(uart_router_t *router)
+{
+	return ring_buf_is_empty(&router->uart4_tx_ring) &&
+	       !atomic_get(&router->uart4_tx_busy);
+}
+
+/**
+ * @brief Response deadline for a command queued on UART4 at @p queued
+ *
+ * The timeout runs from the command's TX complete, not from when it was
+ * queued: behind a batch or a long transparent payload the E310 has not
+ * seen it yet. Until TX is idle the deadline is the worst case, so a
+ * stuck transmitter still times out.
+ */
+static int64_t response_deadline(uart_router_t *router, int64_t queued,
+				 int timeout_ms)
+{
+	if (!uart4_tx_idle(router)) {
+		return queued + UART4_TX_STALL_MS + timeout_ms;
+	}
+
+	uint32_t since_done = k_uptime_get_32() -
+			      (uint32_t)atomic_get(&router->uart4_tx_done_ms);
+
+	return k_uptime_get() - since_done + timeout_ms;
+}
+
+/**
+ * @brief Bring the E310 up to date with the runtime config
+ *
+ * Reader-side commands are only sent between rounds, one per call.
+ *
+ * @return true while a config command awaits its response (the next
+ *         round must not be dispatched yet)
+ */
+static bool apply_reader_config(uart_router_t *router)
+{
+	int64_t now = k_uptime_get();
+	int len;
+
+	if (router->cfg_cmd != 0) {
+		bool answered = router->stats.frames_parsed != router->cfg_frames;
+
+		if (!answered &&
+		    now < response_deadline(router, router->cfg_queued,
+					    CFG_RESPONSE_TIMEOUT_MS)) {
+			return true;
+		}
+		if (!answered) {
+			LOG_WRN("E310 config 0x%02X: no response", router->cfg_cmd);
+		}
+		if (router->cfg_cmd != E310_CMD_MEASURE_TEMPERATURE &&
+		    reader_config_differs(&router->cfg_pending, &router->e310_cfg)) {
+			/* Rejected or lost: e310_cfg still lacks the field */
+			router->cfg_retry = true;
+		}
+		router->cfg_cmd = 0;
+	}
+
+	if (!reader_config_differs(&router->cfg, &router->e310_cfg)) {
+		atomic_set(&router->cfg_applied, router->cfg.version);
+		return false;
+	}
+
+	/* One attempt per round gap, so a rejected value cannot flood UART4 */
+	if (router->inventory_active || !router->e310_connected || router->cfg_retry) {
+		return false;
+	}
+
+	len = build_reader_config(router);
+	if (len <= 0) {
+		if (len < 0) {
+			LOG_ERR("Failed to build config command: %d", len);
+		}
+		return false;
+	}
+
+	router->cfg_cmd = router->e310_ctx.tx_buffer[2];
+	router->cfg_frames = router->stats.frames_parsed;
+	router->cfg_queued = now;
+
+	if (uart_router_send_uart4(router, router->e310_ctx.tx_buffer, len) < 0) {
+		router->cfg_cmd = 0;
+		router->cfg_retry = true;
+		return false;
+	}
+
+	return true;
+}
+
+int uart_router_wait_config(uart_router_t *router, uint32_t version, int timeout_ms)
+{
+	int64_t start = k_uptime_get();
+
+	while ((int32_t)((uint32_t)atomic_get(&router->cfg_applied) - version) < 0) {
+		if ((k_uptime_get() - start) >= timeout_ms) {
+			return -ETIMEDOUT;
+		}
+		k_msleep(1);
+	}
+
+	return 0;
+}
+
+static int send_inventory_command(uart_router_t *router)
+{
+	safe_uart4_rx_reset(router);
+
+	/* 연속 모드: ScanTime=10 (1초), 단발: ScanTime=50 (5초) */
+	uint8_t scan_time = (router->cfg.inventory_interval_ms > 0) ? 10 : 50;
+	int len = e310_build_tag_inventory_scan_time(&router->e310_ctx,
+						     scan_time);
+	if (len < 0) {
+		return len;
+	}
+	router->round_start = k_uptime_get();
+	router->round_timeout_ms = scan_time * 100;
+	router->cfg_retry = false;
+	router->e310_realtime = false;
+	audit_round_begin(router);
+	return uart_router_send_uart4(router, router->e310_ctx.tx_buffer, len);
+}
+
+/* ========================================================================
+ * E310 Link Supervisor
+ * ======================================================================== */
+
+/**
+ * @brief Re-sync a silent E310 and resume inventory
+ *
+ * Stop (skipped in real-time mode, where it would end the stream being
+ * recovered), one reader-info check, the reader-side config re-sent from
+ * the cache, then the next round. A reader that does not answer is
+ * retried every LINK_RETRY_MS.
+ */
+static void link_resync(uart_router_t *router, uint32_t silent_ms)
+{
+	int64_t t0 = k_uptime_get();
+	uart_router_link_t *link = &router->link;
+	runtime_config_t *have = &router->e310_cfg;
+	const runtime_config_t *want = &router->cfg;
+	int len;
+
+	if (router->link_retry_ms == 0) {
+		link->silences++;
+		link->last_silent_ms = silent_ms;
+		LOG_WRN("E310 silent for %u ms, resyncing", silent_ms);
+	}
+
+	router->inventory_active = false;
+	router->cfg_cmd = 0;
+	safe_uart4_rx_reset(router);
+	frame_assembler_reset(&router->e310_frame);
+
+	if (!router->e310_realtime) {
+		len = e310_build_stop_immediately(&router->e310_ctx);
+		if (len > 0 &&
+		    uart_router_send_uart4(router, router->e310_ctx.tx_buffer, len) > 0) {
+			(void)wait_for_e310_response(router, LINK_STOP_TIMEOUT_MS);
+		}
+	}
+
+	len = e310_build_obtain_reader_info(&router->e310_ctx);
+	if (len <= 0 ||
+	    uart_router_send_uart4(router, router->e310_ctx.tx_buffer, len) <= 0 ||
+	    wait_for_e310_response(router, LINK_INFO_TIMEOUT_MS) < 0) {
+		link->failures++;
+		router->link_retry_ms = k_uptime_get() + LINK_RETRY_MS;
+		LOG_RL_WRN("E310 resync: no answer, retrying");
+		return;
+	}
+
+	/*
+	 * The E310 keeps its settings itself (see do_connect()), but a
+	 * change sent during the silence may never have arrived: the cache
+	 * cannot be trusted, so send every field again.
+	 */
+	have->rf_power = ~want->rf_power;
+	have->antenna_config = ~want->antenna_config;
+	have->freq_region = ~want->freq_region;
+	have->inventory_time = ~want->inventory_time;
+	while ((len = build_reader_config(router)) > 0) {
+		/* Not accepted: apply_reader_config() retries at the next gap */
+		if (send_reader_config(router, len, LINK_CFG_TIMEOUT_MS) < 0) {
+			break;
+		}
+	}
+
+	if (!router->e310_realtime) {
+		router->inventory_active = true;
+		if (send_inventory_command(router) < 0) {
+			router->inventory_active = false;
+		}
+		/* The old deadline has long passed: this round replaces it */
+		if (router->cfg.inventory_interval_ms > 0) {
+			router->next_inventory_time =
+				k_uptime_get() + router->cfg.inventory_interval_ms;
+		}
+	}
+
+	uint32_t took = (uint32_t)(k_uptime_get() - t0);
+
+	link->recoveries++;
+	link->last_recovery_ms = took;
+	link->max_recovery_ms = MAX(link->max_recovery_ms, took);
+	router->link_retry_ms = 0;
+	router->last_frame_ms = k_uptime_get();
+	LOG_INF("E310 resynced in %u ms", took);
+}
+
+/**
+ * @brief Check the time since the last valid frame against what is due
+ */
+static void supervise_link(uart_router_t *router)
+{
+	int64_t now = k_uptime_get();
+	int64_t due;
+
+	if (!router->e310_connected || router->mode != ROUTER_MODE_INVENTORY) {
+		router->link_retry_ms = 0;
+		return;
+	}
+
+	if (router->link_retry_ms != 0) {
+		due = router->link_retry_ms;
+	} else if (router->inventory_active) {
+		/* Answer mode: the round must end within its scan time */
+		due = MAX(router->round_start, router->last_frame_ms) +
+		      router->round_timeout_ms + LINK_ROUND_MARGIN_MS;
+	} else if (router->e310_realtime) {
+		/* Real-time mode: a tag or a heartbeat at least this often */
+		due = router->last_frame_ms +
+		      LINK_HEARTBEAT_UNITS * E310_HEARTBEAT_UNIT_MS +
+		      LINK_HEARTBEAT_MARGIN_MS;
+	} else {
+		return;
+	}
+
+	if (now >= due) {
+		link_resync(router, (uint32_t)(now - router->last_frame_ms));
+	}
+}
+
+/**
+ * @brief Between continuous rounds, take a thermal governor sample
+ *
+ * Uses the config command slot, so the next round waits for the answer
+ * (or CFG_RESPONSE_TIMEOUT_MS) just as it does for a config change.
+ *
+ * @return true if a sample request is in flight
+ */
+static bool sample_temperature(uart_router_t *router)
+{
+	int len;
+
+	if (router->inventory_active || !router->e310_connected ||
+	    router->mode != ROUTER_MODE_INVENTORY ||
+	    router->next_inventory_time == 0 ||
+	    !thermal_gov_sample_due()) {
+		return false;
+	}
+
+	len = e310_build_measure_temperature(&router->e310_ctx);
+	if (len <= 0) {
+		return false;
+	}
+
+	thermal_gov_sample_sent();
+	router->cfg_cmd = E310_CMD_MEASURE_TEMPERATURE;
+	router->cfg_frames = router->stats.frames_parsed;
+	router->cfg_queued = k_uptime_get();
+
+	if (uart_router_send_uart4(router, router->e310_ctx.tx_buffer, len) < 0) {
+		router->cfg_cmd = 0;
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief One poll of the router thread: RX, metrics, config, next round
+ */
+static void router_poll(uart_router_t *router)
+{
+	if (!router->running) {
+		return;
+	}
+
+	refresh_config(router);
+	process_inventory_mode(router);
+	supervise_link(router);
+	replay_stored_tags(router);
+	router_metrics_poll(router);
+
+	/* Round boundary: reader-side config changes go out first */
+	bool cfg_busy = apply_reader_config(router) || sample_temperature(router);
+
+	if (router->cfg.inventory_interval_ms > 0 &&
+	    router->next_inventory_time > 0 &&
+	    router->mode == ROUTER_MODE_INVENTORY &&
+	    !router->inventory_active &&
+	    !cfg_busy &&
+	    k_uptime_get() >= router->next_inventory_time) {
+		router->inventory_active = true;
+		if (send_inventory_command(router) < 0) {
+			router->inventory_active = false;
+		}
+		router->next_inventory_time =
+			k_uptime_get() +
+			router->cfg.inventory_interval_ms;
+	}
+}
+
+/* ========================================================================
+ * Statistics
+ * ======================================================================== */
+
+void uart_router_get_stats(uart_router_t *router, uart_router_stats_t *stats)
+{
+	uart_router_status_t status;
+
+	uart_router_get_status(router, &status);
+	memcpy(stats, &status.stats, sizeof(uart_router_stats_t));
+}
+
+void uart_router_reset_stats(uart_router_t *router)
+{
+	(void)uart_router_call(router, ROUTER_OP_RESET_STATS, 0);
+}
+
+/* ========================================================================
+ * Utility Functions
+ * ======================================================================== */
+
+const char *uart_router_get_mode_name(router_mode_t mode)
+{
+	switch (mode) {
+	case ROUTER_MODE_IDLE:       return "IDLE";
+	case ROUTER_MODE_INVENTORY:  return "INVENTORY";
+	default:                     return "UNKNOWN";
+	}
+}
+
+int uart_router_send_uart4(uart_router_t *router, const uint8_t *data, size_t len)
+{
+	if (!router->uart4_ready) {
+		return -ENODEV;
+	}
+
+	frame_trace_record(FRAME_TRACE_TX,
+			   router->inventory_active ? FRAME_TRACE_FLAG_INVENTORY : 0,
+			   data, len);
+
+	/* Queue data in TX ring buffer */
+#ifdef UART4_TX_DMA
+	int put = ring_buf_put(&router->uart4_tx_ring, data, len);
+
+	uart4_tx_kick(router);
+#else
+	/* Busy before the bytes are visible: the ISR clears it on empty */
+	if (!atomic_set(&router->uart4_tx_busy, 1)) {
+		atomic_inc(&router->uart4_tx_batches);
+	}
+	int put = ring_buf_put(&router->uart4_tx_ring, data, len);
+
+	/* Enable TX interrupt to start transmission (or clear busy again) */
+	uart_irq_tx_enable(router->uart4);
+#endif
+
+	if (put < (int)len) {
+		router->stats.tx_errors++;
+		LOG_WRN("UART4 TX buffer full: lost %zu bytes", len - put);
+	}
+
+	return put;
+}
+
+int uart_router_inject_rx(uart_router_t *router, const uint8_t *data, size_t len)
+{
+	int put;
+
+	if (!router->running) {
+		return -ENODEV;
+	}
+
+	/* The ISR is the ring's only producer: keep it out while we write */
+	uart_irq_rx_disable(router->uart4);
+
+	if (ring_buf_space_get(&router->uart4_rx_ring) < len) {
+		uart_irq_rx_enable(router->uart4);
+		return -ENOSPC;
+	}
+	put = ring_buf_put(&router->uart4_rx_ring, data, len);
+
+	uart_irq_rx_enable(router->uart4);
+
+	return put;
+}
+
+/* ========================================================================
+ * E310 RFID Control API
+ * ======================================================================== */
+
+/**
+ * @brief Wait for E310 response with timeout (router thread only)
+ *
+ * Drives the parser itself until a frame (or a bad one) comes in. Other
+ * requests stay queued meanwhile, so nothing else touches the RX path.
+ * The timeout counts from the command's TX complete (response_deadline()).
+ */
+static int wait_for_e310_response(uart_router_t *router, int timeout_ms)
+{
+	int64_t queued = k_uptime_get();
+	uint32_t initial_frames = router->stats.frames_parsed;
+	uint32_t initial_errors = router->stats.parse_errors;
+
+	while (k_uptime_get() < response_deadline(router, queued, timeout_ms)) {
+		atomic_set(&router_checkin, 1);
+		process_inventory_mode(router);
+
+		if (router->stats.frames_parsed > initial_frames ||
+		    router->stats.parse_errors > initial_errors) {
+			return 0;
+		}
+
+		k_msleep(1);
+	}
+
+	return -ETIMEDOUT;
+}
+
+static int do_connect(uart_router_t *router)
 {
 	if (!router->uart4_ready) {
 		LOG_ERR("UART4 not ready");
@@ -916,7 +1658,7 @@ int uart_router_connect_e310(uart_router_t *router)
 
 	/* Set mode to IDLE for command/response processing */
 	router_mode_t saved_mode = router->mode;
-	uart_router_set_mode(router, ROUTER_MODE_IDLE);
+	do_set_mode(router, ROUTER_MODE_IDLE);
 
 	/* Reset frame assembler */
 	frame_assembler_reset(&router->e310_frame);
@@ -970,7 +1712,7 @@ int uart_router_connect_e310(uart_router_t *router)
 
 	/* Restore original address and mode */
 	router->e310_ctx.reader_addr = saved_addr;
-	uart_router_set_mode(router, saved_mode);
+	do_set_mode(router, saved_mode);
 
 	/* Require at least one successful response to consider connected */
 	if (responses_ok > 0) {
@@ -987,17 +1729,38 @@ int uart_router_connect_e310(uart_router_t *router)
 			}
 		}
 
-		uint8_t saved_power = e310_settings_get_rf_power();
-		len = e310_build_modify_rf_power(&router->e310_ctx, saved_power);
+		/*
+		 * The E310 keeps the other reader-side settings itself; a
+		 * link resync re-sends them all (link_resync()). RF power is
+		 * sent now and only counts as applied once it is accepted.
+		 */
+		runtime_config_t cfg;
+
+		runtime_config_get(&cfg);
+		cfg.rf_power = thermal_gov_rf_power(cfg.rf_power);
+		router->e310_cfg = cfg;
+		router->e310_cfg.rf_power = ~cfg.rf_power;
+		router->cfg_pending = cfg;
+		router->cfg_retry = false;
+		len = e310_build_modify_rf_power(&router->e310_ctx, cfg.rf_power);
+		if (len > 0 && send_reader_config(router, len, 200) == 0) {
+			LOG_INF("RF power applied: %u dBm", cfg.rf_power);
+		} else {
+			LOG_WRN("Failed to apply RF power, retried between rounds");
+		}
+
+		/* Real-time mode: let silence show up within a heartbeat */
+		len = e310_build_modify_heartbeat_time(&router->e310_ctx,
+						       LINK_HEARTBEAT_UNITS);
 		if (len > 0) {
 			ret = uart_router_send_uart4(router, router->e310_ctx.tx_buffer, len);
-			if (ret > 0 && wait_for_e310_response(router, 200) == 0) {
-				LOG_INF("RF power applied: %u dBm", saved_power);
-			} else {
-				LOG_WRN("Failed to apply RF power");
+			if (ret <= 0 || wait_for_e310_response(router, 200) != 0) {
+				LOG_WRN("Failed to set heartbeat time");
 			}
 		}
 
+		router->e310_realtime = false;
+		router->link_retry_ms = 0;
 		return 0;
 	}
 
@@ -1006,7 +1769,7 @@ int uart_router_connect_e310(uart_router_t *router)
 	return -ETIMEDOUT;
 }
 
-int uart_router_start_inventory(uart_router_t *router)
+static int do_start_inventory(uart_router_t *router)
 {
 	if (!router->uart4_ready) {
 		LOG_ERR("UART4 not ready");
@@ -1015,7 +1778,7 @@ int uart_router_start_inventory(uart_router_t *router)
 
 	if (!router->e310_connected) {
 		LOG_INF("E310 not connected, running init sequence...");
-		int ret = uart_router_connect_e310(router);
+		int ret = do_connect(router);
 		if (ret < 0) {
 			LOG_ERR("E310 connection failed: %d", ret);
 			return ret;
@@ -1023,10 +1786,10 @@ int uart_router_start_inventory(uart_router_t *router)
 		router->e310_connected = true;
 	}
 
-	/* Set mode to INVENTORY first — uart_router_set_mode() resets ring buffers
+	/* Set mode to INVENTORY first — do_set_mode() resets ring buffers
 	 * on mode change, so we must do this BEFORE queuing the TX command.
 	 * Otherwise the TX ring buffer gets wiped and E310 never receives the command. */
-	uart_router_set_mode(router, ROUTER_MODE_INVENTORY);
+	do_set_mode(router, ROUTER_MODE_INVENTORY);
 
 	/* Clear EPC cache for new inventory session */
 	epc_filter_clear(&router->epc_filter);
@@ -1034,7 +1797,7 @@ int uart_router_start_inventory(uart_router_t *router)
 	int len = e310_build_tag_inventory_default(&router->e310_ctx);
 	if (len < 0) {
 		LOG_ERR("Failed to build start inventory command: %d", len);
-		uart_router_set_mode(router, ROUTER_MODE_IDLE);
+		do_set_mode(router, ROUTER_MODE_IDLE);
 		return len;
 	}
 
@@ -1042,21 +1805,25 @@ int uart_router_start_inventory(uart_router_t *router)
 	int ret = uart_router_send_uart4(router, router->e310_ctx.tx_buffer, len);
 	if (ret < 0) {
 		LOG_ERR("Failed to send start inventory command: %d", ret);
-		uart_router_set_mode(router, ROUTER_MODE_IDLE);
+		do_set_mode(router, ROUTER_MODE_IDLE);
 		return ret;
 	}
 
 	router->inventory_active = true;
+	router->round_start = k_uptime_get();
+	router->round_timeout_ms = E310_INVENTORY_DEFAULT_SCAN_TIME * 100;
+	router->e310_realtime = false;
+	audit_round_begin(router);
 	switch_control_set_inventory_state(true);
 	usb_hid_set_enabled(true);
 	rgb_led_set_inventory_status(true);
 
 	LOG_INF("E310 Tag Inventory started (interval %u ms, HID=ON)",
-	        router->inventory_interval_ms);
+	        router->cfg.inventory_interval_ms);
 	return 0;
 }
 
-int uart_router_stop_inventory(uart_router_t *router)
+static int do_stop_inventory(uart_router_t *router)
 {
 	if (!router->uart4_ready) {
 		LOG_ERR("UART4 not ready");
@@ -1065,6 +1832,8 @@ int uart_router_stop_inventory(uart_router_t *router)
 
 	router->inventory_active = false;
 	router->next_inventory_time = 0;
+	router->e310_realtime = false;
+	router->link_retry_ms = 0;
 	switch_control_set_inventory_state(false);
 	usb_hid_set_enabled(false);
 	rgb_led_set_inventory_status(false);
@@ -1099,52 +1868,311 @@ int uart_router_set_rf_power(uart_router_t *router, uint8_t power)
 		power = 30;
 	}
 
-	/* Build Modify RF Power command */
-	int len = e310_build_modify_rf_power(&router->e310_ctx, power);
+	/* Sent by the router at the next round boundary */
+	runtime_config_edit()->rf_power = power;
+	runtime_config_publish();
+
+	LOG_INF("E310 RF power set to %u dBm", power);
+	return 0;
+}
+
+/**
+ * @brief Stop the E310 and put the router back to IDLE
+ */
+static int do_reset(uart_router_t *router)
+{
+	int len = e310_build_stop_immediately(&router->e310_ctx);
 	if (len < 0) {
-		LOG_ERR("Failed to build RF power command: %d", len);
+		LOG_ERR("Failed to build stop command: %d", len);
 		return len;
 	}
 
-	/* Send command to E310 via UART4 */
 	int ret = uart_router_send_uart4(router, router->e310_ctx.tx_buffer, len);
 	if (ret < 0) {
-		LOG_ERR("Failed to send RF power command: %d", ret);
+		LOG_ERR("Failed to send stop command: %d", ret);
 		return ret;
 	}
 
-	LOG_INF("E310 RF power set to %u dBm", power);
+	wait_for_e310_response(router, 500);
+
+	router->inventory_active = false;
+	router->next_inventory_time = 0;
+	router->e310_realtime = false;
+	router->link_retry_ms = 0;
+	switch_control_set_inventory_state(false);
+	usb_hid_set_enabled(false);
+	rgb_led_set_inventory_status(false);
+	do_set_mode(router, ROUTER_MODE_IDLE);
 	return 0;
 }
 
-int uart_router_get_reader_info(uart_router_t *router)
+static void fill_status(uart_router_t *router, uart_router_status_t *status)
 {
-	if (!router->uart4_ready) {
-		LOG_ERR("UART4 not ready");
-		return -ENODEV;
+	status->mode = router->mode;
+	status->running = router->running;
+	status->inventory_active = router->inventory_active;
+	status->e310_connected = router->e310_connected;
+	status->reader_addr = router->e310_ctx.reader_addr;
+	status->tx_pending = ring_buf_size_get(&router->uart4_tx_ring);
+	status->tx_batches = (uint32_t)atomic_get(&router->uart4_tx_batches);
+	status->rx_pending = ring_buf_size_get(&router->uart4_rx_ring);
+	status->epc_cached = router->epc_filter.count;
+	memcpy(&status->stats, &router->stats, sizeof(status->stats));
+	status->audit = router->audit;
+	status->link = router->link;
+}
+
+/* ========================================================================
+ * Router Thread
+ * ======================================================================== */
+
+/* Requests only the synchronous wrappers make (they carry pointers) */
+#define ROUTER_OP_TRANSACT  0x80
+#define ROUTER_OP_STATUS    0x81
+
+struct router_req {
+	uint8_t op;
+	uint8_t arg;
+	uint16_t timeout_ms;
+	const uint8_t *data;
+	size_t len;
+	void *out;
+	uart_router_cb_t cb;
+	void *user_data;
+};
+
+K_MSGQ_DEFINE(router_q, sizeof(struct router_req), UART_ROUTER_QUEUE_DEPTH, 4);
+
+static int handle_request(uart_router_t *router, const struct router_req *req)
+{
+	int ret;
+
+	switch (req->op) {
+	case ROUTER_OP_CONNECT:
+		return do_connect(router);
+
+	case ROUTER_OP_START_INVENTORY:
+		return do_start_inventory(router);
+
+	case ROUTER_OP_STOP_INVENTORY:
+		return do_stop_inventory(router);
+
+	case ROUTER_OP_SET_MODE:
+		do_set_mode(router, (router_mode_t)req->arg);
+		return 0;
+
+	case ROUTER_OP_SET_ADDR:
+		router->e310_ctx.reader_addr = req->arg;
+		return 0;
+
+	case ROUTER_OP_RESET:
+		return do_reset(router);
+
+	case ROUTER_OP_RESET_STATS:
+		memset(&router->stats, 0, sizeof(uart_router_stats_t));
+		memset(&router->audit, 0, sizeof(router->audit));
+		memset(&router->link, 0, sizeof(router->link));
+		router->audit_open = false;
+		router_metrics_reset();
+		return 0;
+
+	case ROUTER_OP_CLEAR_EPC_CACHE:
+		epc_filter_clear(&router->epc_filter);
+		return 0;
+
+	case ROUTER_OP_TRANSACT:
+		ret = uart_router_send_uart4(router, req->data, req->len);
+		if (ret < 0) {
+			return ret;
+		}
+		return wait_for_e310_response(router, req->timeout_ms);
+
+	case ROUTER_OP_STATUS:
+		fill_status(router, req->out);
+		return 0;
+
+	default:
+		return -EINVAL;
 	}
+}
 
-	/* Build Obtain Reader Info command */
-	int len = e310_build_obtain_reader_info(&router->e310_ctx);
-	if (len < 0) {
-		LOG_ERR("Failed to build reader info command: %d", len);
-		return len;
+static void router_thread_fn(void *p1, void *p2, void *p3)
+{
+	uart_router_t *router = p1;
+	struct router_req req;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		atomic_set(&router_checkin, 1);
+
+		/* Requests run between polls; the poll runs at least every period */
+		if (k_msgq_get(&router_q, &req, K_MSEC(UART_ROUTER_POLL_MS)) == 0) {
+			int ret = handle_request(router, &req);
+
+			if (req.cb) {
+				req.cb(ret, req.user_data);
+			}
+		}
+
+		router_poll(router);
 	}
+}
 
-	/* Send command to E310 via UART4 */
-	int ret = uart_router_send_uart4(router, router->e310_ctx.tx_buffer, len);
-	if (ret < 0) {
-		LOG_ERR("Failed to send reader info command: %d", ret);
-		return ret;
+static int submit(const struct router_req *req)
+{
+	if (k_msgq_put(&router_q, req, K_NO_WAIT) != 0) {
+		LOG_WRN("Router request queue full");
+		return -EAGAIN;
 	}
 
-	LOG_INF("E310 Reader info requested");
 	return 0;
 }
 
+int uart_router_post(uart_router_t *router, uart_router_op_t op, uint8_t arg,
+		     uart_router_cb_t cb, void *user_data)
+{
+	struct router_req req = {
+		.op = op,
+		.arg = arg,
+		.cb = cb,
+		.user_data = user_data,
+	};
+
+	ARG_UNUSED(router);
+
+	if (op > ROUTER_OP_CLEAR_EPC_CACHE) {
+		return -EINVAL;
+	}
+
+	return submit(&req);
+}
+
+struct sync_wait {
+	struct k_sem done;
+	int result;
+};
+
+static void sync_done(int result, void *user_data)
+{
+	struct sync_wait *w = user_data;
+
+	w->result = result;
+	k_sem_give(&w->done);
+}
+
+/**
+ * @brief Run a request on the router thread and wait for it
+ *
+ * Inline on the router thread itself, and before the thread exists.
+ */
+static int run_sync(uart_router_t *router, struct router_req *req)
+{
+	struct sync_wait w;
+	int ret;
+
+	if (router_tid == NULL || k_current_get() == router_tid) {
+		return handle_request(router, req);
+	}
+
+	k_sem_init(&w.done, 0, 1);
+	req->cb = sync_done;
+	req->user_data = &w;
+
+	/* Retry while the queue is momentarily full */
+	while ((ret = submit(req)) == -EAGAIN) {
+		k_msleep(1);
+	}
+
+	k_sem_take(&w.done, K_FOREVER);
+	return w.result;
+}
+
+int uart_router_call(uart_router_t *router, uart_router_op_t op, uint8_t arg)
+{
+	struct router_req req = {
+		.op = op,
+		.arg = arg,
+	};
+
+	if (op > ROUTER_OP_CLEAR_EPC_CACHE) {
+		return -EINVAL;
+	}
+
+	return run_sync(router, &req);
+}
+
+int uart_router_get_status(uart_router_t *router, uart_router_status_t *status)
+{
+	struct router_req req = {
+		.op = ROUTER_OP_STATUS,
+		.out = status,
+	};
+
+	return run_sync(router, &req);
+}
+
+int uart_router_transact(uart_router_t *router, const uint8_t *frame, size_t len,
+			 int timeout_ms)
+{
+	struct router_req req = {
+		.op = ROUTER_OP_TRANSACT,
+		.timeout_ms = (uint16_t)CLAMP(timeout_ms, 0, UINT16_MAX),
+		.data = frame,
+		.len = len,
+	};
+
+	if (!router->uart4_ready) {
+		return -ENODEV;
+	}
+
+	return run_sync(router, &req);
+}
+
+int uart_router_set_mode(uart_router_t *router, router_mode_t mode)
+{
+	return uart_router_call(router, ROUTER_OP_SET_MODE, (uint8_t)mode);
+}
+
+router_mode_t uart_router_get_mode(uart_router_t *router)
+{
+	uart_router_status_t status;
+
+	uart_router_get_status(router, &status);
+	return status.mode;
+}
+
+int uart_router_connect_e310(uart_router_t *router)
+{
+	return uart_router_call(router, ROUTER_OP_CONNECT, 0);
+}
+
+bool uart_router_checked_in(void)
+{
+	if (router_tid == NULL) {
+		return true;
+	}
+
+	return atomic_clear(&router_checkin) != 0;
+}
+
+int uart_router_start_inventory(uart_router_t *router)
+{
+	return uart_router_call(router, ROUTER_OP_START_INVENTORY, 0);
+}
+
+int uart_router_stop_inventory(uart_router_t *router)
+{
+	return uart_router_call(router, ROUTER_OP_STOP_INVENTORY, 0);
+}
+
 bool uart_router_is_inventory_active(uart_router_t *router)
 {
-	return router->inventory_active;
+	uart_router_status_t status;
+
+	uart_router_get_status(router, &status);
+	return status.inventory_active;
 }
 
 /* ========================================================================
@@ -1161,19 +2189,21 @@ static int cmd_router_status(const struct shell *sh, size_t argc, char **argv)
 		return -ENODEV;
 	}
 
-	uart_router_t *router = g_router_instance;
+	uart_router_status_t status;
+
+	uart_router_get_status(g_router_instance, &status);
 
 	shell_print(sh, "=== UART Router Status ===");
-	shell_print(sh, "Running: %s", router->running ? "yes" : "no");
-	shell_print(sh, "Mode: %s", uart_router_get_mode_name(router->mode));
+	shell_print(sh, "Running: %s", status.running ? "yes" : "no");
+	shell_print(sh, "Mode: %s", uart_router_get_mode_name(status.mode));
 	shell_print(sh, "");
 	shell_print(sh, "UART4 (E310 - PD1-TX/PD0-RX):");
-	shell_print(sh, "  Device: %s", router->uart4->name);
-	shell_print(sh, "  TX buffer: %u/%u bytes",
-		    ring_buf_size_get(&router->uart4_tx_ring),
+	shell_print(sh, "  Device: %s", g_router_instance->uart4->name);
+	shell_print(sh, "  TX buffer: %u/%u bytes", status.tx_pending,
 		    UART_ROUTER_BUF_SIZE);
-	shell_print(sh, "  RX buffer: %u/%u bytes",
-		    ring_buf_size_get(&router->uart4_rx_ring),
+	shell_print(sh, "  TX path: %s, %u transmissions",
+		    IS_ENABLED(UART4_TX_DMA) ? "DMA" : "IRQ", status.tx_batches);
+	shell_print(sh, "  RX buffer: %u/%u bytes", status.rx_pending,
 		    UART_ROUTER_BUF_SIZE);
 
 	return 0;
@@ -1205,8 +2235,113 @@ static int cmd_router_stats(const struct shell *sh, size_t argc, char **argv)
 	shell_print(sh, "E310 Protocol:");
 	shell_print(sh, "  Frames parsed: %u", stats.frames_parsed);
 	shell_print(sh, "  Parse errors: %u", stats.parse_errors);
+	shell_print(sh, "  Tags read: %u", stats.tags_read);
+	shell_print(sh, "  Unique tags: %u", stats.unique_tags);
 	shell_print(sh, "  EPC sent (HID): %u", stats.epc_sent);
+	shell_print(sh, "  EPC stored (HID not ready): %u", stats.epc_stored);
+	shell_print(sh, "Logging:");
+	shell_print(sh, "  Rate-limited (suppressed): %u",
+		    log_ratelimit_get_dropped());
+
+	thermal_gov_stats_t thermal;
+	thermal_gov_get_stats(&thermal);
+
+	shell_print(sh, "Thermal (ceiling %d C):", thermal_gov_get_ceiling());
+	shell_print(sh, "  Temperature: %d C (max %d), level %u", thermal.temp_c,
+		    thermal.max_c, thermal.level);
+	shell_print(sh, "  Throttled: %u s, over ceiling: %u s",
+		    thermal.throttled_ms / 1000, thermal.over_ms / 1000);
+
+	router_metrics_snapshot_t snap;
+	router_metrics_get_snapshot(&snap);
+
+	shell_print(sh, "Rates (/s):            1 s       10 s       60 s        total");
+	for (int m = 0; m < ROUTER_METRIC_COUNT; m++) {
+		shell_print(sh, "  %-15s %6u.%u %8u.%u %8u.%u %12llu",
+			    router_metrics_name(m),
+			    snap.rate_x10[m][ROUTER_WINDOW_1S] / 10,
+			    snap.rate_x10[m][ROUTER_WINDOW_1S] % 10,
+			    snap.rate_x10[m][ROUTER_WINDOW_10S] / 10,
+			    snap.rate_x10[m][ROUTER_WINDOW_10S] % 10,
+			    snap.rate_x10[m][ROUTER_WINDOW_60S] / 10,
+			    snap.rate_x10[m][ROUTER_WINDOW_60S] % 10,
+			    (unsigned long long)snap.total[m]);
+	}
+	shell_print(sh, "UART4 line use (%u baud):", snap.uart4_baud);
+	shell_print(sh, "  RX: %u.%02u%% / %u.%02u%% / %u.%02u%% (1 s / 10 s / 60 s)",
+		    snap.uart4_rx_util_x100[0] / 100, snap.uart4_rx_util_x100[0] % 100,
+		    snap.uart4_rx_util_x100[1] / 100, snap.uart4_rx_util_x100[1] % 100,
+		    snap.uart4_rx_util_x100[2] / 100, snap.uart4_rx_util_x100[2] % 100);
+	shell_print(sh, "  TX: %u.%02u%% / %u.%02u%% / %u.%02u%% (1 s / 10 s / 60 s)",
+		    snap.uart4_tx_util_x100[0] / 100, snap.uart4_tx_util_x100[0] % 100,
+		    snap.uart4_tx_util_x100[1] / 100, snap.uart4_tx_util_x100[1] % 100,
+		    snap.uart4_tx_util_x100[2] / 100, snap.uart4_tx_util_x100[2] % 100);
+	shell_print(sh, "Inventory rounds: %u", snap.rounds);
+	if (snap.rounds > 0) {
+		shell_print(sh, "  Duration: last %u ms, min %u, avg %u, max %u",
+			    snap.round_last_ms, snap.round_min_ms,
+			    snap.round_avg_ms, snap.round_max_ms);
+	}
+
+	uart_router_status_t status;
+
+	uart_router_get_status(g_router_instance, &status);
+	shell_print(sh, "E310 beep audit (%s):",
+		    beep_control_is_edge_capture_enabled() ? "on" : "off");
+	if (status.audit.rounds > 0) {
+		const uart_router_audit_t *a = &status.audit;
+
+		shell_print(sh, "  Rounds: %u, reader saw %u, decoded %u",
+			    a->rounds, a->reader_reads, a->decoded);
+		shell_print(sh, "  Missing: %u, decoded without beep: %u",
+			    a->missing, a->unbeeped);
+		shell_print(sh, "  Last round: saw %u, decoded %u",
+			    a->last_reads, a->last_decoded);
+		shell_print(sh, "  Beep -> parsed: avg %u us, max %u us (%u pairs)",
+			    a->lat_avg_us, a->lat_max_us, a->lat_count);
+	}
+
+	return 0;
+}
+
+static int cmd_router_audit(const struct shell *sh, size_t argc, char **argv)
+{
+	if (argc < 2) {
+		shell_print(sh, "E310 beep audit: %s",
+			    beep_control_is_edge_capture_enabled() ? "on" : "off");
+		shell_print(sh, "Usage: router audit <on|off>  (needs e310 buzzer on)");
+		return 0;
+	}
 
+	if (strcmp(argv[1], "on") == 0) {
+		beep_control_set_edge_capture(true);
+	} else if (strcmp(argv[1], "off") == 0) {
+		beep_control_set_edge_capture(false);
+	} else {
+		shell_error(sh, "Invalid argument: %s (use on/off)", argv[1]);
+		return -EINVAL;
+	}
+
+	shell_print(sh, "E310 beep audit %s (from the next round)", argv[1]);
+	return 0;
+}
+
+static int cmd_router_snapshot(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	router_metrics_snapshot_t snap;
+	char hex[2 * sizeof(snap) + 1];
+	const uint8_t *raw = (const uint8_t *)&snap;
+
+	router_metrics_get_snapshot(&snap);
+	for (size_t i = 0; i < sizeof(snap); i++) {
+		snprintf(&hex[2 * i], 3, "%02X", raw[i]);
+	}
+
+	/* One line, decoded by tools/router_snapshot.py */
+	shell_print(sh, "SNAP %s", hex);
 	return 0;
 }
 
@@ -1219,7 +2354,7 @@ static int cmd_router_mode(const struct shell *sh, size_t argc, char **argv)
 
 	if (argc < 2) {
 		shell_print(sh, "Current mode: %s",
-			    uart_router_get_mode_name(g_router_instance->mode));
+			    uart_router_get_mode_name(uart_router_get_mode(g_router_instance)));
 		shell_print(sh, "Usage: router mode <idle|inventory>");
 		return 0;
 	}
@@ -1242,10 +2377,93 @@ static int cmd_router_mode(const struct shell *sh, size_t argc, char **argv)
 }
 
 /* Shell command registration */
+/* ========================================================================
+ * Tag Store Shell Commands
+ * ======================================================================== */
+
+static int cmd_router_store_status(const struct shell *sh, size_t argc, char **argv)
+{
+	tag_store_stats_t st;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	tag_store_get_stats(&st);
+
+	shell_print(sh, "=== Tag Store ===");
+	shell_print(sh, "HID sink: %s", usb_hid_is_ready() ? "ready" : "not ready");
+	shell_print(sh, "Records: %u (%u/%u bytes), oldest %u s", st.records,
+		    st.used_bytes, TAG_STORE_BUF_SIZE, st.oldest_age_ms / 1000);
+	shell_print(sh, "Buffered: %u", st.buffered);
+	shell_print(sh, "Replayed: %u", st.replayed);
+	shell_print(sh, "Expired: %u", st.expired);
+	shell_print(sh, "Deduped (already delivered): %u", st.deduped);
+	shell_print(sh, "Dropped (store full): %u", st.dropped);
+	shell_print(sh, "Failed (sink rejected): %u", st.failed);
+	shell_print(sh, "Expiry: %u s%s", tag_store_get_expiry(),
+		    tag_store_get_expiry() == 0 ? " (never)" : "");
+	shell_print(sh, "Replay rate: %u/s", tag_store_get_rate());
+	return 0;
+}
+
+static int cmd_router_store_clear(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	tag_store_clear();
+	shell_print(sh, "Tag store cleared");
+	return 0;
+}
+
+static int cmd_router_store_expiry(const struct shell *sh, size_t argc, char **argv)
+{
+	if (argc < 2) {
+		shell_print(sh, "Expiry: %u s", tag_store_get_expiry());
+		shell_print(sh, "Usage: router store expiry <seconds> (0 = never)");
+		return 0;
+	}
+
+	tag_store_set_expiry(strtoul(argv[1], NULL, 10));
+	shell_print(sh, "Stored tags expire after %u s", tag_store_get_expiry());
+	return 0;
+}
+
+static int cmd_router_store_rate(const struct shell *sh, size_t argc, char **argv)
+{
+	if (argc < 2) {
+		shell_print(sh, "Replay rate: %u/s", tag_store_get_rate());
+		shell_print(sh, "Usage: router store rate <%u-%u>",
+			    TAG_STORE_RATE_MIN, TAG_STORE_RATE_MAX);
+		return 0;
+	}
+
+	if (tag_store_set_rate(strtoul(argv[1], NULL, 10)) < 0) {
+		shell_error(sh, "Rate must be %u-%u records/s",
+			    TAG_STORE_RATE_MIN, TAG_STORE_RATE_MAX);
+		return -EINVAL;
+	}
+
+	shell_print(sh, "Replay rate: %u/s", tag_store_get_rate());
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_router_store,
+	SHELL_CMD(status, NULL, "Show tag store status", cmd_router_store_status),
+	SHELL_CMD(clear, NULL, "Discard stored tags", cmd_router_store_clear),
+	SHELL_CMD(expiry, NULL, "Get/set record lifetime (s)", cmd_router_store_expiry),
+	SHELL_CMD(rate, NULL, "Get/set replay rate (records/s)", cmd_router_store_rate),
+	SHELL_SUBCMD_SET_END
+);
+
 SHELL_STATIC_SUBCMD_SET_CREATE(sub_router,
 	SHELL_CMD(status, NULL, "Show router status", cmd_router_status),
 	SHELL_CMD(stats, NULL, "Show router statistics", cmd_router_stats),
+	SHELL_CMD(audit, NULL, "E310 beep edges vs decoded tags: <on|off>",
+		  cmd_router_audit),
+	SHELL_CMD(snapshot, NULL, "Binary metrics snapshot (hex)", cmd_router_snapshot),
 	SHELL_CMD(mode, NULL, "Get/set router mode", cmd_router_mode),
+	SHELL_CMD(store, &sub_router_store, "Store-and-forward tag buffer", NULL),
 	SHELL_SUBCMD_SET_END
 );
 
@@ -1255,6 +2473,47 @@ SHELL_CMD_REGISTER(router, &sub_router, "UART Router commands", NULL);
  * E310 Shell Commands
  * ======================================================================== */
 
+/* Frames built by shell commands (shell thread only) */
+static e310_context_t shell_e310;
+
+/**
+ * @brief Protocol context for a command to the current reader address
+ */
+static e310_context_t *shell_ctx(void)
+{
+	uart_router_status_t status;
+
+	uart_router_get_status(g_router_instance, &status);
+	e310_init(&shell_e310, status.reader_addr);
+	return &shell_e310;
+}
+
+/**
+ * @brief Send the command built in shell_ctx() and wait for the response
+ *
+ * @param len Builder result
+ * @param timeout_ms Response timeout
+ * @return 0 (also on no response), negative errno on build/send failure
+ */
+static int shell_transact(const struct shell *sh, int len, int timeout_ms)
+{
+	if (len < 0) {
+		shell_error(sh, "Failed to build command: %d", len);
+		return len;
+	}
+
+	int ret = uart_router_transact(g_router_instance, shell_e310.tx_buffer,
+				       len, timeout_ms);
+	if (ret == -ETIMEDOUT) {
+		shell_warn(sh, "No response from E310");
+	} else if (ret < 0) {
+		shell_error(sh, "Failed to send: %d", ret);
+		return ret;
+	}
+
+	return 0;
+}
+
 static int cmd_e310_connect(const struct shell *sh, size_t argc, char **argv)
 {
 	ARG_UNUSED(argc);
@@ -1292,10 +2551,9 @@ static int cmd_e310_start(const struct shell *sh, size_t argc, char **argv)
 		return ret;
 	}
 
-	/* Return immediately — main loop handles all E310 response processing.
-	 * Previously called wait_for_e310_response(3000) here, which blocked
-	 * the shell thread and called uart_router_process() from shell context,
-	 * causing UART1 freeze due to shell thread starvation. */
+	/* Return once the round is started — the router thread handles the
+	 * E310 responses. Waiting for the round here would only block the
+	 * shell thread. */
 	shell_print(sh, "E310 Tag Inventory started");
 	return 0;
 }
@@ -1316,9 +2574,29 @@ static int cmd_e310_stop(const struct shell *sh, size_t argc, char **argv)
 		return ret;
 	}
 
-	uart_router_set_mode(g_router_instance, ROUTER_MODE_IDLE);
-	shell_print(sh, "E310 Tag Inventory stopped");
-	return 0;
+	uart_router_set_mode(g_router_instance, ROUTER_MODE_IDLE);
+	shell_print(sh, "E310 Tag Inventory stopped");
+	return 0;
+}
+
+/**
+ * @brief Wait for a published reader-side change to reach the E310
+ */
+static void report_config_apply(const struct shell *sh, uint32_t version)
+{
+	uart_router_status_t status;
+
+	if (uart_router_wait_config(g_router_instance, version, CFG_SHELL_WAIT_MS) == 0) {
+		shell_print(sh, "Applied to E310");
+		return;
+	}
+
+	uart_router_get_status(g_router_instance, &status);
+	if (!status.e310_connected) {
+		shell_warn(sh, "E310 not connected: applies once connected");
+	} else {
+		shell_warn(sh, "Not yet applied: queued for the next round boundary");
+	}
 }
 
 static int cmd_e310_power(const struct shell *sh, size_t argc, char **argv)
@@ -1346,13 +2624,13 @@ static int cmd_e310_power(const struct shell *sh, size_t argc, char **argv)
 		return ret;
 	}
 
-	wait_for_e310_response(g_router_instance, 500);
 	ret = e310_settings_set_rf_power((uint8_t)power);
 	if (ret < 0) {
 		shell_warn(sh, "RF power set but failed to save: %d", ret);
 	}
 
 	shell_print(sh, "RF power set to %d dBm (saved)", power);
+	report_config_apply(sh, runtime_config_version());
 	return 0;
 }
 
@@ -1366,16 +2644,7 @@ static int cmd_e310_info(const struct shell *sh, size_t argc, char **argv)
 		return -ENODEV;
 	}
 
-	int ret = uart_router_get_reader_info(g_router_instance);
-	if (ret < 0) {
-		shell_error(sh, "Failed to request reader info: %d", ret);
-		return ret;
-	}
-
-	if (wait_for_e310_response(g_router_instance, 500) < 0) {
-		shell_warn(sh, "No response from E310");
-	}
-	return 0;
+	return shell_transact(sh, e310_build_obtain_reader_info(shell_ctx()), 500);
 }
 
 static int cmd_e310_status(const struct shell *sh, size_t argc, char **argv)
@@ -1388,18 +2657,27 @@ static int cmd_e310_status(const struct shell *sh, size_t argc, char **argv)
 		return -ENODEV;
 	}
 
+	uart_router_status_t status;
+
+	uart_router_get_status(g_router_instance, &status);
+
 	shell_print(sh, "=== E310 Status ===");
-	shell_print(sh, "Inventory active: %s",
-	            g_router_instance->inventory_active ? "YES" : "no");
-	shell_print(sh, "Router mode: %s",
-	            uart_router_get_mode_name(g_router_instance->mode));
-	shell_print(sh, "Reader address: 0x%02X",
-	            g_router_instance->e310_ctx.reader_addr);
-	shell_print(sh, "Frames parsed: %u", g_router_instance->stats.frames_parsed);
-	shell_print(sh, "Parse errors: %u", g_router_instance->stats.parse_errors);
-	shell_print(sh, "EPC sent (HID): %u", g_router_instance->stats.epc_sent);
-	shell_print(sh, "UART4 RX bytes: %u", g_router_instance->stats.uart4_rx_bytes);
-	shell_print(sh, "UART4 TX bytes: %u", g_router_instance->stats.uart4_tx_bytes);
+	shell_print(sh, "Inventory active: %s", status.inventory_active ? "YES" : "no");
+	shell_print(sh, "Router mode: %s", uart_router_get_mode_name(status.mode));
+	shell_print(sh, "Reader address: 0x%02X", status.reader_addr);
+	shell_print(sh, "Frames parsed: %u", status.stats.frames_parsed);
+	shell_print(sh, "Parse errors: %u", status.stats.parse_errors);
+	shell_print(sh, "EPC sent (HID): %u", status.stats.epc_sent);
+	shell_print(sh, "UART4 RX bytes: %u", status.stats.uart4_rx_bytes);
+	shell_print(sh, "UART4 TX bytes: %u", status.stats.uart4_tx_bytes);
+	shell_print(sh, "Link: %u silences, %u recovered, %u failed",
+		    status.link.silences, status.link.recoveries,
+		    status.link.failures);
+	if (status.link.recoveries > 0) {
+		shell_print(sh, "  Last: silent %u ms, recovered in %u ms (max %u ms)",
+			    status.link.last_silent_ms, status.link.last_recovery_ms,
+			    status.link.max_recovery_ms);
+	}
 
 	return 0;
 }
@@ -1493,15 +2771,13 @@ static int cmd_e310_send(const struct shell *sh, size_t argc, char **argv)
 	shell_fprintf(sh, SHELL_NORMAL, "\n");
 
 	/* Send to UART4 */
-	int ret = uart_router_send_uart4(g_router_instance, cmd_buf, cmd_len);
-	if (ret < 0) {
+	int ret = uart_router_transact(g_router_instance, cmd_buf, cmd_len, 1000);
+	if (ret == -ETIMEDOUT) {
+		shell_warn(sh, "No response from E310");
+	} else if (ret < 0) {
 		shell_error(sh, "Failed to send: %d", ret);
 		return ret;
 	}
-
-	if (wait_for_e310_response(g_router_instance, 1000) < 0) {
-		shell_warn(sh, "No response from E310");
-	}
 	return 0;
 }
 
@@ -1515,7 +2791,7 @@ static int cmd_e310_debug(const struct shell *sh, size_t argc, char **argv)
 
 	if (strcmp(argv[1], "on") == 0 || strcmp(argv[1], "1") == 0) {
 		e310_debug_mode = true;
-		shell_print(sh, "Debug mode enabled - raw frames will be shown");
+		shell_print(sh, "Debug mode enabled - frame details logged (raw bytes: e310 trace dump)");
 	} else if (strcmp(argv[1], "off") == 0 || strcmp(argv[1], "0") == 0) {
 		e310_debug_mode = false;
 		shell_print(sh, "Debug mode disabled");
@@ -1535,9 +2811,11 @@ static int cmd_e310_addr(const struct shell *sh, size_t argc, char **argv)
 	}
 
 	if (argc < 2) {
+		uart_router_status_t status;
+
+		uart_router_get_status(g_router_instance, &status);
 		shell_print(sh, "Current address: 0x%02X (saved: 0x%02X)",
-		            g_router_instance->e310_ctx.reader_addr,
-		            e310_settings_get_reader_addr());
+		            status.reader_addr, e310_settings_get_reader_addr());
 		shell_print(sh, "Usage: e310 addr <0x00-0xFF>");
 		shell_print(sh, "  0xFF = broadcast (works with most modules)");
 		return 0;
@@ -1549,7 +2827,7 @@ static int cmd_e310_addr(const struct shell *sh, size_t argc, char **argv)
 		return -EINVAL;
 	}
 
-	g_router_instance->e310_ctx.reader_addr = (uint8_t)addr;
+	uart_router_call(g_router_instance, ROUTER_OP_SET_ADDR, (uint8_t)addr);
 
 	int ret = e310_settings_set_reader_addr((uint8_t)addr);
 	if (ret < 0) {
@@ -1571,23 +2849,7 @@ static int cmd_e310_single(const struct shell *sh, size_t argc, char **argv)
 	}
 
 	/* Build and send single tag inventory command */
-	int len = e310_build_single_tag_inventory(&g_router_instance->e310_ctx);
-	if (len < 0) {
-		shell_error(sh, "Failed to build command: %d", len);
-		return len;
-	}
-
-	int ret = uart_router_send_uart4(g_router_instance,
-	                                  g_router_instance->e310_ctx.tx_buffer, len);
-	if (ret < 0) {
-		shell_error(sh, "Failed to send: %d", ret);
-		return ret;
-	}
-
-	if (wait_for_e310_response(g_router_instance, 1000) < 0) {
-		shell_warn(sh, "No response from E310");
-	}
-	return 0;
+	return shell_transact(sh, e310_build_single_tag_inventory(shell_ctx()), 1000);
 }
 
 static int cmd_e310_reset(const struct shell *sh, size_t argc, char **argv)
@@ -1600,29 +2862,13 @@ static int cmd_e310_reset(const struct shell *sh, size_t argc, char **argv)
 		return -ENODEV;
 	}
 
-	/* Send stop immediately command */
-	int len = e310_build_stop_immediately(&g_router_instance->e310_ctx);
-	if (len < 0) {
-		shell_error(sh, "Failed to build command: %d", len);
-		return len;
-	}
-
-	int ret = uart_router_send_uart4(g_router_instance,
-	                                  g_router_instance->e310_ctx.tx_buffer, len);
+	/* Stop immediately, then clear the inventory state */
+	int ret = uart_router_call(g_router_instance, ROUTER_OP_RESET, 0);
 	if (ret < 0) {
 		shell_error(sh, "Failed to send: %d", ret);
 		return ret;
 	}
 
-	wait_for_e310_response(g_router_instance, 500);
-
-	g_router_instance->inventory_active = false;
-	g_router_instance->next_inventory_time = 0;
-	switch_control_set_inventory_state(false);
-	usb_hid_set_enabled(false);
-	rgb_led_set_inventory_status(false);
-	uart_router_set_mode(g_router_instance, ROUTER_MODE_IDLE);
-
 	shell_print(sh, "E310 stop command sent, router reset to IDLE");
 	return 0;
 }
@@ -1637,23 +2883,7 @@ static int cmd_e310_sn(const struct shell *sh, size_t argc, char **argv)
 		return -ENODEV;
 	}
 
-	int len = e310_build_obtain_reader_sn(&g_router_instance->e310_ctx);
-	if (len < 0) {
-		shell_error(sh, "Failed to build command: %d", len);
-		return len;
-	}
-
-	int ret = uart_router_send_uart4(g_router_instance,
-	                                  g_router_instance->e310_ctx.tx_buffer, len);
-	if (ret < 0) {
-		shell_error(sh, "Failed to send: %d", ret);
-		return ret;
-	}
-
-	if (wait_for_e310_response(g_router_instance, 500) < 0) {
-		shell_warn(sh, "No response from E310");
-	}
-	return 0;
+	return shell_transact(sh, e310_build_obtain_reader_sn(shell_ctx()), 500);
 }
 
 static int cmd_e310_temp(const struct shell *sh, size_t argc, char **argv)
@@ -1666,23 +2896,7 @@ static int cmd_e310_temp(const struct shell *sh, size_t argc, char **argv)
 		return -ENODEV;
 	}
 
-	int len = e310_build_measure_temperature(&g_router_instance->e310_ctx);
-	if (len < 0) {
-		shell_error(sh, "Failed to build command: %d", len);
-		return len;
-	}
-
-	int ret = uart_router_send_uart4(g_router_instance,
-	                                  g_router_instance->e310_ctx.tx_buffer, len);
-	if (ret < 0) {
-		shell_error(sh, "Failed to send: %d", ret);
-		return ret;
-	}
-
-	if (wait_for_e310_response(g_router_instance, 1000) < 0) {
-		shell_warn(sh, "No response from E310");
-	}
-	return 0;
+	return shell_transact(sh, e310_build_measure_temperature(shell_ctx()), 1000);
 }
 
 static int cmd_e310_buffer_count(const struct shell *sh, size_t argc, char **argv)
@@ -1695,23 +2909,7 @@ static int cmd_e310_buffer_count(const struct shell *sh, size_t argc, char **arg
 		return -ENODEV;
 	}
 
-	int len = e310_build_get_tag_count(&g_router_instance->e310_ctx);
-	if (len < 0) {
-		shell_error(sh, "Failed to build command: %d", len);
-		return len;
-	}
-
-	int ret = uart_router_send_uart4(g_router_instance,
-	                                  g_router_instance->e310_ctx.tx_buffer, len);
-	if (ret < 0) {
-		shell_error(sh, "Failed to send: %d", ret);
-		return ret;
-	}
-
-	if (wait_for_e310_response(g_router_instance, 500) < 0) {
-		shell_warn(sh, "No response from E310");
-	}
-	return 0;
+	return shell_transact(sh, e310_build_get_tag_count(shell_ctx()), 500);
 }
 
 static int cmd_e310_buffer_clear(const struct shell *sh, size_t argc, char **argv)
@@ -1724,23 +2922,7 @@ static int cmd_e310_buffer_clear(const struct shell *sh, size_t argc, char **arg
 		return -ENODEV;
 	}
 
-	int len = e310_build_clear_memory_buffer(&g_router_instance->e310_ctx);
-	if (len < 0) {
-		shell_error(sh, "Failed to build command: %d", len);
-		return len;
-	}
-
-	int ret = uart_router_send_uart4(g_router_instance,
-	                                  g_router_instance->e310_ctx.tx_buffer, len);
-	if (ret < 0) {
-		shell_error(sh, "Failed to send: %d", ret);
-		return ret;
-	}
-
-	if (wait_for_e310_response(g_router_instance, 500) < 0) {
-		shell_warn(sh, "No response from E310");
-	}
-	return 0;
+	return shell_transact(sh, e310_build_clear_memory_buffer(shell_ctx()), 500);
 }
 
 static int cmd_e310_buffer_get(const struct shell *sh, size_t argc, char **argv)
@@ -1753,23 +2935,7 @@ static int cmd_e310_buffer_get(const struct shell *sh, size_t argc, char **argv)
 		return -ENODEV;
 	}
 
-	int len = e310_build_get_data_from_buffer(&g_router_instance->e310_ctx);
-	if (len < 0) {
-		shell_error(sh, "Failed to build command: %d", len);
-		return len;
-	}
-
-	int ret = uart_router_send_uart4(g_router_instance,
-	                                  g_router_instance->e310_ctx.tx_buffer, len);
-	if (ret < 0) {
-		shell_error(sh, "Failed to send: %d", ret);
-		return ret;
-	}
-
-	if (wait_for_e310_response(g_router_instance, 500) < 0) {
-		shell_warn(sh, "No response from E310");
-	}
-	return 0;
+	return shell_transact(sh, e310_build_get_data_from_buffer(shell_ctx()), 500);
 }
 
 /**
@@ -1797,32 +2963,24 @@ static int cmd_e310_buzzer(const struct shell *sh, size_t argc, char **argv)
 
 	int len;
 	if (strcmp(argv[1], "on") == 0) {
-		len = e310_build_enable_buzzer(&g_router_instance->e310_ctx, true);
+		len = e310_build_enable_buzzer(shell_ctx(), true);
 	} else if (strcmp(argv[1], "off") == 0) {
-		len = e310_build_enable_buzzer(&g_router_instance->e310_ctx, false);
+		len = e310_build_enable_buzzer(shell_ctx(), false);
 	} else if (strcmp(argv[1], "beep") == 0) {
 		uint8_t duration_100ms = (argc >= 3) ? atoi(argv[2]) : 1;
 		uint8_t active_time = (duration_100ms > 127) ? 255 : (duration_100ms * 2);
-		len = e310_build_led_buzzer_control(&g_router_instance->e310_ctx,
+		len = e310_build_led_buzzer_control(shell_ctx(),
 		                                     active_time, 0, 1);
 	} else {
 		shell_error(sh, "Unknown option: %s", argv[1]);
 		return -EINVAL;
 	}
 
-	if (len < 0) {
-		shell_error(sh, "Failed to build command: %d", len);
-		return len;
-	}
-
-	int ret = uart_router_send_uart4(g_router_instance,
-	                                  g_router_instance->e310_ctx.tx_buffer, len);
+	int ret = shell_transact(sh, len, 500);
 	if (ret < 0) {
-		shell_error(sh, "Failed to send: %d", ret);
 		return ret;
 	}
 
-	wait_for_e310_response(g_router_instance, 500);
 	shell_print(sh, "Buzzer command sent");
 	return 0;
 }
@@ -1840,23 +2998,15 @@ static int cmd_e310_led(const struct shell *sh, size_t argc, char **argv)
 	}
 
 	uint8_t led_state = (strcmp(argv[1], "on") == 0) ? 1 : 0;
-	int len = e310_build_led_buzzer_control(&g_router_instance->e310_ctx,
+	int len = e310_build_led_buzzer_control(shell_ctx(),
 	                                         led_state,
 	                                         0,
 	                                         led_state);
-	if (len < 0) {
-		shell_error(sh, "Failed to build command: %d", len);
-		return len;
-	}
-
-	int ret = uart_router_send_uart4(g_router_instance,
-	                                  g_router_instance->e310_ctx.tx_buffer, len);
+	int ret = shell_transact(sh, len, 500);
 	if (ret < 0) {
-		shell_error(sh, "Failed to send: %d", ret);
 		return ret;
 	}
 
-	wait_for_e310_response(g_router_instance, 500);
 	shell_print(sh, "LED %s", led_state ? "ON" : "OFF");
 	return 0;
 }
@@ -1875,27 +3025,17 @@ static int cmd_e310_antenna(const struct shell *sh, size_t argc, char **argv)
 	}
 
 	unsigned long config = strtoul(argv[1], NULL, 0);
-	int len = e310_build_setup_antenna_mux(&g_router_instance->e310_ctx,
-	                                        (uint8_t)config);
-	if (len < 0) {
-		shell_error(sh, "Failed to build command: %d", len);
-		return len;
-	}
 
-	int ret = uart_router_send_uart4(g_router_instance,
-	                                  g_router_instance->e310_ctx.tx_buffer, len);
-	if (ret < 0) {
-		shell_error(sh, "Failed to send: %d", ret);
-		return ret;
-	}
+	runtime_config_edit()->antenna_config = (uint8_t)config;
+	uint32_t version = runtime_config_publish();
 
-	wait_for_e310_response(g_router_instance, 500);
-	ret = e310_settings_set_antenna((uint8_t)config);
+	int ret = e310_settings_set_antenna((uint8_t)config);
 	if (ret < 0) {
 		shell_warn(sh, "Antenna set but failed to save: %d", ret);
 	}
 
 	shell_print(sh, "Antenna config set to 0x%02X (saved)", (uint8_t)config);
+	report_config_apply(sh, version);
 	return 0;
 }
 
@@ -1920,55 +3060,26 @@ static int cmd_e310_freq(const struct shell *sh, size_t argc, char **argv)
 	uint8_t start = atoi(argv[2]);
 	uint8_t end = atoi(argv[3]);
 
-	/* Encode region + frequency points into MaxFre/MinFre bytes per protocol 0x22 */
-	uint8_t band_hi = 0;
-	uint8_t band_lo = 0;
-	switch (region) {
-	case 1:
-		band_hi = 0x00;
-		band_lo = 0x01;
-		break; /* China */
-	case 2:
-		band_hi = 0x00;
-		band_lo = 0x02;
-		break; /* US */
-	case 3:
-		band_hi = 0x01;
-		band_lo = 0x00;
-		break; /* Europe */
-	case 4:
-		band_hi = 0x00;
-		band_lo = 0x03;
-		break; /* Korea */
-	default:
+	/* Validate the MaxFre/MinFre encoding (protocol 0x22) before publishing */
+	uint8_t max_fre, min_fre;
+	if (e310_encode_frequency(region, start, end, &max_fre, &min_fre) != E310_OK) {
 		shell_error(sh, "Invalid region %d (1=China, 2=US, 3=Europe, 4=Korea)", region);
 		return -EINVAL;
 	}
 
-	uint8_t max_fre = (band_hi << 6) | (end & 0x3F);
-	uint8_t min_fre = (band_lo << 6) | (start & 0x3F);
-
-	int len = e310_build_modify_frequency(&g_router_instance->e310_ctx,
-	                                       max_fre, min_fre);
-	if (len < 0) {
-		shell_error(sh, "Failed to build command: %d", len);
-		return len;
-	}
-
-	int ret = uart_router_send_uart4(g_router_instance,
-	                                  g_router_instance->e310_ctx.tx_buffer, len);
-	if (ret < 0) {
-		shell_error(sh, "Failed to send: %d", ret);
-		return ret;
-	}
+	runtime_config_t *cfg = runtime_config_edit();
+	cfg->freq_region = region;
+	cfg->freq_start = start;
+	cfg->freq_end = end;
+	uint32_t version = runtime_config_publish();
 
-	wait_for_e310_response(g_router_instance, 500);
-	ret = e310_settings_set_frequency(region, start, end);
+	int ret = e310_settings_set_frequency(region, start, end);
 	if (ret < 0) {
 		shell_warn(sh, "Frequency set but failed to save: %d", ret);
 	}
 
 	shell_print(sh, "Frequency set: region=%u, range=%u-%u (saved)", region, start, end);
+	report_config_apply(sh, version);
 	return 0;
 }
 
@@ -1989,26 +3100,22 @@ static int cmd_e310_invtime(const struct shell *sh, size_t argc, char **argv)
 	}
 
 	uint8_t time = atoi(argv[1]);
-	int len = e310_build_modify_inventory_time(&g_router_instance->e310_ctx, time);
-	if (len < 0) {
-		shell_error(sh, "Failed to build command: %d", len);
-		return len;
+	if (time < E310_INVENTORY_TIME_MIN) {
+		shell_error(sh, "Invalid inventory time: %s (must be %d-%d)", argv[1],
+			    E310_INVENTORY_TIME_MIN, E310_INVENTORY_TIME_MAX);
+		return -EINVAL;
 	}
 
-	int ret = uart_router_send_uart4(g_router_instance,
-	                                  g_router_instance->e310_ctx.tx_buffer, len);
-	if (ret < 0) {
-		shell_error(sh, "Failed to send: %d", ret);
-		return ret;
-	}
+	runtime_config_edit()->inventory_time = time;
+	uint32_t version = runtime_config_publish();
 
-	wait_for_e310_response(g_router_instance, 500);
-	ret = e310_settings_set_inventory_time(time);
+	int ret = e310_settings_set_inventory_time(time);
 	if (ret < 0) {
 		shell_warn(sh, "Inventory time set but failed to save: %d", ret);
 	}
 
 	shell_print(sh, "Inventory time set to %ums (saved)", time * 100);
+	report_config_apply(sh, version);
 	return 0;
 }
 
@@ -2020,8 +3127,10 @@ static int cmd_e310_interval(const struct shell *sh, size_t argc, char **argv)
 	}
 
 	if (argc < 2) {
-		shell_print(sh, "Current interval: %u ms",
-			    g_router_instance->inventory_interval_ms);
+		runtime_config_t cfg;
+
+		runtime_config_get(&cfg);
+		shell_print(sh, "Current interval: %u ms", cfg.inventory_interval_ms);
 		shell_print(sh, "Usage: e310 interval <ms>");
 		return 0;
 	}
@@ -2033,7 +3142,10 @@ static int cmd_e310_interval(const struct shell *sh, size_t argc, char **argv)
 		return -EINVAL;
 	}
 
-	g_router_instance->inventory_interval_ms = (uint32_t)ms;
+	/* Picked up by the router's next poll, mid-inventory included */
+	runtime_config_edit()->inventory_interval_ms = (uint32_t)ms;
+	runtime_config_publish();
+
 	int ret = e310_settings_set_inventory_interval((uint16_t)ms);
 	shell_print(sh, "Inventory interval set to %d ms%s",
 		    ms, (ret < 0) ? "" : " (saved)");
@@ -2053,33 +3165,18 @@ static int cmd_e310_gpio(const struct shell *sh, size_t argc, char **argv)
 
 	int len;
 	if (argc < 2) {
-		len = e310_build_obtain_gpio_state(&g_router_instance->e310_ctx);
+		len = e310_build_obtain_gpio_state(shell_ctx());
 		shell_print(sh, "Usage: e310 gpio [state]");
 		shell_print(sh, "  (no arg) - Get current GPIO state");
 		shell_print(sh, "  state    - Set GPIO state (0x00-0xFF)");
 		shell_print(sh, "Requesting current GPIO state...");
 	} else {
 		unsigned long state = strtoul(argv[1], NULL, 0);
-		len = e310_build_gpio_control(&g_router_instance->e310_ctx, (uint8_t)state);
+		len = e310_build_gpio_control(shell_ctx(), (uint8_t)state);
 		shell_print(sh, "GPIO state set to 0x%02X", (uint8_t)state);
 	}
 
-	if (len < 0) {
-		shell_error(sh, "Failed to build command: %d", len);
-		return len;
-	}
-
-	int ret = uart_router_send_uart4(g_router_instance,
-	                                  g_router_instance->e310_ctx.tx_buffer, len);
-	if (ret < 0) {
-		shell_error(sh, "Failed to send: %d", ret);
-		return ret;
-	}
-
-	if (wait_for_e310_response(g_router_instance, 500) < 0) {
-		shell_warn(sh, "No response from E310");
-	}
-	return 0;
+	return shell_transact(sh, len, 500);
 }
 
 static int cmd_e310_settings_show(const struct shell *sh, size_t argc, char **argv)
@@ -2107,9 +3204,221 @@ static int cmd_e310_settings_reset(const struct shell *sh, size_t argc, char **a
 	return 0;
 }
 
+static int cmd_e310_settings_flush(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	int ret = e310_settings_flush();
+	if (ret < 0) {
+		shell_error(sh, "Failed to flush settings: %d", ret);
+		return ret;
+	}
+
+	shell_print(sh, "Settings written to EEPROM");
+	return 0;
+}
+
+/* ========================================================================
+ * Frame Trace Shell Commands
+ * ======================================================================== */
+
+static const char *const trace_dir_names[] = {
+	[FRAME_TRACE_RX] = "RX",
+	[FRAME_TRACE_RX_CRC_ERR] = "RX!CRC",
+	[FRAME_TRACE_TX] = "TX",
+};
+
+struct trace_dump_ctx {
+	const struct shell *sh;
+	uint32_t prev_us;
+	bool first;
+};
+
+static void trace_dump_record(const frame_trace_hdr_t *hdr,
+			      const uint8_t *data, void *user_data)
+{
+	struct trace_dump_ctx *ctx = user_data;
+	const char *dir = hdr->dir < ARRAY_SIZE(trace_dir_names) ?
+			  trace_dir_names[hdr->dir] : "?";
+	uint32_t delta = ctx->first ? 0 : hdr->timestamp_us - ctx->prev_us;
+	char line[16 * 3 + 1];
+
+	ctx->first = false;
+	ctx->prev_us = hdr->timestamp_us;
+
+	shell_print(ctx->sh, "%10u.%06u (+%u us) %s[%u]%s%s",
+		    hdr->timestamp_us / 1000000U, hdr->timestamp_us % 1000000U,
+		    delta, dir, hdr->len,
+		    (hdr->flags & FRAME_TRACE_FLAG_INVENTORY) ? " inv" : "",
+		    (hdr->flags & FRAME_TRACE_FLAG_TRUNCATED) ? " trunc" : "");
+
+	for (size_t off = 0; off < hdr->len; off += 16) {
+		size_t n = MIN(16, hdr->len - off);
+		int pos = 0;
+
+		for (size_t i = 0; i < n; i++) {
+			pos += snprintf(&line[pos], sizeof(line) - pos, "%02X ",
+					data[off + i]);
+		}
+		shell_print(ctx->sh, "    %s", line);
+	}
+}
+
+static int cmd_e310_trace_dump(const struct shell *sh, size_t argc, char **argv)
+{
+	frame_trace_stats_t st;
+	uint32_t skip = 0;
+
+	frame_trace_get_stats(&st);
+
+	if (argc >= 2) {
+		uint32_t last = strtoul(argv[1], NULL, 10);
+
+		if (last < st.records) {
+			skip = st.records - last;
+		}
+	}
+
+	struct trace_dump_ctx ctx = { .sh = sh, .first = true };
+	int ret = frame_trace_foreach(skip, trace_dump_record, &ctx);
+
+	if (ret < 0) {
+		shell_error(sh, "Trace dump already in progress");
+		return ret;
+	}
+
+	shell_print(sh, "--- %d record(s), %u dropped ---", ret, st.dropped);
+	return 0;
+}
+
+static int cmd_e310_trace_clear(const struct shell *sh, size_t argc, char **argv)
+{
+	frame_trace_clear();
+	shell_print(sh, "Frame trace cleared");
+	return 0;
+}
+
+static int cmd_e310_trace_status(const struct shell *sh, size_t argc, char **argv)
+{
+	frame_trace_stats_t st;
+
+	frame_trace_get_stats(&st);
+
+	shell_print(sh, "=== Frame Trace ===");
+	shell_print(sh, "Capture: %s", st.enabled ? "ON" : "OFF");
+	shell_print(sh, "Records: %u (%u/%u bytes)", st.records,
+		    st.used_bytes, FRAME_TRACE_BUF_SIZE);
+	shell_print(sh, "Recorded: %u", st.recorded);
+	shell_print(sh, "Dropped (oldest overwritten): %u", st.dropped);
+	shell_print(sh, "Skipped (off/dumping): %u", st.skipped);
+	return 0;
+}
+
+static int cmd_e310_trace_on(const struct shell *sh, size_t argc, char **argv)
+{
+	frame_trace_set_enabled(true);
+	shell_print(sh, "Frame trace capture enabled");
+	return 0;
+}
+
+static int cmd_e310_trace_off(const struct shell *sh, size_t argc, char **argv)
+{
+	frame_trace_set_enabled(false);
+	shell_print(sh, "Frame trace capture disabled");
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_e310_trace,
+	SHELL_CMD(dump, NULL, "Decode trace records [last N]", cmd_e310_trace_dump),
+	SHELL_CMD(clear, NULL, "Discard trace records", cmd_e310_trace_clear),
+	SHELL_CMD(status, NULL, "Show trace status", cmd_e310_trace_status),
+	SHELL_CMD(on, NULL, "Enable capture", cmd_e310_trace_on),
+	SHELL_CMD(off, NULL, "Disable capture", cmd_e310_trace_off),
+	SHELL_SUBCMD_SET_END
+);
+
+/* ========================================================================
+ * RX Capture Shell Commands
+ * ======================================================================== */
+
+static int cmd_e310_capture_start(const struct shell *sh, size_t argc, char **argv)
+{
+	rx_capture_start();
+	shell_print(sh, "UART4 RX capture started (%u byte buffer)",
+		    RX_CAPTURE_BUF_SIZE);
+	return 0;
+}
+
+static int cmd_e310_capture_stop(const struct shell *sh, size_t argc, char **argv)
+{
+	rx_capture_status_t st;
+
+	rx_capture_stop();
+	rx_capture_get_status(&st);
+	shell_print(sh, "UART4 RX capture stopped: %u chunks, %u bytes, %u us",
+		    st.chunks, st.bytes, st.duration_us);
+	return 0;
+}
+
+static int cmd_e310_capture_status(const struct shell *sh, size_t argc, char **argv)
+{
+	rx_capture_status_t st;
+
+	rx_capture_get_status(&st);
+	shell_print(sh, "=== UART4 RX Capture ===");
+	shell_print(sh, "State: %s%s", st.active ? "CAPTURING" : "STOPPED",
+		    st.full ? " (buffer full)" : "");
+	shell_print(sh, "Chunks: %u", st.chunks);
+	shell_print(sh, "Bytes: %u (%u/%u buffer)", st.bytes, st.used,
+		    RX_CAPTURE_BUF_SIZE);
+	shell_print(sh, "Duration: %u us", st.duration_us);
+	return 0;
+}
+
+static void capture_dump_chunk(const rx_capture_hdr_t *hdr,
+			       const uint8_t *data, void *user_data)
+{
+	const struct shell *sh = user_data;
+	char hex[2 * UINT8_MAX + 1];
+
+	for (uint8_t i = 0; i < hdr->len; i++) {
+		snprintf(&hex[2 * i], 3, "%02X", data[i]);
+	}
+	hex[2 * hdr->len] = '\0';
+
+	shell_print(sh, "C %u %u %s", hdr->timestamp_us, hdr->flags, hex);
+}
+
+static int cmd_e310_capture_dump(const struct shell *sh, size_t argc, char **argv)
+{
+	rx_capture_status_t st;
+
+	rx_capture_get_status(&st);
+	if (st.active) {
+		shell_error(sh, "Capture running, stop it first");
+		return -EBUSY;
+	}
+
+	/* Line format parsed by tools/capture2bin.py */
+	shell_print(sh, "CAPTURE BEGIN v1 chunks=%u bytes=%u", st.chunks, st.bytes);
+	rx_capture_foreach(capture_dump_chunk, (void *)sh);
+	shell_print(sh, "CAPTURE END");
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_e310_capture,
+	SHELL_CMD(start, NULL, "Start UART4 RX capture", cmd_e310_capture_start),
+	SHELL_CMD(stop, NULL, "Stop UART4 RX capture", cmd_e310_capture_stop),
+	SHELL_CMD(status, NULL, "Show capture status", cmd_e310_capture_status),
+	SHELL_CMD(dump, NULL, "Print capture for tools/capture2bin.py", cmd_e310_capture_dump),
+	SHELL_SUBCMD_SET_END
+);
+
 SHELL_STATIC_SUBCMD_SET_CREATE(sub_e310_settings,
 	SHELL_CMD(show, NULL, "Show current settings", cmd_e310_settings_show),
 	SHELL_CMD(reset, NULL, "Reset to factory defaults", cmd_e310_settings_reset),
+	SHELL_CMD(flush, NULL, "Write pending changes to EEPROM now", cmd_e310_settings_flush),
 	SHELL_SUBCMD_SET_END
 );
 
@@ -2142,6 +3451,8 @@ SHELL_STATIC_SUBCMD_SET_CREATE(sub_e310,
 	SHELL_CMD(buffer, &sub_e310_buffer, "Buffer operations", NULL),
 	SHELL_CMD(settings, &sub_e310_settings, "Persistent settings", NULL),
 	SHELL_CMD(send, NULL, "Send raw hex command", cmd_e310_send),
+	SHELL_CMD(trace, &sub_e310_trace, "Raw frame trace", NULL),
+	SHELL_CMD(capture, &sub_e310_capture, "UART4 RX byte capture", NULL),
 	SHELL_CMD(debug, NULL, "Enable/disable debug mode", cmd_e310_debug),
 	SHELL_CMD(reset, NULL, "Stop E310 and reset router", cmd_e310_reset),
 	SHELL_SUBCMD_SET_END
@@ -2230,8 +3541,10 @@ static int cmd_hid_debounce(const struct shell *sh, size_t argc, char **argv)
 	}
 
 	if (argc < 2) {
-		shell_print(sh, "Current debounce: %u seconds",
-		            g_router_instance->epc_filter.debounce_ms / 1000);
+		runtime_config_t cfg;
+
+		runtime_config_get(&cfg);
+		shell_print(sh, "Current debounce: %u seconds", cfg.epc_debounce_ms / 1000);
 		shell_print(sh, "Usage: hid debounce <seconds>");
 		return 0;
 	}
@@ -2243,7 +3556,9 @@ static int cmd_hid_debounce(const struct shell *sh, size_t argc, char **argv)
 		return -EINVAL;
 	}
 
-	epc_filter_set_debounce(&g_router_instance->epc_filter, (uint32_t)sec);
+	runtime_config_edit()->epc_debounce_ms = (uint32_t)sec * 1000;
+	runtime_config_publish();
+
 	int ret = e310_settings_set_epc_debounce((uint8_t)sec);
 	shell_print(sh, "Debounce set to %d seconds%s",
 		    sec, (ret < 0) ? "" : " (saved)");
@@ -2263,7 +3578,7 @@ static int cmd_hid_clear(const struct shell *sh, size_t argc, char **argv)
 		return -ENODEV;
 	}
 
-	epc_filter_clear(&g_router_instance->epc_filter);
+	uart_router_call(g_router_instance, ROUTER_OP_CLEAR_EPC_CACHE, 0);
 	shell_print(sh, "EPC cache cleared");
 	return 0;
 }
@@ -2278,14 +3593,20 @@ static int cmd_hid_status(const struct shell *sh, size_t argc, char **argv)
 		return -ENODEV;
 	}
 
+	uart_router_status_t status;
+	runtime_config_t cfg;
+
+	uart_router_get_status(g_router_instance, &status);
+	runtime_config_get(&cfg);
+
 	shell_print(sh, "=== HID Status ===");
 	shell_print(sh, "Output: %s", usb_hid_is_enabled() ? "ON" : "OFF (muted)");
 	shell_print(sh, "Ready: %s", usb_hid_is_ready() ? "yes" : "no");
 	shell_print(sh, "Typing speed: %u CPM", usb_hid_get_typing_speed());
 	shell_print(sh, "EPC Filter:");
-	shell_print(sh, "  Debounce: %u sec", g_router_instance->epc_filter.debounce_ms / 1000);
-	shell_print(sh, "  Cached EPCs: %u/%u", g_router_instance->epc_filter.count, EPC_CACHE_SIZE);
-	shell_print(sh, "  EPCs sent: %u", g_router_instance->stats.epc_sent);
+	shell_print(sh, "  Debounce: %u sec", cfg.epc_debounce_ms / 1000);
+	shell_print(sh, "  Cached EPCs: %u/%u", status.epc_cached, EPC_CACHE_SIZE);
+	shell_print(sh, "  EPCs sent: %u", status.stats.epc_sent);
 	return 0;
 }
 
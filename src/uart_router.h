@@ -5,6 +5,13 @@
  * Provides transparent data routing between USB CDC ACM (PC) and UART4 (E310 RFID module)
  * with support for multiple operating modes.
  *
+ * One router thread owns the router state and all E310 I/O. Other
+ * threads (shell, switch work handler, main) post typed requests to its
+ * queue with uart_router_post() and get the result in a callback, or
+ * block on it with the synchronous wrappers. Requests run in submission
+ * order, between polls, so a command/response exchange never races the
+ * inventory parser.
+ *
  * @copyright Copyright (c) 2026 PARP
  */
 
@@ -16,6 +23,7 @@
 #include <zephyr/drivers/uart.h>
 #include <zephyr/sys/ring_buffer.h>
 #include "e310_protocol.h"
+#include "runtime_config.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -39,11 +47,11 @@ extern "C" {
 /** Maximum number of cached EPCs for duplicate filtering */
 #define EPC_CACHE_SIZE              32
 
-/** Default EPC debounce time in seconds */
-#define EPC_DEBOUNCE_DEFAULT_SEC    1
+/** Router thread poll period while no request is queued (ms) */
+#define UART_ROUTER_POLL_MS         10
 
-/** Default inventory repeat interval (ms) */
-#define INVENTORY_INTERVAL_DEFAULT_MS  500
+/** Queued requests (uart_router_post() beyond this fails with -EAGAIN) */
+#define UART_ROUTER_QUEUE_DEPTH     8
 
 /* ========================================================================
  * EPC Filter (for duplicate detection)
@@ -57,6 +65,7 @@ typedef struct {
 	uint8_t epc_len;                   /**< EPC length */
 	int64_t last_sent;                 /**< Last HID send timestamp (debounce) */
 	int64_t last_seen;                 /**< Last read timestamp */
+	int64_t last_delivered;            /**< Read time of the last EPC that reached HID (-1 = none) */
 	uint8_t rssi_max;                  /**< Best RSSI observed */
 	uint8_t rssi_min;                  /**< Worst RSSI observed */
 	uint32_t read_count;               /**< Total read count */
@@ -69,7 +78,6 @@ typedef struct {
 	epc_cache_entry_t entries[EPC_CACHE_SIZE]; /**< Cache entries */
 	uint8_t count;                              /**< Current cached count */
 	uint8_t next_idx;                           /**< Next insertion index (circular) */
-	uint32_t debounce_ms;                       /**< Debounce time in ms */
 } epc_filter_t;
 
 /* ========================================================================
@@ -127,9 +135,50 @@ typedef struct {
 	uint32_t tx_errors;         /**< TX error count */
 	uint32_t frames_parsed;     /**< E310 frames successfully parsed */
 	uint32_t parse_errors;      /**< E310 parse error count */
-	uint32_t epc_sent;          /**< EPC tags sent via HID */
+	uint32_t tags_read;         /**< Tag records decoded (before filtering) */
+	uint32_t unique_tags;       /**< Tags not in the duplicate cache */
+	uint32_t epc_sent;          /**< EPC tags sent via HID (live and replayed) */
+	uint32_t epc_stored;        /**< EPC tags parked in the tag store (HID not ready) */
 } uart_router_stats_t;
 
+/**
+ * @brief Reader-side vs decoded tag reads (E310 beep edge capture)
+ *
+ * Per inventory round, the E310's own beep edges on PG0 ("reader saw")
+ * are compared with the tags decoded from UART4 ("we decoded"). The
+ * n-th decoded tag of a round is paired with the n-th edge for the
+ * read -> parse latency.
+ */
+typedef struct {
+	uint32_t rounds;            /**< Rounds measured */
+	uint32_t reader_reads;      /**< Beep edges in those rounds */
+	uint32_t decoded;           /**< Tags decoded in those rounds */
+	uint32_t missing;           /**< Sum over rounds of edges beyond decoded */
+	uint32_t unbeeped;          /**< Sum over rounds of decoded beyond edges */
+	uint32_t last_reads;        /**< Last round: edges */
+	uint32_t last_decoded;      /**< Last round: tags decoded */
+	uint32_t lat_count;         /**< Edge/tag pairs timed */
+	uint32_t lat_avg_us;        /**< Beep edge -> tag parsed, mean */
+	uint32_t lat_max_us;        /**< Beep edge -> tag parsed, max */
+	uint64_t lat_sum_us;        /**< For the mean */
+} uart_router_audit_t;
+
+/**
+ * @brief E310 link supervisor counters
+ *
+ * A round that outlives its scan time, or a real-time stream silent past
+ * its heartbeat, triggers a resync: stop, reader info, reader-side config
+ * re-sent, inventory resumed.
+ */
+typedef struct {
+	uint32_t silences;          /**< Silent link detected */
+	uint32_t recoveries;        /**< Resyncs the reader answered */
+	uint32_t failures;          /**< Resyncs without an answer (retried) */
+	uint32_t last_silent_ms;    /**< Gap since the last frame at detection */
+	uint32_t last_recovery_ms;  /**< Detection -> inventory resumed */
+	uint32_t max_recovery_ms;   /**< Worst recovery */
+} uart_router_link_t;
+
 /**
  * @brief UART Router context
  */
@@ -139,7 +188,6 @@ typedef struct {
 
 	/* Operating mode */
 	router_mode_t mode;          /**< Current operating mode */
-	struct k_mutex mode_lock;    /**< Mode change protection */
 
 	/* Ring buffers for UART4 data */
 	struct ring_buf uart4_rx_ring;  /**< UART4 RX ring buffer */
@@ -147,6 +195,11 @@ typedef struct {
 	uint8_t uart4_rx_buf[UART_ROUTER_BUF_SIZE];  /**< UART4 RX buffer storage */
 	uint8_t uart4_tx_buf[UART_ROUTER_BUF_SIZE];  /**< UART4 TX buffer storage */
 
+	/* UART4 TX completion (response timeouts start at TX complete) */
+	atomic_t uart4_tx_busy;      /**< Bytes handed to the UART still on their way out */
+	atomic_t uart4_tx_done_ms;   /**< k_uptime_get_32() of the last TX complete */
+	atomic_t uart4_tx_batches;   /**< Transmissions started (DMA transfers or IRQ bursts) */
+
 	/* E310 protocol context (for inventory mode) */
 	e310_context_t e310_ctx;     /**< E310 protocol handler */
 	frame_assembler_t e310_frame; /**< E310 frame assembler */
@@ -165,10 +218,79 @@ typedef struct {
 
 	/* Periodic inventory timing */
 	int64_t next_inventory_time; /**< k_uptime for next inventory command */
-	uint32_t inventory_interval_ms; /**< ms between inventory rounds (0=continuous) */
+	int64_t round_start;         /**< k_uptime when the current round was started */
+	int64_t next_replay_time;    /**< k_uptime for the next stored-tag replay */
+
+	/* Runtime configuration (runtime_config.h) */
+	runtime_config_t cfg;        /**< Snapshot the poll loop works with */
+	runtime_config_t e310_cfg;   /**< Reader-side values the E310 has */
+	runtime_config_t cfg_pending; /**< e310_cfg once cfg_cmd is accepted */
+	atomic_t cfg_applied;        /**< Config version fully applied, E310 included */
+	uint8_t cfg_cmd;             /**< Config command awaiting its response (0 = none) */
+	uint32_t cfg_frames;         /**< frames_parsed when cfg_cmd was sent */
+	int64_t cfg_queued;          /**< k_uptime when cfg_cmd was queued */
+	bool cfg_retry;              /**< Last config command failed: resend after the next round */
+	uint8_t rf_power_cfg;        /**< Configured RF power (cfg.rf_power is derated) */
+
+	/* E310 link supervisor */
+	uart_router_link_t link;     /**< Counters */
+	int64_t last_frame_ms;       /**< k_uptime of the last valid E310 frame */
+	uint32_t round_timeout_ms;   /**< Scan time of the round in flight */
+	bool e310_realtime;          /**< Auto-upload frames seen (real-time mode) */
+	int64_t link_retry_ms;       /**< Next resync after a failed one (0 = none) */
+
+	/* E310 beep edge audit (edge capture on) */
+	uart_router_audit_t audit;   /**< Totals */
+	bool audit_open;             /**< A round is being measured */
+	uint32_t audit_edge0;        /**< Edge count at round start */
+	uint32_t audit_edge_next;    /**< Next edge to pair with a decoded tag */
+	uint32_t audit_tags0;        /**< tags_read at round start */
 
 } uart_router_t;
 
+/**
+ * @brief Router requests (see uart_router_post())
+ */
+typedef enum {
+	ROUTER_OP_CONNECT = 0,       /**< E310 connection sequence */
+	ROUTER_OP_START_INVENTORY,   /**< Connect if needed, start inventory */
+	ROUTER_OP_STOP_INVENTORY,    /**< Stop inventory (mode unchanged) */
+	ROUTER_OP_SET_MODE,          /**< arg: router_mode_t */
+	ROUTER_OP_SET_ADDR,          /**< arg: E310 reader address */
+	ROUTER_OP_RESET,             /**< Stop the E310, clear state, go IDLE */
+	ROUTER_OP_RESET_STATS,       /**< Clear statistics and metrics */
+	ROUTER_OP_CLEAR_EPC_CACHE,   /**< Forget the EPCs seen so far */
+} uart_router_op_t;
+
+/**
+ * @brief Request completion callback
+ *
+ * Runs on the router thread: keep it short. Synchronous router calls
+ * made from it run inline.
+ *
+ * @param result 0 on success, negative errno on failure
+ * @param user_data Pointer passed at submission
+ */
+typedef void (*uart_router_cb_t)(int result, void *user_data);
+
+/**
+ * @brief Consistent view of the router state (uart_router_get_status())
+ */
+typedef struct {
+	router_mode_t mode;          /**< Operating mode */
+	bool running;                /**< Router is running */
+	bool inventory_active;       /**< E310 round in progress */
+	bool e310_connected;         /**< E310 connection sequence completed */
+	uint8_t reader_addr;         /**< E310 reader address */
+	uint32_t tx_pending;         /**< Bytes queued in the UART4 TX ring */
+	uint32_t tx_batches;         /**< UART4 transmissions started */
+	uint32_t rx_pending;         /**< Bytes waiting in the UART4 RX ring */
+	uint8_t epc_cached;          /**< EPCs in the duplicate filter */
+	uart_router_stats_t stats;   /**< Statistics */
+	uart_router_audit_t audit;   /**< Beep edge audit */
+	uart_router_link_t link;     /**< Link supervisor */
+} uart_router_status_t;
+
 /* ========================================================================
  * API Functions
  * ======================================================================== */
@@ -186,13 +308,25 @@ int uart_router_init(uart_router_t *router);
 /**
  * @brief Start UART router operation
  *
- * Enables UART interrupts and begins routing.
+ * Enables UART interrupts and starts the router thread on first use.
  *
  * @param router Pointer to router context
  * @return 0 on success, negative errno on error
  */
 int uart_router_start(uart_router_t *router);
 
+/**
+ * @brief Watchdog check-in of the router thread
+ *
+ * The router thread checks in on every loop and while it waits for an
+ * E310 response. The caller feeds the watchdog only when this is true,
+ * so a hung router thread resets the board.
+ *
+ * @return true if the thread checked in since the previous call (or has
+ *         not been started yet)
+ */
+bool uart_router_checked_in(void);
+
 /**
  * @brief Stop UART router operation
  *
@@ -206,7 +340,8 @@ int uart_router_stop(uart_router_t *router);
 /**
  * @brief Set router operating mode
  *
- * Changes the router operating mode. Thread-safe.
+ * Changes the router operating mode. Runs on the router thread; the
+ * caller waits for it.
  *
  * @param router Pointer to router context
  * @param mode New operating mode
@@ -223,14 +358,38 @@ int uart_router_set_mode(uart_router_t *router, router_mode_t mode);
 router_mode_t uart_router_get_mode(uart_router_t *router);
 
 /**
- * @brief Process pending UART data
+ * @brief Queue a request to the router thread
+ *
+ * @param router Pointer to router context
+ * @param op Request
+ * @param arg Request argument (ROUTER_OP_SET_MODE, ROUTER_OP_SET_ADDR)
+ * @param cb Completion callback (may be NULL)
+ * @param user_data Passed to @p cb
+ * @return 0 if queued, -EINVAL on a bad op, -EAGAIN if the queue is full
+ */
+int uart_router_post(uart_router_t *router, uart_router_op_t op, uint8_t arg,
+		     uart_router_cb_t cb, void *user_data);
+
+/**
+ * @brief Run a request on the router thread and wait for its result
  *
- * Should be called periodically from main loop or dedicated thread.
- * Handles data forwarding based on current mode.
+ * Runs inline when called from the router thread itself (callbacks).
  *
  * @param router Pointer to router context
+ * @param op Request
+ * @param arg Request argument
+ * @return Request result
  */
-void uart_router_process(uart_router_t *router);
+int uart_router_call(uart_router_t *router, uart_router_op_t op, uint8_t arg);
+
+/**
+ * @brief Get a consistent snapshot of the router state
+ *
+ * @param router Pointer to router context
+ * @param status Output
+ * @return 0
+ */
+int uart_router_get_status(uart_router_t *router, uart_router_status_t *status);
 
 /**
  * @brief Get router statistics
@@ -250,7 +409,8 @@ void uart_router_reset_stats(uart_router_t *router);
 /**
  * @brief Send data to UART4 (E310)
  *
- * Queues data for transmission to UART4.
+ * Queues data for transmission to UART4. Router thread only; other
+ * threads use uart_router_transact().
  *
  * @param router Pointer to router context
  * @param data Data buffer
@@ -259,6 +419,21 @@ void uart_router_reset_stats(uart_router_t *router);
  */
 int uart_router_send_uart4(uart_router_t *router, const uint8_t *data, size_t len);
 
+/**
+ * @brief Inject bytes into the UART4 RX ring as if received from the E310
+ *
+ * Used by the `bench` command to drive the real assemble/parse/filter
+ * path without a reader. All-or-nothing, so frames are never split by a
+ * full ring.
+ *
+ * @param router Pointer to router context
+ * @param data Raw E310 frame bytes
+ * @param len Data length
+ * @return Number of bytes queued, -ENOSPC if the ring lacks room,
+ *         -ENODEV if the router is not running
+ */
+int uart_router_inject_rx(uart_router_t *router, const uint8_t *data, size_t len);
+
 /**
  * @brief Get mode name string
  *
@@ -308,6 +483,9 @@ int uart_router_stop_inventory(uart_router_t *router);
 /**
  * @brief Set E310 RF Power
  *
+ * Published to the runtime configuration; the router sends it to the
+ * E310 at the next round boundary.
+ *
  * @param router Pointer to router context
  * @param power RF power level (0-30 dBm)
  * @return 0 on success, negative errno on error
@@ -315,14 +493,33 @@ int uart_router_stop_inventory(uart_router_t *router);
 int uart_router_set_rf_power(uart_router_t *router, uint8_t power);
 
 /**
- * @brief Request E310 Reader Information
+ * @brief Send a command frame to the E310 and wait for its response
  *
- * Sends Obtain Reader Info command to E310.
+ * Runs on the router thread, so no frame of the response is missed.
+ * The response is logged by the frame processor as usual.
  *
  * @param router Pointer to router context
- * @return 0 on success, negative errno on error
+ * @param frame Complete command frame, CRC included
+ * @param len Frame length
+ * @param timeout_ms Response timeout
+ * @return 0 when a frame came back, -ETIMEDOUT if none did,
+ *         negative errno if the frame could not be sent
+ */
+int uart_router_transact(uart_router_t *router, const uint8_t *frame, size_t len,
+			 int timeout_ms);
+
+/**
+ * @brief Wait until the router has applied a runtime config version
+ *
+ * Host-side fields are live at the router's next poll; reader-side
+ * fields once the E310 has acknowledged them at a round boundary.
+ *
+ * @param router Pointer to router context
+ * @param version Version returned by runtime_config_publish()
+ * @param timeout_ms Longest wait
+ * @return 0 when applied, -ETIMEDOUT otherwise (it stays queued)
  */
-int uart_router_get_reader_info(uart_router_t *router);
+int uart_router_wait_config(uart_router_t *router, uint32_t version, int timeout_ms);
 
 /**
  * @brief Check if inventory is active
@@ -4,13 +4,15 @@
  *
  * Thread Safety:
  * - usb_hid_send_epc() is protected by mutex (safe for concurrent calls)
- * - typing_speed_cpm uses atomic access
+ * - typing speed is read from a runtime_config snapshot (lock-free)
  * - hid_stats uses atomic counters for lock-free statistics
  *
  * @copyright Copyright (c) 2026 PARP
  */
 
 #include "usb_hid.h"
+#include "log_ratelimit.h"
+#include "runtime_config.h"
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
 #include <zephyr/drivers/usb/udc_buf.h>
@@ -58,12 +60,13 @@ static const uint8_t hid_kbd_report_desc[] = HID_KEYBOARD_REPORT_DESC();
 
 static const struct device *hid_dev;
 static bool hid_ready = false;
+static usb_hid_ready_cb_t ready_cb;
 
 /* HID output mute state (default: true = muted for development) */
 static bool hid_muted = true;
 
-/* Atomic typing speed variable */
-static atomic_t typing_speed_cpm = ATOMIC_INIT(HID_TYPING_SPEED_DEFAULT);
+/* Dry-run sink (bench): reports are built but never submitted */
+static usb_hid_dry_run_cb_t dry_run_cb;
 
 /* Mutex for HID send protection */
 static K_MUTEX_DEFINE(hid_send_lock);
@@ -199,8 +202,13 @@ static uint8_t ascii_to_hid_keycode(char c, uint8_t *modifier)
  */
 static void hid_iface_ready(const struct device *dev, const bool ready)
 {
+	usb_hid_ready_cb_t cb = ready_cb;
+
 	LOG_INF("HID interface %s", ready ? "ready" : "not ready");
 	hid_ready = ready;
+	if (cb != NULL) {
+		cb(ready);
+	}
 }
 
 /**
@@ -304,6 +312,43 @@ int parp_usb_hid_init(void)
 	return 0;
 }
 
+/**
+ * @brief Dry-run an EPC: same key report conversion, no USB traffic
+ *
+ * Every press and release report is folded into a checksum for the
+ * sink, so the conversion is real work the compiler cannot drop.
+ */
+static int hid_dry_run_epc(usb_hid_dry_run_cb_t cb,
+			   const uint8_t *epc, size_t len)
+{
+	uint8_t report[HID_KBD_REPORT_SIZE];
+	uint32_t sum = 0;
+
+	for (size_t i = 0; i < len; i++) {
+		uint8_t modifier = 0;
+		uint8_t keycode = ascii_to_hid_keycode((char)epc[i], &modifier);
+
+		if (keycode == 0) {
+			continue;
+		}
+
+		/* Key press, then key release (all zeros) */
+		memset(report, 0, sizeof(report));
+		report[0] = modifier;
+		report[2] = keycode;
+		for (size_t j = 0; j < sizeof(report); j++) {
+			sum = sum * 31 + report[j];
+		}
+		memset(report, 0, sizeof(report));
+		for (size_t j = 0; j < sizeof(report); j++) {
+			sum = sum * 31 + report[j];
+		}
+	}
+
+	cb(epc, len, sum);
+	return 0;
+}
+
 int usb_hid_send_epc(const uint8_t *epc, size_t len)
 {
 	/* Input parameter validation */
@@ -311,6 +356,12 @@ int usb_hid_send_epc(const uint8_t *epc, size_t len)
 		return -EINVAL;
 	}
 
+	usb_hid_dry_run_cb_t cb = dry_run_cb;
+
+	if (cb) {
+		return hid_dry_run_epc(cb, epc, len);
+	}
+
 	/* Mute check - silently discard if muted */
 	if (hid_muted) {
 		LOG_DBG("HID muted, EPC not sent");
@@ -324,16 +375,18 @@ int usb_hid_send_epc(const uint8_t *epc, size_t len)
 	}
 
 	if (!hid_ready) {
-		LOG_WRN("HID interface not ready");
+		LOG_RL_WRN("HID interface not ready");
 		return -EAGAIN;
 	}
 
 	/* Lock mutex for thread safety */
 	k_mutex_lock(&hid_send_lock, K_FOREVER);
 
-	/* Get typing speed atomically */
-	uint16_t current_speed = (uint16_t)atomic_get(&typing_speed_cpm);
-	uint32_t key_delay = cpm_to_delay_ms(current_speed);
+	/* One snapshot per EPC: the speed cannot change mid-string */
+	runtime_config_t cfg;
+
+	runtime_config_get(&cfg);
+	uint32_t key_delay = cpm_to_delay_ms(cfg.typing_speed_cpm);
 
 	int result = 0;
 	int chars_dropped = 0;
@@ -363,7 +416,7 @@ int usb_hid_send_epc(const uint8_t *epc, size_t len)
 				goto unlock;
 			}
 			/* Transient failure: skip this character, continue with rest */
-			LOG_WRN("Dropped char '%c' at pos %zu (press failed: %d)",
+			LOG_RL_WRN("Dropped char '%c' at pos %zu (press failed: %d)",
 				c, i, ret);
 			chars_dropped++;
 			atomic_inc(&hid_stats.chars_dropped);
@@ -382,7 +435,7 @@ int usb_hid_send_epc(const uint8_t *epc, size_t len)
 				goto unlock;
 			}
 			/* Release failure: key may appear "stuck" briefly */
-			LOG_WRN("Key release failed for '%c' at pos %zu: %d",
+			LOG_RL_WRN("Key release failed for '%c' at pos %zu: %d",
 				c, i, ret);
 			chars_dropped++;
 			atomic_inc(&hid_stats.chars_dropped);
@@ -417,12 +470,12 @@ int usb_hid_send_epc(const uint8_t *epc, size_t len)
 	/* Track EPC-level statistics */
 	if (chars_dropped > 0) {
 		atomic_inc(&hid_stats.epc_partial);
-		LOG_WRN("EPC sent with %d dropped chars: %.*s (speed: %u CPM)",
-			chars_dropped, (int)len, epc, current_speed);
+		LOG_RL_WRN("EPC sent with %d/%u dropped chars (speed: %u CPM)",
+			   chars_dropped, (unsigned int)len, current_speed);
 	} else {
 		atomic_inc(&hid_stats.epc_sent);
-		LOG_INF("EPC sent via HID: %.*s (speed: %u CPM)",
-			(int)len, epc, current_speed);
+		LOG_RL_INF("EPC sent via HID: %u chars (speed: %u CPM)",
+			   (unsigned int)len, current_speed);
 	}
 
 unlock:
@@ -430,11 +483,22 @@ unlock:
 	return result;
 }
 
+void usb_hid_set_dry_run(usb_hid_dry_run_cb_t cb)
+{
+	dry_run_cb = cb;
+	LOG_INF("HID dry-run %s", cb ? "ON" : "OFF");
+}
+
 bool usb_hid_is_ready(void)
 {
 	return hid_ready;
 }
 
+void usb_hid_set_ready_callback(usb_hid_ready_cb_t cb)
+{
+	ready_cb = cb;
+}
+
 int usb_hid_set_typing_speed(uint16_t cpm)
 {
 	/* Round to nearest step */
@@ -448,7 +512,8 @@ int usb_hid_set_typing_speed(uint16_t cpm)
 		cpm = HID_TYPING_SPEED_MAX;
 	}
 
-	atomic_set(&typing_speed_cpm, cpm);
+	runtime_config_edit()->typing_speed_cpm = cpm;
+	runtime_config_publish();
 	LOG_INF("Typing speed set to %u CPM (delay: %u ms)",
 	        cpm, cpm_to_delay_ms(cpm));
 	return 0;
@@ -456,7 +521,10 @@ int usb_hid_set_typing_speed(uint16_t cpm)
 
 uint16_t usb_hid_get_typing_speed(void)
 {
-	return (uint16_t)atomic_get(&typing_speed_cpm);
+	runtime_config_t cfg;
+
+	runtime_config_get(&cfg);
+	return cfg.typing_speed_cpm;
 }
 
 void usb_hid_set_enabled(bool enable)
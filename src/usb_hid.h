@@ -65,6 +65,16 @@ int usb_hid_send_epc(const uint8_t *epc, size_t len);
  */
 bool usb_hid_is_ready(void);
 
+/** Called from the USB stack when the HID interface comes up or goes down */
+typedef void (*usb_hid_ready_cb_t)(bool ready);
+
+/**
+ * @brief Register the HID ready/not ready callback
+ *
+ * @param cb Callback, NULL to remove
+ */
+void usb_hid_set_ready_callback(usb_hid_ready_cb_t cb);
+
 /**
  * @brief Set HID keyboard typing speed
  *
@@ -100,6 +110,28 @@ void usb_hid_set_enabled(bool enable);
  */
 bool usb_hid_is_enabled(void);
 
+/**
+ * @brief Dry-run sink, receives each EPC in place of the USB host
+ *
+ * @param epc EPC string exactly as it would have been typed
+ * @param len String length
+ * @param report_sum Checksum over the key press/release reports built
+ */
+typedef void (*usb_hid_dry_run_cb_t)(const uint8_t *epc, size_t len,
+				     uint32_t report_sum);
+
+/**
+ * @brief Route EPC output to a callback instead of USB (benchmarking)
+ *
+ * While set, usb_hid_send_epc() still converts every character into
+ * key press and release reports but submits nothing, applies no typing
+ * delay and ignores the mute state, then hands the EPC and a checksum
+ * of the reports to @p cb.
+ *
+ * @param cb Sink callback, NULL to restore normal output
+ */
+void usb_hid_set_dry_run(usb_hid_dry_run_cb_t cb);
+
 
 void usb_hid_get_stats(struct usb_hid_stats *stats);
 void usb_hid_reset_stats(void);
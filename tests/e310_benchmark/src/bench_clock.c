@@ -0,0 +1,117 @@
+/**
+ * @file bench_clock.c
+ * @brief Benchmark Time Source
+ */
+
+#include "bench_clock.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#if defined(CONFIG_CPU_CORTEX_M)
+
+/* DWT cycle counter (ARM Cortex-M debug hardware), as in rgb_led.c */
+#define DWT_CTRL_REG    (*(volatile uint32_t *)0xE0001000)
+#define DWT_CYCCNT_REG  (*(volatile uint32_t *)0xE0001004)
+#define DEMCR_REG       (*(volatile uint32_t *)0xE000EDFC)
+#define DWT_CTRL_CYCCNTENA  BIT(0)
+#define DEMCR_TRCENA        BIT(24)
+
+void bench_clock_init(void)
+{
+	DEMCR_REG |= DEMCR_TRCENA;
+	DWT_CTRL_REG |= DWT_CTRL_CYCCNTENA;
+}
+
+uint64_t bench_clock_now(void)
+{
+	return DWT_CYCCNT_REG;
+}
+
+uint64_t bench_clock_delta(uint64_t start, uint64_t end)
+{
+	/* 32-bit counter: modular difference handles one wrap */
+	return (uint32_t)((uint32_t)end - (uint32_t)start);
+}
+
+uint64_t bench_clock_to_ns(uint64_t units)
+{
+	/* DWT runs at the core clock, which is also the SysTick clock */
+	return units * NSEC_PER_SEC / sys_clock_hw_cycles_per_sec();
+}
+
+bool bench_clock_counts_cycles(void)
+{
+	return true;
+}
+
+const char *bench_clock_name(void)
+{
+	return "dwt";
+}
+
+#elif defined(CONFIG_NATIVE_LIBRARY)
+
+/* Implemented in bench_clock_host.c, built against the host libc */
+extern uint64_t bench_host_clock_ns(void);
+
+void bench_clock_init(void)
+{
+}
+
+uint64_t bench_clock_now(void)
+{
+	return bench_host_clock_ns();
+}
+
+uint64_t bench_clock_delta(uint64_t start, uint64_t end)
+{
+	return end - start;
+}
+
+uint64_t bench_clock_to_ns(uint64_t units)
+{
+	return units;
+}
+
+bool bench_clock_counts_cycles(void)
+{
+	return false;
+}
+
+const char *bench_clock_name(void)
+{
+	return "host";
+}
+
+#else
+
+void bench_clock_init(void)
+{
+}
+
+uint64_t bench_clock_now(void)
+{
+	return k_cycle_get_64();
+}
+
+uint64_t bench_clock_delta(uint64_t start, uint64_t end)
+{
+	return end - start;
+}
+
+uint64_t bench_clock_to_ns(uint64_t units)
+{
+	return k_cyc_to_ns_floor64(units);
+}
+
+bool bench_clock_counts_cycles(void)
+{
+	return true;
+}
+
+const char *bench_clock_name(void)
+{
+	return "kernel";
+}
+
+#endif
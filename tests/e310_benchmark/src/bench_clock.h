@@ -0,0 +1,47 @@
+/**
+ * @file bench_clock.h
+ * @brief Benchmark Time Source
+ *
+ * - Cortex-M: DWT cycle counter (core clock, 32-bit, wraps after ~7.8 s
+ *   at 550 MHz, so a single measurement must stay well below that)
+ * - native_sim: host CLOCK_MONOTONIC via the runner (bench_clock_host.c)
+ * - anything else: the kernel cycle counter
+ */
+
+#ifndef BENCH_CLOCK_H_
+#define BENCH_CLOCK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Prepare the time source (enables DWT on Cortex-M)
+ */
+void bench_clock_init(void);
+
+/**
+ * @brief Current timestamp in time-source units
+ */
+uint64_t bench_clock_now(void);
+
+/**
+ * @brief Elapsed units between two bench_clock_now() samples
+ */
+uint64_t bench_clock_delta(uint64_t start, uint64_t end);
+
+/**
+ * @brief Convert time-source units to nanoseconds
+ */
+uint64_t bench_clock_to_ns(uint64_t units);
+
+/**
+ * @brief True if units are CPU cycles (reported as cyc_op)
+ */
+bool bench_clock_counts_cycles(void);
+
+/**
+ * @brief Short name of the time source for the report header
+ */
+const char *bench_clock_name(void);
+
+#endif /* BENCH_CLOCK_H_ */
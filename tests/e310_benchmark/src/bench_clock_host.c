@@ -0,0 +1,19 @@
+/**
+ * @file bench_clock_host.c
+ * @brief Host Wall Clock for native_sim Benchmarks
+ *
+ * Built into the native simulator runner (host libc), not the Zephyr
+ * image: simulated time stands still while embedded code executes, so
+ * only the host clock can time it.
+ */
+
+#include <stdint.h>
+#include <time.h>
+
+uint64_t bench_host_clock_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
@@ -0,0 +1,463 @@
+/**
+ * @file main.c
+ * @brief E310 Protocol Library Microbenchmarks
+ *
+ * Times the hot protocol functions over realistic frame corpora:
+ * 12- and 62-byte EPCs, EPC+TID, phase/frequency blocks and a full
+ * 256-byte multi-tag inventory frame.
+ *
+ * Every benchmark runs BENCH_BATCHES batches of a fixed iteration count
+ * after a warm-up and reports the fastest batch, which is the least
+ * disturbed by interrupts and host scheduling. Iteration counts and
+ * corpora are fixed so results can be diffed across commits:
+ *
+ *   BENCH <function> <corpus> bytes=<n> iters=<n> ns_op=<n.n> bytes_s=<n> cyc_op=<n|->
+ *
+ * tools/bench_compare.py compares two such logs.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <string.h>
+
+#include "e310_protocol.h"
+#include "bench_clock.h"
+
+/* ========================================================================
+ * Parameters
+ * ======================================================================== */
+
+/** Timed batches per benchmark (fastest is reported) */
+#define BENCH_BATCHES       5
+
+/** Untimed iterations before the first batch */
+#define BENCH_WARMUP        64
+
+/** Iterations per batch for cheap (per-tag) and frame-sized operations */
+#define ITERS_SMALL         20000
+#define ITERS_FRAME         5000
+
+/** Sample EPC/TID sizes */
+#define EPC_SHORT_LEN       12
+#define EPC_LONG_LEN        62
+#define TID_LEN             12
+
+/* Keeps results live so the compiler cannot drop the calls */
+static volatile int bench_sink;
+
+/* ========================================================================
+ * Corpora
+ * ======================================================================== */
+
+/* Tag Inventory (0x01) data blocks: LenByte | EPC[/TID] | RSSI [| phase | freq] */
+static uint8_t blk_epc12[1 + EPC_SHORT_LEN + 1];
+static uint8_t blk_epc62[1 + EPC_LONG_LEN + 1];
+static uint8_t blk_epc_tid[1 + 2 + EPC_SHORT_LEN + 2 + TID_LEN + 1];
+static uint8_t blk_phase[1 + EPC_SHORT_LEN + 1 + 4 + 3];
+
+/* Auto-upload (0xEE) data: Ant | Len | EPC | RSSI */
+static uint8_t au_epc12[2 + EPC_SHORT_LEN + 1];
+static uint8_t au_epc62[2 + EPC_LONG_LEN + 1];
+
+/* Complete frames with valid CRC */
+static uint8_t frame_epc12[4 + 2 + sizeof(blk_epc12) + 2];
+static uint8_t frame_multi[E310_MAX_FRAME_SIZE];
+static uint8_t frame_multi_tags;
+
+static uint8_t epc_long[EPC_LONG_LEN];
+static e310_context_t bench_ctx;
+
+static void fill_pattern(uint8_t *buf, size_t len, uint8_t seed)
+{
+	for (size_t i = 0; i < len; i++) {
+		buf[i] = (uint8_t)(seed + i * 37);
+	}
+}
+
+static size_t put_epc_block(uint8_t *out, uint8_t epc_len, uint8_t seed)
+{
+	out[0] = epc_len;
+	fill_pattern(&out[1], epc_len, seed);
+	out[1 + epc_len] = 0xC8; /* RSSI */
+	return 1 + epc_len + 1;
+}
+
+static size_t finish_inventory_frame(uint8_t *frame, size_t data_len,
+				     uint8_t num_tags)
+{
+	size_t total = 4 + 2 + data_len + 2;
+	uint16_t crc;
+
+	frame[0] = (uint8_t)(total - 1);
+	frame[1] = E310_ADDR_DEFAULT;
+	frame[2] = E310_CMD_TAG_INVENTORY;
+	frame[3] = E310_STATUS_MORE_DATA;
+	frame[4] = 0x01; /* Antenna */
+	frame[5] = num_tags;
+
+	crc = e310_crc16(frame, total - 2);
+	frame[total - 2] = (uint8_t)(crc & 0xFF);
+	frame[total - 1] = (uint8_t)(crc >> 8);
+	return total;
+}
+
+static void build_corpora(void)
+{
+	size_t pos;
+
+	put_epc_block(blk_epc12, EPC_SHORT_LEN, 0x30);
+	put_epc_block(blk_epc62, EPC_LONG_LEN, 0x40);
+
+	/* EPC+TID: PC(2) | EPC | CRC(2) | TID, PC bits 15-11 = EPC words */
+	blk_epc_tid[0] = 0x80 | (2 + EPC_SHORT_LEN + 2 + TID_LEN);
+	blk_epc_tid[1] = (uint8_t)(((EPC_SHORT_LEN / 2) << 11) >> 8);
+	blk_epc_tid[2] = 0x00;
+	fill_pattern(&blk_epc_tid[3], EPC_SHORT_LEN, 0x50);
+	blk_epc_tid[3 + EPC_SHORT_LEN] = 0x12;
+	blk_epc_tid[4 + EPC_SHORT_LEN] = 0x34;
+	fill_pattern(&blk_epc_tid[5 + EPC_SHORT_LEN], TID_LEN, 0xE2);
+	blk_epc_tid[sizeof(blk_epc_tid) - 1] = 0xC8;
+
+	/* Phase/frequency: RSSI followed by phase(4) and frequency(3) */
+	put_epc_block(blk_phase, EPC_SHORT_LEN, 0x60);
+	blk_phase[0] |= 0x40;
+	fill_pattern(&blk_phase[2 + EPC_SHORT_LEN], 7, 0x70);
+
+	au_epc12[0] = 0x01;
+	put_epc_block(&au_epc12[1], EPC_SHORT_LEN, 0x80);
+	au_epc62[0] = 0x01;
+	put_epc_block(&au_epc62[1], EPC_LONG_LEN, 0x90);
+
+	memcpy(&frame_epc12[6], blk_epc12, sizeof(blk_epc12));
+	finish_inventory_frame(frame_epc12, sizeof(blk_epc12), 1);
+
+	/*
+	 * Largest frame the reader can send (Len = 0xFF): 12-byte EPC
+	 * blocks, with the remainder taken by one shorter EPC.
+	 */
+	pos = 6;
+	frame_multi_tags = 0;
+	while (pos + (1 + EPC_SHORT_LEN + 1) <= sizeof(frame_multi) - 2) {
+		pos += put_epc_block(&frame_multi[pos], EPC_SHORT_LEN,
+				     frame_multi_tags);
+		frame_multi_tags++;
+	}
+	if (sizeof(frame_multi) - 2 - pos > 2) {
+		pos += put_epc_block(&frame_multi[pos],
+				     sizeof(frame_multi) - 2 - pos - 2,
+				     frame_multi_tags);
+		frame_multi_tags++;
+	}
+	finish_inventory_frame(frame_multi, pos - 6, frame_multi_tags);
+
+	fill_pattern(epc_long, sizeof(epc_long), 0xA0);
+}
+
+/* ========================================================================
+ * Runner
+ * ======================================================================== */
+
+typedef int (*bench_fn_t)(const void *arg);
+
+struct bench_case {
+	const char *name;       /**< Function under test */
+	const char *corpus;     /**< Input description */
+	bench_fn_t fn;
+	const void *arg;
+	size_t bytes;           /**< Input bytes per call (for bytes_s) */
+	uint32_t iters;         /**< Iterations per batch */
+};
+
+static void bench_run(const struct bench_case *bc)
+{
+	uint64_t best = UINT64_MAX;
+	int acc = 0;
+
+	for (uint32_t i = 0; i < BENCH_WARMUP; i++) {
+		acc += bc->fn(bc->arg);
+	}
+
+	for (int b = 0; b < BENCH_BATCHES; b++) {
+		uint64_t start = bench_clock_now();
+
+		for (uint32_t i = 0; i < bc->iters; i++) {
+			acc += bc->fn(bc->arg);
+		}
+
+		best = MIN(best, bench_clock_delta(start, bench_clock_now()));
+	}
+	bench_sink = acc;
+
+	uint64_t ns = MAX(bench_clock_to_ns(best), 1);
+	uint64_t ns_x10 = ns * 10 / bc->iters;
+	uint64_t bytes_s = (uint64_t)bc->bytes * bc->iters * NSEC_PER_SEC / ns;
+	char cyc[12] = "-";
+
+	if (bench_clock_counts_cycles()) {
+		snprintk(cyc, sizeof(cyc), "%u", (uint32_t)(best / bc->iters));
+	}
+
+	printk("BENCH %-28s %-9s bytes=%u iters=%u ns_op=%llu.%llu "
+	       "bytes_s=%llu cyc_op=%s\n",
+	       bc->name, bc->corpus, (uint32_t)bc->bytes, bc->iters,
+	       (unsigned long long)(ns_x10 / 10),
+	       (unsigned long long)(ns_x10 % 10),
+	       (unsigned long long)bytes_s, cyc);
+}
+
+static void bench_run_all(const struct bench_case *cases, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		bench_run(&cases[i]);
+	}
+}
+
+/* ========================================================================
+ * Benchmarked Operations
+ * ======================================================================== */
+
+struct buf_arg {
+	const uint8_t *data;
+	size_t len;
+};
+
+#define BUF_ARG(buf)        { .data = (buf), .len = sizeof(buf) }
+
+static int op_crc16(const void *arg)
+{
+	const struct buf_arg *a = arg;
+
+	/* CRC covers everything but the trailing CRC bytes */
+	return e310_crc16(a->data, a->len - 2);
+}
+
+static int op_verify_crc(const void *arg)
+{
+	const struct buf_arg *a = arg;
+
+	return e310_verify_crc(a->data, a->len);
+}
+
+static int op_parse_tag_data(const void *arg)
+{
+	const struct buf_arg *a = arg;
+	e310_tag_data_t tag;
+
+	return e310_parse_tag_data(a->data, a->len, &tag);
+}
+
+static int op_parse_auto_upload(const void *arg)
+{
+	const struct buf_arg *a = arg;
+	e310_tag_data_t tag;
+
+	return e310_parse_auto_upload_tag(a->data, a->len, &tag);
+}
+
+/* Full router path for one inventory frame: CRC, header, every block */
+static int op_decode_inventory_frame(const void *arg)
+{
+	const struct buf_arg *a = arg;
+	e310_response_header_t header;
+	e310_tag_data_t tag;
+	int tags = 0;
+
+	if (e310_verify_crc(a->data, a->len) != E310_OK ||
+	    e310_parse_response_header(a->data, a->len, &header) != E310_OK) {
+		return -1;
+	}
+
+	const uint8_t *p = &a->data[6];
+	size_t remaining = a->len - 6 - 2;
+
+	for (uint8_t i = 0; i < a->data[5] && remaining > 0; i++) {
+		int consumed = e310_parse_tag_data(p, remaining, &tag);
+
+		if (consumed <= 0) {
+			break;
+		}
+		p += consumed;
+		remaining -= consumed;
+		tags++;
+	}
+
+	return tags;
+}
+
+static int op_format_epc(const void *arg)
+{
+	const struct buf_arg *a = arg;
+	/* Hex digits plus a space every 4 bytes */
+	char out[E310_MAX_EPC_LENGTH * 3];
+
+	return e310_format_epc_string(a->data, a->len, out, sizeof(out));
+}
+
+static int op_build_tag_inventory_default(const void *arg)
+{
+	ARG_UNUSED(arg);
+	return e310_build_tag_inventory_default(&bench_ctx);
+}
+
+static int op_build_start_fast_inventory(const void *arg)
+{
+	ARG_UNUSED(arg);
+	return e310_build_start_fast_inventory(&bench_ctx, E310_TARGET_A);
+}
+
+static int op_build_stop_immediately(const void *arg)
+{
+	ARG_UNUSED(arg);
+	return e310_build_stop_immediately(&bench_ctx);
+}
+
+static int op_build_tag_inventory(const void *arg)
+{
+	return e310_build_tag_inventory(&bench_ctx, arg);
+}
+
+static int op_build_read_data(const void *arg)
+{
+	return e310_build_read_data(&bench_ctx, arg);
+}
+
+/* ========================================================================
+ * Suite
+ * ======================================================================== */
+
+static void *e310_bench_setup(void)
+{
+	e310_tag_data_t tag;
+
+	bench_clock_init();
+	e310_init(&bench_ctx, E310_ADDR_DEFAULT);
+	build_corpora();
+
+	/* Benchmarks are meaningless if the corpora take error paths */
+	zassert_equal(e310_parse_tag_data(blk_epc12, sizeof(blk_epc12), &tag),
+		      sizeof(blk_epc12));
+	zassert_equal(tag.epc_len, EPC_SHORT_LEN);
+	zassert_equal(e310_parse_tag_data(blk_epc62, sizeof(blk_epc62), &tag),
+		      sizeof(blk_epc62));
+	zassert_equal(tag.epc_len, EPC_LONG_LEN);
+	zassert_equal(e310_parse_tag_data(blk_epc_tid, sizeof(blk_epc_tid), &tag),
+		      sizeof(blk_epc_tid));
+	zassert_true(tag.has_tid && tag.tid_len == TID_LEN);
+	zassert_equal(e310_parse_tag_data(blk_phase, sizeof(blk_phase), &tag),
+		      sizeof(blk_phase));
+	zassert_true(tag.has_phase && tag.has_frequency);
+	zassert_equal(frame_multi[0], 0xFF, "multi-tag frame is not full size");
+	zassert_equal(e310_verify_crc(frame_multi, sizeof(frame_multi)), E310_OK);
+
+	printk("BENCH-CONFIG board=%s clock=%s batches=%d warmup=%d\n",
+	       CONFIG_BOARD, bench_clock_name(), BENCH_BATCHES, BENCH_WARMUP);
+
+	return NULL;
+}
+
+ZTEST_SUITE(e310_bench, NULL, e310_bench_setup, NULL, NULL, NULL);
+
+ZTEST(e310_bench, test_crc)
+{
+	static const struct buf_arg epc12 = BUF_ARG(frame_epc12);
+	static const struct buf_arg multi = BUF_ARG(frame_multi);
+	const struct bench_case cases[] = {
+		{ "e310_crc16", "epc12", op_crc16, &epc12,
+		  sizeof(frame_epc12) - 2, ITERS_SMALL },
+		{ "e310_crc16", "frame256", op_crc16, &multi,
+		  sizeof(frame_multi) - 2, ITERS_FRAME },
+		{ "e310_verify_crc", "epc12", op_verify_crc, &epc12,
+		  sizeof(frame_epc12), ITERS_SMALL },
+		{ "e310_verify_crc", "frame256", op_verify_crc, &multi,
+		  sizeof(frame_multi), ITERS_FRAME },
+	};
+
+	bench_run_all(cases, ARRAY_SIZE(cases));
+}
+
+ZTEST(e310_bench, test_parse)
+{
+	static const struct buf_arg epc12 = BUF_ARG(blk_epc12);
+	static const struct buf_arg epc62 = BUF_ARG(blk_epc62);
+	static const struct buf_arg epc_tid = BUF_ARG(blk_epc_tid);
+	static const struct buf_arg phase = BUF_ARG(blk_phase);
+	static const struct buf_arg au12 = BUF_ARG(au_epc12);
+	static const struct buf_arg au62 = BUF_ARG(au_epc62);
+	static const struct buf_arg multi = BUF_ARG(frame_multi);
+	const struct bench_case cases[] = {
+		{ "e310_parse_tag_data", "epc12", op_parse_tag_data, &epc12,
+		  sizeof(blk_epc12), ITERS_SMALL },
+		{ "e310_parse_tag_data", "epc62", op_parse_tag_data, &epc62,
+		  sizeof(blk_epc62), ITERS_SMALL },
+		{ "e310_parse_tag_data", "epc+tid", op_parse_tag_data, &epc_tid,
+		  sizeof(blk_epc_tid), ITERS_SMALL },
+		{ "e310_parse_tag_data", "phase", op_parse_tag_data, &phase,
+		  sizeof(blk_phase), ITERS_SMALL },
+		{ "e310_parse_auto_upload_tag", "epc12", op_parse_auto_upload,
+		  &au12, sizeof(au_epc12), ITERS_SMALL },
+		{ "e310_parse_auto_upload_tag", "epc62", op_parse_auto_upload,
+		  &au62, sizeof(au_epc62), ITERS_SMALL },
+		{ "decode_inventory_frame", "frame256", op_decode_inventory_frame,
+		  &multi, sizeof(frame_multi), ITERS_FRAME },
+	};
+
+	zassert_equal(op_decode_inventory_frame(&multi), frame_multi_tags,
+		      "multi-tag frame did not decode fully");
+
+	bench_run_all(cases, ARRAY_SIZE(cases));
+}
+
+ZTEST(e310_bench, test_format)
+{
+	static const struct buf_arg epc12 = { .data = epc_long,
+					      .len = EPC_SHORT_LEN };
+	static const struct buf_arg epc62 = { .data = epc_long,
+					      .len = EPC_LONG_LEN };
+	const struct bench_case cases[] = {
+		{ "e310_format_epc_string", "epc12", op_format_epc, &epc12,
+		  EPC_SHORT_LEN, ITERS_SMALL },
+		{ "e310_format_epc_string", "epc62", op_format_epc, &epc62,
+		  EPC_LONG_LEN, ITERS_SMALL },
+	};
+
+	zassert_equal(op_format_epc(&epc62),
+		      EPC_LONG_LEN * 2 + (EPC_LONG_LEN - 1) / 4,
+		      "EPC string truncated");
+
+	bench_run_all(cases, ARRAY_SIZE(cases));
+}
+
+ZTEST(e310_bench, test_build)
+{
+	static const e310_inventory_params_t inv = {
+		.q_value = 4,
+		.session = E310_SESSION_S0,
+		.mask_mem = E310_MEMBANK_EPC,
+		.target = E310_TARGET_A,
+		.antenna = E310_ANT_1,
+		.scan_time = 10,
+	};
+	static e310_read_params_t rd = {
+		.epc_len = EPC_SHORT_LEN,
+		.mem_bank = E310_MEMBANK_TID,
+		.word_ptr = 0,
+		.word_count = 6,
+	};
+	const struct bench_case cases[] = {
+		{ "e310_build_tag_inventory_default", "-",
+		  op_build_tag_inventory_default, NULL, 0, ITERS_SMALL },
+		{ "e310_build_tag_inventory", "params",
+		  op_build_tag_inventory, &inv, 0, ITERS_SMALL },
+		{ "e310_build_start_fast_inventory", "-",
+		  op_build_start_fast_inventory, NULL, 0, ITERS_SMALL },
+		{ "e310_build_stop_immediately", "-",
+		  op_build_stop_immediately, NULL, 0, ITERS_SMALL },
+		{ "e310_build_read_data", "epc12",
+		  op_build_read_data, &rd, 0, ITERS_SMALL },
+	};
+
+	memcpy(rd.epc, epc_long, EPC_SHORT_LEN);
+	zassert_true(op_build_read_data(&rd) > 0, "read-data build failed");
+
+	bench_run_all(cases, ARRAY_SIZE(cases));
+}
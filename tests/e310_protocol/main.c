@@ -155,6 +155,24 @@ ZTEST(e310_build, test_build_modify_rf_power_bounds)
 	zassert_equal(len, E310_ERR_INVALID_PARAM, "Power > 30 should fail");
 }
 
+ZTEST(e310_build, test_encode_frequency)
+{
+	uint8_t max_fre, min_fre;
+
+	/* Korea 0-5: band 00/11 */
+	zassert_equal(e310_encode_frequency(4, 0, 5, &max_fre, &min_fre), E310_OK);
+	zassert_equal(max_fre, 0x05, "MaxFre should be 0x05");
+	zassert_equal(min_fre, 0xC0, "MinFre should be 0xC0");
+
+	/* Europe 2-3: band 01/00 */
+	zassert_equal(e310_encode_frequency(3, 2, 3, &max_fre, &min_fre), E310_OK);
+	zassert_equal(max_fre, 0x43, "MaxFre should be 0x43");
+	zassert_equal(min_fre, 0x02, "MinFre should be 0x02");
+
+	zassert_equal(e310_encode_frequency(5, 0, 5, &max_fre, &min_fre),
+		      E310_ERR_INVALID_PARAM, "Unknown region should fail");
+}
+
 ZTEST(e310_build, test_build_simple_commands)
 {
 	int len;
@@ -0,0 +1,451 @@
+/**
+ * @file e310_emul.c
+ * @brief Simulated E310 Reader Implementation
+ *
+ * Router TX bytes arrive through the uart-emul TX-ready callback, are
+ * assembled into command frames and handed to the emulator thread via a
+ * message queue. The thread answers commands and, while a Tag Inventory
+ * round is open, emits data frames (status 0x03) at the scripted rate,
+ * then a final frame (status 0x01) when the round's scan time expires.
+ *
+ * Frames are put on the RX line whole, but never earlier than the line
+ * would be free at 115200 baud, so throughput numbers respect the wire.
+ */
+
+#include "e310_emul.h"
+#include "e310_protocol.h"
+#include "uart_router.h"
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/serial/uart_emul.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(e310_emul, LOG_LEVEL_INF);
+
+#define EMUL_STACK_SIZE     2048
+#define EMUL_PRIORITY       5
+#define EMUL_ANTENNA        0x01
+#define EMUL_RSSI_BASE      0x40
+
+struct emul_cmd {
+	uint8_t len;
+	uint8_t data[64];
+};
+
+K_MSGQ_DEFINE(emul_cmd_q, sizeof(struct emul_cmd), 8, 4);
+K_THREAD_STACK_DEFINE(emul_stack, EMUL_STACK_SIZE);
+
+static struct k_thread emul_thread;
+static const struct device *emul_dev;
+
+static struct e310_emul_config cfg;
+static struct e310_emul_stats stats;
+static struct k_spinlock emul_lock;
+
+/* TX (router -> reader) command assembler, runs in uart-emul callback */
+static struct emul_cmd rx_cmd;
+static size_t rx_cmd_pos;
+
+/* Round state (emulator thread only) */
+static bool round_active;
+static int64_t round_end_ms;
+static int64_t next_frame_ms;
+static uint32_t frame_counter;
+static int64_t line_free_us;
+static bool silent;
+
+/* Population state */
+static uint32_t prng_state;
+static uint32_t next_new_id;
+static int64_t first_emit_us[E310_EMUL_MAX_POPULATION];
+
+/* ========================================================================
+ * Helpers
+ * ======================================================================== */
+
+static uint32_t prng_next(void)
+{
+	/* xorshift32 */
+	uint32_t x = prng_state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	prng_state = x;
+	return x;
+}
+
+static bool prng_pct(uint8_t pct)
+{
+	return pct > 0 && (prng_next() % 100) < pct;
+}
+
+static int64_t now_us(void)
+{
+	return k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+static size_t finish_frame(uint8_t *frame, size_t payload_end)
+{
+	uint16_t crc;
+
+	frame[0] = (uint8_t)(payload_end + 1); /* Len excludes itself */
+	crc = e310_crc16(frame, payload_end);
+	frame[payload_end] = (uint8_t)(crc & 0xFF);
+	frame[payload_end + 1] = (uint8_t)(crc >> 8);
+	return payload_end + 2;
+}
+
+/**
+ * @brief Put bytes on the RX line, honouring wire time
+ *
+ * @param paced false for overrun bursts that model a stalled consumer
+ */
+static void line_put(const uint8_t *data, size_t len, bool paced)
+{
+	if (paced) {
+		int64_t t = now_us();
+
+		if (line_free_us > t) {
+			stats.wire_stalls++;
+			k_usleep((int32_t)(line_free_us - t));
+			t = line_free_us;
+		}
+		line_free_us = t + (int64_t)len * 10 * 1000000 / E310_EMUL_BAUD;
+	}
+
+	uart_emul_put_rx_data(emul_dev, data, len);
+	stats.bytes_tx += len;
+}
+
+static void send_response(uint8_t recmd, uint8_t status,
+			  const uint8_t *data, size_t data_len)
+{
+	uint8_t frame[E310_MAX_FRAME_SIZE];
+	size_t idx = 1;
+
+	frame[idx++] = E310_ADDR_DEFAULT;
+	frame[idx++] = recmd;
+	frame[idx++] = status;
+	if (data_len > 0) {
+		memcpy(&frame[idx], data, data_len);
+		idx += data_len;
+	}
+
+	line_put(frame, finish_frame(frame, idx), true);
+}
+
+/* ========================================================================
+ * Tag Population
+ * ======================================================================== */
+
+static uint32_t pick_tag_id(void)
+{
+	bool have_seen = next_new_id > 0;
+	bool exhausted = next_new_id >= cfg.population;
+
+	if (have_seen && (exhausted || prng_pct(cfg.dup_pct))) {
+		return prng_next() % next_new_id;
+	}
+
+	first_emit_us[next_new_id] = now_us();
+	stats.unique_tx++;
+	return next_new_id++;
+}
+
+static size_t build_data_frame(uint8_t *frame)
+{
+	size_t idx = 1;
+	size_t block = 1 + cfg.epc_len + 1;
+	uint8_t count = cfg.tags_per_frame;
+
+	/* Keep the frame within one Len byte */
+	if (6 + 2 + (size_t)count * block > E310_MAX_FRAME_SIZE - 1) {
+		count = (E310_MAX_FRAME_SIZE - 1 - 8) / block;
+	}
+
+	frame[idx++] = E310_ADDR_DEFAULT;
+	frame[idx++] = E310_CMD_TAG_INVENTORY;
+	frame[idx++] = E310_STATUS_MORE_DATA;
+	frame[idx++] = EMUL_ANTENNA;
+	frame[idx++] = count;
+
+	for (uint8_t t = 0; t < count; t++) {
+		uint32_t id = pick_tag_id();
+
+		frame[idx++] = cfg.epc_len; /* bit7=0: EPC only */
+		frame[idx++] = (uint8_t)(id >> 24);
+		frame[idx++] = (uint8_t)(id >> 16);
+		frame[idx++] = (uint8_t)(id >> 8);
+		frame[idx++] = (uint8_t)id;
+		for (uint8_t b = 4; b < cfg.epc_len; b++) {
+			frame[idx++] = 0xE0 | (b & 0x0F);
+		}
+		frame[idx++] = EMUL_RSSI_BASE + (prng_next() % 32);
+		stats.tags_tx++;
+	}
+
+	return finish_frame(frame, idx);
+}
+
+static void emit_data_frame(void)
+{
+	uint8_t frame[E310_MAX_FRAME_SIZE];
+	size_t len = build_data_frame(frame);
+
+	frame_counter++;
+	stats.frames_tx++;
+
+	if (cfg.overrun_every > 0 && (frame_counter % cfg.overrun_every) == 0) {
+		/* Burst more than the router RX ring in one go */
+		size_t sent = 0;
+
+		stats.overruns_injected++;
+		while (sent <= UART_ROUTER_BUF_SIZE + 512) {
+			line_put(frame, len, false);
+			sent += len;
+		}
+		return;
+	}
+
+	if (prng_pct(cfg.crc_err_pct)) {
+		frame[len - 1] ^= 0x5A;
+		stats.crc_injected++;
+	} else if (prng_pct(cfg.trunc_pct)) {
+		len /= 2;
+		stats.trunc_injected++;
+	}
+
+	line_put(frame, len, true);
+}
+
+/* ========================================================================
+ * Command Handling (emulator thread)
+ * ======================================================================== */
+
+static void handle_command(const struct emul_cmd *cmd)
+{
+	static const uint8_t reader_info[12] = {
+		0x0B, 0x02,     /* FW 2.11 */
+		0x0F,           /* Model */
+		0x08,           /* Protocol: EPC C1G2 */
+		0x4E, 0x00,     /* US band */
+		0x1E,           /* 30 dBm */
+		0x0A,           /* ScanTime */
+		0x01,           /* Antenna 1 */
+		0x00, 0x00,
+		0x00,           /* CheckAnt off */
+	};
+	uint8_t recmd = cmd->data[2];
+
+	stats.cmds_rx++;
+
+	if (silent) {
+		stats.cmds_ignored++;
+		return;
+	}
+
+	if (e310_verify_crc(cmd->data, cmd->len) != E310_OK) {
+		stats.cmd_crc_errors++;
+		send_response(recmd, E310_STATUS_INVALID_COMMAND_CRC, NULL, 0);
+		return;
+	}
+
+	if (recmd == cfg.reject_cmd && stats.config_rejects < cfg.reject_count) {
+		stats.config_rejects++;
+		send_response(recmd, E310_STATUS_UNKNOWN_PARAMETER, NULL, 0);
+		return;
+	}
+
+	switch (recmd) {
+	case E310_CMD_TAG_INVENTORY:
+		if (round_active) {
+			stats.busy_rejects++;
+			return;
+		}
+		stats.inventory_cmds++;
+		round_active = true;
+		/* ScanTime is the last data byte, in 100 ms units */
+		round_end_ms = k_uptime_get() + cmd->data[cmd->len - 3] * 100;
+		next_frame_ms = k_uptime_get();
+		break;
+
+	case E310_CMD_STOP_IMMEDIATELY:
+		round_active = false;
+		send_response(recmd, E310_STATUS_SUCCESS, NULL, 0);
+		break;
+
+	case E310_CMD_OBTAIN_READER_INFO:
+		send_response(recmd, E310_STATUS_SUCCESS,
+			      reader_info, sizeof(reader_info));
+		break;
+
+	case E310_CMD_MEASURE_TEMPERATURE: {
+		/* PlusMinus (1 = positive), then the magnitude */
+		const uint8_t temp[2] = {
+			cfg.temperature_c >= 0 ? 1 : 0,
+			(uint8_t)(cfg.temperature_c >= 0 ? cfg.temperature_c
+							 : -cfg.temperature_c),
+		};
+
+		stats.temp_cmds++;
+		send_response(recmd, E310_STATUS_SUCCESS, temp, sizeof(temp));
+		break;
+	}
+
+	case E310_CMD_MODIFY_RF_POWER:
+		stats.rf_power = cmd->data[3];
+		__fallthrough;
+
+	default:
+		stats.config_cmds++;
+		if (round_active) {
+			stats.config_mid_round++;
+		}
+		send_response(recmd, E310_STATUS_SUCCESS, NULL, 0);
+		break;
+	}
+}
+
+static void emul_thread_fn(void *p1, void *p2, void *p3)
+{
+	struct emul_cmd cmd;
+
+	while (1) {
+		k_timeout_t wait = K_FOREVER;
+
+		if (round_active) {
+			int64_t due = MIN(next_frame_ms, round_end_ms);
+			int64_t delta = due - k_uptime_get();
+
+			wait = K_MSEC(MAX(delta, 0));
+		}
+
+		if (k_msgq_get(&emul_cmd_q, &cmd, wait) == 0) {
+			handle_command(&cmd);
+			continue;
+		}
+
+		if (!round_active) {
+			continue;
+		}
+
+		int64_t now = k_uptime_get();
+
+		if (now >= round_end_ms) {
+			round_active = false;
+			stats.rounds_done++;
+			send_response(E310_CMD_TAG_INVENTORY,
+				      E310_STATUS_OPERATION_COMPLETE, NULL, 0);
+		} else if (now >= next_frame_ms && cfg.frames_per_sec > 0) {
+			emit_data_frame();
+			next_frame_ms += 1000 / cfg.frames_per_sec;
+		} else if (cfg.frames_per_sec == 0) {
+			next_frame_ms = round_end_ms;
+		}
+	}
+}
+
+/* ========================================================================
+ * UART Emulator Hook (router TX -> reader)
+ * ======================================================================== */
+
+static void tx_ready_cb(const struct device *dev, size_t size, void *user_data)
+{
+	uint8_t byte;
+
+	while (uart_emul_get_tx_data(dev, &byte, 1) == 1) {
+		if (rx_cmd_pos == 0 &&
+		    (byte < 4 || byte >= sizeof(rx_cmd.data))) {
+			continue; /* Not a plausible Len byte: resync */
+		}
+
+		rx_cmd.data[rx_cmd_pos++] = byte;
+		if (rx_cmd_pos == (size_t)rx_cmd.data[0] + 1) {
+			rx_cmd.len = (uint8_t)rx_cmd_pos;
+			k_msgq_put(&emul_cmd_q, &rx_cmd, K_NO_WAIT);
+			rx_cmd_pos = 0;
+		}
+	}
+}
+
+/* ========================================================================
+ * API
+ * ======================================================================== */
+
+void e310_emul_init(const struct device *dev)
+{
+	emul_dev = dev;
+	uart_emul_callback_tx_data_ready_set(dev, tx_ready_cb, NULL);
+
+	k_thread_create(&emul_thread, emul_stack,
+			K_THREAD_STACK_SIZEOF(emul_stack),
+			emul_thread_fn, NULL, NULL, NULL,
+			EMUL_PRIORITY, 0, K_NO_WAIT);
+	k_thread_name_set(&emul_thread, "e310_emul");
+}
+
+void e310_emul_configure(const struct e310_emul_config *new_cfg)
+{
+	k_spinlock_key_t key = k_spin_lock(&emul_lock);
+
+	cfg = *new_cfg;
+	if (cfg.population > E310_EMUL_MAX_POPULATION) {
+		cfg.population = E310_EMUL_MAX_POPULATION;
+	}
+	if (cfg.epc_len < 4) {
+		cfg.epc_len = 4;
+	}
+	if (cfg.epc_len > E310_MAX_EPC_LENGTH) {
+		cfg.epc_len = E310_MAX_EPC_LENGTH;
+	}
+
+	memset(&stats, 0, sizeof(stats));
+	prng_state = cfg.seed ? cfg.seed : 0x2545F491;
+	next_new_id = 0;
+	frame_counter = 0;
+	round_active = false;
+	silent = false;
+	line_free_us = 0;
+	for (size_t i = 0; i < ARRAY_SIZE(first_emit_us); i++) {
+		first_emit_us[i] = -1;
+	}
+	k_spin_unlock(&emul_lock, key);
+
+	k_msgq_purge(&emul_cmd_q);
+	uart_emul_flush_rx_data(emul_dev);
+	uart_emul_flush_tx_data(emul_dev);
+	rx_cmd_pos = 0;
+}
+
+void e310_emul_set_silent(bool on)
+{
+	k_spinlock_key_t key = k_spin_lock(&emul_lock);
+
+	silent = on;
+	if (on) {
+		round_active = false;
+	}
+	k_spin_unlock(&emul_lock, key);
+}
+
+void e310_emul_get_stats(struct e310_emul_stats *out)
+{
+	k_spinlock_key_t key = k_spin_lock(&emul_lock);
+
+	*out = stats;
+	k_spin_unlock(&emul_lock, key);
+}
+
+int64_t e310_emul_first_emit_us(uint32_t id)
+{
+	if (id >= E310_EMUL_MAX_POPULATION) {
+		return -1;
+	}
+	return first_emit_us[id];
+}
+
+bool e310_emul_round_active(void)
+{
+	return round_active;
+}
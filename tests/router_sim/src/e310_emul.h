@@ -0,0 +1,114 @@
+/**
+ * @file e310_emul.h
+ * @brief Simulated E310 Reader for native_sim
+ *
+ * Sits behind the uart4 zephyr,uart-emul node. Decodes the commands the
+ * router transmits, answers them, and during Tag Inventory rounds emits
+ * scripted tag populations at a configured rate. Faults (CRC errors,
+ * truncated frames, RX overruns) can be injected per frame.
+ *
+ * EPCs carry the tag id in their first 4 bytes (big endian) so the HID
+ * stub can match deliveries back to emission times.
+ */
+
+#ifndef E310_EMUL_H_
+#define E310_EMUL_H_
+
+#include <zephyr/device.h>
+#include <stdint.h>
+
+/** Maximum tag population the emulator tracks */
+#define E310_EMUL_MAX_POPULATION    1024
+
+/** UART4 line rate used for wire-time pacing (8N1 = 10 bits per byte) */
+#define E310_EMUL_BAUD              115200
+
+/**
+ * @brief Scripted tag population and fault injection
+ */
+struct e310_emul_config {
+	uint16_t frames_per_sec;    /**< Inventory data frames per second */
+	uint8_t tags_per_frame;     /**< Tag records per data frame */
+	uint8_t epc_len;            /**< EPC length in bytes (4-62) */
+	uint16_t population;        /**< Distinct tags in the field */
+	uint8_t dup_pct;            /**< % of reports repeating a seen tag */
+	uint8_t crc_err_pct;        /**< % of data frames with a bad CRC */
+	uint8_t trunc_pct;          /**< % of data frames cut in half */
+	uint16_t overrun_every;     /**< Every Nth frame is a >RX-ring burst (0=off) */
+	uint32_t seed;              /**< PRNG seed (reproducible runs) */
+	int8_t temperature_c;       /**< Measure Temperature (0x92) answer */
+	uint8_t reject_cmd;         /**< Command answered with an error (0 = none) */
+	uint8_t reject_count;       /**< ... for its first this many times */
+};
+
+/**
+ * @brief Emulator counters
+ */
+struct e310_emul_stats {
+	uint32_t cmds_rx;           /**< Commands decoded from router TX */
+	uint32_t cmd_crc_errors;    /**< Commands with a bad CRC */
+	uint32_t cmds_ignored;      /**< Commands dropped while silent */
+	uint32_t inventory_cmds;    /**< Tag Inventory commands accepted */
+	uint32_t busy_rejects;      /**< Tag Inventory received mid-round */
+	uint32_t config_cmds;       /**< Other commands (reader configuration) */
+	uint32_t config_mid_round;  /**< ... of which received mid-round */
+	uint32_t temp_cmds;         /**< Measure Temperature commands */
+	uint32_t config_rejects;    /**< Commands answered with reject_cmd's error */
+	uint8_t rf_power;           /**< Last Modify RF Power value (dBm) */
+	uint32_t rounds_done;       /**< Rounds completed (final frame sent) */
+	uint32_t frames_tx;         /**< Inventory data frames emitted */
+	uint32_t tags_tx;           /**< Tag records emitted */
+	uint32_t unique_tx;         /**< Distinct tag ids emitted */
+	uint32_t bytes_tx;          /**< Bytes put on the RX line */
+	uint32_t crc_injected;      /**< Frames sent with corrupted CRC */
+	uint32_t trunc_injected;    /**< Frames sent truncated */
+	uint32_t overruns_injected; /**< Overrun bursts sent */
+	uint32_t wire_stalls;       /**< Frames delayed by line occupancy */
+};
+
+/**
+ * @brief Attach emulator to the UART emulator device and start its thread
+ *
+ * @param dev zephyr,uart-emul device (uart4)
+ */
+void e310_emul_init(const struct device *dev);
+
+/**
+ * @brief Apply a population/fault script and clear all state
+ *
+ * @param cfg Script to apply
+ */
+void e310_emul_configure(const struct e310_emul_config *cfg);
+
+/**
+ * @brief Make the reader go silent (or come back)
+ *
+ * While silent it ends any round without a final frame, ignores every
+ * command and sends nothing, as a reader that has locked up or lost
+ * power would.
+ *
+ * @param on true to go silent
+ */
+void e310_emul_set_silent(bool on);
+
+/**
+ * @brief Copy emulator counters
+ *
+ * @param stats Output: counters
+ */
+void e310_emul_get_stats(struct e310_emul_stats *stats);
+
+/**
+ * @brief First emission time of a tag id
+ *
+ * @param id Tag id (from EPC bytes 0-3)
+ * @return Uptime in microseconds, or -1 if never emitted
+ */
+int64_t e310_emul_first_emit_us(uint32_t id);
+
+/**
+ * @brief Check if an inventory round is in progress
+ */
+bool e310_emul_round_active(void);
+
+#endif /* E310_EMUL_H_ */
@@ -0,0 +1,706 @@
+/**
+ * @file main.c
+ * @brief Router Pipeline Load Tests on a Simulated E310
+ *
+ * Drives the real uart_router.c (frame assembler, parser, EPC filter)
+ * against the simulated reader in e310_emul.c. The router runs on its
+ * own thread exactly as in the application, the tests drive it through
+ * the same requests as the shell, and the HID stub measures
+ * first-emission -> HID latency.
+ *
+ * Times are native_sim simulated time: the budgets check the pipeline's
+ * structure (poll cadence, read chunking, wire rate), not host CPU speed.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/logging/log.h>
+
+#include "uart_router.h"
+#include "runtime_config.h"
+#include "tag_store.h"
+#include "tag_session.h"
+#include "thermal_gov.h"
+#include "usb_hid.h"
+#include "e310_emul.h"
+#include "replay.h"
+#include "stubs.h"
+
+LOG_MODULE_REGISTER(router_sim_test, LOG_LEVEL_INF);
+
+/* ========================================================================
+ * Budgets
+ * ======================================================================== */
+
+/** Minimum decoded tag rate for the nominal load (400 offered) */
+#define BUDGET_NOMINAL_TAGS_PER_SEC     380
+
+/** Minimum decoded tag rate with the line saturated */
+#define BUDGET_SATURATED_TAGS_PER_SEC   700
+
+/** First emission -> HID latency, 99th percentile (ms) */
+#define BUDGET_LATENCY_P99_MS           25
+
+/** First emission -> HID latency, worst case (ms) */
+#define BUDGET_LATENCY_MAX_MS           50
+
+/** Fraction of emitted tags that must still decode under faults (%) */
+#define BUDGET_FAULT_DELIVERY_PCT       60
+
+/* Keep every duplicate suppressed for the length of a run */
+#define TEST_DEBOUNCE_MS                60000
+
+/* Continuous mode: next round right after the previous one */
+#define TEST_INTERVAL_MS                10
+
+/* Settle time for in-flight frames after stopping inventory */
+#define DRAIN_MS                        200
+
+static uart_router_t router;
+
+struct run_result {
+	struct e310_emul_stats emul;
+	uart_router_stats_t router;
+	struct hid_stub_stats hid;
+	uint32_t duration_ms;
+};
+
+static void set_timing(uint32_t interval_ms, uint32_t debounce_ms)
+{
+	runtime_config_t *rc = runtime_config_edit();
+
+	rc->inventory_interval_ms = interval_ms;
+	rc->epc_debounce_ms = debounce_ms;
+	runtime_config_publish();
+}
+
+static void run_scenario(const struct e310_emul_config *cfg,
+			 uint32_t duration_ms, struct run_result *res)
+{
+	e310_emul_configure(cfg);
+	hid_stub_reset();
+	uart_router_reset_stats(&router);
+
+	set_timing(TEST_INTERVAL_MS, TEST_DEBOUNCE_MS);
+
+	zassert_ok(uart_router_start_inventory(&router),
+		   "start inventory failed");
+	k_msleep(duration_ms);
+
+	/* Snapshot before stopping: stop also mutes HID */
+	hid_stub_get_stats(&res->hid);
+	zassert_ok(uart_router_stop_inventory(&router),
+		   "stop inventory failed");
+	k_msleep(DRAIN_MS);
+
+	e310_emul_get_stats(&res->emul);
+	uart_router_get_stats(&router, &res->router);
+	res->duration_ms = duration_ms;
+
+	LOG_INF("emul: frames=%u tags=%u unique=%u bytes=%u stalls=%u",
+		res->emul.frames_tx, res->emul.tags_tx, res->emul.unique_tx,
+		res->emul.bytes_tx, res->emul.wire_stalls);
+	LOG_INF("router: frames=%u tags=%u errors=%u overruns=%u",
+		res->router.frames_parsed, res->router.tags_read,
+		res->router.parse_errors, res->router.rx_overruns);
+	LOG_INF("hid: epc=%u p50=%lld us p99=%lld us max=%lld us",
+		res->hid.epc_count, (long long)hid_stub_latency_pct_us(50),
+		(long long)hid_stub_latency_pct_us(99),
+		(long long)res->hid.lat_max_us);
+}
+
+static uint32_t tags_per_sec(const struct run_result *res)
+{
+	return (uint32_t)((uint64_t)res->router.tags_read * 1000 /
+			  res->duration_ms);
+}
+
+static void assert_clean_delivery(const struct run_result *res)
+{
+	zassert_equal(res->router.parse_errors, 0, "unexpected parse errors");
+	zassert_equal(res->router.rx_overruns, 0, "unexpected RX overrun");
+	zassert_equal(res->router.tags_read, res->emul.tags_tx,
+		      "decoded %u of %u emitted tags",
+		      res->router.tags_read, res->emul.tags_tx);
+	zassert_equal(res->hid.unknown_ids, 0, "HID saw unknown tag ids");
+}
+
+/* ========================================================================
+ * Suite Setup
+ * ======================================================================== */
+
+static void *router_sim_setup(void)
+{
+	const struct device *uart4 = DEVICE_DT_GET(DT_NODELABEL(uart4));
+
+	zassert_true(device_is_ready(uart4), "uart4 emulator not ready");
+
+	e310_emul_init(uart4);
+	zassert_ok(uart_router_init(&router), "router init failed");
+	zassert_ok(uart_router_start(&router), "router start failed");
+
+	return NULL;
+}
+
+static void router_sim_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	/* Let any previous round finish before re-scripting the reader */
+	while (e310_emul_round_active()) {
+		k_msleep(10);
+	}
+	thermal_gov_reset();
+}
+
+ZTEST_SUITE(router_sim, NULL, router_sim_setup, router_sim_before, NULL, NULL);
+
+/* ========================================================================
+ * Command / Response
+ * ======================================================================== */
+
+ZTEST(router_sim, test_connect_sequence)
+{
+	const struct e310_emul_config cfg = { .population = 1, .epc_len = 12 };
+	struct e310_emul_stats st;
+	uart_router_status_t status;
+
+	e310_emul_configure(&cfg);
+
+	zassert_ok(uart_router_connect_e310(&router), "connect failed");
+	uart_router_get_status(&router, &status);
+	zassert_true(status.e310_connected);
+
+	e310_emul_get_stats(&st);
+	/* Info x2, stop, work mode, antenna check, RF power, heartbeat */
+	zassert_true(st.cmds_rx >= 7, "reader saw %u commands", st.cmds_rx);
+	zassert_equal(st.cmd_crc_errors, 0, "router sent bad CRC");
+}
+
+ZTEST(router_sim, test_live_config)
+{
+	/* Short rounds so a boundary comes by well within the wait */
+	const struct e310_emul_config cfg = {
+		.frames_per_sec = 20,
+		.tags_per_frame = 4,
+		.epc_len = 12,
+		.population = 64,
+		.seed = 7,
+	};
+	struct e310_emul_stats before, applied, after;
+	runtime_config_t *rc;
+	uint32_t version;
+
+	e310_emul_configure(&cfg);
+	set_timing(TEST_INTERVAL_MS, TEST_DEBOUNCE_MS);
+	zassert_ok(uart_router_start_inventory(&router), "start inventory failed");
+	k_msleep(300);
+	e310_emul_get_stats(&before);
+
+	/* Two reader-side fields in one version, published mid-inventory */
+	rc = runtime_config_edit();
+	rc->rf_power = (rc->rf_power == 20) ? 21 : 20;
+	rc->inventory_time = (rc->inventory_time == 5) ? 6 : 5;
+	version = runtime_config_publish();
+
+	zassert_ok(uart_router_wait_config(&router, version, 6000),
+		   "version %u not applied", version);
+	e310_emul_get_stats(&applied);
+	k_msleep(500);
+
+	zassert_ok(uart_router_stop_inventory(&router), "stop inventory failed");
+	k_msleep(DRAIN_MS);
+	e310_emul_get_stats(&after);
+
+	zassert_equal(after.config_cmds - before.config_cmds, 2,
+		      "reader saw %u config commands",
+		      after.config_cmds - before.config_cmds);
+	zassert_equal(after.config_mid_round, 0, "config sent mid-round");
+	zassert_equal(after.busy_rejects, 0, "round dispatched mid-round");
+	zassert_true(after.inventory_cmds > applied.inventory_cmds,
+		     "no round after the change");
+}
+
+ZTEST(router_sim, test_config_rejected)
+{
+	const struct e310_emul_config cfg = {
+		.frames_per_sec = 20,
+		.tags_per_frame = 4,
+		.epc_len = 12,
+		.population = 64,
+		.seed = 8,
+		.reject_cmd = E310_CMD_MODIFY_RF_POWER,
+		.reject_count = 1,
+	};
+	struct e310_emul_stats before, after;
+	runtime_config_t *rc;
+	uint8_t power;
+	uint32_t version;
+
+	e310_emul_configure(&cfg);
+	set_timing(TEST_INTERVAL_MS, TEST_DEBOUNCE_MS);
+	zassert_ok(uart_router_start_inventory(&router), "start inventory failed");
+	k_msleep(300);
+	e310_emul_get_stats(&before);
+
+	rc = runtime_config_edit();
+	power = (rc->rf_power == 20) ? 21 : 20;
+	rc->rf_power = power;
+	version = runtime_config_publish();
+
+	/* The rejected command is not applied: it goes again a round later */
+	zassert_ok(uart_router_wait_config(&router, version, 6000),
+		   "version %u not applied", version);
+
+	zassert_ok(uart_router_stop_inventory(&router), "stop inventory failed");
+	k_msleep(DRAIN_MS);
+	e310_emul_get_stats(&after);
+
+	zassert_equal(after.config_rejects, 1, "reader rejected %u commands",
+		      after.config_rejects);
+	zassert_equal(after.config_cmds - before.config_cmds, 1,
+		      "reader accepted %u config commands",
+		      after.config_cmds - before.config_cmds);
+	zassert_equal(after.rf_power, power, "reader has %u dBm", after.rf_power);
+	zassert_equal(after.config_mid_round, 0, "config sent mid-round");
+	zassert_equal(after.busy_rejects, 0, "round dispatched mid-round");
+}
+
+ZTEST(router_sim, test_link_resync)
+{
+	const struct e310_emul_config cfg = {
+		.frames_per_sec = 20,
+		.tags_per_frame = 4,
+		.epc_len = 12,
+		.population = 64,
+		.seed = 3,
+	};
+	struct e310_emul_stats silent, after;
+	uart_router_status_t status;
+
+	e310_emul_configure(&cfg);
+	zassert_ok(uart_router_connect_e310(&router), "connect failed");
+	uart_router_reset_stats(&router);
+	set_timing(TEST_INTERVAL_MS, TEST_DEBOUNCE_MS);
+	zassert_ok(uart_router_start_inventory(&router), "start inventory failed");
+	/* Past the 5 s start round, into the 1 s continuous ones */
+	k_msleep(E310_INVENTORY_DEFAULT_SCAN_TIME * 100 + 500);
+
+	/* Mid-round: the 1 s round plus margin runs out, then the first
+	 * resync and one retry find nobody there */
+	e310_emul_set_silent(true);
+	k_msleep(2800);
+	uart_router_get_status(&router, &status);
+	zassert_equal(status.link.silences, 1, "%u silences", status.link.silences);
+	zassert_equal(status.link.recoveries, 0);
+	zassert_true(status.link.failures >= 1, "no failed resync");
+	e310_emul_get_stats(&silent);
+
+	/* Back: the next retry recovers and rounds resume */
+	e310_emul_set_silent(false);
+	k_msleep(2500);
+	uart_router_get_status(&router, &status);
+	zassert_ok(uart_router_stop_inventory(&router), "stop inventory failed");
+	k_msleep(DRAIN_MS);
+	e310_emul_get_stats(&after);
+
+	zassert_equal(status.link.silences, 1, "%u silences", status.link.silences);
+	zassert_equal(status.link.recoveries, 1, "%u recoveries",
+		      status.link.recoveries);
+	zassert_true(after.rounds_done > silent.rounds_done, "no round after resync");
+	zassert_true(after.inventory_cmds >= silent.inventory_cmds + 2,
+		     "%u rounds after resync",
+		     after.inventory_cmds - silent.inventory_cmds);
+	zassert_equal(after.busy_rejects, 0, "round dispatched mid-round");
+}
+
+ZTEST(router_sim, test_thermal_throttle)
+{
+	/* 10 C over the default ceiling from the first sample */
+	const struct e310_emul_config cfg = {
+		.frames_per_sec = 20,
+		.tags_per_frame = 4,
+		.epc_len = 12,
+		.population = 64,
+		.seed = 5,
+		.temperature_c = THERMAL_GOV_DEFAULT_CEILING_C + 10,
+	};
+	struct e310_emul_stats st;
+	thermal_gov_stats_t gov;
+	runtime_config_t rc;
+
+	e310_emul_configure(&cfg);
+	zassert_ok(uart_router_connect_e310(&router), "connect failed");
+	zassert_ok(thermal_gov_set_period(THERMAL_GOV_PERIOD_MIN_MS));
+	runtime_config_get(&rc);
+
+	set_timing(TEST_INTERVAL_MS, TEST_DEBOUNCE_MS);
+	zassert_ok(uart_router_start_inventory(&router), "start inventory failed");
+	k_msleep(3500);
+	zassert_ok(uart_router_stop_inventory(&router), "stop inventory failed");
+	k_msleep(DRAIN_MS);
+
+	e310_emul_get_stats(&st);
+	thermal_gov_get_stats(&gov);
+
+	zassert_true(gov.samples >= 2, "%u samples", gov.samples);
+	zassert_equal(gov.temp_c, cfg.temperature_c);
+	/* Six levels on the first sample: past the power steps at once */
+	zassert_true(gov.level > 4, "level %u", gov.level);
+	zassert_equal(gov.throttle_events, 1);
+	zassert_true(gov.throttled_ms > 0, "no throttled time");
+	zassert_equal(st.rf_power, rc.rf_power > 8 ? rc.rf_power - 8 : 0,
+		      "reader runs at %u dBm", st.rf_power);
+	zassert_equal(st.config_mid_round, 0, "config sent mid-round");
+	zassert_equal(st.busy_rejects, 0, "round dispatched mid-round");
+
+	/* Release: full power goes back out while idle */
+	zassert_ok(thermal_gov_set_period(THERMAL_GOV_DEFAULT_PERIOD_MS));
+	thermal_gov_reset();
+	k_msleep(DRAIN_MS);
+	e310_emul_get_stats(&st);
+	zassert_equal(st.rf_power, rc.rf_power, "power not restored");
+}
+
+ZTEST(router_sim, test_store_forward)
+{
+	/* Small field, long debounce: one accepted read per tag */
+	const struct e310_emul_config cfg = {
+		.frames_per_sec = 20,
+		.tags_per_frame = 4,
+		.epc_len = 12,
+		.population = 16,
+		.seed = 11,
+	};
+	struct e310_emul_stats emul;
+	struct hid_stub_stats hid;
+	tag_store_stats_t st;
+
+	e310_emul_configure(&cfg);
+	hid_stub_reset();
+	tag_store_clear();
+	zassert_ok(tag_store_set_rate(TAG_STORE_RATE_MAX));
+	set_timing(TEST_INTERVAL_MS, TEST_DEBOUNCE_MS);
+
+	/* Sink down for the whole field */
+	hid_stub_set_ready(false);
+	zassert_ok(uart_router_start_inventory(&router), "start inventory failed");
+	k_msleep(1500);
+
+	e310_emul_get_stats(&emul);
+	hid_stub_get_stats(&hid);
+	tag_store_get_stats(&st);
+	zassert_equal(hid.epc_count, 0, "HID took %u EPCs while down",
+		      hid.epc_count);
+	zassert_equal(st.buffered, emul.unique_tx, "stored %u of %u tags",
+		      st.buffered, emul.unique_tx);
+	zassert_equal(hid.beeps, st.buffered, "no feedback for stored reads");
+
+	/* Back: 16 records at 100/s drain well within the wait */
+	hid_stub_set_ready(true);
+	k_msleep(1000);
+	hid_stub_get_stats(&hid);
+	tag_store_get_stats(&st);
+
+	zassert_ok(uart_router_stop_inventory(&router), "stop inventory failed");
+	k_msleep(DRAIN_MS);
+	e310_emul_get_stats(&emul);
+
+	zassert_equal(st.records, 0, "%u records left", st.records);
+	zassert_equal(st.replayed, st.buffered, "replayed %u of %u",
+		      st.replayed, st.buffered);
+	zassert_equal(st.expired + st.deduped + st.dropped + st.failed, 0,
+		      "records lost on replay");
+	zassert_equal(hid.epc_count, emul.unique_tx,
+		      "HID got %u of %u unique tags", hid.epc_count,
+		      emul.unique_tx);
+	zassert_equal(hid.unknown_ids, 0, "HID saw unknown tag ids");
+
+	tag_store_set_rate(TAG_STORE_RATE_DEFAULT);
+}
+
+ZTEST(router_sim, test_session_store)
+{
+	/* Far more tags than the duplicate cache holds */
+	const struct e310_emul_config cfg = {
+		.frames_per_sec = 50,
+		.tags_per_frame = 8,
+		.epc_len = 12,
+		.population = 1000,
+		.dup_pct = 50,
+		.seed = 5,
+	};
+	static tag_session_iter_t it;
+	tag_session_entry_t e, prev;
+	tag_session_info_t info;
+	struct run_result res;
+	uint32_t n = 0, reads = 0;
+
+	tag_session_begin();
+	run_scenario(&cfg, 3000, &res);
+	zassert_ok(tag_session_stop(), "session not running");
+
+	tag_session_get_info(TAG_SESSION_CURRENT, &info);
+	zassert_equal(info.full_drops, 0, "session pool full");
+	zassert_equal(info.tags, res.emul.unique_tx, "session has %u of %u tags",
+		      info.tags, res.emul.unique_tx);
+	zassert_equal(info.reads, res.router.tags_read, "session saw %u of %u reads",
+		      info.reads, res.router.tags_read);
+
+	/* Walk in EPC order: strictly ascending, every read accounted for */
+	zassert_ok(tag_session_iter_init(&it, TAG_SESSION_CURRENT));
+	while (tag_session_iter_next(&it, &e) == 0) {
+		if (n > 0) {
+			zassert_true(tag_session_epc_cmp(prev.epc, prev.epc_len,
+							 e.epc, e.epc_len) < 0,
+				     "entry %u out of order", n);
+		}
+		zassert_true(e.stats.first_s <= e.stats.last_s, "entry %u times", n);
+		reads += e.stats.reads;
+		prev = e;
+		n++;
+	}
+	zassert_equal(n, info.tags, "walked %u of %u tags", n, info.tags);
+	zassert_equal(reads, info.reads, "walked %u of %u reads", reads, info.reads);
+}
+
+/* ========================================================================
+ * Throughput and Latency
+ * ======================================================================== */
+
+ZTEST(router_sim, test_nominal_load)
+{
+	/* 50 fps x 8 tags = 400 reads/s, 120-byte frames (~52% of the line) */
+	const struct e310_emul_config cfg = {
+		.frames_per_sec = 50,
+		.tags_per_frame = 8,
+		.epc_len = 12,
+		.population = EPC_CACHE_SIZE,
+		.dup_pct = 60,
+		.seed = 1,
+	};
+	struct run_result res;
+
+	run_scenario(&cfg, 3000, &res);
+
+	assert_clean_delivery(&res);
+	zassert_true(tags_per_sec(&res) >= BUDGET_NOMINAL_TAGS_PER_SEC,
+		     "%u tags/s below budget", tags_per_sec(&res));
+	zassert_equal(res.hid.epc_count, res.emul.unique_tx,
+		      "HID delivered %u of %u unique tags",
+		      res.hid.epc_count, res.emul.unique_tx);
+	zassert_true(hid_stub_latency_pct_us(99) <= BUDGET_LATENCY_P99_MS * 1000,
+		     "p99 latency %lld us",
+		     (long long)hid_stub_latency_pct_us(99));
+	zassert_true(res.hid.lat_max_us <= BUDGET_LATENCY_MAX_MS * 1000,
+		     "max latency %lld us", (long long)res.hid.lat_max_us);
+}
+
+ZTEST(router_sim, test_saturated_line)
+{
+	/* Offered 1600 reads/s in 232-byte frames: the 115200 line caps it */
+	const struct e310_emul_config cfg = {
+		.frames_per_sec = 100,
+		.tags_per_frame = 16,
+		.epc_len = 12,
+		.population = EPC_CACHE_SIZE,
+		.dup_pct = 90,
+		.seed = 2,
+	};
+	struct run_result res;
+
+	run_scenario(&cfg, 3000, &res);
+
+	assert_clean_delivery(&res);
+	zassert_true(res.emul.wire_stalls > 0, "line never saturated");
+	zassert_true(tags_per_sec(&res) >= BUDGET_SATURATED_TAGS_PER_SEC,
+		     "%u tags/s below budget", tags_per_sec(&res));
+}
+
+ZTEST(router_sim, test_long_epc)
+{
+	/* 62-byte EPCs: three 64-byte tag records per frame */
+	const struct e310_emul_config cfg = {
+		.frames_per_sec = 30,
+		.tags_per_frame = 3,
+		.epc_len = E310_MAX_EPC_LENGTH,
+		.population = 20,
+		.dup_pct = 50,
+		.seed = 3,
+	};
+	struct run_result res;
+
+	run_scenario(&cfg, 2000, &res);
+
+	assert_clean_delivery(&res);
+	zassert_equal(res.hid.epc_count, res.emul.unique_tx);
+}
+
+/* ========================================================================
+ * Fault Injection and Recovery
+ * ======================================================================== */
+
+static const struct e310_emul_config recovery_cfg = {
+	.frames_per_sec = 40,
+	.tags_per_frame = 6,
+	.epc_len = 12,
+	.population = EPC_CACHE_SIZE,
+	.dup_pct = 50,
+	.seed = 99,
+};
+
+static void assert_recovers(void)
+{
+	struct run_result res;
+
+	run_scenario(&recovery_cfg, 1500, &res);
+	assert_clean_delivery(&res);
+}
+
+static void assert_fault_delivery(const struct run_result *res)
+{
+	uint32_t floor = (uint32_t)((uint64_t)res->emul.tags_tx *
+				    BUDGET_FAULT_DELIVERY_PCT / 100);
+
+	zassert_true(res->router.tags_read >= floor,
+		     "only %u of %u tags decoded under faults",
+		     res->router.tags_read, res->emul.tags_tx);
+}
+
+ZTEST(router_sim, test_crc_errors)
+{
+	const struct e310_emul_config cfg = {
+		.frames_per_sec = 50,
+		.tags_per_frame = 8,
+		.epc_len = 12,
+		.population = EPC_CACHE_SIZE,
+		.dup_pct = 60,
+		.crc_err_pct = 10,
+		.seed = 4,
+	};
+	struct run_result res;
+
+	run_scenario(&cfg, 3000, &res);
+
+	zassert_true(res.emul.crc_injected > 0);
+	zassert_true(res.router.parse_errors > 0, "CRC errors not detected");
+	/* A reset may cut one following frame in two: at most 2 per fault */
+	zassert_true(res.router.parse_errors <= 2 * res.emul.crc_injected,
+		     "%u errors for %u injected",
+		     res.router.parse_errors, res.emul.crc_injected);
+	assert_fault_delivery(&res);
+
+	assert_recovers();
+}
+
+ZTEST(router_sim, test_truncated_frames)
+{
+	const struct e310_emul_config cfg = {
+		.frames_per_sec = 50,
+		.tags_per_frame = 8,
+		.epc_len = 12,
+		.population = EPC_CACHE_SIZE,
+		.dup_pct = 60,
+		.trunc_pct = 10,
+		.seed = 5,
+	};
+	struct run_result res;
+
+	run_scenario(&cfg, 3000, &res);
+
+	zassert_true(res.emul.trunc_injected > 0);
+	zassert_true(res.router.parse_errors > 0, "truncation not detected");
+	assert_fault_delivery(&res);
+
+	assert_recovers();
+}
+
+ZTEST(router_sim, test_rx_overrun)
+{
+	const struct e310_emul_config cfg = {
+		.frames_per_sec = 50,
+		.tags_per_frame = 8,
+		.epc_len = 12,
+		.population = EPC_CACHE_SIZE,
+		.dup_pct = 60,
+		.overrun_every = 50,
+		.seed = 6,
+	};
+	struct run_result res;
+
+	run_scenario(&cfg, 3000, &res);
+
+	zassert_true(res.emul.overruns_injected > 0);
+	zassert_true(res.router.rx_overruns > 0, "overrun not detected");
+
+	assert_recovers();
+}
+
+/* ========================================================================
+ * Capture Replay
+ * ======================================================================== */
+
+static const uint8_t replay_capture[] = {
+#include "replay_capture.inc"
+};
+
+static void replay_once(enum replay_mode mode, struct replay_result *rep,
+			uart_router_stats_t *st)
+{
+	const struct device *uart4 = DEVICE_DT_GET(DT_NODELABEL(uart4));
+	const struct e310_emul_config idle_cfg = { .population = 1, .epc_len = 12 };
+
+	/* Reader stays silent: the capture is the only RX source */
+	e310_emul_configure(&idle_cfg);
+	hid_stub_reset();
+	uart_router_reset_stats(&router);
+
+	uart_router_set_mode(&router, ROUTER_MODE_INVENTORY);
+	set_timing(0, TEST_DEBOUNCE_MS);
+	router.next_inventory_time = 0;
+	router.inventory_active = true;
+	usb_hid_set_enabled(true);
+
+	zassert_ok(replay_run(uart4, replay_capture, sizeof(replay_capture),
+			      mode, &router.uart4_rx_ring, rep),
+		   "malformed capture");
+	k_msleep(DRAIN_MS);
+
+	usb_hid_set_enabled(false);
+	router.inventory_active = false;
+	set_timing(TEST_INTERVAL_MS, TEST_DEBOUNCE_MS);
+	uart_router_get_stats(&router, st);
+	uart_router_set_mode(&router, ROUTER_MODE_IDLE);
+
+	/* Stable, greppable line for comparing commits */
+	printk("REPLAY mode=%s chunks=%u bytes=%u capture_us=%u sim_us=%u "
+	       "frames=%u tags=%u errors=%u overruns=%u waits=%u\n",
+	       mode == REPLAY_REALTIME ? "realtime" : "asap",
+	       rep->chunks, rep->bytes, rep->capture_us, rep->elapsed_us,
+	       st->frames_parsed, st->tags_read, st->parse_errors,
+	       st->rx_overruns, rep->backpressure);
+}
+
+ZTEST(router_sim, test_replay_capture)
+{
+	struct replay_result rt_rep, asap_rep;
+	uart_router_stats_t rt, asap;
+
+	replay_once(REPLAY_REALTIME, &rt_rep, &rt);
+	replay_once(REPLAY_ASAP, &asap_rep, &asap);
+
+	zassert_true(rt_rep.chunks > 0, "empty capture");
+	zassert_equal(rt.uart4_rx_bytes, rt_rep.bytes, "router missed bytes");
+	zassert_equal(asap.uart4_rx_bytes, asap_rep.bytes, "router missed bytes");
+
+	/* At the original line timing the router must keep up */
+	zassert_equal(rt.rx_overruns, 0, "overrun at capture timing");
+
+	/* Decoding must not depend on how fast bytes arrive */
+	zassert_equal(asap.rx_overruns, 0, "ASAP feed overran the RX ring");
+	zassert_equal(asap.tags_read, rt.tags_read,
+		      "ASAP decoded %u tags, realtime %u",
+		      asap.tags_read, rt.tags_read);
+	zassert_equal(asap.parse_errors, rt.parse_errors);
+}
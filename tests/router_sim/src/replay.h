@@ -0,0 +1,47 @@
+/**
+ * @file replay.h
+ * @brief UART4 Capture Replay Driver for native_sim
+ *
+ * Feeds a capture (.bin from tools/capture2bin.py) into the uart4
+ * emulator, either with the original inter-chunk timing or as fast as
+ * the router's RX ring accepts it.
+ */
+
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+#include <zephyr/device.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum replay_mode {
+	REPLAY_REALTIME,    /**< Honour capture timestamps */
+	REPLAY_ASAP,        /**< Feed whenever the RX ring has room */
+};
+
+struct replay_result {
+	uint32_t chunks;        /**< Chunks fed */
+	uint32_t bytes;         /**< Bytes fed */
+	uint32_t capture_us;    /**< Capture span (last chunk timestamp) */
+	uint32_t elapsed_us;    /**< Simulated time taken to feed */
+	uint32_t overrun_chunks;/**< Chunks flagged as overrun on the target */
+	uint32_t backpressure;  /**< ASAP waits for RX ring space */
+};
+
+/**
+ * @brief Replay a capture into a UART emulator
+ *
+ * @param dev zephyr,uart-emul device
+ * @param cap Capture file contents
+ * @param len Capture size
+ * @param mode Timing mode
+ * @param rx_ring Router RX ring (ASAP back-pressure), may be NULL
+ * @param res Output: replay counters
+ * @return 0 on success, -EINVAL on a malformed capture
+ */
+int replay_run(const struct device *dev, const uint8_t *cap, size_t len,
+	       enum replay_mode mode, struct ring_buf *rx_ring,
+	       struct replay_result *res);
+
+#endif /* REPLAY_H_ */
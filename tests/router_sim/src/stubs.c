@@ -0,0 +1,325 @@
+/**
+ * @file stubs.c
+ * @brief Board-Service Stubs for the Router Simulation
+ */
+
+#include "stubs.h"
+#include "e310_emul.h"
+#include "usb_hid.h"
+#include "beep_control.h"
+#include "feedback.h"
+#include "rgb_led.h"
+#include "switch_control.h"
+#include "e310_settings.h"
+#include "ctrl_proto.h"
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+static struct hid_stub_stats hid_stats;
+static struct k_spinlock hid_lock;
+
+/* ========================================================================
+ * USB HID
+ * ======================================================================== */
+
+static bool hid_enabled;
+static bool hid_ready = true;
+static uint16_t hid_speed = HID_TYPING_SPEED_DEFAULT;
+
+int parp_usb_hid_init(void)
+{
+	return 0;
+}
+
+int usb_hid_send_epc(const uint8_t *epc, size_t len)
+{
+	char id_hex[9];
+	int64_t emitted;
+	uint32_t id;
+
+	if (!hid_enabled) {
+		return 0;
+	}
+	if (len < 8) {
+		return -EINVAL;
+	}
+	if (!hid_ready) {
+		hid_stats.not_ready++;
+		return -EAGAIN;
+	}
+
+	/* EPC bytes 0-3 carry the emulator tag id */
+	memcpy(id_hex, epc, 8);
+	id_hex[8] = '\0';
+	id = strtoul(id_hex, NULL, 16);
+	emitted = e310_emul_first_emit_us(id);
+
+	k_spinlock_key_t key = k_spin_lock(&hid_lock);
+
+	hid_stats.epc_count++;
+	if (emitted < 0) {
+		hid_stats.unknown_ids++;
+	} else {
+		int64_t lat = k_ticks_to_us_floor64(k_uptime_ticks()) - emitted;
+		size_t bucket = MIN(lat / HID_STUB_LAT_BUCKET_US,
+				    HID_STUB_LAT_BUCKETS);
+
+		hid_stats.lat_max_us = MAX(hid_stats.lat_max_us, lat);
+		hid_stats.lat_sum_us += lat;
+		hid_stats.lat_hist[bucket]++;
+	}
+	k_spin_unlock(&hid_lock, key);
+
+	return 0;
+}
+
+bool usb_hid_is_ready(void)
+{
+	return hid_ready;
+}
+
+int usb_hid_set_typing_speed(uint16_t cpm)
+{
+	if (cpm < HID_TYPING_SPEED_MIN || cpm > HID_TYPING_SPEED_MAX) {
+		return -EINVAL;
+	}
+	hid_speed = cpm;
+	return 0;
+}
+
+uint16_t usb_hid_get_typing_speed(void)
+{
+	return hid_speed;
+}
+
+void usb_hid_set_enabled(bool enable)
+{
+	hid_enabled = enable;
+}
+
+bool usb_hid_is_enabled(void)
+{
+	return hid_enabled;
+}
+
+void usb_hid_get_stats(struct usb_hid_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+	stats->epc_sent = hid_stats.epc_count;
+}
+
+void usb_hid_reset_stats(void)
+{
+}
+
+void hid_stub_reset(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&hid_lock);
+
+	memset(&hid_stats, 0, sizeof(hid_stats));
+	k_spin_unlock(&hid_lock, key);
+}
+
+void hid_stub_set_ready(bool ready)
+{
+	hid_ready = ready;
+}
+
+void hid_stub_get_stats(struct hid_stub_stats *out)
+{
+	k_spinlock_key_t key = k_spin_lock(&hid_lock);
+
+	*out = hid_stats;
+	k_spin_unlock(&hid_lock, key);
+}
+
+int64_t hid_stub_latency_pct_us(uint32_t pct)
+{
+	uint32_t total = 0, acc = 0;
+
+	for (size_t i = 0; i <= HID_STUB_LAT_BUCKETS; i++) {
+		total += hid_stats.lat_hist[i];
+	}
+	if (total == 0) {
+		return 0;
+	}
+
+	uint32_t target = DIV_ROUND_UP(total * pct, 100);
+
+	for (size_t i = 0; i <= HID_STUB_LAT_BUCKETS; i++) {
+		acc += hid_stats.lat_hist[i];
+		if (acc >= target) {
+			return (int64_t)(i + 1) * HID_STUB_LAT_BUCKET_US;
+		}
+	}
+	return hid_stats.lat_max_us;
+}
+
+/* ========================================================================
+ * Beeper / RGB LED / Switch
+ * ======================================================================== */
+
+void feedback_request(uint32_t what)
+{
+	if (what & FEEDBACK_BEEP) {
+		hid_stats.beeps++;
+	}
+}
+
+void beep_control_set_edge_capture(bool enable)
+{
+	ARG_UNUSED(enable);
+}
+
+bool beep_control_is_edge_capture_enabled(void)
+{
+	return false;
+}
+
+uint32_t beep_control_get_edge_count(void)
+{
+	return 0;
+}
+
+int beep_control_get_edge_time(uint32_t index, uint32_t *cycles)
+{
+	ARG_UNUSED(index);
+	ARG_UNUSED(cycles);
+	return -ENOENT;
+}
+
+void rgb_led_set_inventory_status(bool running)
+{
+	ARG_UNUSED(running);
+}
+
+static bool sw_inventory_running;
+
+void switch_control_set_inventory_state(bool running)
+{
+	sw_inventory_running = running;
+}
+
+bool switch_control_is_inventory_running(void)
+{
+	return sw_inventory_running;
+}
+
+/* ========================================================================
+ * Control protocol tag stream (no host attached)
+ * ======================================================================== */
+
+void ctrl_proto_tag_read(const uint8_t *epc, uint8_t epc_len, uint8_t rssi,
+			 uint8_t antenna, uint8_t flags)
+{
+	ARG_UNUSED(epc);
+	ARG_UNUSED(epc_len);
+	ARG_UNUSED(rssi);
+	ARG_UNUSED(antenna);
+	ARG_UNUSED(flags);
+}
+
+/* ========================================================================
+ * Settings (RAM only, factory defaults)
+ * ======================================================================== */
+
+static uint8_t set_rf_power = 30;
+static uint8_t set_antenna = 0x01;
+static uint8_t set_region = 0x02, set_start, set_end = 49;
+static uint8_t set_inv_time = 10;
+static uint8_t set_addr = E310_ADDR_DEFAULT;
+
+int e310_settings_reset(void)
+{
+	return 0;
+}
+
+int e310_settings_flush(void)
+{
+	return 0;
+}
+
+int e310_settings_set_rf_power(uint8_t power)
+{
+	set_rf_power = power;
+	return 0;
+}
+
+uint8_t e310_settings_get_rf_power(void)
+{
+	return set_rf_power;
+}
+
+int e310_settings_set_antenna(uint8_t config)
+{
+	set_antenna = config;
+	return 0;
+}
+
+uint8_t e310_settings_get_antenna(void)
+{
+	return set_antenna;
+}
+
+int e310_settings_set_frequency(uint8_t region, uint8_t start, uint8_t end)
+{
+	set_region = region;
+	set_start = start;
+	set_end = end;
+	return 0;
+}
+
+void e310_settings_get_frequency(uint8_t *region, uint8_t *start, uint8_t *end)
+{
+	*region = set_region;
+	*start = set_start;
+	*end = set_end;
+}
+
+int e310_settings_set_inventory_time(uint8_t time)
+{
+	set_inv_time = time;
+	return 0;
+}
+
+uint8_t e310_settings_get_inventory_time(void)
+{
+	return set_inv_time;
+}
+
+int e310_settings_set_reader_addr(uint8_t addr)
+{
+	set_addr = addr;
+	return 0;
+}
+
+uint8_t e310_settings_get_reader_addr(void)
+{
+	return set_addr;
+}
+
+int e310_settings_set_typing_speed(uint16_t cpm)
+{
+	ARG_UNUSED(cpm);
+	return 0;
+}
+
+int e310_settings_set_epc_debounce(uint8_t sec)
+{
+	ARG_UNUSED(sec);
+	return 0;
+}
+
+int e310_settings_set_inventory_interval(uint16_t ms)
+{
+	ARG_UNUSED(ms);
+	return 0;
+}
+
+void e310_settings_print(const struct shell *sh)
+{
+	shell_print(sh, "(router_sim: settings are RAM stubs)");
+}
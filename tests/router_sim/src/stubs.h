@@ -0,0 +1,56 @@
+/**
+ * @file stubs.h
+ * @brief Board-Service Stubs for the Router Simulation
+ *
+ * Replaces USB HID, beeper, RGB LED, switch and EEPROM settings with
+ * in-memory versions. The HID stub records every delivered EPC and the
+ * latency from its first emission by the simulated reader.
+ */
+
+#ifndef ROUTER_SIM_STUBS_H_
+#define ROUTER_SIM_STUBS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Latency histogram resolution and range */
+#define HID_STUB_LAT_BUCKET_US      1000
+#define HID_STUB_LAT_BUCKETS        200
+
+struct hid_stub_stats {
+	uint32_t epc_count;         /**< EPCs delivered to the HID stub */
+	uint32_t unknown_ids;       /**< EPCs the emulator never emitted */
+	int64_t lat_max_us;         /**< Worst first-emit -> HID latency */
+	int64_t lat_sum_us;         /**< Sum for mean */
+	uint32_t lat_hist[HID_STUB_LAT_BUCKETS + 1]; /**< Last bucket: overflow */
+	uint32_t beeps;             /**< feedback_request() calls asking for a beep */
+	uint32_t not_ready;         /**< EPCs refused with -EAGAIN (sink down) */
+};
+
+/**
+ * @brief Clear HID stub counters
+ */
+void hid_stub_reset(void);
+
+/**
+ * @brief Simulate the HID interface going away / coming back
+ *
+ * While not ready, usb_hid_send_epc() fails with -EAGAIN like the real
+ * driver does during re-enumeration.
+ */
+void hid_stub_set_ready(bool ready);
+
+/**
+ * @brief Copy HID stub counters
+ */
+void hid_stub_get_stats(struct hid_stub_stats *out);
+
+/**
+ * @brief Latency percentile from the histogram
+ *
+ * @param pct Percentile (1-100)
+ * @return Upper bound of the bucket holding the percentile, in us
+ */
+int64_t hid_stub_latency_pct_us(uint32_t pct);
+
+#endif /* ROUTER_SIM_STUBS_H_ */
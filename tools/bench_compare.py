@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+"""Compare two runs of the E310 protocol benchmark (tests/e310_benchmark).
+
+Reads the "BENCH <function> <corpus> ... ns_op=<n> ..." lines from two
+console logs (twister handler.log, west build -t run output, or a
+target UART log) and prints the per-benchmark change in ns/op.
+
+Exits with status 1 if any benchmark got slower than --threshold percent,
+so it can gate a CI job.
+
+Usage:
+    tools/bench_compare.py base.log new.log
+    tools/bench_compare.py base.log new.log --threshold 10
+"""
+
+import argparse
+import re
+import sys
+
+BENCH_RE = re.compile(r"BENCH (\S+)\s+(\S+)\s+bytes=\d+ iters=\d+ "
+                      r"ns_op=([\d.]+) bytes_s=\d+ cyc_op=(\S+)")
+CONFIG_RE = re.compile(r"BENCH-CONFIG (.*)$")
+
+
+def load(path):
+    results = {}
+    config = None
+    with open(path, errors="replace") as f:
+        for line in f:
+            m = BENCH_RE.search(line)
+            if m:
+                results[(m.group(1), m.group(2))] = float(m.group(3))
+                continue
+            m = CONFIG_RE.search(line)
+            if m:
+                config = m.group(1).strip()
+    return config, results
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("base", help="baseline log")
+    ap.add_argument("new", help="log to compare against the baseline")
+    ap.add_argument("--threshold", type=float, default=5.0,
+                    help="slowdown in percent reported as a regression "
+                         "(default 5)")
+    args = ap.parse_args()
+
+    base_cfg, base = load(args.base)
+    new_cfg, new = load(args.new)
+    if not base or not new:
+        sys.exit("no BENCH lines found in %s"
+                 % (args.base if not base else args.new))
+    if base_cfg != new_cfg:
+        print("warning: configs differ\n  base: %s\n  new:  %s"
+              % (base_cfg, new_cfg), file=sys.stderr)
+
+    regressions = 0
+    print("%-34s %-9s %12s %12s %8s" %
+          ("function", "corpus", "base ns/op", "new ns/op", "change"))
+    for key in sorted(set(base) | set(new)):
+        b, n = base.get(key), new.get(key)
+        if b is None or n is None:
+            print("%-34s %-9s %12s %12s %8s" %
+                  (key[0], key[1], b or "-", n or "-", "n/a"))
+            continue
+        pct = (n - b) * 100.0 / b if b else 0.0
+        mark = ""
+        if pct > args.threshold:
+            mark = "  SLOWER"
+            regressions += 1
+        elif pct < -args.threshold:
+            mark = "  faster"
+        print("%-34s %-9s %12.1f %12.1f %+7.1f%%%s" %
+              (key[0], key[1], b, n, pct, mark))
+
+    sys.exit(1 if regressions else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+"""Convert a PARP-01 UART4 RX capture dump into a replayable .bin file.
+
+Input is the text printed by `e310 capture dump` on the CDC ACM shell,
+either a saved terminal log or read live from the port (--port).
+
+Output format (little endian), replayed by tests/router_sim:
+
+    offset 0   8 bytes   magic  b"E3CAP\\x01\\x00\\x00"  (version 1)
+    offset 8   uint32    chunk count
+    then per chunk:
+               uint32    timestamp_us since capture start
+               uint8     len
+               uint8     flags (bit0: router RX ring overrun)
+               len bytes raw UART4 RX data
+
+Usage:
+    tools/capture2bin.py capture.log -o field_capture.bin
+    tools/capture2bin.py --port /dev/ttyACM1 -o field_capture.bin
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+MAGIC = b"E3CAP\x01\x00\x00"
+CHUNK_RE = re.compile(r"^C (\d+) (\d+) ([0-9A-Fa-f]*)\s*$")
+
+
+def read_port(port, baud, timeout):
+    import serial  # pyserial, only needed for live download
+
+    lines = []
+    with serial.Serial(port, baud, timeout=timeout) as ser:
+        ser.reset_input_buffer()
+        ser.write(b"e310 capture dump\r\n")
+        while True:
+            raw = ser.readline()
+            if not raw:
+                raise RuntimeError("timeout waiting for CAPTURE END")
+            line = raw.decode("ascii", errors="replace")
+            lines.append(line)
+            if "CAPTURE END" in line:
+                return lines
+
+
+def parse_dump(lines):
+    chunks = []
+    in_capture = False
+    expected = None
+
+    for line in lines:
+        # Strip shell prompt/colour noise ahead of the payload
+        line = re.sub(r"\x1b\[[0-9;]*[A-Za-z]", "", line).strip()
+        if "CAPTURE BEGIN" in line:
+            in_capture = True
+            chunks = []
+            m = re.search(r"chunks=(\d+)", line)
+            expected = int(m.group(1)) if m else None
+            continue
+        if "CAPTURE END" in line:
+            break
+        if not in_capture:
+            continue
+        m = CHUNK_RE.match(line[line.find("C "):] if "C " in line else line)
+        if m:
+            data = bytes.fromhex(m.group(3))
+            chunks.append((int(m.group(1)), int(m.group(2)), data))
+
+    if not in_capture:
+        raise ValueError("no CAPTURE BEGIN marker found")
+    if expected is not None and expected != len(chunks):
+        print(f"warning: header says {expected} chunks, parsed {len(chunks)}",
+              file=sys.stderr)
+    return chunks
+
+
+def write_bin(path, chunks):
+    with open(path, "wb") as f:
+        f.write(MAGIC)
+        f.write(struct.pack("<I", len(chunks)))
+        for ts, flags, data in chunks:
+            f.write(struct.pack("<IBB", ts, len(data), flags))
+            f.write(data)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("log", nargs="?", help="saved `e310 capture dump` output")
+    ap.add_argument("--port", help="read the dump live from this serial port")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--timeout", type=float, default=5.0)
+    ap.add_argument("-o", "--output", required=True, help=".bin output path")
+    args = ap.parse_args()
+
+    if args.port:
+        lines = read_port(args.port, args.baud, args.timeout)
+    elif args.log:
+        with open(args.log, encoding="ascii", errors="replace") as f:
+            lines = f.readlines()
+    else:
+        ap.error("give a log file or --port")
+
+    chunks = parse_dump(lines)
+    write_bin(args.output, chunks)
+    total = sum(len(c[2]) for c in chunks)
+    span = chunks[-1][0] / 1e6 if chunks else 0.0
+    print(f"{args.output}: {len(chunks)} chunks, {total} bytes, {span:.3f} s")
+
+
+if __name__ == "__main__":
+    main()
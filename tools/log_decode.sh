@@ -0,0 +1,55 @@
+#!/bin/sh
+# Decode PARP-01 dictionary logs (CONFIG_LOG_BACKEND_UART_OUTPUT_DICTIONARY_HEX)
+#
+# The firmware sends log messages on USART1 as hex-encoded binary packets
+# that only carry the format-string address and the raw arguments. The
+# strings live in the dictionary database generated at build time
+# (build/zephyr/log_dictionary.json), which must match the flashed image.
+#
+# Usage:
+#   tools/log_decode.sh live [port] [baud]      decode from serial port
+#   tools/log_decode.sh file <capture> [db]     decode a saved hex capture
+#   tools/log_decode.sh save <dir>              archive database with image
+#
+# Environment:
+#   ZEPHYR_BASE   Zephyr tree (provides scripts/logging/dictionary)
+#   BUILD_DIR     west build directory (default: build)
+
+set -e
+
+BUILD_DIR=${BUILD_DIR:-build}
+DB=${BUILD_DIR}/zephyr/log_dictionary.json
+
+if [ -z "$ZEPHYR_BASE" ]; then
+	echo "ZEPHYR_BASE is not set (source zephyr-env.sh or activate west venv)" >&2
+	exit 1
+fi
+
+PARSER_DIR=$ZEPHYR_BASE/scripts/logging/dictionary
+
+cmd=${1:-live}
+[ $# -gt 0 ] && shift
+
+case "$cmd" in
+live)
+	port=${1:-/dev/ttyACM0}
+	baud=${2:-115200}
+	exec python3 "$PARSER_DIR/log_parser_uart.py" "$DB" "$port" "$baud"
+	;;
+file)
+	[ -n "$1" ] || { echo "usage: $0 file <capture> [db]" >&2; exit 1; }
+	exec python3 "$PARSER_DIR/log_parser.py" --hex "${2:-$DB}" "$1"
+	;;
+save)
+	[ -n "$1" ] || { echo "usage: $0 save <dir>" >&2; exit 1; }
+	mkdir -p "$1"
+	tag=$(git describe --always --dirty 2>/dev/null || date +%Y%m%d%H%M%S)
+	cp "$DB" "$1/log_dictionary-$tag.json"
+	cp "$BUILD_DIR/zephyr/zephyr.elf" "$1/zephyr-$tag.elf"
+	echo "Saved $1/log_dictionary-$tag.json"
+	;;
+*)
+	echo "usage: $0 live [port] [baud] | file <capture> [db] | save <dir>" >&2
+	exit 1
+	;;
+esac
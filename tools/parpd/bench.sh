@@ -0,0 +1,52 @@
+#!/bin/sh
+# Run parpd against parp_sim on a pty with two ring consumers and one
+# socket consumer, then print what each side saw.
+#
+# Usage: ./bench.sh [count] [rate]      (rate 0 = as fast as possible)
+#   e.g. ./bench.sh 200000 0
+#        ./bench.sh 20000 2000          (a fast reader, paced)
+
+set -e
+cd "$(dirname "$0")"
+
+COUNT=${1:-200000}
+RATE=${2:-0}
+TTY=/tmp/parp_sim.$$.tty
+SHM=/parpd_bench_$$
+SOCK=/tmp/parpd_bench.$$.sock
+LOG=/tmp/parpd_bench.$$
+
+cleanup() {
+	kill $SIM $DAEMON 2>/dev/null || true
+	wait 2>/dev/null || true
+	rm -f "$TTY" "$SOCK" "$LOG".*
+}
+trap cleanup EXIT INT TERM
+
+# parpd first: it retries the missing port every second, so the
+# consumers are attached before the first tag is sent
+./parpd -d "$TTY" -s "$SHM" -u "$SOCK" -i 1 2>"$LOG.daemon" &
+DAEMON=$!
+while [ ! -S "$SOCK" ]; do sleep 0.05; done
+
+./parp_bench -s "$SHM" -c "$COUNT" >"$LOG.shm1" &
+B1=$!
+./parp_bench -s "$SHM" -c "$COUNT" -S >"$LOG.shm2" &
+B2=$!
+./parp_bench -u "$SOCK" -c "$COUNT" >"$LOG.client" &
+B3=$!
+sleep 0.2
+
+./parp_sim -l "$TTY" -c "$COUNT" -r "$RATE" >/dev/null 2>"$LOG.sim" &
+SIM=$!
+
+wait $SIM || true
+wait $B1 $B2 $B3 || true
+kill -INT $DAEMON
+wait $DAEMON || true
+
+echo "== simulator";           cat "$LOG.sim"
+echo "== parpd";               grep -v "retrying" "$LOG.daemon" | tail -n 6
+echo "== ring consumer (futex wait)"; cat "$LOG.shm1"
+echo "== ring consumer (spin)";       cat "$LOG.shm2"
+echo "== socket consumer";            cat "$LOG.client"
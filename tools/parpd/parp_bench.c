@@ -0,0 +1,250 @@
+/**
+ * @file parp_bench.c
+ * @brief parpd consumer benchmark (shared-memory ring or UNIX socket)
+ *
+ * Attaches to parpd the way a real consumer would and reports what it
+ * saw: tags received, rate, reads missing from the reader's sequence
+ * (device gaps plus this consumer's own ring overruns) and latency:
+ *
+ *   ring  publish -> consume, from the slot's host_ns (us)
+ *   e2e   parp_sim frame build -> consume (ms; read_ms is the
+ *         simulator's CLOCK_MONOTONIC, so only meaningful against
+ *         parp_sim on the same machine)
+ *
+ * Usage:
+ *   parp_bench [-s /parpd | -u /tmp/parpd.sock] [-c count] [-t idle_s]
+ *              [-S] [-q]
+ *
+ *   -c  stop after this many tags (default: run until idle)
+ *   -t  stop after this many seconds without a tag once started
+ *       (default 3)
+ *   -S  spin on the ring instead of sleeping in parp_shm_wait()
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "parp_shm.h"
+
+#define MAX_SAMPLES     (1u << 20)
+
+struct bench {
+	uint64_t tags;
+	uint64_t gaps;
+	bool have_seq;
+	uint32_t next_seq;
+	uint64_t first_ns;
+	uint64_t last_ns;
+
+	uint32_t *ring_us;
+	uint32_t *e2e_ms;
+	size_t samples;
+};
+
+static uint64_t mono_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void account(struct bench *b, uint32_t seq, uint64_t host_ns,
+		    uint32_t read_ms)
+{
+	uint64_t now = mono_ns();
+
+	if (b->have_seq && seq != b->next_seq) {
+		b->gaps += (uint32_t)(seq - b->next_seq);
+	}
+	b->have_seq = true;
+	b->next_seq = seq + 1;
+
+	if (b->tags == 0) {
+		b->first_ns = now;
+	}
+	b->last_ns = now;
+	b->tags++;
+
+	if (b->samples < MAX_SAMPLES) {
+		uint64_t real = parp_shm_now_ns();
+
+		b->ring_us[b->samples] = host_ns && real > host_ns ?
+					 (uint32_t)((real - host_ns) / 1000) : 0;
+		b->e2e_ms[b->samples] = (uint32_t)(now / 1000000ull) - read_ms;
+		b->samples++;
+	}
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+static void print_pct(const char *name, uint32_t *v, size_t n,
+		      const char *unit)
+{
+	if (n == 0) {
+		return;
+	}
+	qsort(v, n, sizeof(*v), cmp_u32);
+	printf("  %-5s p50 %u %s, p99 %u %s, max %u %s\n", name, v[n / 2],
+	       unit, v[n * 99 / 100], unit, v[n - 1], unit);
+}
+
+static int run_shm(struct bench *b, const char *name, uint64_t count,
+		   int idle_s, bool spin)
+{
+	struct parp_shm_reader r;
+	struct parp_shm_tag tag;
+	uint64_t idle_since = mono_ns();
+	int err = parp_shm_reader_open(&r, name, true);
+
+	if (err < 0) {
+		fprintf(stderr, "parp_bench: %s: %s\n", name, strerror(-err));
+		return 1;
+	}
+
+	while (count == 0 || b->tags < count) {
+		if (parp_shm_read(&r, &tag) > 0) {
+			account(b, tag.dev_seq, tag.host_ns, tag.read_ms);
+			idle_since = 0;
+			continue;
+		}
+		if (idle_since == 0) {
+			idle_since = mono_ns();
+		}
+		if (b->tags > 0 &&
+		    mono_ns() - idle_since > (uint64_t)idle_s * 1000000000ull) {
+			break;
+		}
+		if (!spin) {
+			parp_shm_wait(&r, 100);
+		}
+	}
+
+	printf("shm %s: %u slots, overruns %llu, parpd dev_lost %llu\n", name,
+	       r.hdr->slot_count, (unsigned long long)r.overruns,
+	       (unsigned long long)atomic_load(&r.hdr->dev_lost));
+	parp_shm_reader_close(&r);
+	return 0;
+}
+
+static int run_socket(struct bench *b, const char *path, uint64_t count,
+		      int idle_s)
+{
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	static char buf[65536];
+	size_t have = 0;
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+	strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+	if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		fprintf(stderr, "parp_bench: %s: %s\n", path, strerror(errno));
+		return 1;
+	}
+
+	while (count == 0 || b->tags < count) {
+		struct pollfd pfd = { .fd = fd, .events = POLLIN };
+		int wait_ms = b->tags ? idle_s * 1000 : -1;
+
+		if (poll(&pfd, 1, wait_ms) <= 0) {
+			break;
+		}
+
+		ssize_t n = read(fd, buf + have, sizeof(buf) - have);
+
+		if (n <= 0) {
+			break;
+		}
+		have += (size_t)n;
+
+		char *line = buf, *nl;
+
+		while ((nl = memchr(line, '\n', have - (size_t)(line - buf)))) {
+			unsigned seq, rssi, ant, flags, read_ms;
+			char epc[2 * 64 + 1];
+
+			*nl = '\0';
+			if (sscanf(line, "%u %128s %u %u %u %u", &seq, epc, &rssi,
+				   &ant, &flags, &read_ms) == 6) {
+				account(b, seq, 0, read_ms);
+			}
+			line = nl + 1;
+		}
+		have -= (size_t)(line - buf);
+		memmove(buf, line, have);
+	}
+
+	printf("socket %s\n", path);
+	close(fd);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	static struct bench b;
+	const char *shm_name = PARP_SHM_DEFAULT_NAME;
+	const char *sock_path = NULL;
+	uint64_t count = 0;
+	int idle_s = 3, opt, err;
+	bool spin = false;
+
+	while ((opt = getopt(argc, argv, "s:u:c:t:Sh")) != -1) {
+		switch (opt) {
+		case 's':
+			shm_name = optarg;
+			break;
+		case 'u':
+			sock_path = optarg;
+			break;
+		case 'c':
+			count = strtoull(optarg, NULL, 0);
+			break;
+		case 't':
+			idle_s = atoi(optarg);
+			break;
+		case 'S':
+			spin = true;
+			break;
+		default:
+			fprintf(stderr, "usage: parp_bench [-s SHM | -u SOCKET] "
+				"[-c COUNT] [-t IDLE_S] [-S]\n");
+			return 2;
+		}
+	}
+
+	b.ring_us = calloc(MAX_SAMPLES, sizeof(uint32_t));
+	b.e2e_ms = calloc(MAX_SAMPLES, sizeof(uint32_t));
+	if (b.ring_us == NULL || b.e2e_ms == NULL) {
+		return 1;
+	}
+
+	err = sock_path ? run_socket(&b, sock_path, count, idle_s) :
+			  run_shm(&b, shm_name, count, idle_s, spin);
+	if (err) {
+		return err;
+	}
+
+	double secs = (double)(b.last_ns - b.first_ns) / 1e9;
+
+	printf("  tags  %llu in %.2f s (%.0f/s), missing %llu\n",
+	       (unsigned long long)b.tags, secs,
+	       secs > 0 ? (double)b.tags / secs : 0.0,
+	       (unsigned long long)b.gaps);
+	if (sock_path == NULL) {
+		print_pct("ring", b.ring_us, b.samples, "us");
+	}
+	print_pct("e2e", b.e2e_ms, b.samples, "ms");
+	return 0;
+}
@@ -0,0 +1,219 @@
+/**
+ * @file parp_proto.c
+ * @brief PARP-01 control protocol framing for host tools
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#include "parp_proto.h"
+
+#include <string.h>
+
+static uint16_t crc_table[256];
+
+static void crc_table_init(void)
+{
+	for (int i = 0; i < 256; i++) {
+		uint16_t crc = (uint16_t)(i << 8);
+
+		for (int j = 0; j < 8; j++) {
+			crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) :
+					       (uint16_t)(crc << 1);
+		}
+		crc_table[i] = crc;
+	}
+}
+
+uint16_t parp_crc16(const uint8_t *data, size_t len)
+{
+	uint16_t crc = 0xFFFF;
+
+	if (crc_table[1] == 0) {
+		crc_table_init();
+	}
+
+	for (size_t i = 0; i < len; i++) {
+		crc = (uint16_t)(crc << 8) ^ crc_table[(crc >> 8) ^ data[i]];
+	}
+	return crc;
+}
+
+static uint16_t get_le16(const uint8_t *p)
+{
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+	       ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+	put_le16(p, (uint16_t)v);
+	put_le16(p + 2, (uint16_t)(v >> 16));
+}
+
+size_t parp_encode_frame(uint8_t *out, uint8_t seq, uint8_t cmd,
+			 const uint8_t *payload, uint16_t len)
+{
+	out[0] = PARP_SOF;
+	put_le16(&out[1], len);
+	out[3] = seq;
+	out[4] = cmd;
+	if (len > 0) {
+		memcpy(&out[5], payload, len);
+	}
+	put_le16(&out[5 + len], parp_crc16(&out[1], 4 + (size_t)len));
+	return PARP_FRAME_OVERHEAD + len;
+}
+
+void parp_decoder_init(struct parp_decoder *d)
+{
+	memset(d, 0, sizeof(*d));
+}
+
+/** Check a complete frame starting at its SOF; 1 = good, 0 = bad */
+static int check_frame(struct parp_decoder *d, const uint8_t *f,
+		       parp_frame_cb_t cb, void *ctx)
+{
+	uint16_t len = get_le16(&f[1]);
+	struct parp_frame frame;
+
+	if (parp_crc16(&f[1], 4 + (size_t)len) != get_le16(&f[5 + len])) {
+		d->crc_errors++;
+		return 0;
+	}
+
+	frame.len = len;
+	frame.seq = f[3];
+	frame.cmd = f[4];
+	frame.payload = &f[5];
+	d->frames++;
+	cb(&frame, ctx);
+	return 1;
+}
+
+void parp_decoder_feed(struct parp_decoder *d, const uint8_t *data,
+		       size_t len, parp_frame_cb_t cb, void *ctx)
+{
+	while (len > 0) {
+		if (d->have == 0) {
+			const uint8_t *sof = memchr(data, PARP_SOF, len);
+
+			if (sof == NULL) {
+				d->skipped += len;
+				return;
+			}
+			d->skipped += (size_t)(sof - data);
+			len -= (size_t)(sof - data);
+			data = sof;
+
+			/* Whole frame in this buffer: no copy */
+			if (len >= 3) {
+				uint16_t plen = get_le16(&data[1]);
+				size_t total = PARP_FRAME_OVERHEAD + plen;
+
+				if (plen > PARP_MAX_PAYLOAD) {
+					d->len_errors++;
+					data++;
+					len--;
+					continue;
+				}
+				if (len >= total) {
+					check_frame(d, data, cb, ctx);
+					data += total;
+					len -= total;
+					continue;
+				}
+			}
+		}
+
+		/* Partial frame: collect the header, then the rest */
+		size_t need = 3;
+
+		if (d->have >= 3) {
+			need = PARP_FRAME_OVERHEAD + get_le16(&d->part[1]);
+		}
+
+		size_t n = need - d->have;
+
+		if (n > len) {
+			n = len;
+		}
+		memcpy(&d->part[d->have], data, n);
+		d->have += n;
+		data += n;
+		len -= n;
+
+		if (d->have == 3 && get_le16(&d->part[1]) > PARP_MAX_PAYLOAD) {
+			d->len_errors++;
+			d->have = 0;
+			continue;
+		}
+		if (d->have >= 3 &&
+		    d->have == PARP_FRAME_OVERHEAD + (size_t)get_le16(&d->part[1])) {
+			check_frame(d, d->part, cb, ctx);
+			d->have = 0;
+		}
+	}
+}
+
+int parp_decode_tags(const struct parp_frame *frame, struct parp_tag *out,
+		     int max)
+{
+	const uint8_t *p = frame->payload;
+	size_t pos = 1;
+	int count;
+
+	if (frame->len < 1) {
+		return -1;
+	}
+
+	count = p[0];
+	if (count > max) {
+		return -1;
+	}
+
+	for (int i = 0; i < count; i++) {
+		struct parp_tag *t = &out[i];
+
+		if (pos + PARP_TAG_REC_SIZE > frame->len) {
+			return -1;
+		}
+		t->seq = get_le32(&p[pos]);
+		t->read_ms = get_le32(&p[pos + 4]);
+		t->rssi = p[pos + 8];
+		t->antenna = p[pos + 9];
+		t->flags = p[pos + 10];
+		t->epc_len = p[pos + 11];
+		pos += PARP_TAG_REC_SIZE;
+
+		if (t->epc_len > PARP_EPC_MAX || pos + t->epc_len > frame->len) {
+			return -1;
+		}
+		memcpy(t->epc, &p[pos], t->epc_len);
+		pos += t->epc_len;
+	}
+
+	return count;
+}
+
+size_t parp_encode_tag(uint8_t *out, const struct parp_tag *tag)
+{
+	put_le32(&out[0], tag->seq);
+	put_le32(&out[4], tag->read_ms);
+	out[8] = tag->rssi;
+	out[9] = tag->antenna;
+	out[10] = tag->flags;
+	out[11] = tag->epc_len;
+	memcpy(&out[12], tag->epc, tag->epc_len);
+	return PARP_TAG_REC_SIZE + tag->epc_len;
+}
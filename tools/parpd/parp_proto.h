@@ -0,0 +1,121 @@
+/**
+ * @file parp_proto.h
+ * @brief PARP-01 control protocol framing for host tools
+ *
+ * Host-side mirror of the parts of src/ctrl_proto.h that parpd and its
+ * simulator need: frame encode/decode, the TAG_STREAM request and the
+ * EVT_TAGS event records. Keep in step with the firmware header.
+ *
+ * Frame (little endian):
+ *   [0xA5][len u16][seq u8][cmd u8][payload: len bytes][crc u16]
+ *   crc = CRC-16/CCITT-FALSE over len..payload
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#ifndef PARP_PROTO_H_
+#define PARP_PROTO_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PARP_SOF                0xA5
+#define PARP_MAX_PAYLOAD        1024
+#define PARP_FRAME_OVERHEAD     7
+#define PARP_FRAME_MAX          (PARP_FRAME_OVERHEAD + PARP_MAX_PAYLOAD)
+#define PARP_RSP_FLAG           0x80
+
+#define PARP_CMD_IDENT          0x01
+#define PARP_CMD_TAG_STREAM     0x40
+#define PARP_EVT_TAGS           0xF0
+
+#define PARP_ST_OK              0
+#define PARP_ST_UNKNOWN_CMD     1
+
+/** Tag event flags (CTRL_TAG_F_*) */
+#define PARP_TAG_F_NEW          0x01
+#define PARP_TAG_F_DELIVERED    0x02
+
+/** Longest EPC the reader reports */
+#define PARP_EPC_MAX            62
+
+/** EVT_TAGS record header size (ctrl_tag_rec_t) */
+#define PARP_TAG_REC_SIZE       12
+
+/**
+ * @brief Decoded frame (payload points into the decoder or caller buffer)
+ */
+struct parp_frame {
+	uint8_t seq;
+	uint8_t cmd;
+	uint16_t len;
+	const uint8_t *payload;
+};
+
+/**
+ * @brief One tag read from an EVT_TAGS frame
+ */
+struct parp_tag {
+	uint32_t seq;                   /**< Reader event sequence number */
+	uint32_t read_ms;               /**< Reader uptime of the read */
+	uint8_t rssi;
+	uint8_t antenna;                /**< Antenna bitmask */
+	uint8_t flags;                  /**< PARP_TAG_F_* */
+	uint8_t epc_len;
+	uint8_t epc[PARP_EPC_MAX];
+};
+
+typedef void (*parp_frame_cb_t)(const struct parp_frame *frame, void *ctx);
+
+/**
+ * @brief Incremental frame decoder
+ *
+ * Frames wholly inside one feed() buffer are decoded in place; only a
+ * frame split across reads is copied.
+ */
+struct parp_decoder {
+	uint8_t part[PARP_FRAME_MAX];   /**< Frame split across feeds */
+	size_t have;                    /**< Bytes in part (0 = hunting SOF) */
+	uint64_t frames;
+	uint64_t crc_errors;
+	uint64_t len_errors;
+	uint64_t skipped;               /**< Bytes outside any frame */
+};
+
+/** CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) */
+uint16_t parp_crc16(const uint8_t *data, size_t len);
+
+/**
+ * @brief Build a frame
+ *
+ * @param out Output, at least PARP_FRAME_OVERHEAD + len bytes
+ * @return Frame length
+ */
+size_t parp_encode_frame(uint8_t *out, uint8_t seq, uint8_t cmd,
+			 const uint8_t *payload, uint16_t len);
+
+void parp_decoder_init(struct parp_decoder *d);
+
+/**
+ * @brief Feed received bytes; cb runs once per good frame
+ */
+void parp_decoder_feed(struct parp_decoder *d, const uint8_t *data,
+		       size_t len, parp_frame_cb_t cb, void *ctx);
+
+/**
+ * @brief Decode the records of an EVT_TAGS frame
+ *
+ * @return Records written to out (at most max), -1 if malformed
+ */
+int parp_decode_tags(const struct parp_frame *frame, struct parp_tag *out,
+		     int max);
+
+/**
+ * @brief Append one EVT_TAGS record to a payload being built
+ *
+ * @return Bytes written
+ */
+size_t parp_encode_tag(uint8_t *out, const struct parp_tag *tag);
+
+#endif /* PARP_PROTO_H_ */
@@ -0,0 +1,293 @@
+/**
+ * @file parp_shm.h
+ * @brief parpd shared-memory tag ring (single writer, many readers)
+ *
+ * parpd publishes every tag read into a POSIX shared-memory ring
+ * (/dev/shm/<name>, default "/parpd"). Any number of local processes
+ * read it without locks and without talking to parpd:
+ *
+ *   struct parp_shm_reader r;
+ *   struct parp_shm_tag tag;
+ *
+ *   parp_shm_reader_open(&r, "/parpd", true);
+ *   for (;;) {
+ *       while (parp_shm_read(&r, &tag) > 0) {
+ *           ...
+ *       }
+ *       parp_shm_wait(&r, 1000);
+ *   }
+ *
+ * Each slot carries a sequence word (seqlock): 2*pos+1 while parpd
+ * writes it, 2*pos+2 once done. A reader copies the slot and checks the
+ * word before and after; a reader that falls more than slot_count
+ * behind is moved to the oldest live slot and the skipped reads are
+ * counted in overruns. Readers never slow the writer down.
+ *
+ * parp_shm_wait() sleeps on a futex in the header; parpd only issues
+ * the wake syscall when a reader is actually waiting, once per batch
+ * read from the reader port.
+ *
+ * Header-only so consumers need nothing but this file (link -lrt on
+ * older glibc).
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#ifndef PARP_SHM_H_
+#define PARP_SHM_H_
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PARP_SHM_MAGIC          0x50524150u     /* "PARP" */
+#define PARP_SHM_VERSION        1
+#define PARP_SHM_DEFAULT_NAME   "/parpd"
+#define PARP_SHM_DEFAULT_SLOTS  16384
+
+/**
+ * @brief Tag as stored in a slot
+ */
+struct parp_shm_tag {
+	uint64_t host_ns;               /**< CLOCK_REALTIME when parpd received it */
+	uint32_t dev_seq;               /**< Reader event sequence number */
+	uint32_t read_ms;               /**< Reader uptime of the read */
+	uint8_t rssi;
+	uint8_t antenna;                /**< Antenna bitmask */
+	uint8_t flags;                  /**< PARP_TAG_F_* */
+	uint8_t epc_len;
+	uint8_t epc[64];
+	uint8_t reserved[4];
+};
+
+struct parp_shm_slot {
+	_Atomic uint64_t seq;           /**< 2*pos+1 writing, 2*pos+2 done */
+	struct parp_shm_tag tag;
+};
+
+_Static_assert(sizeof(struct parp_shm_slot) == 96, "slot layout");
+
+struct parp_shm_hdr {
+	uint32_t magic;                 /**< PARP_SHM_MAGIC once initialised */
+	uint32_t version;               /**< PARP_SHM_VERSION */
+	uint32_t slot_size;             /**< sizeof(struct parp_shm_slot) */
+	uint32_t slot_count;            /**< Power of two */
+	uint64_t start_ns;              /**< CLOCK_REALTIME when parpd started */
+	uint32_t writer_pid;
+
+	alignas(64) _Atomic uint64_t head;      /**< Slots published so far */
+	_Atomic uint64_t dev_lost;      /**< Reads missing in the reader's seq */
+	_Atomic uint32_t link_up;       /**< Reader port open and streaming */
+
+	alignas(64) _Atomic uint32_t wake;      /**< Futex word, bumped per batch */
+	_Atomic uint32_t waiters;       /**< Readers in parp_shm_wait() */
+
+	alignas(64) struct parp_shm_slot slots[];
+};
+
+static inline size_t parp_shm_size(uint32_t slot_count)
+{
+	return sizeof(struct parp_shm_hdr) +
+	       (size_t)slot_count * sizeof(struct parp_shm_slot);
+}
+
+static inline uint64_t parp_shm_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* ========================================================================
+ * Writer (parpd)
+ * ======================================================================== */
+
+/**
+ * @brief Publish one tag (single writer only)
+ */
+static inline void parp_shm_publish(struct parp_shm_hdr *hdr,
+				    const struct parp_shm_tag *tag)
+{
+	uint64_t pos = atomic_load_explicit(&hdr->head, memory_order_relaxed);
+	struct parp_shm_slot *slot = &hdr->slots[pos & (hdr->slot_count - 1)];
+
+	atomic_store_explicit(&slot->seq, 2 * pos + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	slot->tag = *tag;
+	atomic_store_explicit(&slot->seq, 2 * pos + 2, memory_order_release);
+	atomic_store_explicit(&hdr->head, pos + 1, memory_order_release);
+}
+
+/**
+ * @brief Wake readers blocked in parp_shm_wait() (after a batch)
+ */
+static inline void parp_shm_wake(struct parp_shm_hdr *hdr)
+{
+	/*
+	 * Store head, load waiters here; add waiters, load head in
+	 * parp_shm_wait(). Release/acquire does not order a store before a
+	 * later load: without a full fence on both sides each could miss
+	 * the other and the reader would sleep out its timeout.
+	 */
+	atomic_thread_fence(memory_order_seq_cst);
+	if (atomic_load(&hdr->waiters) == 0) {
+		return;
+	}
+	atomic_fetch_add(&hdr->wake, 1);
+	syscall(SYS_futex, &hdr->wake, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/* ========================================================================
+ * Reader
+ * ======================================================================== */
+
+struct parp_shm_reader {
+	struct parp_shm_hdr *hdr;
+	size_t map_len;
+	uint64_t pos;                   /**< Next slot to read */
+	uint64_t overruns;              /**< Reads lost by falling behind */
+};
+
+/**
+ * @brief Attach to parpd's ring
+ *
+ * @param r Reader state
+ * @param name Shared-memory name (PARP_SHM_DEFAULT_NAME)
+ * @param from_now true: only tags published from now on; false: also
+ *        whatever is still in the ring
+ * @return 0 on success, -errno (-EPROTO: not a parpd ring of this version)
+ */
+static inline int parp_shm_reader_open(struct parp_shm_reader *r,
+				       const char *name, bool from_now)
+{
+	struct parp_shm_hdr *hdr;
+	struct stat st;
+	uint64_t head;
+	int fd;
+
+	memset(r, 0, sizeof(*r));
+
+	/* Read-write: readers update the futex waiter count */
+	fd = shm_open(name, O_RDWR, 0);
+	if (fd < 0) {
+		return -errno;
+	}
+	if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(*hdr)) {
+		close(fd);
+		return -EPROTO;
+	}
+
+	hdr = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE,
+		   MAP_SHARED, fd, 0);
+	close(fd);
+	if (hdr == MAP_FAILED) {
+		return -errno;
+	}
+	if (hdr->magic != PARP_SHM_MAGIC || hdr->version != PARP_SHM_VERSION ||
+	    hdr->slot_size != sizeof(struct parp_shm_slot) ||
+	    (size_t)st.st_size < parp_shm_size(hdr->slot_count)) {
+		munmap(hdr, (size_t)st.st_size);
+		return -EPROTO;
+	}
+
+	r->hdr = hdr;
+	r->map_len = (size_t)st.st_size;
+
+	head = atomic_load_explicit(&hdr->head, memory_order_acquire);
+	if (from_now) {
+		r->pos = head;
+	} else {
+		r->pos = head > hdr->slot_count ? head - hdr->slot_count : 0;
+	}
+	return 0;
+}
+
+static inline void parp_shm_reader_close(struct parp_shm_reader *r)
+{
+	if (r->hdr != NULL) {
+		munmap(r->hdr, r->map_len);
+		r->hdr = NULL;
+	}
+}
+
+/**
+ * @brief Take the next tag
+ *
+ * @return 1 tag copied to out, 0 nothing new
+ */
+static inline int parp_shm_read(struct parp_shm_reader *r,
+				struct parp_shm_tag *out)
+{
+	struct parp_shm_hdr *hdr = r->hdr;
+
+	for (;;) {
+		uint64_t head = atomic_load_explicit(&hdr->head,
+						     memory_order_acquire);
+		struct parp_shm_slot *slot;
+		uint64_t s1, s2;
+
+		if (r->pos >= head) {
+			return 0;
+		}
+		if (head - r->pos > hdr->slot_count) {
+			r->overruns += head - hdr->slot_count - r->pos;
+			r->pos = head - hdr->slot_count;
+		}
+
+		slot = &hdr->slots[r->pos & (hdr->slot_count - 1)];
+		s1 = atomic_load_explicit(&slot->seq, memory_order_acquire);
+		if (s1 == 2 * r->pos + 2) {
+			*out = slot->tag;
+			atomic_thread_fence(memory_order_acquire);
+			s2 = atomic_load_explicit(&slot->seq,
+						  memory_order_relaxed);
+			if (s2 == s1) {
+				r->pos++;
+				return 1;
+			}
+		}
+
+		/* Overwritten under us: the writer lapped this reader */
+		r->overruns++;
+		r->pos++;
+	}
+}
+
+/**
+ * @brief Sleep until parpd publishes more tags or timeout_ms passes
+ *
+ * @return 0 (check parp_shm_read() again either way)
+ */
+static inline int parp_shm_wait(struct parp_shm_reader *r, int timeout_ms)
+{
+	struct parp_shm_hdr *hdr = r->hdr;
+	struct timespec ts = {
+		.tv_sec = timeout_ms / 1000,
+		.tv_nsec = (long)(timeout_ms % 1000) * 1000000L,
+	};
+	uint32_t word;
+
+	atomic_fetch_add(&hdr->waiters, 1);
+	atomic_thread_fence(memory_order_seq_cst);  /* Pairs with parp_shm_wake() */
+	word = atomic_load(&hdr->wake);
+	if (atomic_load(&hdr->head) == r->pos) {
+		syscall(SYS_futex, &hdr->wake, FUTEX_WAIT, word,
+			timeout_ms < 0 ? NULL : &ts, NULL, 0);
+	}
+	atomic_fetch_sub(&hdr->waiters, 1);
+	return 0;
+}
+
+#endif /* PARP_SHM_H_ */
@@ -0,0 +1,322 @@
+/**
+ * @file parp_sim.c
+ * @brief PARP-01 control port simulator on a pseudo-terminal
+ *
+ * Stands in for the reader's control port so parpd can be run and
+ * benchmarked without hardware. Answers TAG_STREAM like the firmware
+ * (every other request gets UNKNOWN_CMD) and, once the stream is on,
+ * sends EVT_TAGS frames with the same packing the firmware uses: up to
+ * -b reads per frame, capped at the payload limit.
+ *
+ * Usage:
+ *   parp_sim [-l /tmp/parp_sim.tty] [-r tags_per_s] [-c count]
+ *            [-b per_frame] [-e epc_len] [-p population] [-x corrupt_every]
+ *
+ *   -r 0 sends as fast as the pty takes it. The pty applies back-pressure
+ *   like the USB endpoint does, so a slow parpd slows the simulator down
+ *   instead of losing bytes; -x N corrupts every Nth frame's CRC to
+ *   exercise the decoder's resync and parpd's gap counter.
+ *
+ * Prints the slave path (and creates the -l symlink), then a summary
+ * line when done.
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "parp_proto.h"
+
+struct sim {
+	int master;
+	double rate;
+	uint64_t count;
+	int per_frame;
+	int epc_len;
+	uint32_t population;
+	uint64_t corrupt_every;
+
+	bool streaming;
+	uint32_t seq;
+	uint64_t frames;
+	uint64_t bytes;
+	struct parp_decoder dec;
+};
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig)
+{
+	(void)sig;
+	stop = 1;
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int write_all(int fd, const uint8_t *buf, size_t len)
+{
+	while (len > 0) {
+		ssize_t n = write(fd, buf, len);
+
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno == EAGAIN) {
+				struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+
+				poll(&pfd, 1, 100);
+				if (stop) {
+					return -EINTR;
+				}
+				continue;
+			}
+			return -errno;
+		}
+		buf += n;
+		len -= (size_t)n;
+	}
+	return 0;
+}
+
+static void on_request(const struct parp_frame *f, void *ctx)
+{
+	struct sim *s = ctx;
+	uint8_t rsp[PARP_FRAME_OVERHEAD + 5];
+	uint8_t payload[5] = { PARP_ST_UNKNOWN_CMD };
+	uint16_t len = 1;
+
+	if (f->cmd == PARP_CMD_TAG_STREAM && f->len >= 1) {
+		s->streaming = f->payload[0] != 0;
+		s->seq = 0;
+		payload[0] = PARP_ST_OK;
+		memset(&payload[1], 0, 4);  /* next event seq, LE */
+		len = 5;
+		fprintf(stderr, "parp_sim: tag stream %s\n",
+			s->streaming ? "on" : "off");
+	}
+
+	size_t n = parp_encode_frame(rsp, f->seq, f->cmd | PARP_RSP_FLAG,
+				     payload, len);
+
+	write_all(s->master, rsp, n);
+}
+
+static void poll_requests(struct sim *s, int timeout_ms)
+{
+	struct pollfd pfd = { .fd = s->master, .events = POLLIN };
+	uint8_t buf[4096];
+
+	if (poll(&pfd, 1, timeout_ms) <= 0 || !(pfd.revents & POLLIN)) {
+		return;
+	}
+
+	ssize_t n = read(s->master, buf, sizeof(buf));
+
+	if (n > 0) {
+		parp_decoder_feed(&s->dec, buf, (size_t)n, on_request, s);
+	}
+}
+
+/** Build and send one EVT_TAGS frame of n reads */
+static int send_tags(struct sim *s, int n)
+{
+	uint8_t payload[PARP_MAX_PAYLOAD];
+	uint8_t frame[PARP_FRAME_MAX];
+	size_t len = 1;
+	int count = 0;
+	uint32_t ms = (uint32_t)(now_ns() / 1000000ull);
+
+	for (; count < n; count++) {
+		struct parp_tag t = {
+			.seq = s->seq,
+			.read_ms = ms,
+			.rssi = (uint8_t)(40 + s->seq % 40),
+			.antenna = (uint8_t)(1u << (s->seq % 4)),
+			.flags = PARP_TAG_F_DELIVERED,
+			.epc_len = (uint8_t)s->epc_len,
+		};
+		uint32_t id = s->seq % s->population;
+
+		if (len + PARP_TAG_REC_SIZE + t.epc_len > PARP_MAX_PAYLOAD) {
+			break;
+		}
+		memset(t.epc, 0, t.epc_len);
+		t.epc[0] = 0xE2;
+		for (int i = 0; i < 4 && i < t.epc_len - 1; i++) {
+			t.epc[t.epc_len - 1 - i] = (uint8_t)(id >> (8 * i));
+		}
+		if (s->seq < s->population) {
+			t.flags |= PARP_TAG_F_NEW;
+		}
+		len += parp_encode_tag(&payload[len], &t);
+		s->seq++;
+	}
+	payload[0] = (uint8_t)count;
+
+	size_t flen = parp_encode_frame(frame, 0, PARP_EVT_TAGS, payload,
+					(uint16_t)len);
+
+	s->frames++;
+	if (s->corrupt_every && s->frames % s->corrupt_every == 0) {
+		frame[flen - 1] ^= 0xFF;
+	}
+	s->bytes += flen;
+	return write_all(s->master, frame, flen) < 0 ? -1 : count;
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: parp_sim [-l LINK] [-r RATE] [-c COUNT] [-b PER_FRAME] "
+		"[-e EPC_LEN] [-p POPULATION] [-x CORRUPT_EVERY]\n");
+}
+
+int main(int argc, char **argv)
+{
+	static struct sim s = {
+		.rate = 1000,
+		.per_frame = 40,
+		.epc_len = 12,
+		.population = 1000,
+	};
+	const char *link_path = NULL;
+	struct termios tio;
+	uint64_t start = 0, sent = 0;
+	char *slave;
+	int slave_fd, opt;
+
+	while ((opt = getopt(argc, argv, "l:r:c:b:e:p:x:h")) != -1) {
+		switch (opt) {
+		case 'l':
+			link_path = optarg;
+			break;
+		case 'r':
+			s.rate = atof(optarg);
+			break;
+		case 'c':
+			s.count = strtoull(optarg, NULL, 0);
+			break;
+		case 'b':
+			s.per_frame = atoi(optarg);
+			break;
+		case 'e':
+			s.epc_len = atoi(optarg);
+			break;
+		case 'p':
+			s.population = (uint32_t)strtoul(optarg, NULL, 0);
+			break;
+		case 'x':
+			s.corrupt_every = strtoull(optarg, NULL, 0);
+			break;
+		default:
+			usage();
+			return 2;
+		}
+	}
+	if (s.per_frame < 1 || s.per_frame > 255 || s.epc_len < 2 ||
+	    s.epc_len > PARP_EPC_MAX || s.population == 0) {
+		usage();
+		return 2;
+	}
+
+	s.master = posix_openpt(O_RDWR | O_NOCTTY);
+	if (s.master < 0 || grantpt(s.master) < 0 || unlockpt(s.master) < 0) {
+		perror("parp_sim: posix_openpt");
+		return 1;
+	}
+	slave = ptsname(s.master);
+
+	/* Keep a raw slave open: no line discipline mangling, and the
+	 * master does not see EIO before parpd connects */
+	slave_fd = open(slave, O_RDWR | O_NOCTTY);
+	if (slave_fd < 0 || tcgetattr(slave_fd, &tio) < 0) {
+		perror("parp_sim: slave");
+		return 1;
+	}
+	cfmakeraw(&tio);
+	tcsetattr(slave_fd, TCSANOW, &tio);
+	fcntl(s.master, F_SETFL, fcntl(s.master, F_GETFL) | O_NONBLOCK);
+
+	if (link_path != NULL) {
+		unlink(link_path);
+		if (symlink(slave, link_path) < 0) {
+			perror("parp_sim: symlink");
+			return 1;
+		}
+	}
+	printf("%s\n", slave);
+	fflush(stdout);
+
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+	parp_decoder_init(&s.dec);
+
+	while (!stop && (s.count == 0 || sent < s.count)) {
+		if (!s.streaming) {
+			poll_requests(&s, 100);
+			start = now_ns();
+			sent = 0;
+			continue;
+		}
+		poll_requests(&s, 0);
+
+		int n = s.per_frame;
+
+		if (s.count && s.count - sent < (uint64_t)n) {
+			n = (int)(s.count - sent);
+		}
+		n = send_tags(&s, n);
+		if (n < 0) {
+			break;
+		}
+		sent += (uint64_t)n;
+
+		/* Pace against the start so sleep granularity does not add up */
+		if (s.rate > 0) {
+			uint64_t due = start + (uint64_t)((double)sent * 1e9 / s.rate);
+			uint64_t now = now_ns();
+
+			if (due > now) {
+				struct timespec ts = {
+					.tv_sec = (time_t)((due - now) / 1000000000ull),
+					.tv_nsec = (long)((due - now) % 1000000000ull),
+				};
+
+				nanosleep(&ts, NULL);
+			}
+		}
+	}
+
+	double secs = start ? (double)(now_ns() - start) / 1e9 : 0;
+
+	fprintf(stderr, "parp_sim: sent %llu tags in %llu frames, %llu bytes, "
+		"%.2f s (%.0f tags/s)\n", (unsigned long long)sent,
+		(unsigned long long)s.frames, (unsigned long long)s.bytes, secs,
+		secs > 0 ? (double)sent / secs : 0.0);
+
+	/* Let parpd drain the pty before the slave goes away */
+	sleep(1);
+	if (link_path != NULL) {
+		unlink(link_path);
+	}
+	close(slave_fd);
+	close(s.master);
+	return 0;
+}
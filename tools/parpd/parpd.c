@@ -0,0 +1,668 @@
+/**
+ * @file parpd.c
+ * @brief PARP-01 host daemon: tag stream to shared memory and UNIX socket
+ *
+ * Opens the reader's control port (the second CDC ACM interface,
+ * cdc_acm_uart1), turns on the tag stream (CTRL_CMD_TAG_STREAM) and
+ * republishes every tag read to local consumers two ways:
+ *
+ *   - shared memory ring (parp_shm.h): lock-free, any number of readers,
+ *     for consumers that keep up with the full rate
+ *   - UNIX stream socket: one text line per read, for scripts
+ *       <dev_seq> <EPC hex> <rssi> <antenna> <flags> <read_ms>\n
+ *     e.g. `socat - UNIX-CONNECT:/tmp/parpd.sock`
+ *
+ * One thread, one epoll set: the serial port, the listening socket,
+ * every client, a signalfd and a 1 s timerfd (stats, reconnect). The
+ * port is drained in 64 KiB reads until EAGAIN and each batch is
+ * published before the next epoll_wait, so a burst costs one wakeup.
+ * A client that cannot keep up loses lines (counted per client) rather
+ * than holding up the port or the other clients.
+ *
+ * If the reader is unplugged the daemon keeps the ring and clients and
+ * reopens the port every second; the stream is turned on again on each
+ * open (the reader turns it off when the port closes).
+ *
+ * Usage:
+ *   parpd -d /dev/ttyACM1 [-s /parpd] [-u /tmp/parpd.sock] [-n slots]
+ *         [-i stats_s] [-q]
+ *
+ * Test without hardware: parp_sim (pty reader simulator), parp_bench
+ * (consumer); `make bench` runs all three.
+ *
+ * @copyright Copyright (c) 2026 PARP
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "parp_proto.h"
+#include "parp_shm.h"
+
+#define READ_CHUNK          65536
+#define CLIENT_BUF_SIZE     65536
+#define MAX_CLIENTS         64
+#define MAX_EVENTS          32
+#define LINE_MAX_LEN        (32 + 2 * PARP_EPC_MAX)
+#define EVT_TAGS_MAX        255
+
+/* epoll tags (clients use their slot pointer) */
+#define TAG_PORT            ((void *)1)
+#define TAG_LISTEN          ((void *)2)
+#define TAG_SIGNAL          ((void *)3)
+#define TAG_TIMER           ((void *)4)
+
+struct client {
+	int fd;
+	bool want_out;                  /**< EPOLLOUT armed */
+	size_t len;                     /**< Pending bytes at buf[0..len) */
+	uint64_t lines;
+	uint64_t dropped;               /**< Lines lost to a full buffer */
+	char buf[CLIENT_BUF_SIZE];
+};
+
+struct parpd {
+	const char *dev;
+	const char *shm_name;
+	const char *sock_path;
+	uint32_t slots;
+	int stats_interval;
+	bool quiet;
+
+	int epfd;
+	int port_fd;
+	int listen_fd;
+	int signal_fd;
+	int timer_fd;
+	bool streaming;                 /**< TAG_STREAM acknowledged */
+	uint8_t req_seq;
+	int enable_age;                 /**< Seconds since the last enable */
+
+	struct parp_shm_hdr *shm;
+	struct parp_decoder dec;
+	struct client *clients[MAX_CLIENTS];
+	int nclients;
+
+	bool have_seq;
+	uint32_t next_seq;              /**< Expected reader event seq */
+
+	/* Totals */
+	uint64_t tags;
+	uint64_t bytes_in;
+	uint64_t reads;
+	uint64_t reopens;
+	uint64_t client_drops;
+	uint64_t last_tags;
+	int stats_age;
+};
+
+static void logmsg(const struct parpd *d, const char *fmt, ...)
+{
+	va_list ap;
+
+	if (d->quiet) {
+		return;
+	}
+	va_start(ap, fmt);
+	fputs("parpd: ", stderr);
+	vfprintf(stderr, fmt, ap);
+	fputc('\n', stderr);
+	va_end(ap);
+}
+
+/* ========================================================================
+ * Shared Memory
+ * ======================================================================== */
+
+static int shm_create(struct parpd *d)
+{
+	size_t size = parp_shm_size(d->slots);
+	struct parp_shm_hdr *hdr;
+	int fd;
+
+	shm_unlink(d->shm_name);
+	fd = shm_open(d->shm_name, O_RDWR | O_CREAT | O_EXCL, 0666);
+	if (fd < 0) {
+		return -errno;
+	}
+	/* Readers map it read-write for the futex; do not let umask stop them */
+	fchmod(fd, 0666);
+	if (ftruncate(fd, (off_t)size) < 0) {
+		int err = -errno;
+
+		close(fd);
+		shm_unlink(d->shm_name);
+		return err;
+	}
+
+	hdr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (hdr == MAP_FAILED) {
+		shm_unlink(d->shm_name);
+		return -errno;
+	}
+
+	hdr->version = PARP_SHM_VERSION;
+	hdr->slot_size = sizeof(struct parp_shm_slot);
+	hdr->slot_count = d->slots;
+	hdr->start_ns = parp_shm_now_ns();
+	hdr->writer_pid = (uint32_t)getpid();
+	atomic_thread_fence(memory_order_release);
+	hdr->magic = PARP_SHM_MAGIC;
+
+	d->shm = hdr;
+	return 0;
+}
+
+/* ========================================================================
+ * Clients
+ * ======================================================================== */
+
+static void client_close(struct parpd *d, int idx)
+{
+	struct client *c = d->clients[idx];
+
+	d->client_drops += c->dropped;
+	epoll_ctl(d->epfd, EPOLL_CTL_DEL, c->fd, NULL);
+	close(c->fd);
+	logmsg(d, "client %d closed (%llu lines, %llu dropped)", c->fd,
+	       (unsigned long long)c->lines, (unsigned long long)c->dropped);
+	free(c);
+	d->clients[idx] = d->clients[--d->nclients];
+}
+
+static void client_accept(struct parpd *d)
+{
+	for (;;) {
+		int fd = accept4(d->listen_fd, NULL, NULL,
+				 SOCK_NONBLOCK | SOCK_CLOEXEC);
+		struct epoll_event ev = { .events = EPOLLIN };
+		struct client *c;
+
+		if (fd < 0) {
+			return;
+		}
+		if (d->nclients == MAX_CLIENTS) {
+			close(fd);
+			continue;
+		}
+		c = calloc(1, sizeof(*c));
+		if (c == NULL) {
+			close(fd);
+			continue;
+		}
+		c->fd = fd;
+		ev.data.ptr = c;
+		epoll_ctl(d->epfd, EPOLL_CTL_ADD, fd, &ev);
+		d->clients[d->nclients++] = c;
+		logmsg(d, "client %d connected", fd);
+	}
+}
+
+/** Write what is pending; false if the client went away */
+static bool client_flush(struct parpd *d, struct client *c)
+{
+	size_t off = 0;
+	bool want_out;
+
+	while (off < c->len) {
+		ssize_t n = send(c->fd, c->buf + off, c->len - off,
+				 MSG_NOSIGNAL | MSG_DONTWAIT);
+
+		if (n < 0) {
+			if (errno == EAGAIN || errno == EINTR) {
+				break;
+			}
+			return false;
+		}
+		off += (size_t)n;
+	}
+	if (off > 0) {
+		memmove(c->buf, c->buf + off, c->len - off);
+		c->len -= off;
+	}
+
+	want_out = c->len > 0;
+	if (want_out != c->want_out) {
+		struct epoll_event ev = {
+			.events = EPOLLIN | (want_out ? EPOLLOUT : 0),
+			.data.ptr = c,
+		};
+
+		epoll_ctl(d->epfd, EPOLL_CTL_MOD, c->fd, &ev);
+		c->want_out = want_out;
+	}
+	return true;
+}
+
+static void client_event(struct parpd *d, struct client *c, uint32_t events)
+{
+	int idx;
+
+	for (idx = 0; idx < d->nclients; idx++) {
+		if (d->clients[idx] == c) {
+			break;
+		}
+	}
+	if (idx == d->nclients) {
+		return;         /* closed earlier in this epoll batch */
+	}
+
+	if (events & EPOLLIN) {
+		char sink[256];
+		ssize_t n = recv(c->fd, sink, sizeof(sink), MSG_DONTWAIT);
+
+		/* Clients have nothing to say; EOF means they are gone */
+		if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+			client_close(d, idx);
+			return;
+		}
+	}
+	if (events & (EPOLLHUP | EPOLLERR)) {
+		client_close(d, idx);
+		return;
+	}
+	if ((events & EPOLLOUT) && !client_flush(d, c)) {
+		client_close(d, idx);
+	}
+}
+
+/* ========================================================================
+ * Reader Port
+ * ======================================================================== */
+
+static void port_send_enable(struct parpd *d)
+{
+	uint8_t frame[PARP_FRAME_OVERHEAD + 1];
+	uint8_t on = 1;
+	size_t len = parp_encode_frame(frame, ++d->req_seq,
+				       PARP_CMD_TAG_STREAM, &on, 1);
+
+	if (write(d->port_fd, frame, len) != (ssize_t)len) {
+		logmsg(d, "%s: enable write failed", d->dev);
+	}
+	d->enable_age = 0;
+}
+
+static int port_open(struct parpd *d)
+{
+	struct epoll_event ev = { .events = EPOLLIN, .data.ptr = TAG_PORT };
+	struct termios tio;
+	int fd;
+
+	fd = open(d->dev, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+	if (fd < 0) {
+		return -errno;
+	}
+
+	/* Raw; the baud rate means nothing on CDC ACM. Opening raises DTR,
+	 * which the reader needs before it sends events. */
+	if (tcgetattr(fd, &tio) == 0) {
+		cfmakeraw(&tio);
+		tio.c_cflag |= CLOCAL | CREAD;
+		tio.c_cc[VMIN] = 1;
+		tio.c_cc[VTIME] = 0;
+		cfsetspeed(&tio, B115200);
+		tcsetattr(fd, TCSANOW, &tio);
+	}
+	tcflush(fd, TCIFLUSH);
+
+	d->port_fd = fd;
+	d->streaming = false;
+	d->have_seq = false;
+	parp_decoder_init(&d->dec);
+	epoll_ctl(d->epfd, EPOLL_CTL_ADD, fd, &ev);
+	atomic_store(&d->shm->link_up, 1);
+
+	port_send_enable(d);
+	logmsg(d, "%s open", d->dev);
+	return 0;
+}
+
+static void port_close(struct parpd *d, const char *why)
+{
+	epoll_ctl(d->epfd, EPOLL_CTL_DEL, d->port_fd, NULL);
+	close(d->port_fd);
+	d->port_fd = -1;
+	d->streaming = false;
+	atomic_store(&d->shm->link_up, 0);
+	logmsg(d, "%s closed (%s), retrying every second", d->dev, why);
+}
+
+static size_t format_line(char *out, const struct parp_tag *t)
+{
+	static const char hex[] = "0123456789ABCDEF";
+	char *p = out;
+
+	p += sprintf(p, "%u ", t->seq);
+	for (int i = 0; i < t->epc_len; i++) {
+		*p++ = hex[t->epc[i] >> 4];
+		*p++ = hex[t->epc[i] & 0x0F];
+	}
+	p += sprintf(p, " %u %u %u %u\n", t->rssi, t->antenna, t->flags,
+		     t->read_ms);
+	return (size_t)(p - out);
+}
+
+static void publish_tags(struct parpd *d, const struct parp_tag *tags,
+			 int count)
+{
+	uint64_t now = parp_shm_now_ns();
+
+	for (int i = 0; i < count; i++) {
+		const struct parp_tag *t = &tags[i];
+		struct parp_shm_tag rec = {
+			.host_ns = now,
+			.dev_seq = t->seq,
+			.read_ms = t->read_ms,
+			.rssi = t->rssi,
+			.antenna = t->antenna,
+			.flags = t->flags,
+			.epc_len = t->epc_len,
+		};
+
+		memcpy(rec.epc, t->epc, t->epc_len);
+		parp_shm_publish(d->shm, &rec);
+
+		if (d->have_seq && t->seq != d->next_seq) {
+			atomic_fetch_add(&d->shm->dev_lost,
+					 (uint32_t)(t->seq - d->next_seq));
+		}
+		d->have_seq = true;
+		d->next_seq = t->seq + 1;
+
+		if (d->nclients > 0) {
+			char line[LINE_MAX_LEN];
+			size_t len = format_line(line, t);
+
+			for (int j = 0; j < d->nclients; j++) {
+				struct client *c = d->clients[j];
+
+				if (c->len + len > CLIENT_BUF_SIZE) {
+					c->dropped++;
+					continue;
+				}
+				memcpy(c->buf + c->len, line, len);
+				c->len += len;
+				c->lines++;
+			}
+		}
+	}
+	d->tags += (uint64_t)count;
+}
+
+static void on_frame(const struct parp_frame *f, void *ctx)
+{
+	struct parpd *d = ctx;
+
+	if (f->cmd == PARP_EVT_TAGS) {
+		struct parp_tag tags[EVT_TAGS_MAX];
+		int count = parp_decode_tags(f, tags, EVT_TAGS_MAX);
+
+		if (count < 0) {
+			d->dec.len_errors++;
+			return;
+		}
+		publish_tags(d, tags, count);
+	} else if (f->cmd == (PARP_CMD_TAG_STREAM | PARP_RSP_FLAG) &&
+		   f->seq == d->req_seq) {
+		if (f->len >= 1 && f->payload[0] == PARP_ST_OK) {
+			d->streaming = true;
+			logmsg(d, "tag stream on");
+		} else {
+			logmsg(d, "tag stream refused (status %u); firmware "
+			       "without CTRL_CAP_TAG_STREAM?",
+			       f->len ? f->payload[0] : 0xFF);
+		}
+	}
+}
+
+static void port_readable(struct parpd *d)
+{
+	static uint8_t buf[READ_CHUNK];
+
+	for (;;) {
+		ssize_t n = read(d->port_fd, buf, sizeof(buf));
+
+		if (n > 0) {
+			d->bytes_in += (uint64_t)n;
+			d->reads++;
+			parp_decoder_feed(&d->dec, buf, (size_t)n, on_frame, d);
+			continue;
+		}
+		if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+			break;
+		}
+		port_close(d, n == 0 ? "hangup" : strerror(errno));
+		break;
+	}
+
+	/* One wake and one send per client for the whole batch */
+	parp_shm_wake(d->shm);
+	for (int i = d->nclients - 1; i >= 0; i--) {
+		if (d->clients[i]->len > 0 && !client_flush(d, d->clients[i])) {
+			client_close(d, i);
+		}
+	}
+}
+
+/* ========================================================================
+ * Housekeeping
+ * ======================================================================== */
+
+static void on_tick(struct parpd *d)
+{
+	if (d->port_fd < 0) {
+		if (port_open(d) == 0) {
+			d->reopens++;
+		}
+	} else if (!d->streaming && ++d->enable_age >= 2) {
+		port_send_enable(d);
+	}
+
+	if (d->stats_interval > 0 && ++d->stats_age >= d->stats_interval) {
+		uint64_t drops = d->client_drops;
+
+		for (int i = 0; i < d->nclients; i++) {
+			drops += d->clients[i]->dropped;
+		}
+		logmsg(d, "%llu tags (%.0f/s), %llu B in %llu reads, crc %llu, "
+		       "lost %llu, clients %d (dropped %llu)",
+		       (unsigned long long)d->tags,
+		       (double)(d->tags - d->last_tags) / d->stats_age,
+		       (unsigned long long)d->bytes_in,
+		       (unsigned long long)d->reads,
+		       (unsigned long long)d->dec.crc_errors,
+		       (unsigned long long)atomic_load(&d->shm->dev_lost),
+		       d->nclients, (unsigned long long)drops);
+		d->last_tags = d->tags;
+		d->stats_age = 0;
+	}
+}
+
+static int setup(struct parpd *d)
+{
+	struct epoll_event ev = { .events = EPOLLIN };
+	struct itimerspec its = {
+		.it_interval = { .tv_sec = 1 },
+		.it_value = { .tv_sec = 1 },
+	};
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	sigset_t mask;
+
+	d->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (d->epfd < 0) {
+		return -errno;
+	}
+
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGINT);
+	sigaddset(&mask, SIGTERM);
+	sigprocmask(SIG_BLOCK, &mask, NULL);
+	d->signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+	d->timer_fd = timerfd_create(CLOCK_MONOTONIC,
+				     TFD_NONBLOCK | TFD_CLOEXEC);
+	if (d->signal_fd < 0 || d->timer_fd < 0) {
+		return -errno;
+	}
+	ev.data.ptr = TAG_SIGNAL;
+	epoll_ctl(d->epfd, EPOLL_CTL_ADD, d->signal_fd, &ev);
+	timerfd_settime(d->timer_fd, 0, &its, NULL);
+	ev.data.ptr = TAG_TIMER;
+	epoll_ctl(d->epfd, EPOLL_CTL_ADD, d->timer_fd, &ev);
+
+	if (strlen(d->sock_path) >= sizeof(addr.sun_path)) {
+		return -ENAMETOOLONG;
+	}
+	strcpy(addr.sun_path, d->sock_path);
+	unlink(d->sock_path);
+	d->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK |
+			      SOCK_CLOEXEC, 0);
+	if (d->listen_fd < 0 ||
+	    bind(d->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+	    listen(d->listen_fd, 16) < 0) {
+		return -errno;
+	}
+	ev.data.ptr = TAG_LISTEN;
+	epoll_ctl(d->epfd, EPOLL_CTL_ADD, d->listen_fd, &ev);
+
+	return 0;
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: parpd -d DEVICE [-s SHM] [-u SOCKET] [-n SLOTS] "
+		"[-i STATS_S] [-q]\n"
+		"  -d  reader control port (second CDC ACM, e.g. /dev/ttyACM1)\n"
+		"  -s  shared-memory ring name (default %s)\n"
+		"  -u  UNIX socket path (default /tmp/parpd.sock)\n"
+		"  -n  ring slots, power of two (default %u)\n"
+		"  -i  stats interval in seconds, 0 = off (default 10)\n"
+		"  -q  quiet\n",
+		PARP_SHM_DEFAULT_NAME, PARP_SHM_DEFAULT_SLOTS);
+}
+
+int main(int argc, char **argv)
+{
+	static struct parpd d = {
+		.shm_name = PARP_SHM_DEFAULT_NAME,
+		.sock_path = "/tmp/parpd.sock",
+		.slots = PARP_SHM_DEFAULT_SLOTS,
+		.stats_interval = 10,
+		.port_fd = -1,
+		.listen_fd = -1,
+	};
+	bool running = true;
+	int opt, err;
+
+	while ((opt = getopt(argc, argv, "d:s:u:n:i:qh")) != -1) {
+		switch (opt) {
+		case 'd':
+			d.dev = optarg;
+			break;
+		case 's':
+			d.shm_name = optarg;
+			break;
+		case 'u':
+			d.sock_path = optarg;
+			break;
+		case 'n':
+			d.slots = (uint32_t)strtoul(optarg, NULL, 0);
+			break;
+		case 'i':
+			d.stats_interval = atoi(optarg);
+			break;
+		case 'q':
+			d.quiet = true;
+			break;
+		default:
+			usage();
+			return 2;
+		}
+	}
+	if (d.dev == NULL || d.slots < 64 || (d.slots & (d.slots - 1)) != 0) {
+		usage();
+		return 2;
+	}
+
+	err = shm_create(&d);
+	if (err < 0) {
+		fprintf(stderr, "parpd: shm %s: %s\n", d.shm_name, strerror(-err));
+		return 1;
+	}
+	err = setup(&d);
+	if (err < 0) {
+		fprintf(stderr, "parpd: setup: %s\n", strerror(-err));
+		shm_unlink(d.shm_name);
+		return 1;
+	}
+	err = port_open(&d);
+	if (err < 0) {
+		logmsg(&d, "%s: %s, retrying every second", d.dev,
+		       strerror(-err));
+	}
+	logmsg(&d, "ring %s (%u slots), socket %s", d.shm_name, d.slots,
+	       d.sock_path);
+
+	while (running) {
+		struct epoll_event evs[MAX_EVENTS];
+		int n = epoll_wait(d.epfd, evs, MAX_EVENTS, -1);
+
+		if (n < 0 && errno != EINTR) {
+			perror("parpd: epoll_wait");
+			break;
+		}
+		for (int i = 0; i < n; i++) {
+			void *tag = evs[i].data.ptr;
+			uint32_t events = evs[i].events;
+
+			if (tag == TAG_PORT) {
+				if (d.port_fd < 0) {
+					continue;
+				}
+				if (events & EPOLLIN) {
+					port_readable(&d);
+				} else if (events & (EPOLLHUP | EPOLLERR)) {
+					port_close(&d, "hangup");
+				}
+			} else if (tag == TAG_LISTEN) {
+				client_accept(&d);
+			} else if (tag == TAG_TIMER) {
+				uint64_t ticks;
+
+				if (read(d.timer_fd, &ticks, sizeof(ticks)) > 0) {
+					on_tick(&d);
+				}
+			} else if (tag == TAG_SIGNAL) {
+				running = false;
+			} else {
+				client_event(&d, tag, events);
+			}
+		}
+	}
+
+	logmsg(&d, "exiting: %llu tags", (unsigned long long)d.tags);
+	for (int i = d.nclients - 1; i >= 0; i--) {
+		client_close(&d, i);
+	}
+	if (d.port_fd >= 0) {
+		port_close(&d, "exit");
+	}
+	unlink(d.sock_path);
+	shm_unlink(d.shm_name);
+	return 0;
+}
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Decode the PARP-01 router metrics snapshot printed by `router snapshot`.
+
+The firmware prints one line, "SNAP <hex>", holding a packed little-endian
+router_metrics_snapshot_t (src/router_metrics.h). This prints it as JSON
+so dashboards and scripts do not have to scrape `router stats`.
+
+Usage:
+    tools/router_snapshot.py log.txt          # last SNAP line in a log
+    echo "SNAP 01060..." | tools/router_snapshot.py
+    tools/router_snapshot.py --port /dev/ttyACM1
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+VERSION = 1
+METRICS = ["reads", "unique", "frames", "uart4_rx", "uart4_tx", "hid_chars"]
+WINDOWS = ["1s", "10s", "60s"]
+SNAP_RE = re.compile(r"SNAP ([0-9A-Fa-f]+)")
+
+NM, NW = len(METRICS), len(WINDOWS)
+LAYOUT = "<BBHII%dQ%dI%dH%dH5I" % (NM, NM * NW, NW, NW)
+
+
+def read_port(port, timeout):
+    import serial  # pyserial, only needed for live reads
+
+    with serial.Serial(port, 115200, timeout=timeout) as ser:
+        ser.reset_input_buffer()
+        ser.write(b"router snapshot\r\n")
+        while True:
+            raw = ser.readline()
+            if not raw:
+                sys.exit("no SNAP line received")
+            line = raw.decode(errors="replace")
+            if SNAP_RE.search(line):
+                return line
+
+
+def decode(hexstr):
+    raw = bytes.fromhex(hexstr)
+    if len(raw) < 4:
+        sys.exit("snapshot too short")
+    version, count, size = struct.unpack_from("<BBH", raw)
+    if version != VERSION or count != NM or size != struct.calcsize(LAYOUT):
+        sys.exit("unsupported snapshot (version %u, %u metrics, %u bytes)"
+                 % (version, count, size))
+
+    v = list(struct.unpack_from(LAYOUT, raw))
+    _, _, _, uptime_ms, baud = v[:5]
+    v = v[5:]
+    totals, v = v[:NM], v[NM:]
+    rates, v = v[:NM * NW], v[NM * NW:]
+    rx_util, v = v[:NW], v[NW:]
+    tx_util, v = v[:NW], v[NW:]
+    rounds, last, rmin, rmax, ravg = v
+
+    return {
+        "uptime_ms": uptime_ms,
+        "uart4_baud": baud,
+        "totals": dict(zip(METRICS, totals)),
+        "rates_per_s": {
+            m: {w: rates[i * NW + j] / 10.0 for j, w in enumerate(WINDOWS)}
+            for i, m in enumerate(METRICS)
+        },
+        "uart4_util_pct": {
+            "rx": {w: rx_util[j] / 100.0 for j, w in enumerate(WINDOWS)},
+            "tx": {w: tx_util[j] / 100.0 for j, w in enumerate(WINDOWS)},
+        },
+        "rounds": {"count": rounds, "last_ms": last, "min_ms": rmin,
+                   "max_ms": rmax, "avg_ms": ravg},
+    }
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("input", nargs="?", help="log file (default: stdin)")
+    ap.add_argument("--port", help="read live from the CDC ACM shell port")
+    ap.add_argument("--timeout", type=float, default=2.0)
+    args = ap.parse_args()
+
+    if args.port:
+        text = read_port(args.port, args.timeout)
+    elif args.input:
+        with open(args.input, errors="replace") as f:
+            text = f.read()
+    else:
+        text = sys.stdin.read()
+
+    matches = SNAP_RE.findall(text)
+    if not matches:
+        sys.exit("no SNAP line found")
+
+    json.dump(decode(matches[-1]), sys.stdout, indent=2)
+    print()
+
+
+if __name__ == "__main__":
+    main()
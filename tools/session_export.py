@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+"""Download a PARP-01 stock-take session over the CDC ACM shell.
+
+Runs `session export bin` (or `csv`) on the port, verifies the stream and
+writes the session as CSV. A saved binary stream (everything between the
+SESSION BEGIN and SESSION END lines, as raw bytes) can be decoded offline.
+
+Binary stream (little endian):
+
+    offset 0   uint32    magic 0x53455350 ("PSES")
+    offset 4   uint8     version (1)
+               uint8     antennas N
+               uint8     stats size (6 + N)
+               uint8     reserved
+               uint32    session id
+               uint32    duration_s
+               uint32    tags at export start
+    then per tag, EPC order, front-coded against the previous tag:
+               uint8     shared prefix length
+               uint8     suffix length
+               suffix bytes
+               uint16    first_s, uint16 last_s, uint16 reads
+               N x uint8 best RSSI per antenna (0 = not seen)
+    end:       uint8     0xFF
+               uint32    CRC-32 (IEEE) of all bytes before it
+
+Usage:
+    tools/session_export.py --port /dev/ttyACM1 -o session.csv
+    tools/session_export.py --port /dev/ttyACM1 --prev -o previous.csv
+    tools/session_export.py --decode stream.bin -o session.csv
+"""
+
+import argparse
+import struct
+import sys
+import time
+import zlib
+
+MAGIC = 0x53455350
+HDR = struct.Struct("<IBBBBIII")
+END = 0xFF
+
+
+def read_port(port, baud, timeout, prev):
+    import serial  # pyserial, only needed for live download
+
+    cmd = "session export bin" + (" prev" if prev else "")
+    with serial.Serial(port, baud, timeout=timeout) as ser:
+        ser.reset_input_buffer()
+        ser.write(cmd.encode("ascii") + b"\r\n")
+        while True:
+            raw = ser.readline()
+            if not raw:
+                raise RuntimeError("timeout waiting for SESSION BEGIN")
+            if b"SESSION BEGIN" in raw:
+                break
+            if b"No such session" in raw:
+                raise RuntimeError("no such session on the reader")
+
+        start = time.monotonic()
+        stream = read_stream(ser)
+        elapsed = time.monotonic() - start
+
+        tail = ser.read_until(b"SESSION END")
+        tail += ser.readline()
+        if b"SESSION END" not in tail:
+            print("warning: no SESSION END line", file=sys.stderr)
+        return stream, elapsed
+
+
+def read_stream(ser):
+    """Read exactly one binary stream by walking its structure."""
+    buf = bytearray(ser.read(HDR.size))
+    if len(buf) < HDR.size:
+        raise RuntimeError("short header")
+    stats_size = buf[6]
+    while True:
+        b = ser.read(1)
+        if not b:
+            raise RuntimeError("timeout inside the binary stream")
+        buf += b
+        if b[0] == END:
+            buf += ser.read(4)
+            return bytes(buf)
+        suffix_len = ser.read(1)
+        buf += suffix_len
+        buf += ser.read(suffix_len[0] + stats_size)
+
+
+def decode(stream):
+    if len(stream) < HDR.size + 5:
+        raise ValueError("stream too short")
+    magic, version, antennas, stats_size, _, sid, duration, tags = \
+        HDR.unpack_from(stream, 0)
+    if magic != MAGIC or version != 1:
+        raise ValueError(f"bad magic/version {magic:#x}/{version}")
+
+    crc = struct.unpack_from("<I", stream, len(stream) - 4)[0]
+    if zlib.crc32(stream[:-4]) & 0xFFFFFFFF != crc:
+        raise ValueError("CRC mismatch")
+
+    rows = []
+    epc = b""
+    pos = HDR.size
+    while stream[pos] != END:
+        shared, suffix_len = stream[pos], stream[pos + 1]
+        pos += 2
+        epc = epc[:shared] + stream[pos:pos + suffix_len]
+        pos += suffix_len
+        first_s, last_s, reads = struct.unpack_from("<HHH", stream, pos)
+        rssi = list(stream[pos + 6:pos + stats_size])
+        pos += stats_size
+        rows.append((epc.hex().upper(), first_s, last_s, reads, rssi))
+
+    info = {"id": sid, "duration_s": duration, "tags": tags,
+            "antennas": antennas}
+    return info, rows
+
+
+def write_csv(path, info, rows):
+    with open(path, "w", encoding="ascii") as f:
+        cols = ",".join(f"rssi_a{a + 1}" for a in range(info["antennas"]))
+        f.write(f"epc,first_s,last_s,reads,{cols}\n")
+        for epc, first_s, last_s, reads, rssi in rows:
+            f.write(f"{epc},{first_s},{last_s},{reads},"
+                    + ",".join(str(r) for r in rssi) + "\n")
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--port", help="download live from this serial port")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--timeout", type=float, default=5.0)
+    ap.add_argument("--prev", action="store_true",
+                    help="export the previous session instead")
+    ap.add_argument("--decode", help="decode a saved binary stream")
+    ap.add_argument("--save-bin", help="also keep the raw binary stream")
+    ap.add_argument("-o", "--output", required=True, help=".csv output path")
+    args = ap.parse_args()
+
+    elapsed = None
+    if args.port:
+        stream, elapsed = read_port(args.port, args.baud, args.timeout,
+                                    args.prev)
+    elif args.decode:
+        with open(args.decode, "rb") as f:
+            stream = f.read()
+    else:
+        ap.error("give --port or --decode")
+
+    if args.save_bin:
+        with open(args.save_bin, "wb") as f:
+            f.write(stream)
+
+    info, rows = decode(stream)
+    write_csv(args.output, info, rows)
+
+    rate = ""
+    if elapsed:
+        rate = f", {len(stream) / elapsed / 1024:.0f} KB/s"
+    print(f"{args.output}: session {info['id']}, {len(rows)} tags, "
+          f"{info['duration_s']} s, {len(stream)} bytes "
+          f"({len(stream) / max(len(rows), 1):.1f} B/tag){rate}")
+
+
+if __name__ == "__main__":
+    main()